@@ -4,8 +4,8 @@
  * SPDX-License-Identifier: MIT
  */
 
-#include "ihist.hpp"
 #include "ihist/ihist.h"
+#include "ihist/ihist.hpp"
 
 #include "benchmark_data.hpp"
 
@@ -231,6 +231,302 @@ std::vector<i64> const data_sizes{512, 1024, 2048, 4096, 8192};
 
 template <unsigned Bits> std::vector<i64> const spread_pcts{0, 1, 6, 25, 100};
 
+// Fused operations are compared with the equivalent separate passes (which
+// must be slower for the fused operation to be worthwhile). These use full-
+// range random data and no mask.
+
+void set_frame_counters(benchmark::State &state, std::size_t size,
+                        std::size_t bytes_per_pixel) {
+    state.SetBytesProcessed(static_cast<i64>(state.iterations()) * size *
+                            bytes_per_pixel);
+    state.counters["pixels_per_second"] = benchmark::Counter(
+        static_cast<double>(static_cast<i64>(state.iterations()) * size),
+        benchmark::Counter::kIsRate);
+}
+
+constexpr ihist_derived_channel derived_channels[] = {IHIST_DERIVED_LUMA_709,
+                                                      IHIST_DERIVED_MAX};
+
+void bm_derived(benchmark::State &state, std::size_t n_derived,
+                bool separate, bool mt) {
+    auto const width = static_cast<std::size_t>(state.range(0));
+    auto const height = width;
+    auto const size = width * height;
+    auto const data = generate_data<u8>(8, size * 3, 1.0f);
+    std::vector<u8> derived(n_derived * size);
+    std::vector<u32> hist((3 + n_derived) << 8);
+    for ([[maybe_unused]] auto _ : state) {
+        if (separate) {
+            ihist_hist8_2d(8, data.data(), nullptr, height, width, width, 0,
+                           3, 3, indices_abc, hist.data(), mt);
+            for (std::size_t i = 0; i < size; ++i) {
+                u32 const r = data[3 * i];
+                u32 const g = data[3 * i + 1];
+                u32 const b = data[3 * i + 2];
+                if (n_derived > 0) {
+                    derived[i] = static_cast<u8>(
+                        (13933 * r + 46871 * g + 4732 * b + 32768) >> 16);
+                }
+                if (n_derived > 1) {
+                    derived[size + i] = static_cast<u8>(std::max({r, g, b}));
+                }
+            }
+            for (std::size_t d = 0; d < n_derived; ++d) {
+                ihist_hist8_2d(8, derived.data() + d * size, nullptr, height,
+                               width, width, 0, 1, 1, indices_mono,
+                               hist.data() + ((3 + d) << 8), mt);
+            }
+        } else {
+            ihist_hist8_2d_derived(8, data.data(), nullptr, height, width,
+                                   width, 0, 3, 3, indices_abc, indices_abc,
+                                   n_derived, derived_channels, hist.data(),
+                                   mt);
+        }
+        benchmark::DoNotOptimize(hist.data());
+    }
+    set_frame_counters(state, size, 3);
+}
+
+void bm_lut8(benchmark::State &state, unsigned bits, bool separate,
+             bool mt) {
+    auto const width = static_cast<std::size_t>(state.range(0));
+    auto const height = width;
+    auto const size = width * height;
+    auto const data = generate_data<u16>(bits, size, 1.0f);
+    std::vector<u8> lut(std::size_t(1) << bits);
+    ihist_window_lut8(bits, 0, (1u << bits) - 1, lut.data());
+    std::vector<u8> output(size);
+    std::vector<u32> hist(std::size_t(1) << bits);
+    for ([[maybe_unused]] auto _ : state) {
+        if (separate) {
+            ihist_hist16_2d(bits, data.data(), nullptr, height, width, width,
+                            0, 1, 1, indices_mono, hist.data(), mt);
+            for (std::size_t i = 0; i < size; ++i) {
+                output[i] = lut[data[i]];
+            }
+        } else {
+            ihist_hist16_2d_lut8(bits, data.data(), nullptr, height, width,
+                                 width, 0, 1, 1, indices_mono, hist.data(),
+                                 lut.data(), output.data(), width, mt);
+        }
+        benchmark::DoNotOptimize(hist.data());
+        benchmark::DoNotOptimize(output.data());
+    }
+    set_frame_counters(state, size, 2);
+}
+
+void bm_corrected(benchmark::State &state, unsigned bits, bool separate,
+                  bool mt) {
+    auto const width = static_cast<std::size_t>(state.range(0));
+    auto const height = width;
+    auto const size = width * height;
+    auto const data = generate_data<u16>(bits, size, 1.0f);
+    auto const dark = generate_data<u16>(bits - 4, size, 1.0f);
+    std::vector<u16> gain(size, u16(1) << 12);
+    std::vector<u16> corrected(size);
+    std::vector<u32> hist(std::size_t(1) << bits);
+    for ([[maybe_unused]] auto _ : state) {
+        if (separate) {
+            for (std::size_t i = 0; i < size; ++i) {
+                u32 v = data[i] > dark[i] ? data[i] - dark[i] : 0;
+                v = (v * gain[i] + (1 << 11)) >> 12;
+                corrected[i] = static_cast<u16>(std::min(v, u32(0xffff)));
+            }
+            ihist_hist16_2d(bits, corrected.data(), nullptr, height, width,
+                            width, 0, 1, 1, indices_mono, hist.data(), mt);
+        } else {
+            ihist_hist16_2d_corrected(bits, data.data(), nullptr, height,
+                                      width, width, 0, 1, 1, indices_mono,
+                                      dark.data(), gain.data(), 12,
+                                      hist.data(), mt);
+        }
+        benchmark::DoNotOptimize(hist.data());
+    }
+    set_frame_counters(state, size, 2);
+}
+
+void bm_difference(benchmark::State &state, unsigned bits,
+                   ihist_difference_mode mode, bool separate, bool mt) {
+    auto const width = static_cast<std::size_t>(state.range(0));
+    auto const height = width;
+    auto const size = width * height;
+    auto const data = generate_data<u16>(bits, size, 1.0f);
+    auto const previous = generate_data<u16>(bits, size, 1.0f);
+    bool const is_signed = mode == IHIST_DIFFERENCE_SIGNED;
+    auto const hist_bits = bits + (is_signed ? 1 : 0);
+    std::vector<u16> difference(size);
+    std::vector<u32> hist(std::size_t(1) << hist_bits);
+    for ([[maybe_unused]] auto _ : state) {
+        if (separate) {
+            u32 const bias = is_signed ? u32(1) << bits : 0;
+            for (std::size_t i = 0; i < size; ++i) {
+                u32 const a = data[i];
+                u32 const b = previous[i];
+                difference[i] = static_cast<u16>(
+                    is_signed ? a + bias - b : (a > b ? a - b : b - a));
+            }
+            ihist_hist16_2d(hist_bits, difference.data(), nullptr, height,
+                            width, width, 0, 1, 1, indices_mono, hist.data(),
+                            mt);
+        } else {
+            ihist_hist16_2d_difference(bits, data.data(), previous.data(),
+                                       nullptr, height, width, width, 0, 1,
+                                       1, indices_mono, mode, hist.data(),
+                                       mt);
+        }
+        benchmark::DoNotOptimize(hist.data());
+    }
+    set_frame_counters(state, size, 4);
+}
+
+template <typename T>
+void bm_copy(benchmark::State &state, std::size_t n_components,
+             bool non_temporal, bool separate, bool mt) {
+    constexpr unsigned bits = 8 * sizeof(T);
+    auto const width = static_cast<std::size_t>(state.range(0));
+    auto const height = width;
+    auto const size = width * height;
+    auto const data = generate_data<T>(bits, size * n_components, 1.0f);
+    std::vector<T> dest(size * n_components);
+    std::vector<u32> hist(n_components << bits);
+    auto const *indices = n_components == 1 ? indices_mono : indices_abc;
+    for ([[maybe_unused]] auto _ : state) {
+        if (separate) {
+            std::copy(data.begin(), data.end(), dest.begin());
+        }
+        if constexpr (sizeof(T) == 1) {
+            if (separate) {
+                ihist_hist8_2d(bits, data.data(), nullptr, height, width,
+                               width, 0, n_components, n_components, indices,
+                               hist.data(), mt);
+            } else {
+                ihist_hist8_2d_copy(bits, data.data(), nullptr, height, width,
+                                    width, 0, n_components, n_components,
+                                    indices, hist.data(), dest.data(), width,
+                                    non_temporal, mt);
+            }
+        } else {
+            if (separate) {
+                ihist_hist16_2d(bits, data.data(), nullptr, height, width,
+                                width, 0, n_components, n_components,
+                                indices, hist.data(), mt);
+            } else {
+                ihist_hist16_2d_copy(bits, data.data(), nullptr, height,
+                                     width, width, 0, n_components,
+                                     n_components, indices, hist.data(),
+                                     dest.data(), width, non_temporal, mt);
+            }
+        }
+        benchmark::DoNotOptimize(hist.data());
+        benchmark::DoNotOptimize(dest.data());
+    }
+    set_frame_counters(state, size, n_components * sizeof(T));
+}
+
+// The frame is split into tiles of tile x tile pixels (a grid of ROIs), which
+// are histogrammed with one call or with a call per tile.
+template <typename T, typename Tile>
+void bm_tiles(benchmark::State &state, unsigned bits,
+              std::size_t n_components, std::size_t tile, bool separate,
+              bool mt) {
+    auto const width = static_cast<std::size_t>(state.range(0));
+    auto const height = width;
+    auto const size = width * height;
+    auto const data = generate_data<T>(bits, size * n_components, 1.0f);
+    std::vector<Tile> tiles;
+    for (std::size_t y = 0; y < height; y += tile) {
+        for (std::size_t x = 0; x < width; x += tile) {
+            tiles.push_back({data.data() + (y * width + x) * n_components,
+                             nullptr, std::min(tile, height - y),
+                             std::min(tile, width - x), width, 0});
+        }
+    }
+    std::vector<u32> hist(n_components << bits);
+    auto const *indices = n_components == 1 ? indices_mono : indices_abc;
+    for ([[maybe_unused]] auto _ : state) {
+        if constexpr (sizeof(T) == 1) {
+            if (separate) {
+                for (auto const &t : tiles) {
+                    ihist_hist8_2d(bits, t.image, nullptr, t.height, t.width,
+                                   t.image_stride, 0, n_components,
+                                   n_components, indices, hist.data(), mt);
+                }
+            } else {
+                ihist_hist8_tiles(bits, tiles.size(), tiles.data(),
+                                  n_components, n_components, indices,
+                                  hist.data(), mt);
+            }
+        } else {
+            if (separate) {
+                for (auto const &t : tiles) {
+                    ihist_hist16_2d(bits, t.image, nullptr, t.height,
+                                    t.width, t.image_stride, 0, n_components,
+                                    n_components, indices, hist.data(), mt);
+                }
+            } else {
+                ihist_hist16_tiles(bits, tiles.size(), tiles.data(),
+                                   n_components, n_components, indices,
+                                   hist.data(), mt);
+            }
+        }
+        benchmark::DoNotOptimize(hist.data());
+    }
+    set_frame_counters(state, size, n_components * sizeof(T));
+}
+
+// The accumulator is fed the frame in bands of 64 rows, as they might arrive
+// from a camera, and compared with one histogram call on the whole frame.
+void bm_accumulator(benchmark::State &state, unsigned bits, bool separate,
+                    bool mt) {
+    constexpr std::size_t band_rows = 64;
+    auto const width = static_cast<std::size_t>(state.range(0));
+    auto const height = width;
+    auto const size = width * height;
+    auto const data = generate_data<u16>(bits, size, 1.0f);
+    std::vector<u32> hist(std::size_t(1) << bits);
+    u32 overflow = 0;
+    ihist_accumulator *acc =
+        ihist_accumulator_create(bits, 1, 1, indices_mono);
+    for ([[maybe_unused]] auto _ : state) {
+        if (separate) {
+            ihist_hist16_2d_overflow(bits, data.data(), nullptr, height,
+                                     width, width, 0, 1, 1, indices_mono,
+                                     hist.data(), &overflow, mt);
+        } else {
+            for (std::size_t y = 0; y < height; y += band_rows) {
+                ihist_accumulator_feed16(acc, data.data() + y * width,
+                                         nullptr,
+                                         std::min(band_rows, height - y),
+                                         width, width, 0, mt);
+            }
+            ihist_accumulator_finish(acc, hist.data(), &overflow);
+        }
+        benchmark::DoNotOptimize(hist.data());
+    }
+    ihist_accumulator_destroy(acc);
+    set_frame_counters(state, size, 2);
+}
+
+std::vector<i64> const fused_sizes{1024, 4096};
+
+// Register the fused and separate variants of a fused operation benchmark,
+// bm(state, separate, mt).
+template <typename F> void register_fused(std::string const &name, F bm) {
+    for (bool mt : {false, true}) {
+        for (bool separate : {false, true}) {
+            benchmark::RegisterBenchmark(
+                ((separate ? "separate/" : "fused/") + name +
+                 (mt ? "/mt" : ""))
+                    .c_str(),
+                [=](benchmark::State &state) { bm(state, separate, mt); })
+                ->MeasureProcessCPUTime()
+                ->UseRealTime()
+                ->ArgName("size")
+                ->ArgsProduct({fused_sizes});
+        }
+    }
+}
+
 } // namespace ihist::bench
 
 auto main(int argc, char **argv) -> int {
@@ -340,6 +636,65 @@ auto main(int argc, char **argv) -> int {
         }
     }
 
+    for (std::size_t n_derived : {0, 1, 2}) {
+        register_fused("derived:" + std::to_string(n_derived) +
+                           "/abc/bits:8",
+                       [=](benchmark::State &state, bool separate, bool mt) {
+                           bm_derived(state, n_derived, separate, mt);
+                       });
+    }
+    for (unsigned bits : {12, 16}) {
+        register_fused("lut8/mono/bits:" + std::to_string(bits),
+                       [=](benchmark::State &state, bool separate, bool mt) {
+                           bm_lut8(state, bits, separate, mt);
+                       });
+    }
+    for (unsigned bits : {12, 16}) {
+        register_fused("corrected/mono/bits:" + std::to_string(bits),
+                       [=](benchmark::State &state, bool separate, bool mt) {
+                           bm_corrected(state, bits, separate, mt);
+                       });
+    }
+    for (auto mode : {IHIST_DIFFERENCE_ABSOLUTE, IHIST_DIFFERENCE_SIGNED}) {
+        register_fused(std::string("difference/") +
+                           (mode == IHIST_DIFFERENCE_SIGNED ? "signed"
+                                                            : "absolute") +
+                           "/mono/bits:12",
+                       [=](benchmark::State &state, bool separate, bool mt) {
+                           bm_difference(state, 12, mode, separate, mt);
+                       });
+    }
+    for (bool non_temporal : {false, true}) {
+        std::string const copy = non_temporal ? "copy:nt/" : "copy/";
+        register_fused(copy + "mono/bits:16",
+                       [=](benchmark::State &state, bool separate, bool mt) {
+                           bm_copy<u16>(state, 1, non_temporal, separate, mt);
+                       });
+        register_fused(copy + "abc/bits:8",
+                       [=](benchmark::State &state, bool separate, bool mt) {
+                           bm_copy<u8>(state, 3, non_temporal, separate, mt);
+                       });
+    }
+    for (std::size_t tile : {64, 512}) {
+        std::string const tiles = "tiles:" + std::to_string(tile) + "/";
+        register_fused(tiles + "mono/bits:12",
+                       [=](benchmark::State &state, bool separate, bool mt) {
+                           bm_tiles<u16, ihist_tile16>(state, 12, 1, tile,
+                                                       separate, mt);
+                       });
+        register_fused(tiles + "abc/bits:8",
+                       [=](benchmark::State &state, bool separate, bool mt) {
+                           bm_tiles<u8, ihist_tile8>(state, 8, 3, tile,
+                                                     separate, mt);
+                       });
+    }
+    for (unsigned bits : {12, 16}) {
+        register_fused("accumulator/mono/bits:" + std::to_string(bits),
+                       [=](benchmark::State &state, bool separate, bool mt) {
+                           bm_accumulator(state, bits, separate, mt);
+                       });
+    }
+
     using namespace benchmark;
     Initialize(&argc, argv);
     if (ReportUnrecognizedArguments(argc, argv))
@@ -4,7 +4,7 @@
  * SPDX-License-Identifier: MIT
  */
 
-#include "ihist.hpp"
+#include "ihist/ihist.hpp"
 
 #include "benchmark_data.hpp"
 #include "tmpl_instantiations.hpp"
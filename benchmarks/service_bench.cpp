@@ -0,0 +1,175 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+// End-to-end latency of the ihistd service: from submitting a frame that is
+// already in shared memory to having read the published histogram, compared
+// with histogramming in-process. The service runs on a thread of this
+// process, so the measured overhead is that of the socket round trip and the
+// shared memory publication, not of process scheduling.
+
+#include "ihist/ihist.h"
+
+#include "benchmark_data.hpp"
+#include "client.hpp"
+#include "posix.hpp"
+#include "protocol.hpp"
+#include "server.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ihist::bench {
+
+namespace {
+
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+using i64 = std::int64_t;
+
+constexpr std::size_t bits = 12;
+
+auto unique_name(std::string const &what) -> std::string {
+    return "/ihist-bench-" + what + "-" + std::to_string(getpid());
+}
+
+void bm_service(benchmark::State &state, std::size_t n_components, bool mt) {
+    auto const width = static_cast<std::size_t>(state.range(0));
+    auto const height = width;
+    auto const size = width * height;
+    auto const data = generate_data<u16>(bits, size * n_components, 0.25f);
+
+    std::string const frame_name = unique_name("frame");
+    auto frame = service::shared_memory::create(frame_name,
+                                                data.size() * sizeof(u16));
+    std::memcpy(frame.data(), data.data(), data.size() * sizeof(u16));
+
+    service::server_config config;
+    config.socket_path = "/tmp" + unique_name("socket");
+    config.region_name = unique_name("region");
+    config.max_sample_bits = bits;
+    config.max_components = n_components;
+    config.parallel = mt;
+    service::server srv(config);
+    std::thread thread([&] { srv.run(); });
+
+    {
+        service::client cli(config.socket_path);
+        service::region_reader const reader(config.region_name);
+        service::snapshot snap{};
+        service::frame_request request{};
+        request.version = service::protocol_version;
+        request.sample_size = sizeof(u16);
+        request.sample_bits = bits;
+        request.n_components = static_cast<std::uint32_t>(n_components);
+        request.height = height;
+        request.width = width;
+        request.stride = width;
+        std::strncpy(request.shm_name, frame_name.c_str(),
+                     sizeof(request.shm_name) - 1);
+
+        double publish_to_read_ns = 0.0;
+        for ([[maybe_unused]] auto _ : state) {
+            ++request.frame_id;
+            auto const reply = cli.submit(request);
+            if (reply.result != service::status::ok ||
+                !reader.read_latest(snap)) {
+                state.SkipWithError("service request failed");
+                break;
+            }
+            auto const now_ns = std::chrono::duration_cast<
+                                    std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now()
+                                        .time_since_epoch())
+                                    .count();
+            publish_to_read_ns +=
+                static_cast<double>(now_ns) -
+                static_cast<double>(snap.publish_time_ns);
+            benchmark::DoNotOptimize(snap.histogram.data());
+        }
+        state.counters["publish_to_read_ns"] = benchmark::Counter(
+            publish_to_read_ns, benchmark::Counter::kAvgIterations);
+        state.counters["pixels_per_second"] = benchmark::Counter(
+            static_cast<double>(static_cast<i64>(state.iterations()) * size),
+            benchmark::Counter::kIsRate);
+    }
+
+    srv.stop();
+    thread.join();
+}
+
+void bm_in_process(benchmark::State &state, std::size_t n_components,
+                   bool mt) {
+    auto const width = static_cast<std::size_t>(state.range(0));
+    auto const height = width;
+    auto const size = width * height;
+    auto const data = generate_data<u16>(bits, size * n_components, 0.25f);
+    std::vector<std::size_t> indices(n_components);
+    for (std::size_t i = 0; i < n_components; ++i) {
+        indices[i] = i;
+    }
+    std::vector<u32> hist(n_components << bits);
+    for ([[maybe_unused]] auto _ : state) {
+        std::fill(hist.begin(), hist.end(), 0);
+        ihist_hist16_2d(bits, data.data(), nullptr, height, width, width,
+                        width, n_components, n_components, indices.data(),
+                        hist.data(), mt);
+        benchmark::DoNotOptimize(hist.data());
+    }
+    state.counters["pixels_per_second"] = benchmark::Counter(
+        static_cast<double>(static_cast<i64>(state.iterations()) * size),
+        benchmark::Counter::kIsRate);
+}
+
+} // namespace
+
+} // namespace ihist::bench
+
+auto main(int argc, char **argv) -> int {
+    using namespace ihist::bench;
+
+    std::vector<i64> const sizes{256, 1024, 2048, 4096};
+    for (std::size_t n_components : {1, 3}) {
+        for (bool mt : {false, true}) {
+            std::string const suffix =
+                std::string(n_components == 1 ? "/mono" : "/abc") +
+                "/bits:12/mt:" + (mt ? "1" : "0");
+            benchmark::RegisterBenchmark(
+                ("service" + suffix).c_str(),
+                [=](benchmark::State &state) {
+                    bm_service(state, n_components, mt);
+                })
+                ->UseRealTime()
+                ->ArgNames({"size"})
+                ->ArgsProduct({sizes});
+            benchmark::RegisterBenchmark(
+                ("in-process" + suffix).c_str(),
+                [=](benchmark::State &state) {
+                    bm_in_process(state, n_components, mt);
+                })
+                ->UseRealTime()
+                ->ArgNames({"size"})
+                ->ArgsProduct({sizes});
+        }
+    }
+
+    using namespace benchmark;
+    Initialize(&argc, argv);
+    if (ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    RunSpecifiedBenchmarks();
+    Shutdown();
+    return 0;
+}
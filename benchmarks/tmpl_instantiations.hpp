@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include "ihist.hpp"
+#include "ihist/ihist.hpp"
 
 #ifndef IHIST_TMPL_EXTERN_0
 #define IHIST_TMPL_EXTERN_0 extern
@@ -0,0 +1,453 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+// ihist command-line tool: histogram raw image dumps and uncompressed TIFF
+// files through memory mapping, without loading them into memory first.
+
+#include "ihist/ihist.h"
+
+#include "mapped_file.hpp"
+#include "output.hpp"
+#include "tiff.hpp"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ihist::cli {
+
+namespace {
+
+// Files are histogrammed in chunks of about this size. Each chunk is large
+// enough for the library to parallelize efficiently, and the next chunk is
+// prefetched while the current one is histogrammed.
+constexpr std::size_t chunk_bytes = std::size_t(64) << 20;
+
+constexpr char const *usage = R"(usage:
+  ihist raw FILE --width W --height H [--components C] [--dtype uint8|uint16]
+            [--offset BYTES] [--frames N] [OPTIONS]
+  ihist tiff FILE [OPTIONS]
+
+Histogram a raw image dump (one or more frames of H x W pixels with C
+interleaved components, starting at byte OFFSET) or an uncompressed TIFF file
+(all pages). The file is memory-mapped and read sequentially.
+
+options:
+  --bits B         significant bits per sample (default: full sample width)
+  --format F       csv (default), json, or npy
+  --output PATH    write the histogram to PATH instead of stdout
+  --serial         histogram on a single thread
+  --time           print the data size, time, and throughput to stderr
+  --help           show this message
+)";
+
+struct usage_error : std::invalid_argument {
+    using std::invalid_argument::invalid_argument;
+};
+
+struct options {
+    std::string mode;
+    std::string path;
+    std::size_t width = 0;
+    std::size_t height = 0;
+    std::size_t n_components = 1;
+    std::size_t sample_size = 2; // Bytes
+    std::size_t offset = 0;
+    std::optional<std::size_t> frames;
+    std::optional<std::size_t> bits;
+    output_format format = output_format::csv;
+    std::string output;
+    bool parallel = true;
+    bool time = false;
+    bool help = false;
+};
+
+auto parse_size(std::string const &name, std::string const &value)
+    -> std::size_t {
+    std::size_t pos = 0;
+    unsigned long long v = 0;
+    try {
+        v = std::stoull(value, &pos);
+    } catch (std::exception const &) {
+        pos = 0;
+    }
+    if (pos == 0 || pos != value.size() || value[0] == '-' ||
+        v > std::numeric_limits<std::size_t>::max()) {
+        throw usage_error("Invalid value for " + name + ": " + value);
+    }
+    return static_cast<std::size_t>(v);
+}
+
+auto parse_args(int argc, char const *const *argv) -> options {
+    options opts;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string const arg = argv[i];
+        if (arg.size() < 2 || arg.compare(0, 2, "--") != 0) {
+            positional.push_back(arg);
+            continue;
+        }
+        if (arg == "--help") {
+            opts.help = true;
+            return opts;
+        }
+        if (arg == "--serial") {
+            opts.parallel = false;
+            continue;
+        }
+        if (arg == "--time") {
+            opts.time = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            throw usage_error("Missing value for " + arg);
+        }
+        std::string const value = argv[++i];
+        if (arg == "--width") {
+            opts.width = parse_size(arg, value);
+        } else if (arg == "--height") {
+            opts.height = parse_size(arg, value);
+        } else if (arg == "--components") {
+            opts.n_components = parse_size(arg, value);
+        } else if (arg == "--dtype") {
+            if (value == "uint8") {
+                opts.sample_size = 1;
+            } else if (value == "uint16") {
+                opts.sample_size = 2;
+            } else {
+                throw usage_error("Invalid value for --dtype: " + value);
+            }
+        } else if (arg == "--offset") {
+            opts.offset = parse_size(arg, value);
+        } else if (arg == "--frames") {
+            opts.frames = parse_size(arg, value);
+        } else if (arg == "--bits") {
+            opts.bits = parse_size(arg, value);
+        } else if (arg == "--format") {
+            opts.format = parse_output_format(value);
+        } else if (arg == "--output") {
+            opts.output = value;
+        } else {
+            throw usage_error("Unknown option: " + arg);
+        }
+    }
+    if (positional.size() != 2 ||
+        (positional[0] != "raw" && positional[0] != "tiff")) {
+        throw usage_error("Expected 'raw FILE' or 'tiff FILE'");
+    }
+    opts.mode = positional[0];
+    opts.path = positional[1];
+    if (opts.mode == "raw" &&
+        (opts.width == 0 || opts.height == 0 || opts.n_components == 0)) {
+        throw usage_error("raw requires positive --width and --height");
+    }
+    return opts;
+}
+
+// A run of rows, contiguous in the file, of one plane.
+struct block {
+    std::size_t offset;
+    std::size_t rows;
+    std::size_t width;
+    std::size_t n_components; // Interleaved in the file
+    std::size_t plane;        // First output histogram
+};
+
+// Accumulates into 32-bit histograms with the C API, and spills into 64-bit
+// totals before any 32-bit count could overflow, so that files of any size
+// can be histogrammed.
+class histogrammer {
+  public:
+    histogrammer(std::size_t sample_bits, std::size_t n_out, bool parallel)
+        : sample_bits_(sample_bits), n_bins_(std::size_t(1) << sample_bits),
+          parallel_(parallel), pending_(n_out * n_bins_),
+          totals_(n_out * n_bins_) {}
+
+    template <typename T>
+    void add(T const *data, block const &b) {
+        std::uint64_t const pixels = std::uint64_t(b.rows) * b.width;
+        if (pending_pixels_ + pixels >=
+            std::numeric_limits<std::uint32_t>::max()) {
+            flush();
+        }
+        pending_pixels_ += pixels;
+
+        std::vector<std::size_t> indices(b.n_components);
+        std::iota(indices.begin(), indices.end(), std::size_t(0));
+        std::uint32_t *hist = pending_.data() + b.plane * n_bins_;
+        if constexpr (sizeof(T) == 1) {
+            ihist_hist8_2d(sample_bits_, data, nullptr, b.rows, b.width,
+                           b.width, b.width, b.n_components, b.n_components,
+                           indices.data(), hist, parallel_);
+        } else {
+            ihist_hist16_2d(sample_bits_, data, nullptr, b.rows, b.width,
+                            b.width, b.width, b.n_components, b.n_components,
+                            indices.data(), hist, parallel_);
+        }
+    }
+
+    auto finish() -> std::vector<std::uint64_t> const & {
+        flush();
+        return totals_;
+    }
+
+  private:
+    void flush() {
+        std::transform(pending_.begin(), pending_.end(), totals_.begin(),
+                       totals_.begin(), [](std::uint32_t p, std::uint64_t t) {
+                           return t + p;
+                       });
+        std::fill(pending_.begin(), pending_.end(), 0);
+        pending_pixels_ = 0;
+    }
+
+    std::size_t sample_bits_;
+    std::size_t n_bins_;
+    bool parallel_;
+    std::vector<std::uint32_t> pending_;
+    std::vector<std::uint64_t> totals_;
+    std::uint64_t pending_pixels_ = 0;
+};
+
+auto host_is_big_endian() -> bool {
+    std::uint16_t const one = 1;
+    unsigned char first = 0;
+    std::memcpy(&first, &one, 1);
+    return first == 0;
+}
+
+// Split blocks so that no piece is much larger than chunk_bytes.
+auto split_into_chunks(std::vector<block> const &blocks,
+                       std::size_t sample_size) -> std::vector<block> {
+    std::vector<block> chunks;
+    for (block const &b : blocks) {
+        std::size_t const row_bytes = b.width * b.n_components * sample_size;
+        std::size_t const rows_per_chunk =
+            std::max(std::size_t(1), chunk_bytes / row_bytes);
+        for (std::size_t y = 0; y < b.rows; y += rows_per_chunk) {
+            chunks.push_back({b.offset + y * row_bytes,
+                              std::min(rows_per_chunk, b.rows - y), b.width,
+                              b.n_components, b.plane});
+        }
+    }
+    return chunks;
+}
+
+// Histogram the blocks in file order, prefetching one chunk ahead. Returns
+// the number of bytes histogrammed.
+auto histogram_blocks(mapped_file const &file,
+                      std::vector<block> const &blocks,
+                      std::size_t sample_size, bool swap_bytes,
+                      histogrammer &hist) -> std::size_t {
+    auto const chunks = split_into_chunks(blocks, sample_size);
+    auto const bytes_of = [&](block const &c) {
+        return c.rows * c.width * c.n_components * sample_size;
+    };
+
+    file.advise_sequential();
+    if (!chunks.empty()) {
+        file.prefetch(chunks[0].offset, bytes_of(chunks[0]));
+    }
+    std::vector<std::uint16_t> buffer;
+    std::size_t total_bytes = 0;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        block const &c = chunks[i];
+        if (i + 1 < chunks.size()) {
+            file.prefetch(chunks[i + 1].offset, bytes_of(chunks[i + 1]));
+        }
+        std::size_t const n_bytes = bytes_of(c);
+        unsigned char const *src = file.data() + c.offset;
+        if (sample_size == 1) {
+            hist.add(src, c);
+        } else if (!swap_bytes && c.offset % alignof(std::uint16_t) == 0) {
+            hist.add(reinterpret_cast<std::uint16_t const *>(src), c);
+        } else {
+            // Foreign byte order (TIFF) or misaligned samples: convert into
+            // a buffer first.
+            buffer.resize(n_bytes / 2);
+            std::memcpy(buffer.data(), src, n_bytes);
+            if (swap_bytes) {
+                for (std::uint16_t &v : buffer) {
+                    v = static_cast<std::uint16_t>((v << 8) | (v >> 8));
+                }
+            }
+            hist.add(buffer.data(), c);
+        }
+        total_bytes += n_bytes;
+    }
+    return total_bytes;
+}
+
+auto check_bits(options const &opts, std::size_t sample_size)
+    -> std::size_t {
+    std::size_t const max_bits = 8 * sample_size;
+    std::size_t const bits = opts.bits.value_or(max_bits);
+    if (bits > max_bits) {
+        throw usage_error("--bits must be at most " +
+                          std::to_string(max_bits) + " for this data");
+    }
+    return bits;
+}
+
+struct result {
+    std::size_t sample_bits;
+    std::size_t n_components;
+    std::vector<std::uint64_t> histogram;
+    std::size_t bytes;
+};
+
+auto histogram_raw(options const &opts, mapped_file const &file) -> result {
+    if (opts.offset > file.size() ||
+        opts.width > file.size() / opts.n_components / opts.sample_size) {
+        throw std::runtime_error("File is smaller than --offset plus one row");
+    }
+    std::size_t const row_bytes =
+        opts.width * opts.n_components * opts.sample_size;
+    std::size_t const frame_rows = opts.height;
+    std::size_t const available_rows = (file.size() - opts.offset) / row_bytes;
+    std::size_t const available_frames = available_rows / frame_rows;
+    std::size_t const frames = opts.frames.value_or(available_frames);
+    if (frames > available_frames || frames == 0) {
+        throw std::runtime_error(
+            "File contains " + std::to_string(available_frames) +
+            " complete frame(s) of the given size after --offset");
+    }
+
+    std::size_t const bits = check_bits(opts, opts.sample_size);
+    histogrammer hist(bits, opts.n_components, opts.parallel);
+    std::vector<block> const blocks{
+        {opts.offset, frames * frame_rows, opts.width, opts.n_components, 0}};
+    std::size_t const bytes =
+        histogram_blocks(file, blocks, opts.sample_size, false, hist);
+    return {bits, opts.n_components, hist.finish(), bytes};
+}
+
+auto histogram_tiff(options const &opts, mapped_file const &file) -> result {
+    tiff_file const tiff = parse_tiff(file.data(), file.size());
+    tiff_page const &first = tiff.pages.front();
+    for (tiff_page const &page : tiff.pages) {
+        if (page.bits_per_sample != first.bits_per_sample ||
+            page.samples_per_pixel != first.samples_per_pixel) {
+            throw std::runtime_error("TIFF pages differ in bits per sample or "
+                                     "samples per pixel");
+        }
+    }
+    std::size_t const sample_size = first.bits_per_sample / 8;
+    std::size_t const n_out = first.samples_per_pixel;
+
+    // Merge strips that follow each other in the file (as most writers
+    // store them, often across pages) into larger blocks.
+    std::vector<block> blocks;
+    for (tiff_page const &page : tiff.pages) {
+        std::size_t const n_components = page.planar ? 1 : n_out;
+        std::size_t const row_bytes = page.width * n_components * sample_size;
+        for (tiff_strip const &strip : page.strips) {
+            auto const offset = static_cast<std::size_t>(strip.offset);
+            if (!blocks.empty()) {
+                block &prev = blocks.back();
+                if (prev.width == page.width &&
+                    prev.n_components == n_components &&
+                    prev.plane == strip.plane &&
+                    prev.offset + prev.rows * row_bytes == offset) {
+                    prev.rows += strip.rows;
+                    continue;
+                }
+            }
+            blocks.push_back(
+                {offset, strip.rows, page.width, n_components, strip.plane});
+        }
+    }
+
+    std::size_t const bits = check_bits(opts, sample_size);
+    histogrammer hist(bits, n_out, opts.parallel);
+    bool const swap_bytes =
+        sample_size == 2 && tiff.big_endian != host_is_big_endian();
+    std::size_t const bytes =
+        histogram_blocks(file, blocks, sample_size, swap_bytes, hist);
+    return {bits, n_out, hist.finish(), bytes};
+}
+
+auto run(options const &opts) -> int {
+    mapped_file const file(opts.path);
+    auto const start = std::chrono::steady_clock::now();
+    result const res = opts.mode == "raw" ? histogram_raw(opts, file)
+                                          : histogram_tiff(opts, file);
+    std::chrono::duration<double> const elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    if (opts.output.empty()) {
+#ifdef _WIN32
+        if (opts.format == output_format::npy) {
+            _setmode(_fileno(stdout), _O_BINARY);
+        }
+#endif
+        write_histogram(std::cout, opts.format, res.sample_bits,
+                        res.n_components, res.histogram);
+        std::cout.flush();
+    } else {
+        std::ofstream out(opts.output, std::ios::binary);
+        if (!out) {
+            throw std::runtime_error("cannot open " + opts.output);
+        }
+        write_histogram(out, opts.format, res.sample_bits, res.n_components,
+                        res.histogram);
+        if (!out) {
+            throw std::runtime_error("error writing " + opts.output);
+        }
+    }
+
+    if (opts.time) {
+        double const secs = elapsed.count();
+        std::fprintf(stderr, "%zu bytes in %.3f s (%.2f GB/s)\n", res.bytes,
+                     secs, secs > 0.0 ? double(res.bytes) / secs / 1e9 : 0.0);
+    }
+    return 0;
+}
+
+} // namespace
+
+} // namespace ihist::cli
+
+auto main(int argc, char **argv) -> int {
+    using namespace ihist::cli;
+    options opts;
+    try {
+        opts = parse_args(argc, argv);
+    } catch (std::invalid_argument const &e) {
+        std::cerr << "ihist: " << e.what() << "\n\n" << usage;
+        return 2;
+    }
+    if (opts.help) {
+        std::cout << usage;
+        return 0;
+    }
+    try {
+        return run(opts);
+    } catch (usage_error const &e) {
+        std::cerr << "ihist: " << e.what() << '\n';
+        return 2;
+    } catch (std::exception const &e) {
+        std::cerr << "ihist: error: " << e.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace ihist::cli {
+
+#ifdef _WIN32
+
+mapped_file::mapped_file(std::string const &path) {
+    file_handle_ =
+        CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                    OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_handle_ == INVALID_HANDLE_VALUE) {
+        file_handle_ = nullptr;
+        throw std::runtime_error("cannot open " + path);
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle_, &file_size)) {
+        CloseHandle(file_handle_);
+        throw std::runtime_error("cannot get size of " + path);
+    }
+    if (static_cast<std::uint64_t>(file_size.QuadPart) >
+        std::numeric_limits<std::size_t>::max()) {
+        CloseHandle(file_handle_);
+        throw std::runtime_error(path + " is too large to map");
+    }
+    size_ = static_cast<std::size_t>(file_size.QuadPart);
+    if (size_ == 0) {
+        return;
+    }
+    mapping_handle_ = CreateFileMappingA(file_handle_, nullptr, PAGE_READONLY,
+                                         0, 0, nullptr);
+    if (mapping_handle_ == nullptr) {
+        CloseHandle(file_handle_);
+        throw std::runtime_error("cannot map " + path);
+    }
+    data_ = static_cast<unsigned char const *>(
+        MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        CloseHandle(mapping_handle_);
+        CloseHandle(file_handle_);
+        throw std::runtime_error("cannot map " + path);
+    }
+}
+
+mapped_file::~mapped_file() {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_handle_ != nullptr) {
+        CloseHandle(mapping_handle_);
+    }
+    if (file_handle_ != nullptr) {
+        CloseHandle(file_handle_);
+    }
+}
+
+// FILE_FLAG_SEQUENTIAL_SCAN (above) is the closest Windows equivalent.
+void mapped_file::advise_sequential() const {}
+
+void mapped_file::prefetch(std::size_t, std::size_t) const {}
+
+#else
+
+mapped_file::mapped_file(std::string const &path) {
+    fd_ = open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw std::runtime_error("cannot open " + path + ": " +
+                                 std::strerror(errno));
+    }
+    struct stat st {};
+    if (fstat(fd_, &st) != 0) {
+        int const err = errno;
+        close(fd_);
+        throw std::runtime_error("cannot stat " + path + ": " +
+                                 std::strerror(err));
+    }
+    if (static_cast<std::uint64_t>(st.st_size) >
+        std::numeric_limits<std::size_t>::max()) {
+        close(fd_);
+        throw std::runtime_error(path + " is too large to map");
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ == 0) {
+        return;
+    }
+    void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (p == MAP_FAILED) {
+        int const err = errno;
+        close(fd_);
+        throw std::runtime_error("cannot map " + path + ": " +
+                                 std::strerror(err));
+    }
+    data_ = static_cast<unsigned char const *>(p);
+}
+
+mapped_file::~mapped_file() {
+    if (data_ != nullptr) {
+        munmap(const_cast<unsigned char *>(data_), size_);
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+void mapped_file::advise_sequential() const {
+    if (data_ != nullptr) {
+        posix_madvise(const_cast<unsigned char *>(data_), size_,
+                      POSIX_MADV_SEQUENTIAL);
+    }
+}
+
+void mapped_file::prefetch(std::size_t offset, std::size_t size) const {
+    if (data_ == nullptr || offset >= size_) {
+        return;
+    }
+    // The address must be page-aligned.
+    static std::size_t const page_size =
+        static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t const begin = offset - offset % page_size;
+    std::size_t const end = offset + std::min(size, size_ - offset);
+    posix_madvise(const_cast<unsigned char *>(data_) + begin, end - begin,
+                  POSIX_MADV_WILLNEED);
+}
+
+#endif
+
+} // namespace ihist::cli
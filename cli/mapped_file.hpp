@@ -0,0 +1,46 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace ihist::cli {
+
+// Read-only memory mapping of a whole file. Throws std::runtime_error if the
+// file cannot be opened or mapped.
+class mapped_file {
+  public:
+    explicit mapped_file(std::string const &path);
+    ~mapped_file();
+
+    mapped_file(mapped_file const &) = delete;
+    auto operator=(mapped_file const &) -> mapped_file & = delete;
+
+    [[nodiscard]] auto data() const -> unsigned char const * { return data_; }
+    [[nodiscard]] auto size() const -> std::size_t { return size_; }
+
+    // Hint that the mapping will be read front to back, so that the OS reads
+    // ahead aggressively and drops pages behind. No-op where unsupported.
+    void advise_sequential() const;
+
+    // Start reading [offset, offset + size) into the page cache without
+    // waiting for it. No-op where unsupported.
+    void prefetch(std::size_t offset, std::size_t size) const;
+
+  private:
+    unsigned char const *data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void *file_handle_ = nullptr;
+    void *mapping_handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+} // namespace ihist::cli
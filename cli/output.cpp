@@ -0,0 +1,131 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "output.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ihist::cli {
+
+namespace {
+
+void write_csv(std::ostream &out, std::size_t n_bins,
+               std::size_t n_components,
+               std::vector<std::uint64_t> const &histogram) {
+    out << "bin";
+    if (n_components == 1) {
+        out << ",count";
+    } else {
+        for (std::size_t c = 0; c < n_components; ++c) {
+            out << ",c" << c;
+        }
+    }
+    out << '\n';
+    for (std::size_t bin = 0; bin < n_bins; ++bin) {
+        out << bin;
+        for (std::size_t c = 0; c < n_components; ++c) {
+            out << ',' << histogram[c * n_bins + bin];
+        }
+        out << '\n';
+    }
+}
+
+void write_json(std::ostream &out, std::size_t sample_bits,
+                std::size_t n_bins, std::size_t n_components,
+                std::vector<std::uint64_t> const &histogram) {
+    auto const write_list = [&](std::size_t c) {
+        out << '[';
+        for (std::size_t bin = 0; bin < n_bins; ++bin) {
+            out << (bin > 0 ? "," : "") << histogram[c * n_bins + bin];
+        }
+        out << ']';
+    };
+    out << "{\"bits\":" << sample_bits << ",\"histogram\":";
+    if (n_components == 1) {
+        write_list(0);
+    } else {
+        out << '[';
+        for (std::size_t c = 0; c < n_components; ++c) {
+            out << (c > 0 ? "," : "");
+            write_list(c);
+        }
+        out << ']';
+    }
+    out << "}\n";
+}
+
+void write_npy(std::ostream &out, std::size_t n_bins,
+               std::size_t n_components,
+               std::vector<std::uint64_t> const &histogram) {
+    std::string const shape =
+        n_components == 1 ? "(" + std::to_string(n_bins) + ",)"
+                          : "(" + std::to_string(n_components) + ", " +
+                                std::to_string(n_bins) + ")";
+    std::string header = "{'descr': '<u8', 'fortran_order': False, 'shape': " +
+                         shape + ", }";
+    // Magic (6) + version (2) + header length (2) + header, padded with
+    // spaces and terminated by a newline to a multiple of 64 bytes.
+    std::size_t const unpadded = 10 + header.size() + 1;
+    header.append((64 - unpadded % 64) % 64, ' ');
+    header.push_back('\n');
+    assert(header.size() <= 65535);
+
+    out.write("\x93NUMPY\x01\x00", 8);
+    char const len[2] = {static_cast<char>(header.size() & 0xff),
+                         static_cast<char>(header.size() >> 8)};
+    out.write(len, 2);
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    for (std::uint64_t v : histogram) {
+        char bytes[8];
+        for (char &b : bytes) {
+            b = static_cast<char>(v & 0xff);
+            v >>= 8;
+        }
+        out.write(bytes, 8);
+    }
+}
+
+} // namespace
+
+auto parse_output_format(std::string const &name) -> output_format {
+    if (name == "csv") {
+        return output_format::csv;
+    }
+    if (name == "json") {
+        return output_format::json;
+    }
+    if (name == "npy") {
+        return output_format::npy;
+    }
+    throw std::invalid_argument("Unknown output format: " + name +
+                                " (expected csv, json, or npy)");
+}
+
+void write_histogram(std::ostream &out, output_format format,
+                     std::size_t sample_bits, std::size_t n_components,
+                     std::vector<std::uint64_t> const &histogram) {
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    assert(histogram.size() == n_components * n_bins);
+    switch (format) {
+    case output_format::csv:
+        write_csv(out, n_bins, n_components, histogram);
+        break;
+    case output_format::json:
+        write_json(out, sample_bits, n_bins, n_components, histogram);
+        break;
+    case output_format::npy:
+        write_npy(out, n_bins, n_components, histogram);
+        break;
+    }
+}
+
+} // namespace ihist::cli
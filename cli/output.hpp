@@ -0,0 +1,30 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ihist::cli {
+
+enum class output_format { csv, json, npy };
+
+// Throws std::invalid_argument for an unknown name.
+auto parse_output_format(std::string const &name) -> output_format;
+
+// Write n_components histograms of 2^sample_bits bins each (concatenated in
+// histogram). A single histogram is written as 1D (a count column in CSV, a
+// flat list in JSON, shape (n_bins,) in NPY); otherwise one column, list, or
+// row per component. NPY output is uint64 in NPY format version 1.0.
+void write_histogram(std::ostream &out, output_format format,
+                     std::size_t sample_bits, std::size_t n_components,
+                     std::vector<std::uint64_t> const &histogram);
+
+} // namespace ihist::cli
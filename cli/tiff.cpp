@@ -0,0 +1,296 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "tiff.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ihist::cli {
+
+namespace {
+
+enum : std::uint16_t {
+    tag_image_width = 256,
+    tag_image_length = 257,
+    tag_bits_per_sample = 258,
+    tag_compression = 259,
+    tag_strip_offsets = 273,
+    tag_samples_per_pixel = 277,
+    tag_rows_per_strip = 278,
+    tag_strip_byte_counts = 279,
+    tag_planar_configuration = 284,
+    tag_tile_width = 322,
+    tag_sample_format = 339,
+};
+
+class reader {
+  public:
+    reader(unsigned char const *data, std::size_t size, bool big_endian)
+        : data_(data), size_(size), big_endian_(big_endian) {}
+
+    [[nodiscard]] auto uint(std::uint64_t offset, std::size_t n_bytes) const
+        -> std::uint64_t {
+        if (offset > size_ || n_bytes > size_ - offset) {
+            throw std::runtime_error("TIFF data extends past end of file");
+        }
+        std::uint64_t v = 0;
+        for (std::size_t i = 0; i < n_bytes; ++i) {
+            std::size_t const b = big_endian_ ? i : n_bytes - 1 - i;
+            v = (v << 8) | data_[offset + b];
+        }
+        return v;
+    }
+
+    [[nodiscard]] auto size() const -> std::size_t { return size_; }
+
+  private:
+    unsigned char const *data_;
+    std::size_t size_;
+    bool big_endian_;
+};
+
+// Values of one IFD entry, for the integer types used by the tags we read.
+auto entry_values(reader const &r, std::uint64_t entry, bool big_tiff)
+    -> std::vector<std::uint64_t> {
+    auto const type = r.uint(entry + 2, 2);
+    std::uint64_t const count = r.uint(entry + 4, big_tiff ? 8 : 4);
+    std::size_t elem_size = 0;
+    switch (type) {
+    case 1: // BYTE
+        elem_size = 1;
+        break;
+    case 3: // SHORT
+        elem_size = 2;
+        break;
+    case 4: // LONG
+    case 13: // IFD
+        elem_size = 4;
+        break;
+    case 16: // LONG8
+        elem_size = 8;
+        break;
+    default:
+        throw std::runtime_error("Unsupported TIFF field type " +
+                                 std::to_string(type) + " for tag " +
+                                 std::to_string(r.uint(entry, 2)));
+    }
+    if (count > r.size() / elem_size) {
+        throw std::runtime_error("TIFF field count exceeds file size");
+    }
+    std::size_t const inline_size = big_tiff ? 8 : 4;
+    std::uint64_t const value_field = entry + (big_tiff ? 12 : 8);
+    std::uint64_t const values_offset =
+        count * elem_size <= inline_size ? value_field
+                                         : r.uint(value_field, inline_size);
+    std::vector<std::uint64_t> values(static_cast<std::size_t>(count));
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = r.uint(values_offset + i * elem_size, elem_size);
+    }
+    return values;
+}
+
+auto single_value(std::vector<std::uint64_t> const &values, char const *name)
+    -> std::uint64_t {
+    if (values.empty()) {
+        throw std::runtime_error(std::string("TIFF field ") + name +
+                                 " is empty");
+    }
+    return values[0];
+}
+
+auto parse_page(reader const &r, std::uint64_t ifd, bool big_tiff,
+                std::uint64_t &next_ifd) -> tiff_page {
+    std::size_t const count_size = big_tiff ? 8 : 2;
+    std::size_t const entry_size = big_tiff ? 20 : 12;
+    std::uint64_t const n_entries = r.uint(ifd, count_size);
+    if (n_entries > r.size() / entry_size) {
+        throw std::runtime_error("TIFF directory exceeds file size");
+    }
+
+    std::uint64_t width = 0;
+    std::uint64_t height = 0;
+    std::uint64_t bits = 1;
+    std::uint64_t compression = 1;
+    std::uint64_t samples = 1;
+    std::uint64_t rows_per_strip = std::numeric_limits<std::uint32_t>::max();
+    std::uint64_t planar_config = 1;
+    std::vector<std::uint64_t> strip_offsets;
+    std::vector<std::uint64_t> strip_byte_counts;
+    for (std::uint64_t i = 0; i < n_entries; ++i) {
+        std::uint64_t const entry = ifd + count_size + i * entry_size;
+        auto const tag = r.uint(entry, 2);
+        switch (tag) {
+        case tag_image_width:
+            width = single_value(entry_values(r, entry, big_tiff), "width");
+            break;
+        case tag_image_length:
+            height = single_value(entry_values(r, entry, big_tiff), "length");
+            break;
+        case tag_bits_per_sample: {
+            auto const v = entry_values(r, entry, big_tiff);
+            bits = single_value(v, "BitsPerSample");
+            if (!std::all_of(v.begin(), v.end(),
+                             [&](std::uint64_t b) { return b == bits; })) {
+                throw std::runtime_error(
+                    "TIFF samples of differing bit depth are not supported");
+            }
+            break;
+        }
+        case tag_compression:
+            compression =
+                single_value(entry_values(r, entry, big_tiff), "Compression");
+            break;
+        case tag_strip_offsets:
+            strip_offsets = entry_values(r, entry, big_tiff);
+            break;
+        case tag_samples_per_pixel:
+            samples = single_value(entry_values(r, entry, big_tiff),
+                                   "SamplesPerPixel");
+            break;
+        case tag_rows_per_strip:
+            rows_per_strip = single_value(entry_values(r, entry, big_tiff),
+                                          "RowsPerStrip");
+            break;
+        case tag_strip_byte_counts:
+            strip_byte_counts = entry_values(r, entry, big_tiff);
+            break;
+        case tag_planar_configuration:
+            planar_config = single_value(entry_values(r, entry, big_tiff),
+                                         "PlanarConfiguration");
+            break;
+        case tag_tile_width:
+            throw std::runtime_error("Tiled TIFF is not supported");
+        case tag_sample_format: {
+            auto const v = entry_values(r, entry, big_tiff);
+            if (!std::all_of(v.begin(), v.end(),
+                             [](std::uint64_t f) { return f == 1; })) {
+                throw std::runtime_error(
+                    "Only unsigned integer TIFF samples are supported");
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    next_ifd = r.uint(ifd + count_size + n_entries * entry_size,
+                      big_tiff ? 8 : 4);
+
+    if (compression != 1) {
+        throw std::runtime_error("Compressed TIFF (compression " +
+                                 std::to_string(compression) +
+                                 ") is not supported");
+    }
+    if (bits != 8 && bits != 16) {
+        throw std::runtime_error("Unsupported TIFF bits per sample: " +
+                                 std::to_string(bits));
+    }
+    if (samples == 0 || width == 0 || height == 0) {
+        throw std::runtime_error("TIFF page has no samples");
+    }
+    if (planar_config != 1 && planar_config != 2) {
+        throw std::runtime_error("Invalid TIFF planar configuration");
+    }
+    if (rows_per_strip == 0) {
+        throw std::runtime_error("Invalid TIFF rows per strip");
+    }
+    // Bounds the dimensions well below overflow of the products below.
+    if (width > r.size() || height > r.size() || samples > r.size()) {
+        throw std::runtime_error("TIFF page dimensions exceed file size");
+    }
+
+    tiff_page page{};
+    page.width = static_cast<std::size_t>(width);
+    page.height = static_cast<std::size_t>(height);
+    page.bits_per_sample = static_cast<std::size_t>(bits);
+    page.samples_per_pixel = static_cast<std::size_t>(samples);
+    page.planar = planar_config == 2 && samples > 1;
+
+    std::size_t const rps = static_cast<std::size_t>(
+        std::min<std::uint64_t>(rows_per_strip, height));
+    std::size_t const strips_per_plane = (page.height + rps - 1) / rps;
+    std::size_t const n_planes = page.planar ? page.samples_per_pixel : 1;
+    std::size_t const row_bytes = page.width *
+                                  (page.planar ? 1 : page.samples_per_pixel) *
+                                  (page.bits_per_sample / 8);
+    if (strip_offsets.size() != strips_per_plane * n_planes) {
+        throw std::runtime_error("TIFF strip offsets do not match the image "
+                                 "size and rows per strip");
+    }
+    if (!strip_byte_counts.empty() &&
+        strip_byte_counts.size() != strip_offsets.size()) {
+        throw std::runtime_error(
+            "TIFF strip byte counts do not match strip offsets");
+    }
+
+    page.strips.reserve(strip_offsets.size());
+    for (std::size_t i = 0; i < strip_offsets.size(); ++i) {
+        std::size_t const first_row = (i % strips_per_plane) * rps;
+        std::size_t const rows = std::min(rps, page.height - first_row);
+        std::uint64_t const needed = std::uint64_t(rows) * row_bytes;
+        if (!strip_byte_counts.empty() && strip_byte_counts[i] < needed) {
+            throw std::runtime_error("TIFF strip is shorter than its rows "
+                                     "(is the file compressed?)");
+        }
+        if (strip_offsets[i] > r.size() ||
+            needed > r.size() - strip_offsets[i]) {
+            throw std::runtime_error("TIFF strip extends past end of file");
+        }
+        page.strips.push_back({strip_offsets[i], rows, i / strips_per_plane});
+    }
+    return page;
+}
+
+} // namespace
+
+auto parse_tiff(unsigned char const *data, std::size_t size) -> tiff_file {
+    if (size < 8) {
+        throw std::runtime_error("Not a TIFF file");
+    }
+    tiff_file file{};
+    if (data[0] == 'I' && data[1] == 'I') {
+        file.big_endian = false;
+    } else if (data[0] == 'M' && data[1] == 'M') {
+        file.big_endian = true;
+    } else {
+        throw std::runtime_error("Not a TIFF file");
+    }
+    reader const r(data, size, file.big_endian);
+
+    auto const version = r.uint(2, 2);
+    bool const big_tiff = version == 43;
+    if (version != 42 && !big_tiff) {
+        throw std::runtime_error("Not a TIFF file");
+    }
+    if (big_tiff && (r.uint(4, 2) != 8 || r.uint(6, 2) != 0)) {
+        throw std::runtime_error("Unsupported BigTIFF offset size");
+    }
+
+    std::uint64_t ifd = big_tiff ? r.uint(8, 8) : r.uint(4, 4);
+    // Each directory takes at least 8 bytes, which bounds the number of pages
+    // in a well-formed file (and catches cycles in a malformed one).
+    std::size_t const max_pages = size / 8;
+    while (ifd != 0) {
+        if (file.pages.size() >= max_pages) {
+            throw std::runtime_error("TIFF directories form a cycle");
+        }
+        std::uint64_t next_ifd = 0;
+        file.pages.push_back(parse_page(r, ifd, big_tiff, next_ifd));
+        ifd = next_ifd;
+    }
+    if (file.pages.empty()) {
+        throw std::runtime_error("TIFF file has no pages");
+    }
+    return file;
+}
+
+} // namespace ihist::cli
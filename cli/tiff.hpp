@@ -0,0 +1,43 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ihist::cli {
+
+// One strip of a TIFF page: rows consecutive rows of one plane, stored
+// uncompressed at offset in the file.
+struct tiff_strip {
+    std::uint64_t offset;
+    std::size_t rows;
+    std::size_t plane; // Always 0 unless the page is planar
+};
+
+struct tiff_page {
+    std::size_t width;
+    std::size_t height;
+    std::size_t bits_per_sample; // 8 or 16
+    std::size_t samples_per_pixel;
+    bool planar; // Samples stored as separate planes (PlanarConfiguration 2)
+    std::vector<tiff_strip> strips;
+};
+
+struct tiff_file {
+    bool big_endian;
+    std::vector<tiff_page> pages;
+};
+
+// Parse the structure of a classic or BigTIFF file held in memory. Only
+// uncompressed, stripped pages with 8- or 16-bit unsigned integer samples are
+// supported; anything else, and any strip extending past the end of the data,
+// is reported by throwing std::runtime_error. Sample data is not read.
+auto parse_tiff(unsigned char const *data, std::size_t size) -> tiff_file;
+
+} // namespace ihist::cli
@@ -57,6 +57,461 @@ ihist_hist16_2d(size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
                 size_t const *IHIST_RESTRICT component_indices,
                 uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel);
 
+// Same as above, but additionally add to overflow[i] the number of samples of
+// component i that were out of range (>= 2^sample_bits). See README.md.
+IHIST_PUBLIC void ihist_hist8_2d_overflow(
+    size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, uint32_t *IHIST_RESTRICT overflow,
+    bool maybe_parallel);
+
+IHIST_PUBLIC void ihist_hist16_2d_overflow(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, uint32_t *IHIST_RESTRICT overflow,
+    bool maybe_parallel);
+
+// Same as ihist_hist8_2d() and ihist_hist16_2d(), but additionally fill
+// n_levels coarser histograms: level_histograms[i] receives n_hist_components
+// histograms of 2^level_bits[i] bins (level_bits[i] <= sample_bits), binning
+// the top level_bits[i] bits of each sample. The coarse histograms are
+// overwritten (not accumulated) with a reduction of the full histogram after
+// the call. See README.md.
+IHIST_PUBLIC void ihist_hist8_2d_multires(
+    size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, size_t n_levels,
+    size_t const *IHIST_RESTRICT level_bits,
+    uint32_t *const *IHIST_RESTRICT level_histograms, bool maybe_parallel);
+
+IHIST_PUBLIC void ihist_hist16_2d_multires(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, size_t n_levels,
+    size_t const *IHIST_RESTRICT level_bits,
+    uint32_t *const *IHIST_RESTRICT level_histograms, bool maybe_parallel);
+
+// Channels that can be derived from the red, green, and blue samples of each
+// pixel. Luma is computed in fixed point and rounded to nearest.
+typedef enum ihist_derived_channel {
+    IHIST_DERIVED_LUMA_709, // 0.2126 R + 0.7152 G + 0.0722 B
+    IHIST_DERIVED_LUMA_601, // 0.299 R + 0.587 G + 0.114 B
+    IHIST_DERIVED_MAX,      // max(R, G, B)
+    IHIST_DERIVED_MEAN,     // (R + G + B) / 3, rounded down
+} ihist_derived_channel;
+
+// Same as ihist_hist8_2d() and ihist_hist16_2d(), but additionally histogram
+// n_derived channels computed from components rgb_indices[0], [1], and [2]
+// (R, G, B) of each pixel, reading the image only once. histogram holds
+// n_hist_components + n_derived histograms: the selected components followed
+// by derived[0], ..., derived[n_derived - 1]. Derived values are computed
+// from the raw samples and are excluded if >= 2^sample_bits. See README.md.
+IHIST_PUBLIC void ihist_hist8_2d_derived(
+    size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    size_t const *IHIST_RESTRICT rgb_indices, size_t n_derived,
+    ihist_derived_channel const *IHIST_RESTRICT derived,
+    uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel);
+
+IHIST_PUBLIC void ihist_hist16_2d_derived(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    size_t const *IHIST_RESTRICT rgb_indices, size_t n_derived,
+    ihist_derived_channel const *IHIST_RESTRICT derived,
+    uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel);
+
+// Same as ihist_hist16_2d(), but histogram the corrected value
+// max(raw - dark, 0) * gain / 2^gain_frac_bits (rounded to nearest) of each
+// selected sample, without materializing the corrected image. dark and gain
+// (each may be NULL to skip that step) have the same layout and stride as
+// image. Corrected values >= 2^sample_bits are excluded. See README.md.
+IHIST_PUBLIC void ihist_hist16_2d_corrected(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint16_t const *IHIST_RESTRICT dark, uint16_t const *IHIST_RESTRICT gain,
+    size_t gain_frac_bits, uint32_t *IHIST_RESTRICT histogram,
+    bool maybe_parallel);
+
+// How ihist_hist8_2d_difference() and ihist_hist16_2d_difference() bin the
+// difference image - previous of each sample.
+typedef enum ihist_difference_mode {
+    // |image - previous|, in 2^sample_bits bins.
+    IHIST_DIFFERENCE_ABSOLUTE,
+    // image - previous + 2^sample_bits, in 2^(sample_bits + 1) bins; bin
+    // 2^sample_bits counts unchanged samples.
+    IHIST_DIFFERENCE_SIGNED,
+} ihist_difference_mode;
+
+// Same as ihist_hist8_2d() and ihist_hist16_2d(), but histogram the
+// difference between image and previous (same layout and stride), reading
+// each frame once. Samples that are out of range in either frame are
+// excluded. See README.md.
+IHIST_PUBLIC void ihist_hist8_2d_difference(
+    size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT previous,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    ihist_difference_mode mode, uint32_t *IHIST_RESTRICT histogram,
+    bool maybe_parallel);
+
+IHIST_PUBLIC void ihist_hist16_2d_difference(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint16_t const *IHIST_RESTRICT previous,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    ihist_difference_mode mode, uint32_t *IHIST_RESTRICT histogram,
+    bool maybe_parallel);
+
+// Same as ihist_hist8_2d() and ihist_hist16_2d(), but additionally copy the
+// image (all components of each row) to dest, which has the same layout with
+// a row stride of dest_stride pixels, reading the image from memory only
+// once. If non_temporal, dest is written with cache-bypassing stores where
+// the platform supports them. See README.md.
+IHIST_PUBLIC void ihist_hist8_2d_copy(
+    size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, uint8_t *IHIST_RESTRICT dest,
+    size_t dest_stride, bool non_temporal, bool maybe_parallel);
+
+IHIST_PUBLIC void ihist_hist16_2d_copy(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, uint16_t *IHIST_RESTRICT dest,
+    size_t dest_stride, bool non_temporal, bool maybe_parallel);
+
+// One tile of an image stored as separate tiles (or chunks). The fields have
+// the same meaning as the corresponding parameters of ihist_hist8_2d().
+typedef struct ihist_tile8 {
+    uint8_t const *image;
+    uint8_t const *mask; // May be NULL
+    size_t height;
+    size_t width;
+    size_t image_stride;
+    size_t mask_stride;
+} ihist_tile8;
+
+typedef struct ihist_tile16 {
+    uint16_t const *image;
+    uint8_t const *mask; // May be NULL
+    size_t height;
+    size_t width;
+    size_t image_stride;
+    size_t mask_stride;
+} ihist_tile16;
+
+// Compute (accumulate) one histogram of all n_tiles tiles, which share
+// sample_bits and pixel format (n_components) but may differ in size,
+// stride, and masking. Equivalent to histogramming each tile in turn, but
+// with a single parallel loop over the rows of all tiles. See README.md.
+IHIST_PUBLIC void
+ihist_hist8_tiles(size_t sample_bits, size_t n_tiles,
+                  ihist_tile8 const *IHIST_RESTRICT tiles,
+                  size_t n_components, size_t n_hist_components,
+                  size_t const *IHIST_RESTRICT component_indices,
+                  uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel);
+
+IHIST_PUBLIC void
+ihist_hist16_tiles(size_t sample_bits, size_t n_tiles,
+                   ihist_tile16 const *IHIST_RESTRICT tiles,
+                   size_t n_components, size_t n_hist_components,
+                   size_t const *IHIST_RESTRICT component_indices,
+                   uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel);
+
+// Compute (accumulate) a separate histogram of each of n_images images (given
+// as ihist_tile8/16), into histograms[i]. The images share sample_bits and
+// pixel format but may differ in size, stride, and masking. Equivalent to
+// calling ihist_hist8_2d() or ihist_hist16_2d() for each image, but many
+// small images are distributed across threads. See README.md.
+IHIST_PUBLIC void
+ihist_hist8_2d_batch(size_t sample_bits, size_t n_images,
+                     ihist_tile8 const *IHIST_RESTRICT images,
+                     size_t n_components, size_t n_hist_components,
+                     size_t const *IHIST_RESTRICT component_indices,
+                     uint32_t *const *IHIST_RESTRICT histograms,
+                     bool maybe_parallel);
+
+IHIST_PUBLIC void
+ihist_hist16_2d_batch(size_t sample_bits, size_t n_images,
+                      ihist_tile16 const *IHIST_RESTRICT images,
+                      size_t n_components, size_t n_hist_components,
+                      size_t const *IHIST_RESTRICT component_indices,
+                      uint32_t *const *IHIST_RESTRICT histograms,
+                      bool maybe_parallel);
+
+// Accumulator for histogramming an image that arrives a few rows at a time
+// (or is too large to hold in memory): create, feed any number of row bands,
+// then finish. Per-thread partial histograms are kept between feeds and
+// reduced only at finish. An accumulator must not be used from more than one
+// thread at a time. See README.md.
+typedef struct ihist_accumulator ihist_accumulator;
+
+// Returns NULL if memory cannot be allocated. The pixel format and component
+// selection are as for ihist_hist8_2d() and ihist_hist16_2d().
+IHIST_PUBLIC ihist_accumulator *
+ihist_accumulator_create(size_t sample_bits, size_t n_components,
+                         size_t n_hist_components,
+                         size_t const *IHIST_RESTRICT component_indices);
+
+IHIST_PUBLIC void ihist_accumulator_destroy(ihist_accumulator *accumulator);
+
+IHIST_PUBLIC void ihist_accumulator_feed8(
+    ihist_accumulator *IHIST_RESTRICT accumulator,
+    uint8_t const *IHIST_RESTRICT image, uint8_t const *IHIST_RESTRICT mask,
+    size_t height, size_t width, size_t image_stride, size_t mask_stride,
+    bool maybe_parallel);
+
+IHIST_PUBLIC void ihist_accumulator_feed16(
+    ihist_accumulator *IHIST_RESTRICT accumulator,
+    uint16_t const *IHIST_RESTRICT image, uint8_t const *IHIST_RESTRICT mask,
+    size_t height, size_t width, size_t image_stride, size_t mask_stride,
+    bool maybe_parallel);
+
+// Add the counts fed since creation or the previous finish to histogram
+// (n_hist_components * 2^sample_bits bins) and, if overflow is not NULL, the
+// out-of-range counts to overflow[i]; then reset the accumulator.
+IHIST_PUBLIC void
+ihist_accumulator_finish(ihist_accumulator *IHIST_RESTRICT accumulator,
+                         uint32_t *IHIST_RESTRICT histogram,
+                         uint32_t *IHIST_RESTRICT overflow);
+
+// Time series of histograms (e.g., one per frame) stored compactly in a
+// file: each histogram is encoded as the varint-coded nonzero differences from
+// the previous one, with a full (keyframe) encoding every keyframe_interval
+// histograms, and an index for random access. See README.md for the format.
+typedef struct ihist_series_writer ihist_series_writer;
+typedef struct ihist_series_reader ihist_series_reader;
+
+// Create (overwrite) the file for histograms of n_components * 2^sample_bits
+// counts. Returns NULL if the file cannot be created.
+IHIST_PUBLIC ihist_series_writer *
+ihist_series_create(char const *path, size_t sample_bits, size_t n_components,
+                    size_t keyframe_interval);
+
+// Append one histogram. Returns false on a write error.
+IHIST_PUBLIC bool
+ihist_series_append(ihist_series_writer *IHIST_RESTRICT writer,
+                    uint32_t const *IHIST_RESTRICT histogram);
+
+// Write the index and close the file; the writer is freed even on failure.
+// Returns false on a write error. A file that was not closed (e.g., after a
+// crash) remains readable up to its last complete histogram.
+IHIST_PUBLIC bool ihist_series_close(ihist_series_writer *writer);
+
+// Returns NULL if the file cannot be opened or is not a histogram series.
+IHIST_PUBLIC ihist_series_reader *ihist_series_open(char const *path);
+
+IHIST_PUBLIC void
+ihist_series_info(ihist_series_reader const *IHIST_RESTRICT reader,
+                  size_t *IHIST_RESTRICT sample_bits,
+                  size_t *IHIST_RESTRICT n_components,
+                  size_t *IHIST_RESTRICT n_histograms);
+
+// Read histogram number index into histogram (overwritten). Reading in
+// increasing order is fastest. Returns false on a read error, a corrupt file,
+// or index out of range.
+IHIST_PUBLIC bool ihist_series_read(ihist_series_reader *IHIST_RESTRICT reader,
+                                    size_t index,
+                                    uint32_t *IHIST_RESTRICT histogram);
+
+IHIST_PUBLIC void ihist_series_free(ihist_series_reader *reader);
+
+// The encoding of one histogram record, for use without the file functions.
+// Encode the differences of histogram (n_counts counts) from previous (or
+// from zero if previous is NULL) into out, which must have room for
+// ihist_series_encoded_bound(n_counts) bytes; return the encoded size.
+IHIST_PUBLIC size_t ihist_series_encoded_bound(size_t n_counts);
+
+IHIST_PUBLIC size_t
+ihist_series_encode(size_t n_counts, uint32_t const *IHIST_RESTRICT previous,
+                    uint32_t const *IHIST_RESTRICT histogram,
+                    uint8_t *IHIST_RESTRICT out);
+
+// Apply encoded differences to histogram, which holds the previous histogram
+// (or zeros) on entry. Returns false if the data is malformed.
+IHIST_PUBLIC bool ihist_series_decode(size_t n_counts,
+                                      uint8_t const *IHIST_RESTRICT data,
+                                      size_t size,
+                                      uint32_t *IHIST_RESTRICT histogram);
+
+// Sparse histograms: for each histogrammed component, the nonzero bins in
+// increasing order, as parallel arrays of bin values and counts. The entries
+// of the components are stored one after another (component i has
+// n_nonzero[i] entries); bins and counts must each have room for
+// ihist_sparse_capacity() entries. The outputs are overwritten, not
+// accumulated. Returns the total number of entries. See README.md.
+IHIST_PUBLIC size_t ihist_sparse_capacity(size_t sample_bits,
+                                          size_t n_hist_components,
+                                          size_t n_pixels);
+
+IHIST_PUBLIC size_t ihist_hist8_2d_sparse(
+    size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint16_t *IHIST_RESTRICT bins, uint32_t *IHIST_RESTRICT counts,
+    size_t *IHIST_RESTRICT n_nonzero, bool maybe_parallel);
+
+IHIST_PUBLIC size_t ihist_hist16_2d_sparse(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint16_t *IHIST_RESTRICT bins, uint32_t *IHIST_RESTRICT counts,
+    size_t *IHIST_RESTRICT n_nonzero, bool maybe_parallel);
+
+// Sparse histograms of 32-bit samples (such as label images), which are
+// counted in hash tables and need not fit a dense histogram. The keys (sample
+// values) take the place of bins; samples of 2^sample_bits or greater are
+// excluded, as are masked-out pixels.
+IHIST_PUBLIC size_t ihist_hist32_2d_sparse(
+    size_t sample_bits, uint32_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT keys, uint32_t *IHIST_RESTRICT counts,
+    size_t *IHIST_RESTRICT n_nonzero, bool maybe_parallel);
+
+// Convert dense histograms to the sparse form above; bins and counts need
+// room for n_hist_components << sample_bits entries (or fewer, if the number
+// of nonzero bins is known).
+IHIST_PUBLIC size_t
+ihist_histogram_to_sparse(size_t sample_bits, size_t n_hist_components,
+                          uint32_t const *IHIST_RESTRICT histogram,
+                          uint16_t *IHIST_RESTRICT bins,
+                          uint32_t *IHIST_RESTRICT counts,
+                          size_t *IHIST_RESTRICT n_nonzero);
+
+// Summary statistics of one histogram component. See README.md.
+typedef struct ihist_stats {
+    uint64_t count;          // Number of samples counted in the histogram
+    uint64_t sum;            // Sum of sample values
+    uint64_t sum_of_squares; // Sum of squared sample values
+    uint32_t min;            // Smallest sample value (0 if count == 0)
+    uint32_t max;            // Largest sample value (0 if count == 0)
+    uint64_t n_saturated;    // Number of samples equal to 2^sample_bits - 1
+    double mean;             // sum / count (NaN if count == 0)
+    double stddev;           // Population standard deviation (NaN if empty)
+} ihist_stats;
+
+IHIST_PUBLIC void
+ihist_histogram_stats(size_t sample_bits, size_t n_hist_components,
+                      uint32_t const *IHIST_RESTRICT histogram,
+                      ihist_stats *IHIST_RESTRICT stats);
+
+// Histogram analyses. Each takes n_hist_components consecutive histograms of
+// 2^sample_bits bins and writes per-component results. See README.md.
+
+IHIST_PUBLIC void
+ihist_histogram_cumsum(size_t sample_bits, size_t n_hist_components,
+                       uint32_t const *IHIST_RESTRICT histogram,
+                       uint64_t *IHIST_RESTRICT cumsum);
+
+IHIST_PUBLIC void
+ihist_histogram_quantiles(size_t sample_bits, size_t n_hist_components,
+                          uint32_t const *IHIST_RESTRICT histogram,
+                          size_t n_quantiles,
+                          double const *IHIST_RESTRICT quantiles,
+                          uint32_t *IHIST_RESTRICT values);
+
+IHIST_PUBLIC void
+ihist_histogram_otsu(size_t sample_bits, size_t n_hist_components,
+                     uint32_t const *IHIST_RESTRICT histogram,
+                     uint32_t *IHIST_RESTRICT thresholds);
+
+IHIST_PUBLIC void
+ihist_histogram_entropy(size_t sample_bits, size_t n_hist_components,
+                        uint32_t const *IHIST_RESTRICT histogram,
+                        double *IHIST_RESTRICT entropy);
+
+// Reduce histograms of 2^sample_bits bins to 2^coarse_bits bins
+// (coarse_bits <= sample_bits) by summing adjacent bins, overwriting coarse.
+IHIST_PUBLIC void
+ihist_histogram_rebin(size_t sample_bits, size_t n_hist_components,
+                      uint32_t const *IHIST_RESTRICT histogram,
+                      size_t coarse_bits, uint32_t *IHIST_RESTRICT coarse);
+
+IHIST_PUBLIC void
+ihist_histogram_mode(size_t sample_bits, size_t n_hist_components,
+                     uint32_t const *IHIST_RESTRICT histogram,
+                     uint32_t *IHIST_RESTRICT modes);
+
+// Metrics for comparing histograms, which are first normalized to unit sum.
+// All are 0 for identical histograms. See README.md.
+typedef enum ihist_distance_metric {
+    IHIST_DISTANCE_CHI_SQUARE,    // sum((p - q)^2 / (p + q)), in [0, 2]
+    IHIST_DISTANCE_BHATTACHARYYA, // sqrt(1 - sum(sqrt(p * q))), in [0, 1]
+    IHIST_DISTANCE_INTERSECTION,  // 1 - sum(min(p, q)), in [0, 1]
+    IHIST_DISTANCE_EMD,           // 1D earth mover's distance, in bins
+    IHIST_DISTANCE_KL_DIVERGENCE, // sum(p * log2(p / q)); may be infinite
+} ihist_distance_metric;
+
+// Compare histogram_a (p) with histogram_b (q), component by component,
+// writing n_hist_components distances (NaN if either histogram is empty).
+IHIST_PUBLIC void
+ihist_histogram_distance(size_t sample_bits, size_t n_hist_components,
+                         uint32_t const *IHIST_RESTRICT histogram_a,
+                         uint32_t const *IHIST_RESTRICT histogram_b,
+                         ihist_distance_metric metric,
+                         double *IHIST_RESTRICT distances);
+
+// Compare query (p) with each of n_references histograms (q) stored
+// consecutively in references (each of n_hist_components components).
+// distances[r * n_hist_components + i] receives the distance for reference r,
+// component i.
+IHIST_PUBLIC void ihist_histogram_distance_batch(
+    size_t sample_bits, size_t n_hist_components,
+    uint32_t const *IHIST_RESTRICT query, size_t n_references,
+    uint32_t const *IHIST_RESTRICT references, ihist_distance_metric metric,
+    double *IHIST_RESTRICT distances, bool maybe_parallel);
+
+// Same as ihist_hist16_2d(), but additionally map every sample of the image
+// through lut (2^sample_bits entries; out-of-range samples use the last entry)
+// into output (same layout as the image, with output_stride in pixels),
+// reading the image from memory only once. The mask does not affect output.
+// See README.md.
+IHIST_PUBLIC void ihist_hist16_2d_lut8(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, uint8_t const *IHIST_RESTRICT lut,
+    uint8_t *IHIST_RESTRICT output, size_t output_stride,
+    bool maybe_parallel);
+
+// Fill lut (2^sample_bits entries) with a linear ramp from 0 at low to 255 at
+// high, clamped outside that range.
+IHIST_PUBLIC void ihist_window_lut8(size_t sample_bits, uint32_t low,
+                                    uint32_t high,
+                                    uint8_t *IHIST_RESTRICT lut);
+
+// Fill lut as ihist_window_lut8() does, with low and high set to the given
+// quantiles of histogram (a single component).
+IHIST_PUBLIC void
+ihist_auto_contrast_lut8(size_t sample_bits,
+                         uint32_t const *IHIST_RESTRICT histogram,
+                         double low_quantile, double high_quantile,
+                         uint8_t *IHIST_RESTRICT lut);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
\ No newline at end of file
@@ -6,6 +6,23 @@
 
 #pragma once
 
+// Header-only C++17 interface to the histogram kernels.
+//
+// Most C++ code should use the typed interface at the end of this file:
+// image_view, pixel_format (and the mono, abc, abcx, xabc aliases), and the
+// histogram() and histogram_mt() functions. These select the kernel at
+// compile time, so there is no run-time dispatch as in the C API and the
+// single-threaded kernel can be inlined into the caller.
+//
+// The kernel templates (hist_*_st/mt, histxy_*_st/mt) are also usable
+// directly; the names in namespace ihist::internal are not a stable API.
+//
+// The multi-threaded kernels use oneTBB when IHIST_USE_TBB is defined (set by
+// the ihist Meson dependency and pkg-config file when ihist was built with
+// TBB); otherwise they run single-threaded. They also call
+// internal::get_physical_core_count(), so programs using them must link to
+// the ihist library.
+
 #include "phys_core_count.hpp"
 
 #ifdef IHIST_USE_TBB
@@ -19,16 +36,11 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <limits>
 #include <type_traits>
 #include <vector>
 
-#ifdef _MSC_VER
-#define IHIST_RESTRICT __restrict
-#else
-#define IHIST_RESTRICT __restrict__
-#endif
-
 #ifdef _MSC_VER
 #define IHIST_NOINLINE __declspec(noinline)
 #else
@@ -77,15 +89,20 @@ constexpr auto bin_index(T value) -> std::size_t {
     }
 }
 
-} // namespace internal
+// The kernel implementations below take an additional 'overflow' argument,
+// which, if not null, must point to one counter per histogrammed sample;
+// out-of-range samples (those that bin_index() maps to the overflow bin) are
+// counted there. The public kernels forward to these with a null 'overflow',
+// so that their signatures stay uniform for use through function pointers.
 
-template <typename T, bool UseMask = false, unsigned Bits = 8 * sizeof(T),
-          unsigned LoBit = 0, std::size_t SamplesPerPixel = 1,
-          std::size_t Sample0Index = 0, std::size_t... SampleIndices>
-/* not noinline */ void
-hist_unoptimized_st(T const *IHIST_RESTRICT data,
-                    std::uint8_t const *IHIST_RESTRICT mask, std::size_t size,
-                    std::uint32_t *IHIST_RESTRICT histogram, std::size_t = 0) {
+template <typename T, bool UseMask, unsigned Bits, unsigned LoBit,
+          std::size_t SamplesPerPixel, std::size_t Sample0Index,
+          std::size_t... SampleIndices>
+void hist_unoptimized(T const *IHIST_RESTRICT data,
+                      std::uint8_t const *IHIST_RESTRICT mask,
+                      std::size_t size,
+                      std::uint32_t *IHIST_RESTRICT histogram,
+                      std::uint32_t *IHIST_RESTRICT overflow) {
     assert(size < std::numeric_limits<std::uint32_t>::max());
 
     static_assert(std::max<std::size_t>({Sample0Index, SampleIndices...}) <
@@ -102,24 +119,26 @@ hist_unoptimized_st(T const *IHIST_RESTRICT data,
         if (!UseMask || mask[j]) {
             for (std::size_t s = 0; s < NSAMPLES; ++s) {
                 auto const s_index = s_indices[s];
-                auto const bin =
-                    internal::bin_index<T, Bits, LoBit>(data[i + s_index]);
+                auto const bin = bin_index<T, Bits, LoBit>(data[i + s_index]);
                 if (bin != NBINS) {
                     ++histogram[s * NBINS + bin];
+                } else if (overflow != nullptr) {
+                    ++overflow[s];
                 }
             }
         }
     }
 }
 
-template <typename T, bool UseMask = false, unsigned Bits = 8 * sizeof(T),
-          unsigned LoBit = 0, std::size_t SamplesPerPixel = 1,
-          std::size_t Sample0Index = 0, std::size_t... SampleIndices>
-/* not noinline */ void histxy_unoptimized_st(
-    T const *IHIST_RESTRICT data, std::uint8_t const *IHIST_RESTRICT mask,
-    std::size_t height, std::size_t width, std::size_t image_stride,
-    std::size_t mask_stride, std::uint32_t *IHIST_RESTRICT histogram,
-    std::size_t = 0) {
+template <typename T, bool UseMask, unsigned Bits, unsigned LoBit,
+          std::size_t SamplesPerPixel, std::size_t Sample0Index,
+          std::size_t... SampleIndices>
+void histxy_unoptimized(T const *IHIST_RESTRICT data,
+                        std::uint8_t const *IHIST_RESTRICT mask,
+                        std::size_t height, std::size_t width,
+                        std::size_t image_stride, std::size_t mask_stride,
+                        std::uint32_t *IHIST_RESTRICT histogram,
+                        std::uint32_t *IHIST_RESTRICT overflow) {
     assert(width * height < std::numeric_limits<std::uint32_t>::max());
     assert(width <= image_stride);
 
@@ -141,9 +160,11 @@ template <typename T, bool UseMask = false, unsigned Bits = 8 * sizeof(T),
                 for (std::size_t s = 0; s < NSAMPLES; ++s) {
                     auto const s_index = s_indices[s];
                     auto const bin =
-                        internal::bin_index<T, Bits, LoBit>(data[i + s_index]);
+                        bin_index<T, Bits, LoBit>(data[i + s_index]);
                     if (bin != NBINS) {
                         ++histogram[s * NBINS + bin];
+                    } else if (overflow != nullptr) {
+                        ++overflow[s];
                     }
                 }
             }
@@ -151,14 +172,43 @@ template <typename T, bool UseMask = false, unsigned Bits = 8 * sizeof(T),
     }
 }
 
-template <tuning_parameters const &Tuning, typename T, bool UseMask = false,
-          unsigned Bits = 8 * sizeof(T), unsigned LoBit = 0,
-          std::size_t SamplesPerPixel = 1, std::size_t Sample0Index = 0,
-          std::size_t... SampleIndices>
-IHIST_NOINLINE void
-hist_striped_st(T const *IHIST_RESTRICT data,
-                std::uint8_t const *IHIST_RESTRICT mask, std::size_t size,
-                std::uint32_t *IHIST_RESTRICT histogram, std::size_t = 0) {
+// Add the per-stripe histograms (and overflow bins, if any) to the output.
+template <std::size_t NStripes, std::size_t NSamples, std::size_t NBins,
+          std::size_t StripeLen>
+void reduce_stripes(std::uint32_t const *IHIST_RESTRICT stripes,
+                    std::uint32_t *IHIST_RESTRICT histogram,
+                    std::uint32_t *IHIST_RESTRICT overflow) {
+    for (std::size_t s = 0; s < NSamples; ++s) {
+        for (std::size_t bin = 0; bin < NBins; ++bin) {
+            std::uint32_t sum = 0;
+            for (std::size_t stripe = 0; stripe < NStripes; ++stripe) {
+                sum += stripes[(stripe * NSamples + s) * StripeLen + bin];
+            }
+            histogram[s * NBins + bin] += sum;
+        }
+    }
+
+    if constexpr (StripeLen > NBins) {
+        if (overflow != nullptr) {
+            for (std::size_t s = 0; s < NSamples; ++s) {
+                std::uint32_t sum = 0;
+                for (std::size_t stripe = 0; stripe < NStripes; ++stripe) {
+                    sum +=
+                        stripes[(stripe * NSamples + s) * StripeLen + NBins];
+                }
+                overflow[s] += sum;
+            }
+        }
+    }
+}
+
+template <tuning_parameters const &Tuning, typename T, bool UseMask,
+          unsigned Bits, unsigned LoBit, std::size_t SamplesPerPixel,
+          std::size_t Sample0Index, std::size_t... SampleIndices>
+void hist_striped(T const *IHIST_RESTRICT data,
+                  std::uint8_t const *IHIST_RESTRICT mask, std::size_t size,
+                  std::uint32_t *IHIST_RESTRICT histogram,
+                  std::uint32_t *IHIST_RESTRICT overflow) {
     assert(size < std::numeric_limits<std::uint32_t>::max());
 
     static_assert(std::max<std::size_t>({Sample0Index, SampleIndices...}) <
@@ -208,7 +258,7 @@ hist_striped_st(T const *IHIST_RESTRICT data,
         IHIST_PRAGMA_LOOP_UNROLL_FULL
         for (std::size_t n = 0; n < BLOCKSIZE * SamplesPerPixel; ++n) {
             auto const i = block * BLOCKSIZE * SamplesPerPixel + n;
-            bins[n] = internal::bin_index<T, Bits, LoBit>(data[i]);
+            bins[n] = bin_index<T, Bits, LoBit>(data[i]);
         }
         auto const *block_mask = UseMask ? mask + block * BLOCKSIZE : nullptr;
 
@@ -227,32 +277,24 @@ hist_striped_st(T const *IHIST_RESTRICT data,
     }
 
     if constexpr (USE_STRIPES) {
-        for (std::size_t s = 0; s < NSAMPLES; ++s) {
-            for (std::size_t bin = 0; bin < NBINS; ++bin) {
-                std::uint32_t sum = 0;
-                for (std::size_t stripe = 0; stripe < NSTRIPES; ++stripe) {
-                    sum += stripes[(stripe * NSAMPLES + s) * STRIPE_LEN + bin];
-                }
-                histogram[s * NBINS + bin] += sum;
-            }
-        }
+        reduce_stripes<NSTRIPES, NSAMPLES, NBINS, STRIPE_LEN>(
+            stripes, histogram, overflow);
     }
 
-    hist_unoptimized_st<T, UseMask, Bits, LoBit, SamplesPerPixel, Sample0Index,
-                        SampleIndices...>(epilog_data, epilog_mask,
-                                          epilog_size, histogram);
+    hist_unoptimized<T, UseMask, Bits, LoBit, SamplesPerPixel, Sample0Index,
+                     SampleIndices...>(epilog_data, epilog_mask, epilog_size,
+                                       histogram, overflow);
 }
 
-template <tuning_parameters const &Tuning, typename T, bool UseMask = false,
-          unsigned Bits = 8 * sizeof(T), unsigned LoBit = 0,
-          std::size_t SamplesPerPixel = 1, std::size_t Sample0Index = 0,
-          std::size_t... SampleIndices>
-IHIST_NOINLINE void
-histxy_striped_st(T const *IHIST_RESTRICT data,
-                  std::uint8_t const *IHIST_RESTRICT mask, std::size_t height,
-                  std::size_t width, std::size_t image_stride,
-                  std::size_t mask_stride,
-                  std::uint32_t *IHIST_RESTRICT histogram, std::size_t = 0) {
+template <tuning_parameters const &Tuning, typename T, bool UseMask,
+          unsigned Bits, unsigned LoBit, std::size_t SamplesPerPixel,
+          std::size_t Sample0Index, std::size_t... SampleIndices>
+void histxy_striped(T const *IHIST_RESTRICT data,
+                    std::uint8_t const *IHIST_RESTRICT mask,
+                    std::size_t height, std::size_t width,
+                    std::size_t image_stride, std::size_t mask_stride,
+                    std::uint32_t *IHIST_RESTRICT histogram,
+                    std::uint32_t *IHIST_RESTRICT overflow) {
     assert(width * height < std::numeric_limits<std::uint32_t>::max());
     assert(width <= image_stride);
 
@@ -274,10 +316,10 @@ histxy_striped_st(T const *IHIST_RESTRICT data,
     if (width == image_stride && (!UseMask || width == mask_stride) &&
         height > 1) {
         auto const size = height * width;
-        return histxy_striped_st<Tuning, T, UseMask, Bits, LoBit,
-                                 SamplesPerPixel, Sample0Index,
-                                 SampleIndices...>(
-            data, UseMask ? mask : nullptr, 1, size, size, size, histogram);
+        return histxy_striped<Tuning, T, UseMask, Bits, LoBit,
+                              SamplesPerPixel, Sample0Index, SampleIndices...>(
+            data, UseMask ? mask : nullptr, 1, size, size, size, histogram,
+            overflow);
     }
 
     // Use extra bin for overflows if applicable.
@@ -314,7 +356,7 @@ histxy_striped_st(T const *IHIST_RESTRICT data,
             IHIST_PRAGMA_LOOP_UNROLL_FULL
             for (std::size_t n = 0; n < BLOCKSIZE * SamplesPerPixel; ++n) {
                 auto const i = block * BLOCKSIZE * SamplesPerPixel + n;
-                bins[n] = internal::bin_index<T, Bits, LoBit>(row_data[i]);
+                bins[n] = bin_index<T, Bits, LoBit>(row_data[i]);
             }
             auto const *block_mask =
                 UseMask ? row_mask + block * BLOCKSIZE : nullptr;
@@ -334,91 +376,149 @@ histxy_striped_st(T const *IHIST_RESTRICT data,
         }
 
         // Epilog goes straight to the final histogram.
-        hist_unoptimized_st<T, UseMask, Bits, LoBit, SamplesPerPixel,
-                            Sample0Index, SampleIndices...>(
-            row_epilog_data, row_epilog_mask, row_epilog_size, histogram);
+        hist_unoptimized<T, UseMask, Bits, LoBit, SamplesPerPixel,
+                         Sample0Index, SampleIndices...>(
+            row_epilog_data, row_epilog_mask, row_epilog_size, histogram,
+            overflow);
     }
 
     if constexpr (USE_STRIPES) {
-        for (std::size_t s = 0; s < NSAMPLES; ++s) {
-            for (std::size_t bin = 0; bin < NBINS; ++bin) {
-                std::uint32_t sum = 0;
-                for (std::size_t stripe = 0; stripe < NSTRIPES; ++stripe) {
-                    sum += stripes[(stripe * NSAMPLES + s) * STRIPE_LEN + bin];
-                }
-                histogram[s * NBINS + bin] += sum;
-            }
-        }
+        reduce_stripes<NSTRIPES, NSAMPLES, NBINS, STRIPE_LEN>(
+            stripes, histogram, overflow);
     }
 }
 
+} // namespace internal
+
+template <typename T, bool UseMask = false, unsigned Bits = 8 * sizeof(T),
+          unsigned LoBit = 0, std::size_t SamplesPerPixel = 1,
+          std::size_t Sample0Index = 0, std::size_t... SampleIndices>
+/* not noinline */ void
+hist_unoptimized_st(T const *IHIST_RESTRICT data,
+                    std::uint8_t const *IHIST_RESTRICT mask, std::size_t size,
+                    std::uint32_t *IHIST_RESTRICT histogram, std::size_t = 0) {
+    internal::hist_unoptimized<T, UseMask, Bits, LoBit, SamplesPerPixel,
+                               Sample0Index, SampleIndices...>(
+        data, mask, size, histogram, nullptr);
+}
+
+template <typename T, bool UseMask = false, unsigned Bits = 8 * sizeof(T),
+          unsigned LoBit = 0, std::size_t SamplesPerPixel = 1,
+          std::size_t Sample0Index = 0, std::size_t... SampleIndices>
+/* not noinline */ void histxy_unoptimized_st(
+    T const *IHIST_RESTRICT data, std::uint8_t const *IHIST_RESTRICT mask,
+    std::size_t height, std::size_t width, std::size_t image_stride,
+    std::size_t mask_stride, std::uint32_t *IHIST_RESTRICT histogram,
+    std::size_t = 0) {
+    internal::histxy_unoptimized<T, UseMask, Bits, LoBit, SamplesPerPixel,
+                                 Sample0Index, SampleIndices...>(
+        data, mask, height, width, image_stride, mask_stride, histogram,
+        nullptr);
+}
+
+template <tuning_parameters const &Tuning, typename T, bool UseMask = false,
+          unsigned Bits = 8 * sizeof(T), unsigned LoBit = 0,
+          std::size_t SamplesPerPixel = 1, std::size_t Sample0Index = 0,
+          std::size_t... SampleIndices>
+IHIST_NOINLINE void
+hist_striped_st(T const *IHIST_RESTRICT data,
+                std::uint8_t const *IHIST_RESTRICT mask, std::size_t size,
+                std::uint32_t *IHIST_RESTRICT histogram, std::size_t = 0) {
+    internal::hist_striped<Tuning, T, UseMask, Bits, LoBit, SamplesPerPixel,
+                           Sample0Index, SampleIndices...>(
+        data, mask, size, histogram, nullptr);
+}
+
+template <tuning_parameters const &Tuning, typename T, bool UseMask = false,
+          unsigned Bits = 8 * sizeof(T), unsigned LoBit = 0,
+          std::size_t SamplesPerPixel = 1, std::size_t Sample0Index = 0,
+          std::size_t... SampleIndices>
+IHIST_NOINLINE void
+histxy_striped_st(T const *IHIST_RESTRICT data,
+                  std::uint8_t const *IHIST_RESTRICT mask, std::size_t height,
+                  std::size_t width, std::size_t image_stride,
+                  std::size_t mask_stride,
+                  std::uint32_t *IHIST_RESTRICT histogram, std::size_t = 0) {
+    internal::histxy_striped<Tuning, T, UseMask, Bits, LoBit, SamplesPerPixel,
+                             Sample0Index, SampleIndices...>(
+        data, mask, height, width, image_stride, mask_stride, histogram,
+        nullptr);
+}
+
 namespace internal {
 
 template <typename T>
 using hist_st_func = void(T const *IHIST_RESTRICT,
                           std::uint8_t const *IHIST_RESTRICT, std::size_t,
-                          std::uint32_t *IHIST_RESTRICT, std::size_t);
+                          std::uint32_t *IHIST_RESTRICT,
+                          std::uint32_t *IHIST_RESTRICT);
 
 template <typename T>
 using histxy_st_func = void(T const *IHIST_RESTRICT,
                             std::uint8_t const *IHIST_RESTRICT, std::size_t,
                             std::size_t, std::size_t, std::size_t,
-                            std::uint32_t *IHIST_RESTRICT, std::size_t);
+                            std::uint32_t *IHIST_RESTRICT,
+                            std::uint32_t *IHIST_RESTRICT);
 
-template <typename T, std::size_t HistSize>
+// Each thread's histogram is followed by its overflow counts.
+template <typename T, std::size_t NBins, std::size_t NSamples>
 void hist_mt(hist_st_func<T> *hist_func, T const *IHIST_RESTRICT data,
              std::uint8_t const *IHIST_RESTRICT mask, std::size_t size,
              std::size_t n_components, std::uint32_t *IHIST_RESTRICT histogram,
+             std::uint32_t *IHIST_RESTRICT overflow,
              std::size_t grain_size = 1) {
 #ifdef IHIST_USE_TBB
-    using hist_array = std::array<std::uint32_t, HistSize>;
+    constexpr std::size_t HIST_SIZE = NBins * NSamples;
+    using hist_array = std::array<std::uint32_t, HIST_SIZE + NSamples>;
     tbb::combinable<hist_array> local_hists([] { return hist_array{}; });
 
-    // Histogramming scales very poorly with simultaneous multithreading
-    // (Hyper-Threading), so only schedule 1 thread per physical core.
-    int const n_phys_cores = get_physical_core_count();
-    auto arena =
-        n_phys_cores > 0 ? tbb::task_arena(n_phys_cores) : tbb::task_arena();
+    auto arena = internal::phys_core_arena();
     arena.execute([&] {
-        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, size, grain_size),
-                          [&](tbb::blocked_range<std::size_t> const &r) {
-                              auto &h = local_hists.local();
-                              hist_func(data + r.begin() * n_components,
-                                        mask == nullptr ? nullptr
-                                                        : mask + r.begin(),
-                                        r.size(), h.data(), 0);
-                          });
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, size, grain_size),
+            [&](tbb::blocked_range<std::size_t> const &r) {
+                auto &h = local_hists.local();
+                hist_func(data + r.begin() * n_components,
+                          mask == nullptr ? nullptr : mask + r.begin(),
+                          r.size(), h.data(),
+                          overflow == nullptr ? nullptr
+                                              : h.data() + HIST_SIZE);
+            });
     });
 
     local_hists.combine_each([&](hist_array const &h) {
-        std::transform(h.begin(), h.end(), histogram, histogram, std::plus{});
+        std::transform(h.begin(), h.begin() + HIST_SIZE, histogram, histogram,
+                       std::plus{});
+        if (overflow != nullptr) {
+            std::transform(h.begin() + HIST_SIZE, h.end(), overflow, overflow,
+                           std::plus{});
+        }
     });
 #else
     (void)grain_size;
     (void)n_components;
-    hist_func(data, mask, size, histogram, 0);
+    hist_func(data, mask, size, histogram, overflow);
 #endif
 }
 
-template <typename T, std::size_t SamplesPerPixel, std::size_t HistSize>
+template <typename T, std::size_t SamplesPerPixel, std::size_t NBins,
+          std::size_t NSamples>
 void histxy_mt(histxy_st_func<T> *histxy_func, T const *IHIST_RESTRICT data,
                std::uint8_t const *IHIST_RESTRICT mask, std::size_t height,
                std::size_t width, std::size_t image_stride,
                std::size_t mask_stride,
                std::uint32_t *IHIST_RESTRICT histogram,
+               std::uint32_t *IHIST_RESTRICT overflow,
                std::size_t grain_size = 1) {
 #ifdef IHIST_USE_TBB
-    using hist_array = std::array<std::uint32_t, HistSize>;
+    constexpr std::size_t HIST_SIZE = NBins * NSamples;
+    using hist_array = std::array<std::uint32_t, HIST_SIZE + NSamples>;
     tbb::combinable<hist_array> local_hists([] { return hist_array{}; });
 
     auto const h_grain_size =
         std::max(std::size_t(1), grain_size / std::max(std::size_t(1), width));
 
-    // Histogramming scales very poorly with simultaneous multithreading
-    // (Hyper-Threading), so only schedule 1 thread per physical core.
-    int const n_phys_cores = get_physical_core_count();
-    auto arena =
-        n_phys_cores > 0 ? tbb::task_arena(n_phys_cores) : tbb::task_arena();
+    auto arena = internal::phys_core_arena();
     arena.execute([&] {
         tbb::parallel_for(
             tbb::blocked_range<std::size_t>(0, height, h_grain_size),
@@ -427,20 +527,51 @@ void histxy_mt(histxy_st_func<T> *histxy_func, T const *IHIST_RESTRICT data,
                 histxy_func(data + r.begin() * image_stride * SamplesPerPixel,
                             mask ? mask + r.begin() * mask_stride : nullptr,
                             r.size(), width, image_stride, mask_stride,
-                            h.data(), 0);
+                            h.data(),
+                            overflow == nullptr ? nullptr
+                                                : h.data() + HIST_SIZE);
             });
     });
 
     local_hists.combine_each([&](hist_array const &h) {
-        std::transform(h.begin(), h.end(), histogram, histogram, std::plus{});
+        std::transform(h.begin(), h.begin() + HIST_SIZE, histogram, histogram,
+                       std::plus{});
+        if (overflow != nullptr) {
+            std::transform(h.begin() + HIST_SIZE, h.end(), overflow, overflow,
+                           std::plus{});
+        }
     });
 #else
     (void)grain_size;
     histxy_func(data, mask, height, width, image_stride, mask_stride,
-                histogram, 0);
+                histogram, overflow);
 #endif
 }
 
+template <tuning_parameters const &Tuning, typename T, bool UseMask,
+          unsigned Bits, unsigned LoBit, std::size_t SamplesPerPixel,
+          std::size_t Sample0Index, std::size_t... SampleIndices>
+void histxy_striped_maybe_mt(T const *IHIST_RESTRICT data,
+                             std::uint8_t const *IHIST_RESTRICT mask,
+                             std::size_t height, std::size_t width,
+                             std::size_t image_stride, std::size_t mask_stride,
+                             std::uint32_t *IHIST_RESTRICT histogram,
+                             std::uint32_t *IHIST_RESTRICT overflow, bool mt,
+                             std::size_t grain_size) {
+    constexpr auto *st_func =
+        histxy_striped<Tuning, T, UseMask, Bits, LoBit, SamplesPerPixel,
+                       Sample0Index, SampleIndices...>;
+    if (mt) {
+        histxy_mt<T, SamplesPerPixel, (1uLL << Bits),
+                  1 + sizeof...(SampleIndices)>(
+            st_func, data, mask, height, width, image_stride, mask_stride,
+            histogram, overflow, grain_size);
+    } else {
+        st_func(data, mask, height, width, image_stride, mask_stride,
+                histogram, overflow);
+    }
+}
+
 } // namespace internal
 
 template <typename T, bool UseMask = false, unsigned Bits = 8 * sizeof(T),
@@ -453,10 +584,10 @@ hist_unoptimized_mt(T const *IHIST_RESTRICT data,
                     std::size_t grain_size = 1) {
 #ifdef IHIST_USE_TBB
     constexpr auto NSAMPLES = 1 + sizeof...(SampleIndices);
-    internal::hist_mt<T, (1uLL << Bits) * NSAMPLES>(
-        hist_unoptimized_st<T, UseMask, Bits, LoBit, SamplesPerPixel,
-                            Sample0Index, SampleIndices...>,
-        data, mask, size, SamplesPerPixel, histogram, grain_size);
+    internal::hist_mt<T, (1uLL << Bits), NSAMPLES>(
+        internal::hist_unoptimized<T, UseMask, Bits, LoBit, SamplesPerPixel,
+                                   Sample0Index, SampleIndices...>,
+        data, mask, size, SamplesPerPixel, histogram, nullptr, grain_size);
 #else
     (void)grain_size;
     hist_unoptimized_st<T, UseMask, Bits, LoBit, SamplesPerPixel, Sample0Index,
@@ -475,10 +606,11 @@ IHIST_NOINLINE void hist_striped_mt(T const *IHIST_RESTRICT data,
                                     std::size_t grain_size = 1) {
 #ifdef IHIST_USE_TBB
     constexpr auto NSAMPLES = 1 + sizeof...(SampleIndices);
-    internal::hist_mt<T, (1uLL << Bits) * NSAMPLES>(
-        hist_striped_st<Tuning, T, UseMask, Bits, LoBit, SamplesPerPixel,
-                        Sample0Index, SampleIndices...>,
-        data, mask, size, SamplesPerPixel, histogram, grain_size);
+    internal::hist_mt<T, (1uLL << Bits), NSAMPLES>(
+        internal::hist_striped<Tuning, T, UseMask, Bits, LoBit,
+                               SamplesPerPixel, Sample0Index,
+                               SampleIndices...>,
+        data, mask, size, SamplesPerPixel, histogram, nullptr, grain_size);
 #else
     (void)grain_size;
     hist_striped_st<Tuning, T, UseMask, Bits, LoBit, SamplesPerPixel,
@@ -497,11 +629,11 @@ IHIST_NOINLINE void histxy_unoptimized_mt(
     std::size_t grain_size = 1) {
 #ifdef IHIST_USE_TBB
     constexpr auto NSAMPLES = 1 + sizeof...(SampleIndices);
-    internal::histxy_mt<T, SamplesPerPixel, (1uLL << Bits) * NSAMPLES>(
-        histxy_unoptimized_st<T, UseMask, Bits, LoBit, SamplesPerPixel,
-                              Sample0Index, SampleIndices...>,
+    internal::histxy_mt<T, SamplesPerPixel, (1uLL << Bits), NSAMPLES>(
+        internal::histxy_unoptimized<T, UseMask, Bits, LoBit, SamplesPerPixel,
+                                     Sample0Index, SampleIndices...>,
         data, mask, height, width, image_stride, mask_stride, histogram,
-        grain_size);
+        nullptr, grain_size);
 #else
     (void)grain_size;
     histxy_unoptimized_st<T, UseMask, Bits, LoBit, SamplesPerPixel,
@@ -523,11 +655,12 @@ IHIST_NOINLINE void histxy_striped_mt(T const *IHIST_RESTRICT data,
                                       std::size_t grain_size = 1) {
 #ifdef IHIST_USE_TBB
     constexpr auto NSAMPLES = 1 + sizeof...(SampleIndices);
-    internal::histxy_mt<T, SamplesPerPixel, (1uLL << Bits) * NSAMPLES>(
-        histxy_striped_st<Tuning, T, UseMask, Bits, LoBit, SamplesPerPixel,
-                          Sample0Index, SampleIndices...>,
+    internal::histxy_mt<T, SamplesPerPixel, (1uLL << Bits), NSAMPLES>(
+        internal::histxy_striped<Tuning, T, UseMask, Bits, LoBit,
+                                 SamplesPerPixel, Sample0Index,
+                                 SampleIndices...>,
         data, mask, height, width, image_stride, mask_stride, histogram,
-        grain_size);
+        nullptr, grain_size);
 #else
     (void)grain_size;
     histxy_striped_st<Tuning, T, UseMask, Bits, LoBit, SamplesPerPixel,
@@ -545,7 +678,8 @@ histxy_dynamic_st(T const *IHIST_RESTRICT data,
                   std::size_t mask_stride, std::size_t n_components,
                   std::size_t n_hist_components,
                   std::size_t const *IHIST_RESTRICT component_indices,
-                  std::uint32_t *IHIST_RESTRICT histogram) {
+                  std::uint32_t *IHIST_RESTRICT histogram,
+                  std::uint32_t *IHIST_RESTRICT overflow = nullptr) {
     assert(width * height < std::numeric_limits<std::uint32_t>::max());
     assert(width <= image_stride);
     assert(component_indices != nullptr || n_hist_components == 0);
@@ -558,7 +692,7 @@ histxy_dynamic_st(T const *IHIST_RESTRICT data,
         auto const size = height * width;
         return histxy_dynamic_st<T, UseMask, Bits, LoBit>(
             data, mask, 1, size, size, size, n_components, n_hist_components,
-            component_indices, histogram);
+            component_indices, histogram, overflow);
     }
 
     // We could implement striping for dynamic components, perhaps only for the
@@ -577,6 +711,8 @@ histxy_dynamic_st(T const *IHIST_RESTRICT data,
                         internal::bin_index<T, Bits, LoBit>(data[i + s_index]);
                     if (bin != NBINS) {
                         ++histogram[s * NBINS + bin];
+                    } else if (overflow != nullptr) {
+                        ++overflow[s];
                     }
                 }
             }
@@ -592,23 +728,22 @@ IHIST_NOINLINE void histxy_dynamic_mt(
     std::size_t mask_stride, std::size_t n_components,
     std::size_t n_hist_components,
     std::size_t const *IHIST_RESTRICT component_indices,
-    std::uint32_t *IHIST_RESTRICT histogram, std::size_t grain_size = 1) {
+    std::uint32_t *IHIST_RESTRICT histogram, std::size_t grain_size = 1,
+    std::uint32_t *IHIST_RESTRICT overflow = nullptr) {
 #ifdef IHIST_USE_TBB
     constexpr std::size_t NBINS = 1uLL << Bits;
     std::size_t const hist_size = n_hist_components * NBINS;
 
+    // Each thread's histogram is followed by its overflow counts.
     using hist_vec = std::vector<std::uint32_t>;
-    tbb::combinable<hist_vec> local_hists(
-        [hist_size] { return hist_vec(hist_size, 0); });
+    tbb::combinable<hist_vec> local_hists([hist_size, n_hist_components] {
+        return hist_vec(hist_size + n_hist_components, 0);
+    });
 
     auto const h_grain_size =
         std::max(std::size_t(1), grain_size / std::max(std::size_t(1), width));
 
-    // Histogramming scales very poorly with simultaneous multithreading
-    // (Hyper-Threading), so only schedule 1 thread per physical core.
-    int const n_phys_cores = internal::get_physical_core_count();
-    auto arena =
-        n_phys_cores > 0 ? tbb::task_arena(n_phys_cores) : tbb::task_arena();
+    auto arena = internal::phys_core_arena();
 
     arena.execute([&] {
         tbb::parallel_for(
@@ -619,19 +754,231 @@ IHIST_NOINLINE void histxy_dynamic_mt(
                     data + r.begin() * image_stride * n_components,
                     mask ? mask + r.begin() * mask_stride : nullptr, r.size(),
                     width, image_stride, mask_stride, n_components,
-                    n_hist_components, component_indices, h.data());
+                    n_hist_components, component_indices, h.data(),
+                    overflow == nullptr ? nullptr : h.data() + hist_size);
             });
     });
 
     local_hists.combine_each([&](hist_vec const &h) {
-        std::transform(h.begin(), h.end(), histogram, histogram, std::plus{});
+        auto const hist_end = std::next(h.begin(), hist_size);
+        std::transform(h.begin(), hist_end, histogram, histogram,
+                       std::plus{});
+        if (overflow != nullptr) {
+            std::transform(hist_end, h.end(), overflow, overflow,
+                           std::plus{});
+        }
     });
 #else
     (void)grain_size;
     histxy_dynamic_st<T, UseMask, Bits, LoBit>(
         data, mask, height, width, image_stride, mask_stride, n_components,
-        n_hist_components, component_indices, histogram);
+        n_hist_components, component_indices, histogram, overflow);
 #endif
 }
 
+// Typed interface
+
+// Non-owning view of a 2D image whose pixels consist of Components
+// interleaved samples of type T. Height, width, and stride are in pixels;
+// pixel (y, x) starts at data() + (y * stride() + x) * Components.
+template <typename T, std::size_t Components = 1> class image_view {
+    static_assert(std::is_unsigned_v<T>);
+    static_assert(Components > 0);
+
+  public:
+    using sample_type = T;
+    static constexpr std::size_t components = Components;
+
+    constexpr image_view() noexcept = default;
+
+    constexpr image_view(T const *data, std::size_t height,
+                         std::size_t width) noexcept
+        : image_view(data, height, width, width) {}
+
+    constexpr image_view(T const *data, std::size_t height, std::size_t width,
+                         std::size_t stride) noexcept
+        : data_(data), height_(height), width_(width), stride_(stride) {
+        assert(width <= stride);
+    }
+
+    [[nodiscard]] constexpr auto data() const noexcept -> T const * {
+        return data_;
+    }
+    [[nodiscard]] constexpr auto height() const noexcept -> std::size_t {
+        return height_;
+    }
+    [[nodiscard]] constexpr auto width() const noexcept -> std::size_t {
+        return width_;
+    }
+    [[nodiscard]] constexpr auto stride() const noexcept -> std::size_t {
+        return stride_;
+    }
+
+    // View of the height x width rectangle whose top-left pixel is (y, x).
+    [[nodiscard]] constexpr auto subview(std::size_t y, std::size_t x,
+                                         std::size_t height,
+                                         std::size_t width) const noexcept
+        -> image_view {
+        assert(y + height <= height_ && x + width <= width_);
+        return {data_ + (y * stride_ + x) * Components, height, width,
+                stride_};
+    }
+
+  private:
+    T const *data_ = nullptr;
+    std::size_t height_ = 0;
+    std::size_t width_ = 0;
+    std::size_t stride_ = 0;
+};
+
+// Mask with the same height and width as the image; only pixels whose mask
+// value is nonzero are histogrammed.
+using mask_view = image_view<std::uint8_t>;
+
+// Compile-time description of the samples to histogram: the sample type T;
+// the Bits significant bits starting at LoBit (samples with higher bits set
+// are out of range and not counted); the number of interleaved samples per
+// pixel; and the indices of the samples (within each pixel) to histogram, in
+// the order of their histograms in the output.
+template <typename T, unsigned Bits = 8 * sizeof(T), unsigned LoBit = 0,
+          std::size_t SamplesPerPixel = 1, std::size_t Sample0Index = 0,
+          std::size_t... SampleIndices>
+struct pixel_format {
+    static_assert(std::is_unsigned_v<T>);
+    static_assert(Bits > 0 && Bits + LoBit <= 8 * sizeof(T));
+    static_assert(std::max<std::size_t>({Sample0Index, SampleIndices...}) <
+                  SamplesPerPixel);
+
+    using sample_type = T;
+    using view_type = image_view<T, SamplesPerPixel>;
+
+    static constexpr unsigned bits = Bits;
+    static constexpr unsigned lo_bit = LoBit;
+    static constexpr std::size_t samples_per_pixel = SamplesPerPixel;
+    static constexpr std::size_t n_hist_components =
+        1 + sizeof...(SampleIndices);
+    static constexpr std::array<std::size_t, n_hist_components>
+        sample_indices{Sample0Index, SampleIndices...};
+    static constexpr std::size_t n_bins = std::size_t(1) << Bits;
+
+    // Number of std::uint32_t elements in the output histogram.
+    static constexpr std::size_t histogram_size = n_hist_components * n_bins;
+};
+
+template <typename T, unsigned Bits = 8 * sizeof(T)>
+using mono = pixel_format<T, Bits>;
+
+template <typename T, unsigned Bits = 8 * sizeof(T)>
+using abc = pixel_format<T, Bits, 0, 3, 0, 1, 2>;
+
+template <typename T, unsigned Bits = 8 * sizeof(T)>
+using abcx = pixel_format<T, Bits, 0, 4, 0, 1, 2>;
+
+template <typename T, unsigned Bits = 8 * sizeof(T)>
+using xabc = pixel_format<T, Bits, 0, 4, 1, 2, 3>;
+
+namespace internal {
+
+// Same as the generic values the library uses on platforms it has no
+// tuning for.
+template <typename Format>
+constexpr auto generic_tuning() -> tuning_parameters {
+    if constexpr (Format::samples_per_pixel == 1) {
+        if (Format::bits <= 8) {
+            return {4, 4};
+        }
+        if (Format::bits <= 12) {
+            return {2, 2};
+        }
+    }
+    return {1, 1};
+}
+
+template <typename Format> struct format_kernels;
+
+template <typename T, unsigned Bits, unsigned LoBit,
+          std::size_t SamplesPerPixel, std::size_t Sample0Index,
+          std::size_t... SampleIndices>
+struct format_kernels<pixel_format<T, Bits, LoBit, SamplesPerPixel,
+                                   Sample0Index, SampleIndices...>> {
+    template <tuning_parameters const &Tuning, bool UseMask>
+    static constexpr histxy_st_func<T> *histxy =
+        histxy_striped<Tuning, T, UseMask, Bits, LoBit, SamplesPerPixel,
+                       Sample0Index, SampleIndices...>;
+};
+
+} // namespace internal
+
+// Striping and unrolling used by histogram() and histogram_mt() unless
+// another tuning is given. The C API uses values benchmarked for the target
+// platform, which may differ; pass a custom tuning_parameters object (with
+// static storage duration) to override.
+template <typename Format>
+inline constexpr tuning_parameters default_tuning =
+    internal::generic_tuning<Format>();
+
+// Minimum number of pixels per task used by histogram_mt() by default (the
+// same value as the C API).
+inline constexpr std::size_t default_grain_size = std::size_t(1) << 20;
+
+// Add the histogram of 'image' to 'hist', which must have
+// Format::histogram_size elements (the histograms of the selected samples,
+// one after another). If 'overflow' is not null, it must have
+// Format::n_hist_components elements, and out-of-range samples are added to
+// it.
+template <typename Format,
+          tuning_parameters const &Tuning = default_tuning<Format>>
+void histogram(typename Format::view_type const &image,
+               std::uint32_t *IHIST_RESTRICT hist,
+               std::uint32_t *IHIST_RESTRICT overflow = nullptr) {
+    internal::format_kernels<Format>::template histxy<Tuning, false>(
+        image.data(), nullptr, image.height(), image.width(), image.stride(),
+        0, hist, overflow);
+}
+
+// Same as above, but only histogram pixels selected by 'mask'.
+template <typename Format,
+          tuning_parameters const &Tuning = default_tuning<Format>>
+void histogram(typename Format::view_type const &image, mask_view const &mask,
+               std::uint32_t *IHIST_RESTRICT hist,
+               std::uint32_t *IHIST_RESTRICT overflow = nullptr) {
+    assert(mask.height() == image.height() && mask.width() == image.width());
+    internal::format_kernels<Format>::template histxy<Tuning, true>(
+        image.data(), mask.data(), image.height(), image.width(),
+        image.stride(), mask.stride(), hist, overflow);
+}
+
+// Multi-threaded histogram() (if built with TBB). Each task histograms at
+// least about 'grain_size' pixels; small images are therefore processed by a
+// single thread, though with the overhead of a per-thread histogram.
+template <typename Format,
+          tuning_parameters const &Tuning = default_tuning<Format>>
+void histogram_mt(typename Format::view_type const &image,
+                  std::uint32_t *IHIST_RESTRICT hist,
+                  std::uint32_t *IHIST_RESTRICT overflow = nullptr,
+                  std::size_t grain_size = default_grain_size) {
+    internal::histxy_mt<typename Format::sample_type,
+                        Format::samples_per_pixel, Format::n_bins,
+                        Format::n_hist_components>(
+        internal::format_kernels<Format>::template histxy<Tuning, false>,
+        image.data(), nullptr, image.height(), image.width(), image.stride(),
+        0, hist, overflow, grain_size);
+}
+
+// Same as above, but only histogram pixels selected by 'mask'.
+template <typename Format,
+          tuning_parameters const &Tuning = default_tuning<Format>>
+void histogram_mt(typename Format::view_type const &image,
+                  mask_view const &mask, std::uint32_t *IHIST_RESTRICT hist,
+                  std::uint32_t *IHIST_RESTRICT overflow = nullptr,
+                  std::size_t grain_size = default_grain_size) {
+    assert(mask.height() == image.height() && mask.width() == image.width());
+    internal::histxy_mt<typename Format::sample_type,
+                        Format::samples_per_pixel, Format::n_bins,
+                        Format::n_hist_components>(
+        internal::format_kernels<Format>::template histxy<Tuning, true>,
+        image.data(), mask.data(), image.height(), image.width(),
+        image.stride(), mask.stride(), hist, overflow, grain_size);
+}
+
 } // namespace ihist
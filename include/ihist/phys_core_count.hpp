@@ -6,7 +6,11 @@
 
 #pragma once
 
-#include "ihist/ihist.h"
+#include "ihist.h"
+
+#ifdef IHIST_USE_TBB
+#include <tbb/task_arena.h>
+#endif
 
 namespace ihist::internal {
 
@@ -26,4 +30,16 @@ namespace ihist::internal {
 
 IHIST_PUBLIC auto get_physical_core_count() -> int;
 
+#ifdef IHIST_USE_TBB
+// Return a task arena for the library's parallel loops. Histogramming scales
+// very poorly with simultaneous multithreading (Hyper-Threading), so only
+// schedule 1 thread per physical core (or TBB's default if the count is
+// unknown).
+inline auto phys_core_arena() -> tbb::task_arena {
+    int const n_phys_cores = get_physical_core_count();
+    return n_phys_cores > 0 ? tbb::task_arena(n_phys_cores)
+                            : tbb::task_arena();
+}
+#endif
+
 } // namespace ihist::internal
\ No newline at end of file
@@ -0,0 +1,164 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist.benchmarks;
+
+import io.github.marktsuchida.ihist.HistogramRequest;
+import java.nio.Buffer;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.ShortBuffer;
+import java.util.concurrent.TimeUnit;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Histogram of an image through {@link HistogramRequest}, by the kind of
+ * image (and mask) storage.
+ *
+ * <p>
+ * Storage kinds ({@code buffer}):
+ * <ul>
+ * <li>{@code array}: Java array (JNI critical array access)
+ * <li>{@code heap}: array-backed buffer (likewise)
+ * <li>{@code direct}: direct buffer
+ * <li>{@code view}: heap buffer without an accessible array (read-only, or a
+ * {@code ShortBuffer} view of a {@code ByteBuffer}), which
+ * {@code HistogramRequest} copies to a temporary direct buffer
+ * <li>{@code copy}: Java array copied to a (preallocated) direct buffer
+ * before each call; this is the cost of the native code's region-copy
+ * fallback, used if critical array access is unavailable
+ * </ul>
+ *
+ * <p>
+ * The output is always a preallocated {@code int[]}. Compare with
+ * {@link JavaLoopBenchmark} for the same image parameters.
+ */
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+public class HistogramBenchmark extends ImageState {
+
+    @Param({"array", "heap", "direct", "view", "copy"}) public String buffer;
+
+    @Param({"false", "true"}) public boolean parallel;
+
+    private ByteBuffer image8Buf;
+    private ShortBuffer image16Buf;
+    private ByteBuffer maskBuf;
+    private int[] histogram;
+
+    @Setup
+    public void prepareBuffers() {
+        generateImage();
+        histogram = new int[histogramSize()];
+        image8Buf = null;
+        image16Buf = null;
+        maskBuf = null;
+        switch (buffer) {
+        case "array":
+            break;
+        case "heap":
+            if (is8Bit()) {
+                image8Buf = ByteBuffer.wrap(image8);
+            } else {
+                image16Buf = ShortBuffer.wrap(image16);
+            }
+            maskBuf = mask != null ? ByteBuffer.wrap(mask) : null;
+            break;
+        case "direct":
+        case "copy":
+            if (is8Bit()) {
+                image8Buf = ByteBuffer.allocateDirect(image8.length);
+                image8Buf.put(image8);
+                ((Buffer)image8Buf).rewind();
+            } else {
+                image16Buf = ByteBuffer.allocateDirect(image16.length * 2)
+                                 .order(ByteOrder.nativeOrder())
+                                 .asShortBuffer();
+                image16Buf.put(image16);
+                ((Buffer)image16Buf).rewind();
+            }
+            if (mask != null) {
+                maskBuf = ByteBuffer.allocateDirect(mask.length);
+                maskBuf.put(mask);
+                ((Buffer)maskBuf).rewind();
+            }
+            break;
+        case "view":
+            if (is8Bit()) {
+                image8Buf = ByteBuffer.wrap(image8).asReadOnlyBuffer();
+            } else {
+                ByteBuffer bytes = ByteBuffer.allocate(image16.length * 2)
+                                       .order(ByteOrder.nativeOrder());
+                bytes.asShortBuffer().put(image16);
+                image16Buf = bytes.asShortBuffer();
+            }
+            maskBuf =
+                mask != null ? ByteBuffer.wrap(mask).asReadOnlyBuffer() : null;
+            break;
+        default:
+            throw new IllegalArgumentException("unknown buffer: " + buffer);
+        }
+    }
+
+    @Benchmark
+    public int[] histogram() {
+        if (buffer.equals("copy")) {
+            copyToDirect();
+        }
+        HistogramRequest req;
+        if (buffer.equals("array")) {
+            req = is8Bit()
+                      ? HistogramRequest.forImage(image8, size, size,
+                                                  nComponents)
+                      : HistogramRequest.forImage(image16, size, size,
+                                                  nComponents);
+            if (mask != null) {
+                req.mask(mask, size, size);
+            }
+        } else {
+            req = is8Bit()
+                      ? HistogramRequest.forImage(image8Buf, size, size,
+                                                  nComponents)
+                      : HistogramRequest.forImage(image16Buf, size, size,
+                                                  nComponents);
+            if (maskBuf != null) {
+                req.mask(maskBuf, size, size);
+            }
+        }
+        req.selectComponents(componentIndices)
+            .bits(bits)
+            .parallel(parallel)
+            .output(histogram)
+            .compute();
+        return histogram;
+    }
+
+    private void copyToDirect() {
+        if (is8Bit()) {
+            ((Buffer)image8Buf).clear();
+            image8Buf.put(image8);
+            ((Buffer)image8Buf).flip();
+        } else {
+            ((Buffer)image16Buf).clear();
+            image16Buf.put(image16);
+            ((Buffer)image16Buf).flip();
+        }
+        if (maskBuf != null) {
+            ((Buffer)maskBuf).clear();
+            maskBuf.put(mask);
+            ((Buffer)maskBuf).flip();
+        }
+    }
+}
@@ -0,0 +1,84 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist.benchmarks;
+
+import java.util.Random;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.State;
+
+/**
+ * Image parameters and random test data shared by the benchmarks.
+ *
+ * <p>
+ * Images are square. Pixel values are uniformly distributed over the
+ * {@code bits}-bit range; 8-bit images are stored as {@code byte}, others as
+ * {@code short}. About 3/4 of the mask (if any) is nonzero.
+ */
+@State(Scope.Thread)
+public abstract class ImageState {
+
+    @Param({"64", "512", "2048"}) public int size;
+
+    /** Sample bits: 8 for 8-bit images; 12 or 16 for 16-bit images. */
+    @Param({"8", "12", "16"}) public int bits;
+
+    /**
+     * Component layout: {@code mono} (1 component), {@code rgb} (3), or
+     * {@code rgbx} (4, of which the first 3 are histogrammed).
+     */
+    @Param({"mono", "rgb", "rgbx"}) public String layout;
+
+    @Param({"false", "true"}) public boolean masked;
+
+    int nComponents;
+    int[] componentIndices;
+    byte[] image8;   // Non-null if bits == 8
+    short[] image16; // Non-null if bits > 8
+    byte[] mask;     // Null if !masked
+
+    boolean is8Bit() { return bits == 8; }
+
+    int histogramSize() { return componentIndices.length << bits; }
+
+    // Called first by the subclass's @Setup method.
+    void generateImage() {
+        switch (layout) {
+        case "mono":
+            nComponents = 1;
+            componentIndices = new int[] {0};
+            break;
+        case "rgb":
+            nComponents = 3;
+            componentIndices = new int[] {0, 1, 2};
+            break;
+        case "rgbx":
+            nComponents = 4;
+            componentIndices = new int[] {0, 1, 2};
+            break;
+        default:
+            throw new IllegalArgumentException("unknown layout: " + layout);
+        }
+
+        Random rng = new Random(42);
+        int nSamples = size * size * nComponents;
+        if (is8Bit()) {
+            image8 = new byte[nSamples];
+            rng.nextBytes(image8);
+        } else {
+            image16 = new short[nSamples];
+            for (int i = 0; i < nSamples; ++i) {
+                image16[i] = (short)rng.nextInt(1 << bits);
+            }
+        }
+        mask = null;
+        if (masked) {
+            mask = new byte[size * size];
+            for (int i = 0; i < mask.length; ++i) {
+                mask[i] = (byte)(rng.nextInt(4) != 0 ? 1 : 0);
+            }
+        }
+    }
+}
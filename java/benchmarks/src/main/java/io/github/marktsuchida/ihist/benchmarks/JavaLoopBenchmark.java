@@ -0,0 +1,59 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist.benchmarks;
+
+import java.util.Arrays;
+import java.util.concurrent.TimeUnit;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.Warmup;
+
+/**
+ * Baseline: the same histograms as {@link HistogramBenchmark}, computed by a
+ * straightforward single-threaded Java loop over a Java array.
+ */
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 3, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+public class JavaLoopBenchmark extends ImageState {
+
+    private int[] histogram;
+
+    @Setup
+    public void allocateHistogram() {
+        generateImage();
+        histogram = new int[histogramSize()];
+    }
+
+    @Benchmark
+    public int[] javaLoop() {
+        Arrays.fill(histogram, 0);
+        int nPixels = size * size;
+        int nHist = componentIndices.length;
+        int maxValue = (1 << bits) - 1;
+        for (int i = 0; i < nPixels; ++i) {
+            if (mask != null && mask[i] == 0) {
+                continue;
+            }
+            int pixel = i * nComponents;
+            for (int c = 0; c < nHist; ++c) {
+                int v = image8 != null
+                            ? image8[pixel + componentIndices[c]] & 0xff
+                            : image16[pixel + componentIndices[c]] & 0xffff;
+                if (v <= maxValue) {
+                    ++histogram[(c << bits) + v];
+                }
+            }
+        }
+        return histogram;
+    }
+}
@@ -8,6 +8,8 @@
 
 #include <ihist/ihist.h>
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
@@ -111,6 +113,32 @@ template <> struct jni_array_region_traits<jint> {
     }
 };
 
+template <> struct jni_array_region_traits<jlong> {
+    static void get_region(JNIEnv *env, jarray array, jsize start, jsize len,
+                           jlong *buf) {
+        env->GetLongArrayRegion(static_cast<jlongArray>(array), start, len,
+                                buf);
+    }
+    static void set_region(JNIEnv *env, jarray array, jsize start, jsize len,
+                           jlong const *buf) {
+        env->SetLongArrayRegion(static_cast<jlongArray>(array), start, len,
+                                buf);
+    }
+};
+
+template <> struct jni_array_region_traits<jdouble> {
+    static void get_region(JNIEnv *env, jarray array, jsize start, jsize len,
+                           jdouble *buf) {
+        env->GetDoubleArrayRegion(static_cast<jdoubleArray>(array), start,
+                                  len, buf);
+    }
+    static void set_region(JNIEnv *env, jarray array, jsize start, jsize len,
+                           jdouble const *buf) {
+        env->SetDoubleArrayRegion(static_cast<jdoubleArray>(array), start,
+                                  len, buf);
+    }
+};
+
 // RAII wrapper for JNI array access with fallback.
 // Tries GetPrimitiveArrayCritical first; if that fails (and no exception is
 // pending), falls back to Get*ArrayRegion with a temporary buffer.
@@ -342,6 +370,7 @@ template <> struct jni_pixel_traits<std::uint8_t> {
     using jni_array_type = jbyteArray;
     using jni_element_type = jbyte;
     using pixel_type = std::uint8_t;
+    using tile_type = ihist_tile8;
     static constexpr int max_sample_bits = 8;
     static constexpr char const *bit_error_msg =
         "sampleBits must be in range [0, 8] for 8-bit";
@@ -357,12 +386,39 @@ template <> struct jni_pixel_traits<std::uint8_t> {
                        mask_stride, n_components, n_hist_components,
                        component_indices, histogram, parallel);
     }
+
+    static void call_ihist_batch(std::size_t sample_bits, std::size_t n_images,
+                                 tile_type const *images,
+                                 std::size_t n_components,
+                                 std::size_t n_hist_components,
+                                 std::size_t const *component_indices,
+                                 std::uint32_t *const *histograms,
+                                 bool parallel) {
+        ihist_hist8_2d_batch(sample_bits, n_images, images, n_components,
+                             n_hist_components, component_indices, histograms,
+                             parallel);
+    }
+
+    static auto call_ihist_sparse(
+        std::size_t sample_bits, pixel_type const *image,
+        std::uint8_t const *mask, std::size_t height, std::size_t width,
+        std::size_t image_stride, std::size_t mask_stride,
+        std::size_t n_components, std::size_t n_hist_components,
+        std::size_t const *component_indices, std::uint16_t *bins,
+        std::uint32_t *counts, std::size_t *n_nonzero, bool parallel)
+        -> std::size_t {
+        return ihist_hist8_2d_sparse(
+            sample_bits, image, mask, height, width, image_stride, mask_stride,
+            n_components, n_hist_components, component_indices, bins, counts,
+            n_nonzero, parallel);
+    }
 };
 
 template <> struct jni_pixel_traits<std::uint16_t> {
     using jni_array_type = jshortArray;
     using jni_element_type = jshort;
     using pixel_type = std::uint16_t;
+    using tile_type = ihist_tile16;
     static constexpr int max_sample_bits = 16;
     static constexpr char const *bit_error_msg =
         "sampleBits must be in range [0, 16] for 16-bit";
@@ -378,6 +434,32 @@ template <> struct jni_pixel_traits<std::uint16_t> {
                         mask_stride, n_components, n_hist_components,
                         component_indices, histogram, parallel);
     }
+
+    static void call_ihist_batch(std::size_t sample_bits, std::size_t n_images,
+                                 tile_type const *images,
+                                 std::size_t n_components,
+                                 std::size_t n_hist_components,
+                                 std::size_t const *component_indices,
+                                 std::uint32_t *const *histograms,
+                                 bool parallel) {
+        ihist_hist16_2d_batch(sample_bits, n_images, images, n_components,
+                             n_hist_components, component_indices, histograms,
+                             parallel);
+    }
+
+    static auto call_ihist_sparse(
+        std::size_t sample_bits, pixel_type const *image,
+        std::uint8_t const *mask, std::size_t height, std::size_t width,
+        std::size_t image_stride, std::size_t mask_stride,
+        std::size_t n_components, std::size_t n_hist_components,
+        std::size_t const *component_indices, std::uint16_t *bins,
+        std::uint32_t *counts, std::size_t *n_nonzero, bool parallel)
+        -> std::size_t {
+        return ihist_hist16_2d_sparse(
+            sample_bits, image, mask, height, width, image_stride, mask_stride,
+            n_components, n_hist_components, component_indices, bins, counts,
+            n_nonzero, parallel);
+    }
 };
 
 template <typename PixelT>
@@ -445,18 +527,25 @@ class buffer_access {
     void *ptr() const { return data_ptr_; }
 };
 
-// Get buffer data - handles both direct and array-backed buffers.
+// Location of a buffer's data: either a direct address, or a Java array and
+// element offset (not yet accessed, so that the caller can choose when to hold
+// the array as a critical region).
+template <typename ElementT> struct buffer_location {
+    ElementT *direct = nullptr;
+    local_ref<jarray> array;
+    std::size_t offset = 0;
+};
+
+// Find buffer data - handles both direct and array-backed buffers.
 // Validates buffer remaining size against required size.
 // Returns std::nullopt on failure (exception will have been thrown).
 // Template parameters:
 //   ElementT: The element type for pointer arithmetic
-//   IsWritable: If true, checks for read-only and uses release mode 0
+//   IsWritable: If true, checks for read-only
 template <typename ElementT, bool IsWritable = false>
-auto get_buffer_access(JNIEnv *env, jobject buffer,
-                       std::size_t required_elements, char const *buffer_name)
-    -> std::optional<buffer_access> {
-    constexpr jint release_mode = IsWritable ? 0 : JNI_ABORT;
-
+auto locate_buffer(JNIEnv *env, jobject buffer, std::size_t required_elements,
+                   char const *buffer_name)
+    -> std::optional<buffer_location<ElementT>> {
     if constexpr (IsWritable) {
         auto read_only = is_read_only(env, buffer);
         if (!read_only) {
@@ -483,6 +572,11 @@ auto get_buffer_access(JNIEnv *env, jobject buffer,
         return {};
     }
 
+    auto position = get_buffer_position(env, buffer);
+    if (!position) {
+        return {};
+    }
+
     auto is_direct = is_direct_buffer(env, buffer);
     if (!is_direct) {
         return {};
@@ -493,12 +587,9 @@ auto get_buffer_access(JNIEnv *env, jobject buffer,
             return {};
         }
         if (direct != nullptr) {
-            auto position = get_buffer_position(env, buffer);
-            if (!position) {
-                return {};
-            }
-            void *data_ptr = static_cast<ElementT *>(direct) + *position;
-            return buffer_access(data_ptr);
+            buffer_location<ElementT> loc;
+            loc.direct = static_cast<ElementT *>(direct) + *position;
+            return loc;
         }
     }
 
@@ -512,20 +603,15 @@ auto get_buffer_access(JNIEnv *env, jobject buffer,
             return {};
         }
         if (*arr) {
-            auto access = std::make_unique<array_access<ElementT>>(
-                env, std::move(*arr), release_mode);
-            if (*access) {
-                auto array_offset = get_array_offset(env, buffer);
-                if (!array_offset) {
-                    return {};
-                }
-                auto position = get_buffer_position(env, buffer);
-                if (!position) {
-                    return {};
-                }
-                void *data_ptr = access->get() + *array_offset + *position;
-                return buffer_access(std::move(access), data_ptr);
+            auto array_offset = get_array_offset(env, buffer);
+            if (!array_offset) {
+                return {};
             }
+            buffer_location<ElementT> loc;
+            loc.array = std::move(*arr);
+            loc.offset = static_cast<std::size_t>(*array_offset) +
+                         static_cast<std::size_t>(*position);
+            return loc;
         }
     }
 
@@ -535,6 +621,69 @@ auto get_buffer_access(JNIEnv *env, jobject buffer,
     return {};
 }
 
+// Get buffer data, accessing array-backed buffers for the lifetime of the
+// returned object. Returns std::nullopt on failure (exception will have been
+// thrown). Template parameters are as for locate_buffer; if IsWritable, the
+// array is released with mode 0 (copy back).
+template <typename ElementT, bool IsWritable = false>
+auto get_buffer_access(JNIEnv *env, jobject buffer,
+                       std::size_t required_elements, char const *buffer_name)
+    -> std::optional<buffer_access> {
+    constexpr jint release_mode = IsWritable ? 0 : JNI_ABORT;
+
+    auto loc = locate_buffer<ElementT, IsWritable>(env, buffer,
+                                                   required_elements,
+                                                   buffer_name);
+    if (!loc) {
+        return {};
+    }
+    if (loc->direct != nullptr) {
+        return buffer_access(loc->direct);
+    }
+    auto access = std::make_unique<array_access<ElementT>>(
+        env, std::move(loc->array), release_mode);
+    if (!*access) {
+        if (!env->ExceptionCheck()) {
+            throw_illegal_argument(
+                env, (std::string(buffer_name) + " buffer array not accessible")
+                         .c_str());
+        }
+        return {};
+    }
+    void *data_ptr = access->get() + loc->offset;
+    return buffer_access(std::move(access), data_ptr);
+}
+
+// Access located buffer data for the lifetime of the returned object. Unlike
+// get_buffer_access(), the array (if any) remains owned by 'loc', so that it
+// can be accessed more than once.
+template <typename ElementT>
+auto access_buffer(JNIEnv *env, buffer_location<ElementT> const &loc,
+                   jint release_mode, char const *buffer_name)
+    -> std::optional<buffer_access> {
+    if (loc.direct != nullptr) {
+        return buffer_access(loc.direct);
+    }
+    auto access = std::make_unique<array_access<ElementT>>(
+        env, loc.array.get(), release_mode);
+    if (!*access) {
+        if (!env->ExceptionCheck()) {
+            throw_illegal_argument(
+                env, (std::string(buffer_name) + " buffer array not accessible")
+                         .c_str());
+        }
+        return {};
+    }
+    void *data_ptr = access->get() + loc.offset;
+    return buffer_access(std::move(access), data_ptr);
+}
+
+// Images in Java arrays larger than this are histogrammed in bands of rows,
+// so that garbage collection is blocked (by critical array access) for the
+// duration of one band (a few milliseconds) rather than the whole image.
+// Bands are large enough to be parallelized efficiently by the library.
+constexpr std::size_t critical_band_pixels = std::size_t(1) << 22;
+
 // Buffer-based histogram implementation template.
 // Handles both direct and array-backed buffers.
 //
@@ -543,9 +692,10 @@ auto get_buffer_access(JNIEnv *env, jobject buffer,
 // This is safe because:
 // 1. The histogram computation is CPU-bound and does not call back into Java
 // 2. No JNI calls are made while holding critical arrays
-// 3. The computation typically completes quickly
-// Per JNI specification, critical regions should be short and non-blocking,
-// which this satisfies for typical image sizes.
+// 3. The computation completes quickly: images larger than
+//    critical_band_pixels are processed in bands, each in its own critical
+//    region
+// Per JNI specification, critical regions should be short and non-blocking.
 template <typename PixelT>
 void histogram_impl(JNIEnv *env, jint sample_bits, jobject image_buffer,
                     jobject mask_buffer, jint height, jint width,
@@ -597,37 +747,684 @@ void histogram_impl(JNIEnv *env, jint sample_bits, jobject image_buffer,
     std::size_t hist_required =
         n_hist_components * (static_cast<std::size_t>(1) << sample_bits);
 
-    std::optional<buffer_access> image_data =
-        get_buffer_access<typename traits::jni_element_type>(
-            env, image_buffer, image_required, "image");
-    if (!image_data) {
+    auto image_loc = locate_buffer<typename traits::jni_element_type>(
+        env, image_buffer, image_required, "image");
+    if (!image_loc) {
         return;
     }
 
-    std::optional<buffer_access> mask_data;
+    std::optional<buffer_location<jbyte>> mask_loc;
     if (mask_buffer != nullptr) {
-        mask_data =
-            get_buffer_access<jbyte>(env, mask_buffer, mask_required, "mask");
-        if (!mask_data) {
+        mask_loc =
+            locate_buffer<jbyte>(env, mask_buffer, mask_required, "mask");
+        if (!mask_loc) {
             return;
         }
     }
 
-    std::optional<buffer_access> histogram_data =
-        get_buffer_access<jint, true>(env, histogram_buffer, hist_required,
-                                      "histogram");
-    if (!histogram_data) {
+    auto hist_loc = locate_buffer<jint, true>(env, histogram_buffer,
+                                              hist_required, "histogram");
+    if (!hist_loc) {
+        return;
+    }
+
+    bool const uses_arrays = image_loc->direct == nullptr ||
+                             (mask_loc && mask_loc->direct == nullptr) ||
+                             hist_loc->direct == nullptr;
+    std::size_t const band_rows =
+        w > 0 ? std::max<std::size_t>(1, critical_band_pixels / w) : h;
+
+    if (!uses_arrays || h <= band_rows) {
+        auto image_data = access_buffer(env, *image_loc, JNI_ABORT, "image");
+        if (!image_data) {
+            return;
+        }
+        std::optional<buffer_access> mask_data;
+        if (mask_loc) {
+            mask_data = access_buffer(env, *mask_loc, JNI_ABORT, "mask");
+            if (!mask_data) {
+                return;
+            }
+        }
+        auto histogram_data = access_buffer(env, *hist_loc, 0, "histogram");
+        if (!histogram_data) {
+            return;
+        }
+        traits::call_ihist(
+            static_cast<std::size_t>(sample_bits),
+            static_cast<typename traits::pixel_type const *>(
+                image_data->ptr()),
+            mask_data ? static_cast<std::uint8_t const *>(mask_data->ptr())
+                      : nullptr,
+            h, w, img_stride, msk_stride, n_comp, n_hist_components,
+            indices->data(),
+            static_cast<std::uint32_t *>(histogram_data->ptr()),
+            parallel != JNI_FALSE);
         return;
     }
 
-    traits::call_ihist(
-        static_cast<std::size_t>(sample_bits),
-        static_cast<typename traits::pixel_type const *>(image_data->ptr()),
-        mask_data ? static_cast<std::uint8_t const *>(mask_data->ptr())
-                  : nullptr,
-        h, w, img_stride, msk_stride, n_comp, n_hist_components,
-        indices->data(), static_cast<std::uint32_t *>(histogram_data->ptr()),
-        parallel != JNI_FALSE);
+    // Banded: a histogram in a Java array is accumulated in a native copy,
+    // and the image and mask arrays are accessed one band at a time.
+    std::vector<std::uint32_t> hist_copy;
+    auto *hist = reinterpret_cast<std::uint32_t *>(hist_loc->direct);
+    if (hist == nullptr) {
+        hist_copy.resize(hist_required);
+        jni_array_region_traits<jint>::get_region(
+            env, hist_loc->array.get(), static_cast<jsize>(hist_loc->offset),
+            static_cast<jsize>(hist_required),
+            reinterpret_cast<jint *>(hist_copy.data()));
+        if (env->ExceptionCheck()) {
+            return;
+        }
+        hist = hist_copy.data();
+    }
+
+    for (std::size_t row = 0; row < h; row += band_rows) {
+        std::size_t const rows = std::min(band_rows, h - row);
+        auto image_data = access_buffer(env, *image_loc, JNI_ABORT, "image");
+        if (!image_data) {
+            return;
+        }
+        std::optional<buffer_access> mask_data;
+        if (mask_loc) {
+            mask_data = access_buffer(env, *mask_loc, JNI_ABORT, "mask");
+            if (!mask_data) {
+                return;
+            }
+        }
+        traits::call_ihist(
+            static_cast<std::size_t>(sample_bits),
+            static_cast<typename traits::pixel_type const *>(
+                image_data->ptr()) +
+                row * img_stride * n_comp,
+            mask_data ? static_cast<std::uint8_t const *>(mask_data->ptr()) +
+                            row * msk_stride
+                      : nullptr,
+            rows, w, img_stride, msk_stride, n_comp, n_hist_components,
+            indices->data(), hist, parallel != JNI_FALSE);
+    }
+
+    if (!hist_copy.empty()) {
+        jni_array_region_traits<jint>::set_region(
+            env, hist_loc->array.get(), static_cast<jsize>(hist_loc->offset),
+            static_cast<jsize>(hist_required),
+            reinterpret_cast<jint const *>(hist_copy.data()));
+    }
+}
+
+// One image of a batch: its located buffer and the element offset of its
+// first pixel (nonzero for regions of a larger image), and its mask (if any).
+template <typename ElementT> struct batch_image {
+    buffer_location<ElementT> const *image = nullptr;
+    std::size_t image_offset = 0;
+    buffer_location<jbyte> const *mask = nullptr;
+};
+
+// Compute the histograms of a batch of located images, the i-th into the i-th
+// of consecutive histograms in 'hist_loc'. If any buffer is a Java array, the
+// images are processed in groups of up to critical_band_pixels pixels, each
+// group in its own critical region (as in histogram_impl(); a single image
+// larger than that is processed whole). Consecutive images in the same buffer
+// share one access.
+template <typename PixelT>
+void batch_run(
+    JNIEnv *env, std::size_t sample_bits,
+    std::vector<batch_image<
+        typename jni_pixel_traits<PixelT>::jni_element_type>> const &images,
+    std::size_t h, std::size_t w, std::size_t img_stride,
+    std::size_t msk_stride, std::size_t n_comp,
+    std::vector<std::size_t> const &indices,
+    buffer_location<jint> const &hist_loc, bool parallel) {
+    using traits = jni_pixel_traits<PixelT>;
+    using pixel_type = typename traits::pixel_type;
+
+    std::size_t const n_images = images.size();
+    std::size_t const hist_size = indices.size() << sample_bits;
+
+    bool uses_arrays = hist_loc.direct == nullptr;
+    for (auto const &item : images) {
+        uses_arrays = uses_arrays || item.image->direct == nullptr ||
+                      (item.mask != nullptr && item.mask->direct == nullptr);
+    }
+    std::size_t const group_size =
+        uses_arrays && h * w > 0
+            ? std::max<std::size_t>(1, critical_band_pixels / (h * w))
+            : n_images;
+
+    std::vector<typename traits::tile_type> tiles;
+    std::vector<std::uint32_t *> histograms;
+    for (std::size_t begin = 0; begin < n_images; begin += group_size) {
+        std::size_t const end = std::min(n_images, begin + group_size);
+        tiles.clear();
+        histograms.clear();
+
+        std::vector<buffer_access> accesses;
+        auto histogram_data = access_buffer(env, hist_loc, 0, "histogram");
+        if (!histogram_data) {
+            return;
+        }
+        auto *hist = static_cast<std::uint32_t *>(histogram_data->ptr());
+
+        void const *prev_image = nullptr;
+        void const *prev_mask = nullptr;
+        pixel_type const *image_base = nullptr;
+        std::uint8_t const *mask_base = nullptr;
+        for (std::size_t i = begin; i < end; ++i) {
+            auto const &item = images[i];
+            if (item.image != prev_image) {
+                auto data =
+                    access_buffer(env, *item.image, JNI_ABORT, "image");
+                if (!data) {
+                    return;
+                }
+                image_base = static_cast<pixel_type const *>(data->ptr());
+                accesses.push_back(std::move(*data));
+                prev_image = item.image;
+            }
+            if (item.mask != nullptr && item.mask != prev_mask) {
+                auto data = access_buffer(env, *item.mask, JNI_ABORT, "mask");
+                if (!data) {
+                    return;
+                }
+                mask_base = static_cast<std::uint8_t const *>(data->ptr());
+                accesses.push_back(std::move(*data));
+                prev_mask = item.mask;
+            }
+            tiles.push_back({image_base + item.image_offset,
+                             item.mask != nullptr ? mask_base : nullptr, h, w,
+                             img_stride, msk_stride});
+            histograms.push_back(hist + i * hist_size);
+        }
+
+        traits::call_ihist_batch(sample_bits, tiles.size(), tiles.data(),
+                                 n_comp, indices.size(), indices.data(),
+                                 histograms.data(), parallel);
+    }
+}
+
+// Histograms of a batch of same-size images (with optional, per-image masks).
+// All buffers are located (and validated) before any is accessed.
+template <typename PixelT>
+void batch_impl(JNIEnv *env, jint sample_bits, jobjectArray image_buffers,
+                jobjectArray mask_buffers, jint height, jint width,
+                jint image_stride, jint mask_stride, jint n_components,
+                jintArray component_indices, jobject histogram_buffer,
+                jboolean parallel) {
+    using element_type = typename jni_pixel_traits<PixelT>::jni_element_type;
+
+    if (!validate_params<PixelT>(env, sample_bits, height, width, image_stride,
+                                 mask_stride, mask_buffers != nullptr,
+                                 n_components, component_indices)) {
+        return;
+    }
+
+    auto indices = to_size_t_vector(env, component_indices);
+    if (!indices) {
+        return;
+    }
+    std::size_t const n_hist_components = indices->size();
+
+    if (!validate_component_indices(env, *indices,
+                                    static_cast<std::size_t>(n_components))) {
+        return;
+    }
+
+    if (image_buffers == nullptr) {
+        throw_null_pointer(env, "images cannot be null");
+        return;
+    }
+    if (histogram_buffer == nullptr) {
+        throw_null_pointer(env, "histogram buffer cannot be null");
+        return;
+    }
+
+    jsize const n_images = env->GetArrayLength(image_buffers);
+    if (mask_buffers != nullptr &&
+        env->GetArrayLength(mask_buffers) != n_images) {
+        throw_illegal_argument(env,
+                               "masks must have the same length as images");
+        return;
+    }
+
+    if (n_hist_components == 0) {
+        return;
+    }
+
+    std::size_t const h = static_cast<std::size_t>(height);
+    std::size_t const w = static_cast<std::size_t>(width);
+    std::size_t const img_stride = static_cast<std::size_t>(image_stride);
+    std::size_t const msk_stride = static_cast<std::size_t>(mask_stride);
+    std::size_t const n_comp = static_cast<std::size_t>(n_components);
+
+    std::size_t image_required =
+        (h > 0 && w > 0) ? ((h - 1) * img_stride + w) * n_comp : 0;
+    std::size_t mask_required =
+        (h > 0 && w > 0) ? (h - 1) * msk_stride + w : 0;
+    std::size_t hist_required = static_cast<std::size_t>(n_images) *
+                                n_hist_components *
+                                (static_cast<std::size_t>(1) << sample_bits);
+
+    auto hist_loc = locate_buffer<jint, true>(env, histogram_buffer,
+                                              hist_required, "histogram");
+    if (!hist_loc) {
+        return;
+    }
+
+    // Located array-backed buffers hold a local reference each.
+    if (env->EnsureLocalCapacity(2 * n_images + 16) != 0) {
+        return;
+    }
+
+    // Locations are not moved after being taken the address of.
+    std::vector<buffer_location<element_type>> image_locs(
+        static_cast<std::size_t>(n_images));
+    std::vector<buffer_location<jbyte>> mask_locs(
+        mask_buffers != nullptr ? static_cast<std::size_t>(n_images) : 0);
+    std::vector<batch_image<element_type>> images(
+        static_cast<std::size_t>(n_images));
+    for (jsize i = 0; i < n_images; ++i) {
+        auto const idx = static_cast<std::size_t>(i);
+        local_ref<jobject> image(env,
+                                 env->GetObjectArrayElement(image_buffers, i));
+        if (env->ExceptionCheck()) {
+            return;
+        }
+        if (!image) {
+            throw_null_pointer(env, "image buffer cannot be null");
+            return;
+        }
+        auto image_loc = locate_buffer<element_type>(env, image.get(),
+                                                     image_required, "image");
+        if (!image_loc) {
+            return;
+        }
+        image_locs[idx] = std::move(*image_loc);
+        images[idx].image = &image_locs[idx];
+
+        if (mask_buffers != nullptr) {
+            local_ref<jobject> mask(
+                env, env->GetObjectArrayElement(mask_buffers, i));
+            if (env->ExceptionCheck()) {
+                return;
+            }
+            if (mask) {
+                auto mask_loc = locate_buffer<jbyte>(env, mask.get(),
+                                                     mask_required, "mask");
+                if (!mask_loc) {
+                    return;
+                }
+                mask_locs[idx] = std::move(*mask_loc);
+                images[idx].mask = &mask_locs[idx];
+            }
+        }
+    }
+
+    batch_run<PixelT>(env, static_cast<std::size_t>(sample_bits), images, h,
+                      w, img_stride, msk_stride, n_comp, *indices, *hist_loc,
+                      parallel != JNI_FALSE);
+}
+
+// Histograms of same-size regions of one image, with an optional mask shared
+// by all regions.
+template <typename PixelT>
+void rois_impl(JNIEnv *env, jint sample_bits, jobject image_buffer,
+               jobject mask_buffer, jint image_height, jint image_width,
+               jint image_stride, jint mask_stride, jintArray roi_x,
+               jintArray roi_y, jint roi_height, jint roi_width,
+               jint n_components, jintArray component_indices,
+               jobject histogram_buffer, jboolean parallel) {
+    using element_type = typename jni_pixel_traits<PixelT>::jni_element_type;
+
+    // Validates the region size against the image stride and mask stride.
+    if (!validate_params<PixelT>(env, sample_bits, roi_height, roi_width,
+                                 image_stride, mask_stride,
+                                 mask_buffer != nullptr, n_components,
+                                 component_indices)) {
+        return;
+    }
+    if (image_height < 0 || image_width < 0) {
+        throw_illegal_argument(env, "height and width must be >= 0");
+        return;
+    }
+    if (image_stride < image_width) {
+        throw_illegal_argument(env, "imageStride must be >= width");
+        return;
+    }
+
+    auto indices = to_size_t_vector(env, component_indices);
+    if (!indices) {
+        return;
+    }
+    std::size_t const n_hist_components = indices->size();
+
+    if (!validate_component_indices(env, *indices,
+                                    static_cast<std::size_t>(n_components))) {
+        return;
+    }
+
+    if (image_buffer == nullptr) {
+        throw_null_pointer(env, "image buffer cannot be null");
+        return;
+    }
+    if (roi_x == nullptr || roi_y == nullptr) {
+        throw_null_pointer(env, "roiX and roiY cannot be null");
+        return;
+    }
+    if (histogram_buffer == nullptr) {
+        throw_null_pointer(env, "histogram buffer cannot be null");
+        return;
+    }
+
+    jsize const n_rois = env->GetArrayLength(roi_x);
+    if (env->GetArrayLength(roi_y) != n_rois) {
+        throw_illegal_argument(env, "roiX and roiY must have the same length");
+        return;
+    }
+    std::vector<jint> xs(static_cast<std::size_t>(n_rois));
+    std::vector<jint> ys(static_cast<std::size_t>(n_rois));
+    env->GetIntArrayRegion(roi_x, 0, n_rois, xs.data());
+    env->GetIntArrayRegion(roi_y, 0, n_rois, ys.data());
+    if (env->ExceptionCheck()) {
+        return;
+    }
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+        if (xs[i] < 0 || ys[i] < 0 ||
+            static_cast<std::int64_t>(xs[i]) + roi_width > image_width ||
+            static_cast<std::int64_t>(ys[i]) + roi_height > image_height) {
+            throw_illegal_argument(env, "ROI exceeds image bounds");
+            return;
+        }
+    }
+
+    if (n_hist_components == 0) {
+        return;
+    }
+
+    std::size_t const h = static_cast<std::size_t>(roi_height);
+    std::size_t const w = static_cast<std::size_t>(roi_width);
+    std::size_t const img_h = static_cast<std::size_t>(image_height);
+    std::size_t const img_w = static_cast<std::size_t>(image_width);
+    std::size_t const img_stride = static_cast<std::size_t>(image_stride);
+    std::size_t const msk_stride = static_cast<std::size_t>(mask_stride);
+    std::size_t const n_comp = static_cast<std::size_t>(n_components);
+
+    std::size_t image_required =
+        (img_h > 0 && img_w > 0) ? ((img_h - 1) * img_stride + img_w) * n_comp
+                                 : 0;
+    std::size_t mask_required =
+        (h > 0 && w > 0) ? (h - 1) * msk_stride + w : 0;
+    std::size_t hist_required = static_cast<std::size_t>(n_rois) *
+                                n_hist_components *
+                                (static_cast<std::size_t>(1) << sample_bits);
+
+    auto image_loc = locate_buffer<element_type>(env, image_buffer,
+                                                 image_required, "image");
+    if (!image_loc) {
+        return;
+    }
+
+    std::optional<buffer_location<jbyte>> mask_loc;
+    if (mask_buffer != nullptr) {
+        mask_loc =
+            locate_buffer<jbyte>(env, mask_buffer, mask_required, "mask");
+        if (!mask_loc) {
+            return;
+        }
+    }
+
+    auto hist_loc = locate_buffer<jint, true>(env, histogram_buffer,
+                                              hist_required, "histogram");
+    if (!hist_loc) {
+        return;
+    }
+
+    if (h == 0 || w == 0) {
+        return; // Regions are empty (and their offsets may be out of range).
+    }
+
+    std::vector<batch_image<element_type>> images(
+        static_cast<std::size_t>(n_rois));
+    for (std::size_t i = 0; i < images.size(); ++i) {
+        images[i].image = &*image_loc;
+        images[i].image_offset =
+            (static_cast<std::size_t>(ys[i]) * img_stride +
+             static_cast<std::size_t>(xs[i])) *
+            n_comp;
+        images[i].mask = mask_loc ? &*mask_loc : nullptr;
+    }
+
+    batch_run<PixelT>(env, static_cast<std::size_t>(sample_bits), images, h,
+                      w, img_stride, msk_stride, n_comp, *indices, *hist_loc,
+                      parallel != JNI_FALSE);
+}
+
+// Sparse histogram. The nonzero bins are computed into native buffers while
+// the image (and mask) are accessed, and copied to the Java arrays only after
+// that access is released.
+template <typename PixelT>
+auto sparse_impl(JNIEnv *env, jint sample_bits, jobject image_buffer,
+                 jobject mask_buffer, jint height, jint width,
+                 jint image_stride, jint mask_stride, jint n_components,
+                 jintArray component_indices, jshortArray bins_array,
+                 jintArray counts_array, jintArray n_nonzero_array,
+                 jboolean parallel) -> jint {
+    using traits = jni_pixel_traits<PixelT>;
+
+    if (!validate_params<PixelT>(env, sample_bits, height, width, image_stride,
+                                 mask_stride, mask_buffer != nullptr,
+                                 n_components, component_indices)) {
+        return 0;
+    }
+
+    auto indices = to_size_t_vector(env, component_indices);
+    if (!indices) {
+        return 0;
+    }
+    std::size_t const n_hist_components = indices->size();
+
+    if (!validate_component_indices(env, *indices,
+                                    static_cast<std::size_t>(n_components))) {
+        return 0;
+    }
+
+    if (image_buffer == nullptr) {
+        throw_null_pointer(env, "image buffer cannot be null");
+        return 0;
+    }
+    if (bins_array == nullptr || counts_array == nullptr ||
+        n_nonzero_array == nullptr) {
+        throw_null_pointer(env, "bins, counts, and nonzeroCounts cannot be "
+                                "null");
+        return 0;
+    }
+
+    std::size_t const h = static_cast<std::size_t>(height);
+    std::size_t const w = static_cast<std::size_t>(width);
+    std::size_t const img_stride = static_cast<std::size_t>(image_stride);
+    std::size_t const msk_stride = static_cast<std::size_t>(mask_stride);
+    std::size_t const n_comp = static_cast<std::size_t>(n_components);
+
+    std::size_t const capacity = ihist_sparse_capacity(
+        static_cast<std::size_t>(sample_bits), n_hist_components, h * w);
+    if (static_cast<std::size_t>(env->GetArrayLength(bins_array)) <
+            capacity ||
+        static_cast<std::size_t>(env->GetArrayLength(counts_array)) <
+            capacity) {
+        throw_illegal_argument(
+            env, ("bins and counts must have length at least " +
+                  std::to_string(capacity))
+                     .c_str());
+        return 0;
+    }
+    if (static_cast<std::size_t>(env->GetArrayLength(n_nonzero_array)) !=
+        n_hist_components) {
+        throw_illegal_argument(
+            env, "nonzeroCounts must have length componentIndices.length");
+        return 0;
+    }
+    if (n_hist_components == 0) {
+        return 0;
+    }
+
+    std::size_t image_required =
+        (h > 0 && w > 0) ? ((h - 1) * img_stride + w) * n_comp : 0;
+    std::size_t mask_required =
+        (h > 0 && w > 0) ? (h - 1) * msk_stride + w : 0;
+
+    std::vector<std::uint16_t> bins(capacity);
+    std::vector<std::uint32_t> counts(capacity);
+    std::vector<std::size_t> n_nonzero(n_hist_components);
+    std::size_t total = 0;
+    {
+        std::optional<buffer_access> image_data =
+            get_buffer_access<typename traits::jni_element_type>(
+                env, image_buffer, image_required, "image");
+        if (!image_data) {
+            return 0;
+        }
+
+        std::optional<buffer_access> mask_data;
+        if (mask_buffer != nullptr) {
+            mask_data = get_buffer_access<jbyte>(env, mask_buffer,
+                                                 mask_required, "mask");
+            if (!mask_data) {
+                return 0;
+            }
+        }
+
+        total = traits::call_ihist_sparse(
+            static_cast<std::size_t>(sample_bits),
+            static_cast<typename traits::pixel_type const *>(
+                image_data->ptr()),
+            mask_data ? static_cast<std::uint8_t const *>(mask_data->ptr())
+                      : nullptr,
+            h, w, img_stride, msk_stride, n_comp, n_hist_components,
+            indices->data(), bins.data(), counts.data(), n_nonzero.data(),
+            parallel != JNI_FALSE);
+    }
+
+    std::vector<jint> n_nonzero_j(n_nonzero.begin(), n_nonzero.end());
+    env->SetShortArrayRegion(bins_array, 0, static_cast<jsize>(total),
+                             reinterpret_cast<jshort const *>(bins.data()));
+    env->SetIntArrayRegion(counts_array, 0, static_cast<jsize>(total),
+                           reinterpret_cast<jint const *>(counts.data()));
+    env->SetIntArrayRegion(n_nonzero_array, 0,
+                           static_cast<jsize>(n_hist_components),
+                           n_nonzero_j.data());
+    return static_cast<jint>(total);
+}
+
+// Shared implementation of the histogram analyses. The histogram buffer is
+// accessed (possibly as a critical array) only while 'analyze' runs; the
+// results are then copied to the Java output array, whose element type
+// JElementT must have the same size as ResultT.
+template <typename ResultT, typename JElementT, typename Analyze>
+void analysis_impl(JNIEnv *env, jint sample_bits, jint n_hist_components,
+                   jobject histogram_buffer, jarray output,
+                   std::size_t results_per_component, char const *output_name,
+                   Analyze analyze) {
+    static_assert(sizeof(ResultT) == sizeof(JElementT));
+
+    if (sample_bits < 0 || sample_bits > 16) {
+        throw_illegal_argument(env, "sampleBits must be in range [0, 16]");
+        return;
+    }
+    if (n_hist_components < 0) {
+        throw_illegal_argument(env, "nHistComponents must be >= 0");
+        return;
+    }
+    if (histogram_buffer == nullptr) {
+        throw_null_pointer(env, "histogram buffer cannot be null");
+        return;
+    }
+    if (output == nullptr) {
+        throw_null_pointer(
+            env, (std::string(output_name) + " cannot be null").c_str());
+        return;
+    }
+
+    std::size_t const n_hist = static_cast<std::size_t>(n_hist_components);
+    std::size_t const n_results = n_hist * results_per_component;
+    jsize const output_len = env->GetArrayLength(output);
+    if (static_cast<std::size_t>(output_len) != n_results) {
+        throw_illegal_argument(
+            env, (std::string(output_name) + " has incorrect length " +
+                  std::to_string(output_len) + " (expected " +
+                  std::to_string(n_results) + ")")
+                     .c_str());
+        return;
+    }
+
+    std::vector<ResultT> results(n_results);
+    {
+        std::optional<buffer_access> histogram_data = get_buffer_access<jint>(
+            env, histogram_buffer,
+            n_hist << static_cast<std::size_t>(sample_bits), "histogram");
+        if (!histogram_data) {
+            return;
+        }
+        analyze(static_cast<std::size_t>(sample_bits), n_hist,
+                static_cast<std::uint32_t const *>(histogram_data->ptr()),
+                results.data());
+    }
+
+    jni_array_region_traits<JElementT>::set_region(
+        env, output, 0, output_len,
+        reinterpret_cast<JElementT const *>(results.data()));
+}
+
+// Read and validate the quantiles array. Returns nullopt if an exception was
+// thrown.
+[[nodiscard]] auto to_quantile_vector(JNIEnv *env, jdoubleArray arr)
+    -> std::optional<std::vector<double>> {
+    if (arr == nullptr) {
+        throw_null_pointer(env, "quantiles cannot be null");
+        return {};
+    }
+    jsize const len = env->GetArrayLength(arr);
+    std::vector<double> result(static_cast<std::size_t>(len));
+    env->GetDoubleArrayRegion(arr, 0, len, result.data());
+    if (env->ExceptionCheck()) {
+        return {};
+    }
+    for (double const q : result) {
+        if (!(q >= 0.0 && q <= 1.0)) {
+            throw_illegal_argument(env, "quantiles must be in range [0, 1]");
+            return {};
+        }
+    }
+    return result;
+}
+
+// Histogram for the java.lang.foreign backend (FfmBackend.java), which
+// validates the arguments in Java and passes the buffers' addresses. Only the
+// component indices need converting; a handful fit on the stack.
+template <typename PixelT>
+void ffm_histogram_impl(std::int32_t sample_bits, PixelT const *image,
+                        std::uint8_t const *mask, std::int32_t height,
+                        std::int32_t width, std::int32_t image_stride,
+                        std::int32_t mask_stride, std::int32_t n_components,
+                        std::int32_t n_hist_components,
+                        std::int32_t const *component_indices,
+                        std::uint32_t *histogram, bool parallel) {
+    std::size_t const n_hist = static_cast<std::size_t>(n_hist_components);
+    std::array<std::size_t, 16> stack_indices;
+    std::vector<std::size_t> heap_indices;
+    std::size_t *indices = stack_indices.data();
+    if (n_hist > stack_indices.size()) {
+        heap_indices.resize(n_hist);
+        indices = heap_indices.data();
+    }
+    for (std::size_t i = 0; i < n_hist; ++i) {
+        indices[i] = static_cast<std::size_t>(component_indices[i]);
+    }
+    jni_pixel_traits<PixelT>::call_ihist(
+        static_cast<std::size_t>(sample_bits), image, mask,
+        static_cast<std::size_t>(height), static_cast<std::size_t>(width),
+        static_cast<std::size_t>(image_stride),
+        static_cast<std::size_t>(mask_stride),
+        static_cast<std::size_t>(n_components), n_hist, indices, histogram,
+        parallel);
 }
 
 } // namespace
@@ -658,6 +1455,247 @@ Java_io_github_marktsuchida_ihist_IHistNative_histogram16__ILjava_nio_ShortBuffe
                                   histogram_buffer, parallel);
 }
 
+JNIEXPORT void JNICALL
+Java_io_github_marktsuchida_ihist_IHistNative_histogram8Batch__I_3Ljava_nio_ByteBuffer_2_3Ljava_nio_ByteBuffer_2IIIII_3ILjava_nio_IntBuffer_2Z(
+    JNIEnv *env, jclass, jint sample_bits, jobjectArray image_buffers,
+    jobjectArray mask_buffers, jint height, jint width, jint image_stride,
+    jint mask_stride, jint n_components, jintArray component_indices,
+    jobject histogram_buffer, jboolean parallel) {
+    batch_impl<std::uint8_t>(env, sample_bits, image_buffers, mask_buffers,
+                             height, width, image_stride, mask_stride,
+                             n_components, component_indices,
+                             histogram_buffer, parallel);
+}
+
+JNIEXPORT void JNICALL
+Java_io_github_marktsuchida_ihist_IHistNative_histogram16Batch__I_3Ljava_nio_ShortBuffer_2_3Ljava_nio_ByteBuffer_2IIIII_3ILjava_nio_IntBuffer_2Z(
+    JNIEnv *env, jclass, jint sample_bits, jobjectArray image_buffers,
+    jobjectArray mask_buffers, jint height, jint width, jint image_stride,
+    jint mask_stride, jint n_components, jintArray component_indices,
+    jobject histogram_buffer, jboolean parallel) {
+    batch_impl<std::uint16_t>(env, sample_bits, image_buffers, mask_buffers,
+                              height, width, image_stride, mask_stride,
+                              n_components, component_indices,
+                              histogram_buffer, parallel);
+}
+
+JNIEXPORT void JNICALL
+Java_io_github_marktsuchida_ihist_IHistNative_histogram8Rois__ILjava_nio_ByteBuffer_2Ljava_nio_ByteBuffer_2IIII_3I_3IIII_3ILjava_nio_IntBuffer_2Z(
+    JNIEnv *env, jclass, jint sample_bits, jobject image_buffer,
+    jobject mask_buffer, jint image_height, jint image_width,
+    jint image_stride, jint mask_stride, jintArray roi_x, jintArray roi_y,
+    jint roi_height, jint roi_width, jint n_components,
+    jintArray component_indices, jobject histogram_buffer,
+    jboolean parallel) {
+    rois_impl<std::uint8_t>(env, sample_bits, image_buffer, mask_buffer,
+                            image_height, image_width, image_stride,
+                            mask_stride, roi_x, roi_y, roi_height, roi_width,
+                            n_components, component_indices, histogram_buffer,
+                            parallel);
+}
+
+JNIEXPORT void JNICALL
+Java_io_github_marktsuchida_ihist_IHistNative_histogram16Rois__ILjava_nio_ShortBuffer_2Ljava_nio_ByteBuffer_2IIII_3I_3IIII_3ILjava_nio_IntBuffer_2Z(
+    JNIEnv *env, jclass, jint sample_bits, jobject image_buffer,
+    jobject mask_buffer, jint image_height, jint image_width,
+    jint image_stride, jint mask_stride, jintArray roi_x, jintArray roi_y,
+    jint roi_height, jint roi_width, jint n_components,
+    jintArray component_indices, jobject histogram_buffer,
+    jboolean parallel) {
+    rois_impl<std::uint16_t>(env, sample_bits, image_buffer, mask_buffer,
+                             image_height, image_width, image_stride,
+                             mask_stride, roi_x, roi_y, roi_height, roi_width,
+                             n_components, component_indices,
+                             histogram_buffer, parallel);
+}
+
+JNIEXPORT jint JNICALL
+Java_io_github_marktsuchida_ihist_IHistNative_histogram8Sparse__ILjava_nio_ByteBuffer_2Ljava_nio_ByteBuffer_2IIIII_3I_3S_3I_3IZ(
+    JNIEnv *env, jclass, jint sample_bits, jobject image_buffer,
+    jobject mask_buffer, jint height, jint width, jint image_stride,
+    jint mask_stride, jint n_components, jintArray component_indices,
+    jshortArray bins, jintArray counts, jintArray nonzero_counts,
+    jboolean parallel) {
+    return sparse_impl<std::uint8_t>(
+        env, sample_bits, image_buffer, mask_buffer, height, width,
+        image_stride, mask_stride, n_components, component_indices, bins,
+        counts, nonzero_counts, parallel);
+}
+
+JNIEXPORT jint JNICALL
+Java_io_github_marktsuchida_ihist_IHistNative_histogram16Sparse__ILjava_nio_ShortBuffer_2Ljava_nio_ByteBuffer_2IIIII_3I_3S_3I_3IZ(
+    JNIEnv *env, jclass, jint sample_bits, jobject image_buffer,
+    jobject mask_buffer, jint height, jint width, jint image_stride,
+    jint mask_stride, jint n_components, jintArray component_indices,
+    jshortArray bins, jintArray counts, jintArray nonzero_counts,
+    jboolean parallel) {
+    return sparse_impl<std::uint16_t>(
+        env, sample_bits, image_buffer, mask_buffer, height, width,
+        image_stride, mask_stride, n_components, component_indices, bins,
+        counts, nonzero_counts, parallel);
+}
+
+JNIEXPORT void JNICALL
+Java_io_github_marktsuchida_ihist_IHistNative_histogramCumsum__IILjava_nio_IntBuffer_2_3J(
+    JNIEnv *env, jclass, jint sample_bits, jint n_hist_components,
+    jobject histogram_buffer, jlongArray cumsum) {
+    std::size_t const n_bins =
+        sample_bits >= 0 && sample_bits <= 16 ? std::size_t(1) << sample_bits
+                                              : 0;
+    analysis_impl<std::uint64_t, jlong>(env, sample_bits, n_hist_components,
+                                        histogram_buffer, cumsum, n_bins,
+                                        "cumsum", ihist_histogram_cumsum);
+}
+
+JNIEXPORT void JNICALL
+Java_io_github_marktsuchida_ihist_IHistNative_histogramQuantiles__IILjava_nio_IntBuffer_2_3D_3I(
+    JNIEnv *env, jclass, jint sample_bits, jint n_hist_components,
+    jobject histogram_buffer, jdoubleArray quantiles, jintArray values) {
+    auto qs = to_quantile_vector(env, quantiles);
+    if (!qs) {
+        return;
+    }
+    analysis_impl<std::uint32_t, jint>(
+        env, sample_bits, n_hist_components, histogram_buffer, values,
+        qs->size(), "values",
+        [&](std::size_t bits, std::size_t n, std::uint32_t const *hist,
+            std::uint32_t *out) {
+            ihist_histogram_quantiles(bits, n, hist, qs->size(), qs->data(),
+                                      out);
+        });
+}
+
+JNIEXPORT void JNICALL
+Java_io_github_marktsuchida_ihist_IHistNative_histogramOtsu__IILjava_nio_IntBuffer_2_3I(
+    JNIEnv *env, jclass, jint sample_bits, jint n_hist_components,
+    jobject histogram_buffer, jintArray thresholds) {
+    analysis_impl<std::uint32_t, jint>(env, sample_bits, n_hist_components,
+                                       histogram_buffer, thresholds, 1,
+                                       "thresholds", ihist_histogram_otsu);
+}
+
+JNIEXPORT void JNICALL
+Java_io_github_marktsuchida_ihist_IHistNative_histogramEntropy__IILjava_nio_IntBuffer_2_3D(
+    JNIEnv *env, jclass, jint sample_bits, jint n_hist_components,
+    jobject histogram_buffer, jdoubleArray entropy) {
+    analysis_impl<double, jdouble>(env, sample_bits, n_hist_components,
+                                   histogram_buffer, entropy, 1, "entropy",
+                                   ihist_histogram_entropy);
+}
+
+JNIEXPORT void JNICALL
+Java_io_github_marktsuchida_ihist_IHistNative_histogramMode__IILjava_nio_IntBuffer_2_3I(
+    JNIEnv *env, jclass, jint sample_bits, jint n_hist_components,
+    jobject histogram_buffer, jintArray modes) {
+    analysis_impl<std::uint32_t, jint>(env, sample_bits, n_hist_components,
+                                       histogram_buffer, modes, 1, "modes",
+                                       ihist_histogram_mode);
+}
+
+JNIEXPORT void JNICALL
+Java_io_github_marktsuchida_ihist_IHistNative_histogramDistance__IILjava_nio_IntBuffer_2ILjava_nio_IntBuffer_2I_3DZ(
+    JNIEnv *env, jclass, jint sample_bits, jint n_hist_components,
+    jobject query_buffer, jint n_references, jobject references_buffer,
+    jint metric, jdoubleArray distances, jboolean parallel) {
+    if (sample_bits < 0 || sample_bits > 16) {
+        throw_illegal_argument(env, "sampleBits must be in range [0, 16]");
+        return;
+    }
+    if (n_hist_components < 0) {
+        throw_illegal_argument(env, "nHistComponents must be >= 0");
+        return;
+    }
+    if (n_references < 0) {
+        throw_illegal_argument(env, "nReferences must be >= 0");
+        return;
+    }
+    if (metric < IHIST_DISTANCE_CHI_SQUARE ||
+        metric > IHIST_DISTANCE_KL_DIVERGENCE) {
+        throw_illegal_argument(env, ("unknown distance metric " +
+                                     std::to_string(metric))
+                                        .c_str());
+        return;
+    }
+    if (query_buffer == nullptr) {
+        throw_null_pointer(env, "query buffer cannot be null");
+        return;
+    }
+    if (references_buffer == nullptr) {
+        throw_null_pointer(env, "references buffer cannot be null");
+        return;
+    }
+    if (distances == nullptr) {
+        throw_null_pointer(env, "distances cannot be null");
+        return;
+    }
+
+    std::size_t const n_hist = static_cast<std::size_t>(n_hist_components);
+    std::size_t const n_refs = static_cast<std::size_t>(n_references);
+    std::size_t const hist_size =
+        n_hist << static_cast<std::size_t>(sample_bits);
+    jsize const output_len = env->GetArrayLength(distances);
+    if (static_cast<std::size_t>(output_len) != n_refs * n_hist) {
+        throw_illegal_argument(
+            env, ("distances has incorrect length " +
+                  std::to_string(output_len) + " (expected " +
+                  std::to_string(n_refs * n_hist) + ")")
+                     .c_str());
+        return;
+    }
+
+    std::vector<double> results(n_refs * n_hist);
+    {
+        std::optional<buffer_access> query_data =
+            get_buffer_access<jint>(env, query_buffer, hist_size, "query");
+        if (!query_data) {
+            return;
+        }
+        std::optional<buffer_access> references_data =
+            get_buffer_access<jint>(env, references_buffer,
+                                    n_refs * hist_size, "references");
+        if (!references_data) {
+            return;
+        }
+        ihist_histogram_distance_batch(
+            static_cast<std::size_t>(sample_bits), n_hist,
+            static_cast<std::uint32_t const *>(query_data->ptr()), n_refs,
+            static_cast<std::uint32_t const *>(references_data->ptr()),
+            static_cast<ihist_distance_metric>(metric), results.data(),
+            parallel != JNI_FALSE);
+    }
+
+    env->SetDoubleArrayRegion(distances, 0, output_len, results.data());
+}
+
+// Downcall entry points for FfmBackend.java (not JNI functions, but exported
+// from this library in the same way).
+
+JNIEXPORT void ihistj_ffm_hist8_2d(
+    std::int32_t sample_bits, std::uint8_t const *image,
+    std::uint8_t const *mask, std::int32_t height, std::int32_t width,
+    std::int32_t image_stride, std::int32_t mask_stride,
+    std::int32_t n_components, std::int32_t n_hist_components,
+    std::int32_t const *component_indices, std::uint32_t *histogram,
+    bool parallel) {
+    ffm_histogram_impl<std::uint8_t>(sample_bits, image, mask, height, width,
+                                     image_stride, mask_stride, n_components,
+                                     n_hist_components, component_indices,
+                                     histogram, parallel);
+}
+
+JNIEXPORT void ihistj_ffm_hist16_2d(
+    std::int32_t sample_bits, std::uint16_t const *image,
+    std::uint8_t const *mask, std::int32_t height, std::int32_t width,
+    std::int32_t image_stride, std::int32_t mask_stride,
+    std::int32_t n_components, std::int32_t n_hist_components,
+    std::int32_t const *component_indices, std::uint32_t *histogram,
+    bool parallel) {
+    ffm_histogram_impl<std::uint16_t>(sample_bits, image, mask, height, width,
+                                      image_stride, mask_stride, n_components,
+                                      n_hist_components, component_indices,
+                                      histogram, parallel);
+}
+
 JNIEXPORT jint JNI_OnLoad(JavaVM *vm, void *) {
     JNIEnv *env;
     if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) !=
@@ -0,0 +1,44 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+/**
+ * Metrics for comparing histograms.
+ *
+ * <p>
+ * Histograms p and q are normalized to unit sum before comparison, so that
+ * histograms of differently sized images or masks are comparable. All metrics
+ * are 0 for identical histograms.
+ */
+public enum DistanceMetric {
+    /** Symmetric chi-square: sum((p - q)^2 / (p + q)), in [0, 2]. */
+    CHI_SQUARE(0),
+
+    /** Bhattacharyya (Hellinger) distance: sqrt(1 - sum(sqrt(p q))). */
+    BHATTACHARYYA(1),
+
+    /** One minus the histogram intersection: 1 - sum(min(p, q)). */
+    INTERSECTION(2),
+
+    /** One-dimensional earth mover's distance, in units of bins. */
+    EMD(3),
+
+    /**
+     * Kullback-Leibler divergence of p from q, in bits; infinite if q has an
+     * empty bin where p does not.
+     */
+    KL_DIVERGENCE(4);
+
+    private final int nativeValue;
+
+    DistanceMetric(int nativeValue) { this.nativeValue = nativeValue; }
+
+    /**
+     * Return the value of the corresponding C enumerator.
+     *
+     * @return the value passed to {@link IHistNative#histogramDistance}
+     */
+    public int nativeValue() { return nativeValue; }
+}
@@ -0,0 +1,243 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import java.nio.IntBuffer;
+
+/**
+ * Analyses and comparisons of histograms computed by
+ * {@link HistogramRequest}.
+ *
+ * <p>
+ * Each method takes the histogram buffer (as returned by
+ * {@link HistogramRequest#compute()}: the remaining portion holds one or more
+ * consecutive histograms of 2^sampleBits bins) and returns one result per
+ * histogrammed component. The analyses run in native code, in one pass (or a
+ * few passes) over the bins, without revisiting the image.
+ *
+ * <p>
+ * Example usage:
+ *
+ * <pre>{@code
+ * IntBuffer histogram = HistogramRequest.forImage(imageData, width, height)
+ *         .bits(12)
+ *         .compute();
+ * int[] limits = HistogramAnalysis.quantiles(histogram, 12, 0.001, 0.999);
+ * // limits[0], limits[1]: 0.1 and 99.9 percentiles
+ * }</pre>
+ *
+ * <p>
+ * Buffers that are neither direct nor array-backed are copied before being
+ * passed to native code. The buffer's position and limit are not modified.
+ */
+public final class HistogramAnalysis {
+
+    private HistogramAnalysis() {
+        // Prevent instantiation
+    }
+
+    /**
+     * Compute cumulative sums of histograms along the bins.
+     *
+     * @param histogram  histogram(s)
+     * @param sampleBits number of bits per sample (0-16)
+     * @return cumulative sums, with the same layout as the histogram
+     * @throws IllegalArgumentException if the histogram size is not a
+     *                                  multiple of 2^sampleBits
+     */
+    public static long[] cumsum(IntBuffer histogram, int sampleBits) {
+        int nHist = componentCount(histogram, sampleBits);
+        long[] result = new long[nHist << sampleBits];
+        IHistNative.histogramCumsum(sampleBits, nHist,
+                                    nativeBuffer(histogram), result);
+        return result;
+    }
+
+    /**
+     * Find sample values at the given quantiles of histograms.
+     *
+     * <p>
+     * The value for quantile q is the smallest bin value v such that at least
+     * max(1, ceil(q * count)) samples are &lt;= v; thus q = 0 gives the
+     * minimum and q = 1 the maximum (0 for an empty histogram).
+     *
+     * @param histogram  histogram(s)
+     * @param sampleBits number of bits per sample (0-16)
+     * @param quantiles  quantiles, each in the range [0, 1]
+     * @return values, of length nHistComponents * quantiles.length, with the
+     *         quantiles of each component stored consecutively
+     * @throws IllegalArgumentException if the histogram size is not a
+     *                                  multiple of 2^sampleBits or a
+     *                                  quantile is out of range
+     */
+    public static int[] quantiles(IntBuffer histogram, int sampleBits,
+                                  double... quantiles) {
+        int nHist = componentCount(histogram, sampleBits);
+        int[] result = new int[nHist * quantiles.length];
+        IHistNative.histogramQuantiles(
+            sampleBits, nHist, nativeBuffer(histogram), quantiles, result);
+        return result;
+    }
+
+    /**
+     * Compute Otsu thresholds of histograms.
+     *
+     * <p>
+     * The threshold t maximizes the between-class variance of the classes
+     * (values &lt;= t) and (values &gt; t); it is 0 if the histogram has
+     * fewer than 2 occupied bins.
+     *
+     * @param histogram  histogram(s)
+     * @param sampleBits number of bits per sample (0-16)
+     * @return one threshold per component
+     * @throws IllegalArgumentException if the histogram size is not a
+     *                                  multiple of 2^sampleBits
+     */
+    public static int[] otsuThresholds(IntBuffer histogram, int sampleBits) {
+        int nHist = componentCount(histogram, sampleBits);
+        int[] result = new int[nHist];
+        IHistNative.histogramOtsu(sampleBits, nHist, nativeBuffer(histogram),
+                                  result);
+        return result;
+    }
+
+    /**
+     * Compute the Shannon entropy (in bits) of histograms.
+     *
+     * @param histogram  histogram(s)
+     * @param sampleBits number of bits per sample (0-16)
+     * @return one entropy per component (NaN for an empty histogram)
+     * @throws IllegalArgumentException if the histogram size is not a
+     *                                  multiple of 2^sampleBits
+     */
+    public static double[] entropy(IntBuffer histogram, int sampleBits) {
+        int nHist = componentCount(histogram, sampleBits);
+        double[] result = new double[nHist];
+        IHistNative.histogramEntropy(sampleBits, nHist,
+                                     nativeBuffer(histogram), result);
+        return result;
+    }
+
+    /**
+     * Find the most frequent value (lowest if tied) of histograms.
+     *
+     * @param histogram  histogram(s)
+     * @param sampleBits number of bits per sample (0-16)
+     * @return one mode per component
+     * @throws IllegalArgumentException if the histogram size is not a
+     *                                  multiple of 2^sampleBits
+     */
+    public static int[] modes(IntBuffer histogram, int sampleBits) {
+        int nHist = componentCount(histogram, sampleBits);
+        int[] result = new int[nHist];
+        IHistNative.histogramMode(sampleBits, nHist, nativeBuffer(histogram),
+                                  result);
+        return result;
+    }
+
+    /**
+     * Compare two histograms, component by component.
+     *
+     * @param histogram  histogram(s) (p)
+     * @param other      histogram(s) of the same size (q)
+     * @param sampleBits number of bits per sample (0-16)
+     * @param metric     the distance metric
+     * @return one distance per component (NaN where either histogram is
+     *         empty)
+     * @throws IllegalArgumentException if the histogram size is not a
+     *                                  multiple of 2^sampleBits or the sizes
+     *                                  differ
+     */
+    public static double[] distance(IntBuffer histogram, IntBuffer other,
+                                    int sampleBits, DistanceMetric metric) {
+        int nHist = componentCount(histogram, sampleBits);
+        if (other == null) {
+            throw new NullPointerException("other cannot be null");
+        }
+        if (other.remaining() != histogram.remaining()) {
+            throw new IllegalArgumentException(
+                "other histogram size " + other.remaining() +
+                " does not match histogram size " + histogram.remaining());
+        }
+        return compare(histogram, nHist, 1, other, sampleBits, metric, false);
+    }
+
+    /**
+     * Compare a histogram with each of many stored references.
+     *
+     * <p>
+     * This is much faster than repeated calls to {@link #distance}, because
+     * the query histogram is normalized only once and large batches may be
+     * processed in parallel.
+     *
+     * @param query      histogram(s) (p)
+     * @param references reference histograms (q), stored consecutively, each
+     *                   the size of query
+     * @param sampleBits number of bits per sample (0-16)
+     * @param metric     the distance metric
+     * @return distances, of length nReferences * nHistComponents, with the
+     *         distances for each reference stored consecutively
+     * @throws IllegalArgumentException if the query size is not a multiple of
+     *                                  2^sampleBits or the references size is
+     *                                  not a multiple of the query size
+     */
+    public static double[] distances(IntBuffer query, IntBuffer references,
+                                     int sampleBits, DistanceMetric metric) {
+        int nHist = componentCount(query, sampleBits);
+        if (references == null) {
+            throw new NullPointerException("references cannot be null");
+        }
+        int querySize = query.remaining();
+        if (querySize == 0 ? references.remaining() != 0
+                           : references.remaining() % querySize != 0) {
+            throw new IllegalArgumentException(
+                "references size " + references.remaining() +
+                " is not a multiple of query size " + querySize);
+        }
+        int nRefs = querySize == 0 ? 0 : references.remaining() / querySize;
+        return compare(query, nHist, nRefs, references, sampleBits, metric,
+                       true);
+    }
+
+    private static double[] compare(IntBuffer query, int nHist, int nRefs,
+                                    IntBuffer references, int sampleBits,
+                                    DistanceMetric metric, boolean parallel) {
+        if (metric == null) {
+            throw new NullPointerException("metric cannot be null");
+        }
+        double[] result = new double[nRefs * nHist];
+        IHistNative.histogramDistance(sampleBits, nHist, nativeBuffer(query),
+                                      nRefs, nativeBuffer(references),
+                                      metric.nativeValue(), result, parallel);
+        return result;
+    }
+
+    private static int componentCount(IntBuffer histogram, int sampleBits) {
+        if (histogram == null) {
+            throw new NullPointerException("histogram cannot be null");
+        }
+        if (sampleBits < 0 || sampleBits > 16) {
+            throw new IllegalArgumentException(
+                "sampleBits must be in range [0, 16]");
+        }
+        int nBins = 1 << sampleBits;
+        if (histogram.remaining() % nBins != 0) {
+            throw new IllegalArgumentException(
+                "histogram size " + histogram.remaining() +
+                " is not a multiple of 2^sampleBits (" + nBins + ")");
+        }
+        return histogram.remaining() / nBins;
+    }
+
+    private static IntBuffer nativeBuffer(IntBuffer histogram) {
+        if (histogram.isDirect() || histogram.hasArray()) {
+            return histogram.duplicate();
+        }
+        IntBuffer copy = IntBuffer.allocate(histogram.remaining());
+        copy.put(histogram.duplicate());
+        copy.flip();
+        return copy;
+    }
+}
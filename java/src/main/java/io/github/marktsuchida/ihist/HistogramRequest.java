@@ -484,17 +484,17 @@ public final class HistogramRequest {
         if (is8Bit) {
             ByteBuffer imageBuf =
                 prepareImage8Buffer(imageOffset, imageRequired);
-            IHistNative.histogram8(effectiveBits, imageBuf, maskBuf,
-                                   effectiveHeight, effectiveWidth,
-                                   imageStride, effectiveMaskStride,
-                                   nComponents, indices, jniBuf, parallel);
+            NativeBackend.get().histogram8(
+                effectiveBits, imageBuf, maskBuf, effectiveHeight,
+                effectiveWidth, imageStride, effectiveMaskStride, nComponents,
+                indices, jniBuf, parallel);
         } else {
             ShortBuffer imageBuf =
                 prepareImage16Buffer(imageOffset, imageRequired);
-            IHistNative.histogram16(effectiveBits, imageBuf, maskBuf,
-                                    effectiveHeight, effectiveWidth,
-                                    imageStride, effectiveMaskStride,
-                                    nComponents, indices, jniBuf, parallel);
+            NativeBackend.get().histogram16(
+                effectiveBits, imageBuf, maskBuf, effectiveHeight,
+                effectiveWidth, imageStride, effectiveMaskStride, nComponents,
+                indices, jniBuf, parallel);
         }
 
         if (jniBuf != returnBuf) {
@@ -506,6 +506,81 @@ public final class HistogramRequest {
         return returnBuf;
     }
 
+    /**
+     * Compute the histogram as its nonzero bins only.
+     *
+     * <p>
+     * For small regions of 16-bit images this is faster than
+     * {@link #compute()} followed by a scan of the dense histogram, and the
+     * result is much smaller. The output options ({@link #output(IntBuffer)}
+     * and {@link #accumulate(boolean)}) do not apply.
+     *
+     * @return the sparse histogram
+     * @throws IllegalArgumentException if parameters are invalid or an output
+     *                                  buffer was specified
+     */
+    public SparseHistogram computeSparse() {
+        if (outputBuffer != null || accumulate) {
+            throw new IllegalArgumentException(
+                "output and accumulate cannot be used with computeSparse()");
+        }
+        validate();
+
+        int effectiveWidth = (roiWidth < 0) ? imageWidth : roiWidth;
+        int effectiveHeight = (roiHeight < 0) ? imageHeight : roiHeight;
+        int effectiveMaskStride = (maskBuffer != null) ? maskWidth : 0;
+        int effectiveBits = (sampleBits < 0) ? (is8Bit ? 8 : 16) : sampleBits;
+
+        int[] indices = (componentIndices != null)
+                            ? componentIndices
+                            : defaultComponentIndices(nComponents);
+
+        // Each component has at most one nonzero bin per pixel.
+        int capacity =
+            indices.length * (int)Math.min(1L << effectiveBits,
+                                           (long)effectiveWidth *
+                                               effectiveHeight);
+        short[] bins = new short[capacity];
+        int[] counts = new int[capacity];
+        int[] nonzeroCounts = new int[indices.length];
+
+        int imageOffset = (roiY * imageStride + roiX) * nComponents;
+        int maskOffset = maskOffsetY * effectiveMaskStride + maskOffsetX;
+
+        int imageRequired =
+            (effectiveHeight > 0 && effectiveWidth > 0)
+                ? ((effectiveHeight - 1) * imageStride + effectiveWidth) *
+                      nComponents
+                : 0;
+        int maskRequired =
+            (effectiveHeight > 0 && effectiveWidth > 0)
+                ? (effectiveHeight - 1) * effectiveMaskStride + effectiveWidth
+                : 0;
+
+        ByteBuffer maskBuf = prepareMaskBuffer(maskOffset, maskRequired);
+
+        int total;
+        if (is8Bit) {
+            ByteBuffer imageBuf =
+                prepareImage8Buffer(imageOffset, imageRequired);
+            total = IHistNative.histogram8Sparse(
+                effectiveBits, imageBuf, maskBuf, effectiveHeight,
+                effectiveWidth, imageStride, effectiveMaskStride, nComponents,
+                indices, bins, counts, nonzeroCounts, parallel);
+        } else {
+            ShortBuffer imageBuf =
+                prepareImage16Buffer(imageOffset, imageRequired);
+            total = IHistNative.histogram16Sparse(
+                effectiveBits, imageBuf, maskBuf, effectiveHeight,
+                effectiveWidth, imageStride, effectiveMaskStride, nComponents,
+                indices, bins, counts, nonzeroCounts, parallel);
+        }
+
+        return new SparseHistogram(effectiveBits, Arrays.copyOf(bins, total),
+                                   Arrays.copyOf(counts, total),
+                                   nonzeroCounts);
+    }
+
     private static void clearBuffer(IntBuffer buf, int size) {
         if (buf.hasArray()) {
             int offset = buf.arrayOffset() + buf.position();
@@ -0,0 +1,284 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Path;
+import java.nio.file.StandardOpenOption;
+import java.util.Arrays;
+
+/**
+ * Reader for histogram series files written by the C or Python API
+ * ({@code ihist_series_create()}, {@code ihist.HistogramSeriesWriter}).
+ *
+ * <p>
+ * The format is decoded in Java, so reading does not require the native
+ * library. See README.md for the file format.
+ *
+ * <p>
+ * Example usage:
+ *
+ * <pre>{@code
+ * try (HistogramSeriesReader series =
+ *          HistogramSeriesReader.open(Paths.get("run.ihs"))) {
+ *     for (int i = 0; i < series.frameCount(); ++i) {
+ *         IntBuffer histogram = series.read(i);
+ *         // ...
+ *     }
+ * }
+ * }</pre>
+ *
+ * <p>
+ * Reading frames in increasing order is fastest. Instances are not
+ * thread-safe.
+ */
+public final class HistogramSeriesReader implements AutoCloseable {
+
+    private static final byte[] FILE_MAGIC =
+        "IHSERIES".getBytes(StandardCharsets.US_ASCII);
+    private static final byte[] INDEX_MAGIC =
+        "IHSINDEX".getBytes(StandardCharsets.US_ASCII);
+    private static final int FORMAT_VERSION = 1;
+    private static final int HEADER_SIZE = 32;
+    private static final int TRAILER_SIZE = 24;
+
+    private final FileChannel channel;
+    private final int sampleBits;
+    private final int componentCount;
+    private final int countsPerFrame;
+    private final int keyframeInterval;
+    private final long[] offsets;
+    private final long recordsEnd;
+
+    // Most recently decoded frame, so that sequential reads decode one
+    // record each.
+    private final int[] current;
+    private int currentFrame = -1;
+
+    private HistogramSeriesReader(FileChannel channel, int sampleBits,
+                                  int componentCount, int keyframeInterval,
+                                  long[] offsets, long recordsEnd) {
+        this.channel = channel;
+        this.sampleBits = sampleBits;
+        this.componentCount = componentCount;
+        this.countsPerFrame = componentCount << sampleBits;
+        this.keyframeInterval = keyframeInterval;
+        this.offsets = offsets;
+        this.recordsEnd = recordsEnd;
+        this.current = new int[countsPerFrame];
+    }
+
+    /**
+     * Open a histogram series file.
+     *
+     * <p>
+     * A file whose writer was not closed (e.g., after a crash) is readable up
+     * to its last complete histogram.
+     *
+     * @param path the file
+     * @return the reader
+     * @throws IOException if the file cannot be read or is not a histogram
+     *                     series
+     */
+    public static HistogramSeriesReader open(Path path) throws IOException {
+        FileChannel channel = FileChannel.open(path, StandardOpenOption.READ);
+        try {
+            return open(channel);
+        } catch (IOException | RuntimeException e) {
+            channel.close();
+            throw e;
+        }
+    }
+
+    private static HistogramSeriesReader open(FileChannel channel)
+        throws IOException {
+        long fileSize = channel.size();
+        ByteBuffer header = readAt(channel, 0, HEADER_SIZE);
+        if (header == null || !hasMagic(header, 0, FILE_MAGIC) ||
+            header.getInt(8) != FORMAT_VERSION ||
+            Integer.compareUnsigned(header.getInt(12), 16) > 0 ||
+            header.getInt(16) <= 0 || header.getInt(20) <= 0 ||
+            ((long)header.getInt(16) << header.getInt(12)) >
+                Integer.MAX_VALUE) {
+            throw new IOException("Not a histogram series file");
+        }
+        int sampleBits = header.getInt(12);
+        int componentCount = header.getInt(16);
+        int keyframeInterval = header.getInt(20);
+        long maxRecord = 15L * ((long)componentCount << sampleBits);
+
+        // Use the index if the file was closed properly.
+        if (fileSize >= HEADER_SIZE + TRAILER_SIZE) {
+            ByteBuffer trailer =
+                readAt(channel, fileSize - TRAILER_SIZE, TRAILER_SIZE);
+            if (trailer != null && hasMagic(trailer, 16, INDEX_MAGIC)) {
+                long indexOffset = trailer.getLong(0);
+                long n = trailer.getLong(8);
+                if (indexOffset >= HEADER_SIZE && n >= 0 &&
+                    n <= Integer.MAX_VALUE / 8 &&
+                    indexOffset + 8 * n + TRAILER_SIZE == fileSize) {
+                    ByteBuffer index =
+                        readAt(channel, indexOffset, (int)(8 * n));
+                    if (index != null) {
+                        long[] offsets = new long[(int)n];
+                        index.asLongBuffer().get(offsets);
+                        return new HistogramSeriesReader(
+                            channel, sampleBits, componentCount,
+                            keyframeInterval, offsets, indexOffset);
+                    }
+                }
+            }
+        }
+
+        // Otherwise recover the offsets from the record size prefixes.
+        long[] offsets = new long[16];
+        int n = 0;
+        long offset = HEADER_SIZE;
+        while (fileSize - offset >= 4) {
+            ByteBuffer prefix = readAt(channel, offset, 4);
+            if (prefix == null) {
+                break;
+            }
+            long size = Integer.toUnsignedLong(prefix.getInt(0));
+            if (size > maxRecord || size > fileSize - offset - 4) {
+                break;
+            }
+            if (n == offsets.length) {
+                offsets = Arrays.copyOf(offsets, 2 * n);
+            }
+            offsets[n++] = offset;
+            offset += 4 + size;
+        }
+        return new HistogramSeriesReader(channel, sampleBits, componentCount,
+                                         keyframeInterval,
+                                         Arrays.copyOf(offsets, n), offset);
+    }
+
+    /**
+     * @return number of bits per sample; each histogram component has
+     *         2^sampleBits bins
+     */
+    public int sampleBits() { return sampleBits; }
+
+    /**
+     * @return number of components per histogram
+     */
+    public int componentCount() { return componentCount; }
+
+    /**
+     * @return number of histograms in the file
+     */
+    public int frameCount() { return offsets.length; }
+
+    /**
+     * Read one histogram.
+     *
+     * @param frame index of the histogram, in the range [0, frameCount())
+     * @return newly allocated buffer of componentCount() * 2^sampleBits()
+     *         counts, components stored consecutively
+     * @throws IndexOutOfBoundsException if frame is out of range
+     * @throws IOException               if the file cannot be read or is
+     *                                   corrupt
+     */
+    public IntBuffer read(int frame) throws IOException {
+        if (frame < 0 || frame >= offsets.length) {
+            throw new IndexOutOfBoundsException(
+                "Frame " + frame + " out of range [0, " + offsets.length +
+                ")");
+        }
+        int keyframe = frame - frame % keyframeInterval;
+        int start = keyframe;
+        if (currentFrame >= keyframe && currentFrame <= frame) {
+            start = currentFrame + 1;
+        } else {
+            Arrays.fill(current, 0);
+        }
+        currentFrame = -1;
+        for (int i = start; i <= frame; ++i) {
+            applyRecord(i);
+        }
+        currentFrame = frame;
+        return IntBuffer.wrap(current.clone());
+    }
+
+    @Override
+    public void close() throws IOException {
+        channel.close();
+    }
+
+    private void applyRecord(int frame) throws IOException {
+        long offset = offsets[frame];
+        long end =
+            frame + 1 < offsets.length ? offsets[frame + 1] : recordsEnd;
+        if (end - offset < 4 || end - offset > Integer.MAX_VALUE) {
+            throw new IOException("Corrupt histogram series");
+        }
+        ByteBuffer record = readAt(channel, offset, (int)(end - offset));
+        if (record == null ||
+            Integer.toUnsignedLong(record.getInt(0)) != end - offset - 4) {
+            throw new IOException("Corrupt histogram series");
+        }
+        record.position(4);
+        int i = 0;
+        while (record.hasRemaining()) {
+            long gap = readVarint(record);
+            long zz = readVarint(record);
+            if (gap < 0 || zz < 0 || gap >= countsPerFrame - i) {
+                throw new IOException("Corrupt histogram series");
+            }
+            i += (int)gap;
+            long delta = (zz >>> 1) ^ -(zz & 1);
+            long value = Integer.toUnsignedLong(current[i]) + delta;
+            if (value < 0 || value > 0xffffffffL) {
+                throw new IOException("Corrupt histogram series");
+            }
+            current[i] = (int)value;
+            ++i;
+        }
+    }
+
+    // Returns -1 if truncated or longer than 63 bits (which a valid file
+    // never has).
+    private static long readVarint(ByteBuffer buf) {
+        long v = 0;
+        for (int shift = 0; shift < 63 && buf.hasRemaining(); shift += 7) {
+            byte b = buf.get();
+            v |= (long)(b & 0x7f) << shift;
+            if (b >= 0) {
+                return v;
+            }
+        }
+        return -1;
+    }
+
+    private static boolean hasMagic(ByteBuffer buf, int offset,
+                                    byte[] magic) {
+        for (int i = 0; i < magic.length; ++i) {
+            if (buf.get(offset + i) != magic[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Returns null if the file ends before size bytes.
+    private static ByteBuffer readAt(FileChannel channel, long offset,
+                                     int size) throws IOException {
+        ByteBuffer buf =
+            ByteBuffer.allocate(size).order(ByteOrder.LITTLE_ENDIAN);
+        while (buf.hasRemaining()) {
+            if (channel.read(buf, offset + buf.position()) < 0) {
+                return null;
+            }
+        }
+        buf.flip();
+        return buf;
+    }
+}
@@ -159,4 +159,331 @@ public final class IHistNative {
     histogram16(int sampleBits, ShortBuffer image, ByteBuffer mask, int height,
                 int width, int imageStride, int maskStride, int nComponents,
                 int[] componentIndices, IntBuffer histogram, boolean parallel);
+
+    /**
+     * Compute the nonzero bins of the histogram of 8-bit image data.
+     *
+     * <p>Parameters other than the outputs are as for
+     * {@link #histogram8}. The nonzero bins of each histogrammed component
+     * are written in increasing order, the components one after another.
+     * See {@link HistogramRequest#computeSparse()} for a higher-level
+     * interface.
+     *
+     * @param sampleBits       number of significant bits per sample (0-8)
+     * @param image            image pixel data buffer
+     * @param mask             per-pixel mask buffer, or null
+     * @param height           image height in pixels
+     * @param width            image width in pixels
+     * @param imageStride      row stride in pixels
+     * @param maskStride       mask row stride in pixels (0 if mask is null)
+     * @param nComponents      number of interleaved components per pixel
+     * @param componentIndices indices of components to histogram
+     * @param bins             output bin values (unsigned); length must be
+     *                         at least componentIndices.length *
+     *                         min(2^sampleBits, width * height)
+     * @param counts           output counts, of the same minimum length
+     * @param nonzeroCounts    output number of nonzero bins per component;
+     *                         length must equal componentIndices.length
+     * @param parallel         if true, allows multi-threaded execution
+     * @return total number of nonzero bins written
+     * @throws NullPointerException     if image, componentIndices, or an
+     *                                  output is null
+     * @throws IllegalArgumentException if parameters are invalid
+     */
+    public static native int
+    histogram8Sparse(int sampleBits, ByteBuffer image, ByteBuffer mask,
+                     int height, int width, int imageStride, int maskStride,
+                     int nComponents, int[] componentIndices, short[] bins,
+                     int[] counts, int[] nonzeroCounts, boolean parallel);
+
+    /**
+     * Compute the nonzero bins of the histogram of 16-bit image data.
+     *
+     * <p>As {@link #histogram8Sparse}, but for 16-bit images (sampleBits
+     * 0-16; image as for {@link #histogram16}).
+     *
+     * @param sampleBits       number of significant bits per sample (0-16)
+     * @param image            image pixel data buffer
+     * @param mask             per-pixel mask buffer, or null
+     * @param height           image height in pixels
+     * @param width            image width in pixels
+     * @param imageStride      row stride in pixels
+     * @param maskStride       mask row stride in pixels (0 if mask is null)
+     * @param nComponents      number of interleaved components per pixel
+     * @param componentIndices indices of components to histogram
+     * @param bins             output bin values (unsigned)
+     * @param counts           output counts
+     * @param nonzeroCounts    output number of nonzero bins per component
+     * @param parallel         if true, allows multi-threaded execution
+     * @return total number of nonzero bins written
+     * @throws NullPointerException     if image, componentIndices, or an
+     *                                  output is null
+     * @throws IllegalArgumentException if parameters are invalid
+     */
+    public static native int
+    histogram16Sparse(int sampleBits, ShortBuffer image, ByteBuffer mask,
+                      int height, int width, int imageStride, int maskStride,
+                      int nComponents, int[] componentIndices, short[] bins,
+                      int[] counts, int[] nonzeroCounts, boolean parallel);
+
+    /**
+     * Compute separate histograms of a batch of same-size 8-bit images.
+     *
+     * <p>Equivalent to calling {@link #histogram8} for each image (with the
+     * same parameters), but in a single native call, in which many small
+     * images are distributed across threads. The histogram of
+     * {@code images[i]} is accumulated into the i-th of
+     * {@code images.length} consecutive histograms in {@code histograms}.
+     *
+     * @param sampleBits       number of significant bits per sample (0-8)
+     * @param images           image pixel data buffers, each as for
+     *                         {@link #histogram8}
+     * @param masks            per-pixel mask buffers (null, or an array of
+     *                         the same length as {@code images}, whose
+     *                         elements may be null)
+     * @param height           image height in pixels
+     * @param width            image width in pixels
+     * @param imageStride      row stride in pixels
+     * @param maskStride       mask row stride in pixels (0 if masks is null)
+     * @param nComponents      number of interleaved components per pixel
+     * @param componentIndices indices of components to histogram
+     * @param histograms       output buffer for the histograms; remaining
+     *                         size must be images.length *
+     *                         componentIndices.length * 2^sampleBits
+     * @param parallel         if true, allows multi-threaded execution
+     * @throws NullPointerException     if images, an element of images,
+     *                                  componentIndices, or histograms is
+     *                                  null
+     * @throws IllegalArgumentException if parameters are invalid
+     */
+    public static native void
+    histogram8Batch(int sampleBits, ByteBuffer[] images, ByteBuffer[] masks,
+                    int height, int width, int imageStride, int maskStride,
+                    int nComponents, int[] componentIndices,
+                    IntBuffer histograms, boolean parallel);
+
+    /**
+     * Compute separate histograms of a batch of same-size 16-bit images.
+     *
+     * <p>As {@link #histogram8Batch}, but for 16-bit images (sampleBits
+     * 0-16; images as for {@link #histogram16}).
+     *
+     * @param sampleBits       number of significant bits per sample (0-16)
+     * @param images           image pixel data buffers
+     * @param masks            per-pixel mask buffers, or null
+     * @param height           image height in pixels
+     * @param width            image width in pixels
+     * @param imageStride      row stride in pixels
+     * @param maskStride       mask row stride in pixels (0 if masks is null)
+     * @param nComponents      number of interleaved components per pixel
+     * @param componentIndices indices of components to histogram
+     * @param histograms       output buffer for the histograms
+     * @param parallel         if true, allows multi-threaded execution
+     * @throws NullPointerException     if images, an element of images,
+     *                                  componentIndices, or histograms is
+     *                                  null
+     * @throws IllegalArgumentException if parameters are invalid
+     */
+    public static native void
+    histogram16Batch(int sampleBits, ShortBuffer[] images, ByteBuffer[] masks,
+                     int height, int width, int imageStride, int maskStride,
+                     int nComponents, int[] componentIndices,
+                     IntBuffer histograms, boolean parallel);
+
+    /**
+     * Compute separate histograms of same-size regions of one 8-bit image.
+     *
+     * <p>The i-th region has its top-left pixel at ({@code roiX[i]},
+     * {@code roiY[i]}) and must lie within the image. Its histogram is
+     * accumulated into the i-th of {@code roiX.length} consecutive
+     * histograms in {@code histograms}. The mask, if given, applies to each
+     * region (it is {@code roiWidth} by {@code roiHeight}).
+     *
+     * @param sampleBits       number of significant bits per sample (0-8)
+     * @param image            image pixel data buffer, as for
+     *                         {@link #histogram8}
+     * @param mask             per-pixel mask buffer for the regions, or null
+     * @param imageHeight      image height in pixels
+     * @param imageWidth       image width in pixels
+     * @param imageStride      image row stride in pixels
+     * @param maskStride       mask row stride in pixels (must be &gt;=
+     *                         roiWidth, or == 0 when mask == null)
+     * @param roiX             x coordinates of the regions
+     * @param roiY             y coordinates of the regions (same length as
+     *                         roiX)
+     * @param roiHeight        region height in pixels
+     * @param roiWidth         region width in pixels
+     * @param nComponents      number of interleaved components per pixel
+     * @param componentIndices indices of components to histogram
+     * @param histograms       output buffer for the histograms; remaining
+     *                         size must be roiX.length *
+     *                         componentIndices.length * 2^sampleBits
+     * @param parallel         if true, allows multi-threaded execution
+     * @throws NullPointerException     if image, roiX, roiY,
+     *                                  componentIndices, or histograms is
+     *                                  null
+     * @throws IllegalArgumentException if parameters are invalid or a region
+     *                                  exceeds the image bounds
+     */
+    public static native void
+    histogram8Rois(int sampleBits, ByteBuffer image, ByteBuffer mask,
+                   int imageHeight, int imageWidth, int imageStride,
+                   int maskStride, int[] roiX, int[] roiY, int roiHeight,
+                   int roiWidth, int nComponents, int[] componentIndices,
+                   IntBuffer histograms, boolean parallel);
+
+    /**
+     * Compute separate histograms of same-size regions of one 16-bit image.
+     *
+     * <p>As {@link #histogram8Rois}, but for 16-bit images (sampleBits
+     * 0-16; image as for {@link #histogram16}).
+     *
+     * @param sampleBits       number of significant bits per sample (0-16)
+     * @param image            image pixel data buffer
+     * @param mask             per-pixel mask buffer for the regions, or null
+     * @param imageHeight      image height in pixels
+     * @param imageWidth       image width in pixels
+     * @param imageStride      image row stride in pixels
+     * @param maskStride       mask row stride in pixels (0 if mask is null)
+     * @param roiX             x coordinates of the regions
+     * @param roiY             y coordinates of the regions
+     * @param roiHeight        region height in pixels
+     * @param roiWidth         region width in pixels
+     * @param nComponents      number of interleaved components per pixel
+     * @param componentIndices indices of components to histogram
+     * @param histograms       output buffer for the histograms
+     * @param parallel         if true, allows multi-threaded execution
+     * @throws NullPointerException     if image, roiX, roiY,
+     *                                  componentIndices, or histograms is
+     *                                  null
+     * @throws IllegalArgumentException if parameters are invalid or a region
+     *                                  exceeds the image bounds
+     */
+    public static native void
+    histogram16Rois(int sampleBits, ShortBuffer image, ByteBuffer mask,
+                    int imageHeight, int imageWidth, int imageStride,
+                    int maskStride, int[] roiX, int[] roiY, int roiHeight,
+                    int roiWidth, int nComponents, int[] componentIndices,
+                    IntBuffer histograms, boolean parallel);
+
+    // The histogram analysis methods below read {@code nHistComponents}
+    // consecutive histograms of 2^sampleBits bins each from the remaining
+    // portion of {@code histogram} (which must be exactly that size, and be
+    // direct or hasArray() == true), and write their results to a Java array.
+    // See HistogramAnalysis for a higher-level interface.
+
+    /**
+     * Compute cumulative sums of histograms along the bins.
+     *
+     * @param sampleBits      number of bits per sample (0-16)
+     * @param nHistComponents number of histograms
+     * @param histogram       histogram data
+     * @param cumsum          output, of length nHistComponents *
+     *                        2^sampleBits
+     * @throws NullPointerException     if histogram or cumsum is null
+     * @throws IllegalArgumentException if parameters or sizes are invalid
+     */
+    public static native void histogramCumsum(int sampleBits,
+                                              int nHistComponents,
+                                              IntBuffer histogram,
+                                              long[] cumsum);
+
+    /**
+     * Find sample values at the given quantiles of histograms.
+     *
+     * <p>The value for quantile q is the smallest bin value v such that at
+     * least max(1, ceil(q * count)) samples are &lt;= v (0 for an empty
+     * histogram). All quantiles are found in a single pass over the bins.
+     *
+     * @param sampleBits      number of bits per sample (0-16)
+     * @param nHistComponents number of histograms
+     * @param histogram       histogram data
+     * @param quantiles       quantiles, each in the range [0, 1]
+     * @param values          output, of length nHistComponents *
+     *                        quantiles.length; component-major
+     * @throws NullPointerException     if histogram, quantiles, or values is
+     *                                  null
+     * @throws IllegalArgumentException if parameters or sizes are invalid
+     */
+    public static native void histogramQuantiles(int sampleBits,
+                                                 int nHistComponents,
+                                                 IntBuffer histogram,
+                                                 double[] quantiles,
+                                                 int[] values);
+
+    /**
+     * Compute Otsu thresholds of histograms.
+     *
+     * <p>The threshold t maximizes the between-class variance of the classes
+     * (values &lt;= t) and (values &gt; t); it is 0 if the histogram has fewer
+     * than 2 occupied bins.
+     *
+     * @param sampleBits      number of bits per sample (0-16)
+     * @param nHistComponents number of histograms
+     * @param histogram       histogram data
+     * @param thresholds      output, of length nHistComponents
+     * @throws NullPointerException     if histogram or thresholds is null
+     * @throws IllegalArgumentException if parameters or sizes are invalid
+     */
+    public static native void histogramOtsu(int sampleBits,
+                                            int nHistComponents,
+                                            IntBuffer histogram,
+                                            int[] thresholds);
+
+    /**
+     * Compute the Shannon entropy (in bits) of histograms.
+     *
+     * @param sampleBits      number of bits per sample (0-16)
+     * @param nHistComponents number of histograms
+     * @param histogram       histogram data
+     * @param entropy         output, of length nHistComponents; NaN for an
+     *                        empty histogram
+     * @throws NullPointerException     if histogram or entropy is null
+     * @throws IllegalArgumentException if parameters or sizes are invalid
+     */
+    public static native void histogramEntropy(int sampleBits,
+                                               int nHistComponents,
+                                               IntBuffer histogram,
+                                               double[] entropy);
+
+    /**
+     * Find the most frequent value (lowest if tied) of histograms.
+     *
+     * @param sampleBits      number of bits per sample (0-16)
+     * @param nHistComponents number of histograms
+     * @param histogram       histogram data
+     * @param modes           output, of length nHistComponents
+     * @throws NullPointerException     if histogram or modes is null
+     * @throws IllegalArgumentException if parameters or sizes are invalid
+     */
+    public static native void histogramMode(int sampleBits,
+                                            int nHistComponents,
+                                            IntBuffer histogram, int[] modes);
+
+    /**
+     * Compare a histogram with each of a number of reference histograms.
+     *
+     * <p>
+     * Histograms are normalized to unit sum before comparison. See
+     * {@link DistanceMetric} for the metrics.
+     *
+     * @param sampleBits      number of bits per sample (0-16)
+     * @param nHistComponents number of histograms in the query and in each
+     *                        reference
+     * @param query           query histogram data
+     * @param nReferences     number of references
+     * @param references      reference histogram data, of size nReferences *
+     *                        nHistComponents * 2^sampleBits
+     * @param metric          the metric's {@link DistanceMetric#nativeValue()}
+     * @param distances       output, of length nReferences * nHistComponents;
+     *                        NaN where either histogram is empty
+     * @param parallel        whether to allow multi-threaded comparison
+     * @throws NullPointerException     if query, references, or distances is
+     *                                  null
+     * @throws IllegalArgumentException if parameters or sizes are invalid
+     */
+    public static native void histogramDistance(
+        int sampleBits, int nHistComponents, IntBuffer query, int nReferences,
+        IntBuffer references, int metric, double[] distances,
+        boolean parallel);
 }
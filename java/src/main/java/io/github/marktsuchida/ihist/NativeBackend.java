@@ -0,0 +1,135 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import java.nio.ByteBuffer;
+import java.nio.IntBuffer;
+import java.nio.ShortBuffer;
+
+/**
+ * The native call path used by {@link HistogramRequest}.
+ *
+ * <p>
+ * Two backends exist: JNI (via {@link IHistNative}, available on all
+ * supported JDKs) and the Foreign Function &amp; Memory API
+ * ({@code FfmBackend}, JDK 22+), which avoids the JNI layer's reflective
+ * buffer queries and array conversions and is therefore cheaper per call.
+ *
+ * <p>
+ * The FFM backend is selected if it is available and native access is
+ * enabled for this library (for example, with
+ * {@code --enable-native-access=ALL-UNNAMED}); otherwise JNI is used. The
+ * system property {@code ihist.backend} can be set to {@code jni} or
+ * {@code ffm} to override the automatic selection.
+ *
+ * <p>
+ * The methods have the same parameters, requirements, and exceptions as
+ * {@link IHistNative#histogram8} and {@link IHistNative#histogram16}.
+ */
+abstract class NativeBackend {
+
+    static final String PROPERTY = "ihist.backend";
+
+    private static final String FFM_CLASS =
+        "io.github.marktsuchida.ihist.FfmBackend";
+
+    abstract String name();
+
+    abstract void histogram8(int sampleBits, ByteBuffer image, ByteBuffer mask,
+                             int height, int width, int imageStride,
+                             int maskStride, int nComponents,
+                             int[] componentIndices, IntBuffer histogram,
+                             boolean parallel);
+
+    abstract void histogram16(int sampleBits, ShortBuffer image,
+                              ByteBuffer mask, int height, int width,
+                              int imageStride, int maskStride,
+                              int nComponents, int[] componentIndices,
+                              IntBuffer histogram, boolean parallel);
+
+    /**
+     * @return the selected backend
+     */
+    static NativeBackend get() { return Holder.SELECTED; }
+
+    /**
+     * @return the JNI backend
+     */
+    static NativeBackend jni() { return JniBackend.INSTANCE; }
+
+    /**
+     * @return the FFM backend, or null if not available on this JDK (or if
+     *         native access is not enabled and {@code requireNativeAccess}
+     *         is true)
+     */
+    static NativeBackend ffm(boolean requireNativeAccess) {
+        // FfmBackend is compiled for Java 22 and cannot be referenced
+        // directly (or loaded on older JDKs).
+        try {
+            Class<?> clazz = Class.forName(FFM_CLASS);
+            if (requireNativeAccess &&
+                !(Boolean)clazz.getDeclaredMethod("isNativeAccessEnabled")
+                     .invoke(null)) {
+                return null;
+            }
+            return (NativeBackend)clazz.getDeclaredConstructor()
+                .newInstance();
+        } catch (ReflectiveOperationException | LinkageError e) {
+            return null;
+        }
+    }
+
+    private static final class Holder {
+        static final NativeBackend SELECTED = select();
+
+        private static NativeBackend select() {
+            String requested = System.getProperty(PROPERTY, "");
+            if (requested.equals("jni")) {
+                return jni();
+            }
+            if (requested.equals("ffm")) {
+                NativeBackend ffm = ffm(false);
+                if (ffm == null) {
+                    throw new UnsupportedOperationException(
+                        PROPERTY + "=ffm requires JDK 22 or later and a " +
+                        "native library built with FFM entry points");
+                }
+                return ffm;
+            }
+            NativeBackend ffm = ffm(true);
+            return ffm != null ? ffm : jni();
+        }
+    }
+
+    private static final class JniBackend extends NativeBackend {
+        static final JniBackend INSTANCE = new JniBackend();
+
+        @Override
+        String name() {
+            return "jni";
+        }
+
+        @Override
+        void histogram8(int sampleBits, ByteBuffer image, ByteBuffer mask,
+                        int height, int width, int imageStride, int maskStride,
+                        int nComponents, int[] componentIndices,
+                        IntBuffer histogram, boolean parallel) {
+            IHistNative.histogram8(sampleBits, image, mask, height, width,
+                                   imageStride, maskStride, nComponents,
+                                   componentIndices, histogram, parallel);
+        }
+
+        @Override
+        void histogram16(int sampleBits, ShortBuffer image, ByteBuffer mask,
+                         int height, int width, int imageStride,
+                         int maskStride, int nComponents,
+                         int[] componentIndices, IntBuffer histogram,
+                         boolean parallel) {
+            IHistNative.histogram16(sampleBits, image, mask, height, width,
+                                    imageStride, maskStride, nComponents,
+                                    componentIndices, histogram, parallel);
+        }
+    }
+}
@@ -0,0 +1,577 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import java.nio.Buffer;
+import java.nio.ByteBuffer;
+import java.nio.IntBuffer;
+import java.nio.ShortBuffer;
+import java.util.Arrays;
+
+/**
+ * Histogram computation with fixed format, dimensions, and component
+ * selection, for repeated use on new image buffers.
+ *
+ * <p>
+ * Unlike {@link HistogramRequest}, which is configured anew for each image,
+ * a {@code PreparedHistogram} is validated once, in {@link Builder#build()},
+ * and its compute methods then pass the given buffers straight to the native
+ * code: they allocate nothing and do not copy or duplicate buffers. This
+ * makes it suitable for histogramming every frame of a video or camera
+ * stream.
+ *
+ * <p>
+ * Example usage:
+ *
+ * <pre>{@code
+ * PreparedHistogram prepared =
+ *     PreparedHistogram.for16Bit(width, height).bits(12).build();
+ * IntBuffer histogram = IntBuffer.allocate(prepared.histogramSize());
+ * for (ShortBuffer frame : frames) {
+ *     prepared.compute(frame, null, histogram);
+ *     // ...
+ * }
+ * }</pre>
+ *
+ * <p>
+ * The batch methods ({@link #computeBatch(ByteBuffer[], ByteBuffer[],
+ * IntBuffer)} and {@link #computeRois(ByteBuffer, int, int, int[], int[],
+ * ByteBuffer, IntBuffer)}) compute separate histograms of many images, or of
+ * many regions of one image, in a single native call, which is much faster
+ * than one call per image when the images are small.
+ *
+ * <p><b>Buffer requirements:</b> As for {@link IHistNative}, buffers must be
+ * direct or array-backed ({@code hasArray() == true}), and the remaining
+ * size of each must equal the required size exactly. The buffers' positions
+ * and limits are not modified.
+ *
+ * <p>
+ * Instances are immutable and may be used from multiple threads
+ * concurrently (with distinct output buffers).
+ */
+public final class PreparedHistogram {
+
+    private final boolean is8Bit;
+    private final int sampleBits;
+    private final int width;
+    private final int height;
+    private final int imageStride;
+    private final int maskStride;
+    private final int nComponents;
+    private final int[] componentIndices;
+    private final boolean accumulate;
+    private final boolean parallel;
+
+    private PreparedHistogram(Builder b) {
+        this.is8Bit = b.is8Bit;
+        this.sampleBits =
+            b.sampleBits < 0 ? (b.is8Bit ? 8 : 16) : b.sampleBits;
+        this.width = b.width;
+        this.height = b.height;
+        this.imageStride = b.imageStride < 0 ? b.width : b.imageStride;
+        this.maskStride = b.maskStride < 0 ? b.width : b.maskStride;
+        this.nComponents = b.nComponents;
+        this.componentIndices = b.componentIndices != null
+                                    ? b.componentIndices.clone()
+                                    : defaultComponentIndices(b.nComponents);
+        this.accumulate = b.accumulate;
+        this.parallel = b.parallel;
+    }
+
+    // ========== Factory methods ==========
+
+    /**
+     * Start preparing a histogram of 8-bit grayscale images.
+     *
+     * @param width  image width in pixels
+     * @param height image height in pixels
+     * @return new builder
+     */
+    public static Builder for8Bit(int width, int height) {
+        return for8Bit(width, height, 1);
+    }
+
+    /**
+     * Start preparing a histogram of 8-bit multi-component images.
+     *
+     * @param width       image width in pixels
+     * @param height      image height in pixels
+     * @param nComponents number of interleaved components per pixel
+     * @return new builder
+     */
+    public static Builder for8Bit(int width, int height, int nComponents) {
+        return new Builder(true, width, height, nComponents);
+    }
+
+    /**
+     * Start preparing a histogram of 16-bit grayscale images.
+     *
+     * @param width  image width in pixels
+     * @param height image height in pixels
+     * @return new builder
+     */
+    public static Builder for16Bit(int width, int height) {
+        return for16Bit(width, height, 1);
+    }
+
+    /**
+     * Start preparing a histogram of 16-bit multi-component images.
+     *
+     * @param width       image width in pixels
+     * @param height      image height in pixels
+     * @param nComponents number of interleaved components per pixel
+     * @return new builder
+     */
+    public static Builder for16Bit(int width, int height, int nComponents) {
+        return new Builder(false, width, height, nComponents);
+    }
+
+    /**
+     * Builder for {@link PreparedHistogram}.
+     */
+    public static final class Builder {
+        private final boolean is8Bit;
+        private final int width;
+        private final int height;
+        private final int nComponents;
+        private int imageStride = -1; // -1 means width
+        private int maskStride = -1;  // -1 means width
+        private int[] componentIndices; // null means all components
+        private int sampleBits = -1;    // -1 means use default (8 or 16)
+        private boolean accumulate = false;
+        private boolean parallel = true;
+
+        private Builder(boolean is8Bit, int width, int height,
+                        int nComponents) {
+            this.is8Bit = is8Bit;
+            this.width = width;
+            this.height = height;
+            this.nComponents = nComponents;
+        }
+
+        /**
+         * Set the image row stride (default: width).
+         *
+         * @param stride row stride in pixels (must be &gt;= width)
+         * @return this builder
+         */
+        public Builder stride(int stride) {
+            this.imageStride = stride;
+            return this;
+        }
+
+        /**
+         * Set the mask row stride (default: width).
+         *
+         * @param stride mask row stride in pixels (must be &gt;= width)
+         * @return this builder
+         */
+        public Builder maskStride(int stride) {
+            this.maskStride = stride;
+            return this;
+        }
+
+        /**
+         * Set which component indices to histogram (default: all).
+         *
+         * @param indices component indices to histogram (each must be &lt;
+         *                nComponents)
+         * @return this builder
+         */
+        public Builder selectComponents(int... indices) {
+            this.componentIndices = indices.clone();
+            return this;
+        }
+
+        /**
+         * Set the number of significant bits per sample (default: 8 or 16).
+         *
+         * @param bits 0-8 for 8-bit images, 0-16 for 16-bit images
+         * @return this builder
+         */
+        public Builder bits(int bits) {
+            this.sampleBits = bits;
+            return this;
+        }
+
+        /**
+         * Set whether to accumulate into existing output values.
+         *
+         * <p>
+         * If false (default), the output histograms are zeroed before
+         * computing.
+         *
+         * @param accumulate true to add to existing values
+         * @return this builder
+         */
+        public Builder accumulate(boolean accumulate) {
+            this.accumulate = accumulate;
+            return this;
+        }
+
+        /**
+         * Set whether to allow parallel execution (default: true).
+         *
+         * @param parallel true to allow multi-threading
+         * @return this builder
+         */
+        public Builder parallel(boolean parallel) {
+            this.parallel = parallel;
+            return this;
+        }
+
+        /**
+         * Validate the parameters and create the prepared histogram.
+         *
+         * @return the prepared histogram
+         * @throws IllegalArgumentException if parameters are invalid
+         */
+        public PreparedHistogram build() {
+            int maxBits = is8Bit ? 8 : 16;
+            if (sampleBits > maxBits) {
+                throw new IllegalArgumentException(
+                    "sampleBits must be in range [0, " + maxBits + "] for " +
+                    maxBits + "-bit");
+            }
+            if (width < 0 || height < 0) {
+                throw new IllegalArgumentException(
+                    "dimensions must be non-negative");
+            }
+            if (imageStride >= 0 && imageStride < width) {
+                throw new IllegalArgumentException(
+                    "imageStride must be >= width");
+            }
+            if (maskStride >= 0 && maskStride < width) {
+                throw new IllegalArgumentException(
+                    "maskStride must be >= width");
+            }
+            if (nComponents < 0) {
+                throw new IllegalArgumentException("nComponents must be >= 0");
+            }
+            if (componentIndices != null) {
+                for (int idx : componentIndices) {
+                    if (idx < 0 || idx >= nComponents) {
+                        throw new IllegalArgumentException(
+                            "component index out of range [0, nComponents)");
+                    }
+                }
+            }
+            PreparedHistogram prepared = new PreparedHistogram(this);
+            if (prepared.imageSize() > Integer.MAX_VALUE) {
+                throw new IllegalArgumentException(
+                    "image size must not exceed Integer.MAX_VALUE");
+            }
+            return prepared;
+        }
+    }
+
+    // ========== Properties ==========
+
+    /**
+     * @return the number of elements in one histogram
+     *         ({@code nHistComponents * 2^bits})
+     */
+    public int histogramSize() {
+        return componentIndices.length << sampleBits;
+    }
+
+    /**
+     * @return the required remaining size, in samples, of an image buffer
+     */
+    public long imageSize() {
+        return width > 0 && height > 0
+            ? ((long)(height - 1) * imageStride + width) * nComponents
+            : 0;
+    }
+
+    // ========== Execution ==========
+
+    /**
+     * Compute the histogram of an 8-bit image.
+     *
+     * @param image     image data; remaining size must equal
+     *                  {@link #imageSize()}
+     * @param mask      per-pixel mask, or null to histogram all pixels
+     * @param histogram output buffer; remaining size must equal
+     *                  {@link #histogramSize()}
+     * @throws IllegalStateException    if prepared for 16-bit images
+     * @throws NullPointerException     if image or histogram is null
+     * @throws IllegalArgumentException if a buffer has the wrong size or
+     *                                  type
+     */
+    public void compute(ByteBuffer image, ByteBuffer mask,
+                        IntBuffer histogram) {
+        checkFormat(true);
+        checkImage(image, mask);
+        clearOutput(histogram, 1);
+        NativeBackend.get().histogram8(
+            sampleBits, image, mask, height, width, imageStride,
+            mask != null ? maskStride : 0, nComponents, componentIndices,
+            histogram, parallel);
+    }
+
+    /**
+     * Compute the histogram of a 16-bit image.
+     *
+     * @param image     image data; remaining size must equal
+     *                  {@link #imageSize()}
+     * @param mask      per-pixel mask, or null to histogram all pixels
+     * @param histogram output buffer; remaining size must equal
+     *                  {@link #histogramSize()}
+     * @throws IllegalStateException    if prepared for 8-bit images
+     * @throws NullPointerException     if image or histogram is null
+     * @throws IllegalArgumentException if a buffer has the wrong size or
+     *                                  type
+     */
+    public void compute(ShortBuffer image, ByteBuffer mask,
+                        IntBuffer histogram) {
+        checkFormat(false);
+        checkImage(image, mask);
+        clearOutput(histogram, 1);
+        NativeBackend.get().histogram16(
+            sampleBits, image, mask, height, width, imageStride,
+            mask != null ? maskStride : 0, nComponents, componentIndices,
+            histogram, parallel);
+    }
+
+    /**
+     * Compute separate histograms of a batch of 8-bit images in one call.
+     *
+     * @param images     image data buffers, each as for
+     *                   {@link #compute(ByteBuffer, ByteBuffer, IntBuffer)}
+     * @param masks      per-image masks (null, or an array of the same length
+     *                   as images whose elements may be null)
+     * @param histograms output buffer for {@code images.length} consecutive
+     *                   histograms; remaining size must equal
+     *                   {@code images.length * histogramSize()}
+     * @throws IllegalStateException    if prepared for 16-bit images
+     * @throws NullPointerException     if images, an image, or histograms is
+     *                                  null
+     * @throws IllegalArgumentException if a buffer has the wrong size or
+     *                                  type
+     */
+    public void computeBatch(ByteBuffer[] images, ByteBuffer[] masks,
+                             IntBuffer histograms) {
+        checkFormat(true);
+        checkBatch(images, masks);
+        clearOutput(histograms, images.length);
+        IHistNative.histogram8Batch(sampleBits, images, masks, height, width,
+                                    imageStride,
+                                    masks != null ? maskStride : 0,
+                                    nComponents, componentIndices, histograms,
+                                    parallel);
+    }
+
+    /**
+     * Compute separate histograms of a batch of 16-bit images in one call.
+     *
+     * @param images     image data buffers, each as for
+     *                   {@link #compute(ShortBuffer, ByteBuffer, IntBuffer)}
+     * @param masks      per-image masks, or null
+     * @param histograms output buffer for {@code images.length} consecutive
+     *                   histograms
+     * @throws IllegalStateException    if prepared for 8-bit images
+     * @throws NullPointerException     if images, an image, or histograms is
+     *                                  null
+     * @throws IllegalArgumentException if a buffer has the wrong size or
+     *                                  type
+     */
+    public void computeBatch(ShortBuffer[] images, ByteBuffer[] masks,
+                             IntBuffer histograms) {
+        checkFormat(false);
+        checkBatch(images, masks);
+        clearOutput(histograms, images.length);
+        IHistNative.histogram16Batch(sampleBits, images, masks, height, width,
+                                     imageStride,
+                                     masks != null ? maskStride : 0,
+                                     nComponents, componentIndices,
+                                     histograms, parallel);
+    }
+
+    /**
+     * Compute separate histograms of regions of one 8-bit image in one call.
+     *
+     * <p>
+     * Each region has the prepared width and height; the image has the
+     * prepared stride (which must be at least {@code imageWidth}).
+     *
+     * @param image       image data; remaining size must equal
+     *                    {@code ((imageHeight - 1) * stride + imageWidth) *
+     *                    nComponents}
+     * @param imageWidth  image width in pixels
+     * @param imageHeight image height in pixels
+     * @param roiX        left edges of the regions
+     * @param roiY        top edges of the regions (same length as roiX)
+     * @param mask        per-pixel mask applied to every region, or null
+     * @param histograms  output buffer for {@code roiX.length} consecutive
+     *                    histograms
+     * @throws IllegalStateException    if prepared for 16-bit images
+     * @throws NullPointerException     if image, roiX, roiY, or histograms is
+     *                                  null
+     * @throws IllegalArgumentException if a buffer has the wrong size or
+     *                                  type, or a region exceeds the image
+     *                                  bounds
+     */
+    public void computeRois(ByteBuffer image, int imageWidth, int imageHeight,
+                            int[] roiX, int[] roiY, ByteBuffer mask,
+                            IntBuffer histograms) {
+        checkFormat(true);
+        checkRois(image, imageWidth, imageHeight, roiX, roiY, mask);
+        clearOutput(histograms, roiX.length);
+        IHistNative.histogram8Rois(
+            sampleBits, image, mask, imageHeight, imageWidth, imageStride,
+            mask != null ? maskStride : 0, roiX, roiY, height, width,
+            nComponents, componentIndices, histograms, parallel);
+    }
+
+    /**
+     * Compute separate histograms of regions of one 16-bit image in one
+     * call.
+     *
+     * @param image       image data
+     * @param imageWidth  image width in pixels
+     * @param imageHeight image height in pixels
+     * @param roiX        left edges of the regions
+     * @param roiY        top edges of the regions
+     * @param mask        per-pixel mask applied to every region, or null
+     * @param histograms  output buffer for {@code roiX.length} consecutive
+     *                    histograms
+     * @throws IllegalStateException    if prepared for 8-bit images
+     * @throws NullPointerException     if image, roiX, roiY, or histograms is
+     *                                  null
+     * @throws IllegalArgumentException if a buffer has the wrong size or
+     *                                  type, or a region exceeds the image
+     *                                  bounds
+     * @see #computeRois(ByteBuffer, int, int, int[], int[], ByteBuffer,
+     *      IntBuffer)
+     */
+    public void computeRois(ShortBuffer image, int imageWidth,
+                            int imageHeight, int[] roiX, int[] roiY,
+                            ByteBuffer mask, IntBuffer histograms) {
+        checkFormat(false);
+        checkRois(image, imageWidth, imageHeight, roiX, roiY, mask);
+        clearOutput(histograms, roiX.length);
+        IHistNative.histogram16Rois(
+            sampleBits, image, mask, imageHeight, imageWidth, imageStride,
+            mask != null ? maskStride : 0, roiX, roiY, height, width,
+            nComponents, componentIndices, histograms, parallel);
+    }
+
+    private void checkFormat(boolean for8Bit) {
+        if (for8Bit != is8Bit) {
+            throw new IllegalStateException(
+                "prepared for " + (is8Bit ? 8 : 16) +
+                "-bit images; cannot compute " + (for8Bit ? 8 : 16) + "-bit");
+        }
+    }
+
+    // The checks below mirror those of the native code, so that a call that is
+    // going to throw does so before clearOutput() has touched the output.
+
+    private void checkImage(Buffer image, ByteBuffer mask) {
+        checkBuffer(image, imageSize(), "image");
+        if (mask != null) {
+            checkBuffer(mask, maskSize(), "mask");
+        }
+    }
+
+    private void checkBatch(Buffer[] images, ByteBuffer[] masks) {
+        if (images == null) {
+            throw new NullPointerException("images cannot be null");
+        }
+        if (masks != null && masks.length != images.length) {
+            throw new IllegalArgumentException(
+                "masks must have the same length as images");
+        }
+        for (int i = 0; i < images.length; i++) {
+            checkImage(images[i], masks != null ? masks[i] : null);
+        }
+    }
+
+    private void checkRois(Buffer image, int imageWidth, int imageHeight,
+                           int[] roiX, int[] roiY, ByteBuffer mask) {
+        if (imageWidth < 0 || imageHeight < 0) {
+            throw new IllegalArgumentException(
+                "height and width must be >= 0");
+        }
+        if (imageStride < imageWidth) {
+            throw new IllegalArgumentException("imageStride must be >= width");
+        }
+        if (roiX == null || roiY == null) {
+            throw new NullPointerException("roiX and roiY cannot be null");
+        }
+        if (roiX.length != roiY.length) {
+            throw new IllegalArgumentException(
+                "roiX and roiY must have the same length");
+        }
+        for (int i = 0; i < roiX.length; i++) {
+            if (roiX[i] < 0 || roiY[i] < 0 ||
+                (long)roiX[i] + width > imageWidth ||
+                (long)roiY[i] + height > imageHeight) {
+                throw new IllegalArgumentException("ROI exceeds image bounds");
+            }
+        }
+        long size = imageWidth > 0 && imageHeight > 0
+                        ? ((long)(imageHeight - 1) * imageStride +
+                           imageWidth) * nComponents
+                        : 0;
+        checkBuffer(image, size, "image");
+        if (mask != null) {
+            checkBuffer(mask, maskSize(), "mask");
+        }
+    }
+
+    private long maskSize() {
+        return width > 0 && height > 0
+            ? (long)(height - 1) * maskStride + width
+            : 0;
+    }
+
+    private static void checkBuffer(Buffer buffer, long size, String name) {
+        if (buffer == null) {
+            throw new NullPointerException(name + " buffer cannot be null");
+        }
+        if (buffer.remaining() != size) {
+            throw new IllegalArgumentException(
+                name + " buffer has incorrect size " + buffer.remaining() +
+                " (expected " + size + ")");
+        }
+        if (!buffer.isDirect() && !buffer.hasArray()) {
+            throw new IllegalArgumentException(
+                name + " buffer must be direct or array-backed");
+        }
+    }
+
+    // Zero the output (if not accumulating) without allocating. A histogram
+    // buffer of the wrong size or type is left alone for the native code to
+    // reject.
+    private void clearOutput(IntBuffer histograms, int nHistograms) {
+        if (histograms == null) {
+            throw new NullPointerException("histogram buffer cannot be null");
+        }
+        long size = (long)nHistograms * histogramSize();
+        if (accumulate || histograms.isReadOnly() ||
+            histograms.remaining() != size) {
+            return;
+        }
+        int pos = histograms.position();
+        if (histograms.hasArray()) {
+            int offset = histograms.arrayOffset() + pos;
+            Arrays.fill(histograms.array(), offset, offset + (int)size, 0);
+        } else {
+            for (int i = 0; i < size; i++) {
+                histograms.put(pos + i, 0);
+            }
+        }
+    }
+
+    private static int[] defaultComponentIndices(int n) {
+        int[] indices = new int[n];
+        for (int i = 0; i < n; i++) {
+            indices[i] = i;
+        }
+        return indices;
+    }
+}
@@ -0,0 +1,109 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import java.nio.IntBuffer;
+
+/**
+ * Histogram stored as its nonzero bins only, as computed by
+ * {@link HistogramRequest#computeSparse()}.
+ *
+ * <p>
+ * For each histogrammed component, the nonzero bins are stored in
+ * increasing order of bin value. For small regions of 16-bit images, which
+ * occupy few of the 65536 bins, this is much smaller than the dense
+ * histogram and can be iterated without scanning empty bins:
+ *
+ * <pre>{@code
+ * SparseHistogram sparse = HistogramRequest.forImage(image, width, height)
+ *         .roi(x, y, 32, 32)
+ *         .computeSparse();
+ * for (int i = 0; i < sparse.nonzeroCount(0); ++i) {
+ *     int bin = sparse.bin(0, i);
+ *     long count = sparse.count(0, i);
+ * }
+ * }</pre>
+ */
+public final class SparseHistogram {
+
+    private final int sampleBits;
+    private final short[] bins;
+    private final int[] counts;
+    private final int[] starts; // Per component, plus total at end
+
+    SparseHistogram(int sampleBits, short[] bins, int[] counts,
+                    int[] nonzeroCounts) {
+        this.sampleBits = sampleBits;
+        this.bins = bins;
+        this.counts = counts;
+        this.starts = new int[nonzeroCounts.length + 1];
+        for (int c = 0; c < nonzeroCounts.length; ++c) {
+            starts[c + 1] = starts[c] + nonzeroCounts[c];
+        }
+    }
+
+    /**
+     * @return number of bits per sample; the dense histogram of each
+     *         component has 2^sampleBits bins
+     */
+    public int sampleBits() { return sampleBits; }
+
+    /**
+     * @return number of histogrammed components
+     */
+    public int componentCount() { return starts.length - 1; }
+
+    /**
+     * @param component index of the histogrammed component
+     * @return number of nonzero bins of the component
+     */
+    public int nonzeroCount(int component) {
+        return starts[component + 1] - starts[component];
+    }
+
+    /**
+     * @param component index of the histogrammed component
+     * @param i         index among the component's nonzero bins
+     * @return the bin value (sample value), in the range [0, 2^sampleBits)
+     */
+    public int bin(int component, int i) {
+        return Short.toUnsignedInt(bins[entry(component, i)]);
+    }
+
+    /**
+     * @param component index of the histogrammed component
+     * @param i         index among the component's nonzero bins
+     * @return the (unsigned 32-bit) count of the bin
+     */
+    public long count(int component, int i) {
+        return Integer.toUnsignedLong(counts[entry(component, i)]);
+    }
+
+    /**
+     * Expand to a dense histogram.
+     *
+     * @return buffer of componentCount() * 2^sampleBits counts, in the layout
+     *         returned by {@link HistogramRequest#compute()}
+     */
+    public IntBuffer toDense() {
+        int nBins = 1 << sampleBits;
+        int[] dense = new int[componentCount() * nBins];
+        for (int c = 0; c < componentCount(); ++c) {
+            for (int k = starts[c]; k < starts[c + 1]; ++k) {
+                dense[c * nBins + Short.toUnsignedInt(bins[k])] = counts[k];
+            }
+        }
+        return IntBuffer.wrap(dense);
+    }
+
+    private int entry(int component, int i) {
+        if (i < 0 || i >= nonzeroCount(component)) {
+            throw new IndexOutOfBoundsException(
+                "Index " + i + " out of range [0, " +
+                nonzeroCount(component) + ")");
+        }
+        return starts[component] + i;
+    }
+}
@@ -0,0 +1,253 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import static java.lang.foreign.ValueLayout.ADDRESS;
+import static java.lang.foreign.ValueLayout.JAVA_BOOLEAN;
+import static java.lang.foreign.ValueLayout.JAVA_INT;
+
+import java.lang.foreign.Arena;
+import java.lang.foreign.FunctionDescriptor;
+import java.lang.foreign.Linker;
+import java.lang.foreign.MemorySegment;
+import java.lang.foreign.SymbolLookup;
+import java.lang.invoke.MethodHandle;
+import java.nio.Buffer;
+import java.nio.ByteBuffer;
+import java.nio.IntBuffer;
+import java.nio.ShortBuffer;
+
+/**
+ * Backend calling the native library through the Foreign Function &amp;
+ * Memory API (JDK 22+).
+ *
+ * <p>
+ * This class is compiled for Java 22 (from {@code src/main/java22}) and is
+ * only loaded, reflectively, by {@link NativeBackend}. Arguments are
+ * validated here (with the same messages as the JNI code); the native entry
+ * points ({@code ihistj_ffm_hist8_2d} and {@code ihistj_ffm_hist16_2d} in
+ * the JNI library) trust them.
+ *
+ * <p>
+ * Buffers are passed as {@link MemorySegment}s over their remaining
+ * elements. Heap segments can only be passed to "critical" downcalls, which,
+ * like JNI critical array access, hold off garbage collection for the
+ * duration of the call; we also use critical downcalls for small images,
+ * where they avoid the thread state transition. Large images in direct
+ * buffers use ordinary downcalls so that garbage collection can proceed, and
+ * large images on the heap are histogrammed in bands of rows, one critical
+ * downcall each (as in the JNI code).
+ */
+final class FfmBackend extends NativeBackend {
+
+    // Matches the parallelization threshold of the C library; below this,
+    // calls are short enough that blocking GC does not matter.
+    private static final long CRITICAL_MAX_PIXELS = 1L << 20;
+
+    // Band size for heap images (critical_band_pixels in ihistj_jni.cpp).
+    private static final long BAND_PIXELS = 1L << 22;
+
+    private static final FunctionDescriptor DESCRIPTOR =
+        FunctionDescriptor.ofVoid(JAVA_INT, ADDRESS, ADDRESS, JAVA_INT,
+                                  JAVA_INT, JAVA_INT, JAVA_INT, JAVA_INT,
+                                  JAVA_INT, ADDRESS, ADDRESS, JAVA_BOOLEAN);
+
+    private final MethodHandle hist8;
+    private final MethodHandle hist8Critical;
+    private final MethodHandle hist16;
+    private final MethodHandle hist16Critical;
+
+    static boolean isNativeAccessEnabled() {
+        return FfmBackend.class.getModule().isNativeAccessEnabled();
+    }
+
+    FfmBackend() {
+        IHistNative.loadNativeLibrary();
+        Linker linker = Linker.nativeLinker();
+        SymbolLookup lookup = SymbolLookup.loaderLookup();
+        MemorySegment sym8 =
+            lookup.find("ihistj_ffm_hist8_2d").orElseThrow();
+        MemorySegment sym16 =
+            lookup.find("ihistj_ffm_hist16_2d").orElseThrow();
+        Linker.Option critical = Linker.Option.critical(true);
+        hist8 = linker.downcallHandle(sym8, DESCRIPTOR);
+        hist8Critical = linker.downcallHandle(sym8, DESCRIPTOR, critical);
+        hist16 = linker.downcallHandle(sym16, DESCRIPTOR);
+        hist16Critical = linker.downcallHandle(sym16, DESCRIPTOR, critical);
+    }
+
+    @Override
+    String name() {
+        return "ffm";
+    }
+
+    @Override
+    void histogram8(int sampleBits, ByteBuffer image, ByteBuffer mask,
+                    int height, int width, int imageStride, int maskStride,
+                    int nComponents, int[] componentIndices,
+                    IntBuffer histogram, boolean parallel) {
+        histogram(8, hist8, hist8Critical, sampleBits, image, mask, height,
+                  width, imageStride, maskStride, nComponents,
+                  componentIndices, histogram, parallel);
+    }
+
+    @Override
+    void histogram16(int sampleBits, ShortBuffer image, ByteBuffer mask,
+                     int height, int width, int imageStride, int maskStride,
+                     int nComponents, int[] componentIndices,
+                     IntBuffer histogram, boolean parallel) {
+        histogram(16, hist16, hist16Critical, sampleBits, image, mask, height,
+                  width, imageStride, maskStride, nComponents,
+                  componentIndices, histogram, parallel);
+    }
+
+    private static void
+    histogram(int maxBits, MethodHandle handle, MethodHandle criticalHandle,
+              int sampleBits, Buffer image, ByteBuffer mask, int height,
+              int width, int imageStride, int maskStride, int nComponents,
+              int[] componentIndices, IntBuffer histogram, boolean parallel) {
+        validateParams(maxBits, sampleBits, height, width, imageStride,
+                       maskStride, mask != null, nComponents,
+                       componentIndices);
+        for (int idx : componentIndices) {
+            if (idx < 0) {
+                throw new IllegalArgumentException(
+                    "component index cannot be negative");
+            }
+            if (idx >= nComponents) {
+                throw new IllegalArgumentException(
+                    "component index out of range [0, nComponents)");
+            }
+        }
+        int nHist = componentIndices.length;
+        if (nHist == 0) {
+            return;
+        }
+        if (image == null) {
+            throw new NullPointerException("image buffer cannot be null");
+        }
+        if (histogram == null) {
+            throw new NullPointerException("histogram buffer cannot be null");
+        }
+
+        long pixels = (long)height * width;
+        long imageRequired =
+            pixels > 0 ? ((long)(height - 1) * imageStride + width) *
+                             nComponents
+                       : 0;
+        long maskRequired =
+            pixels > 0 ? (long)(height - 1) * maskStride + width : 0;
+        long histRequired = (long)nHist << sampleBits;
+
+        checkRemaining(image, imageRequired, "image");
+        if (mask != null) {
+            checkRemaining(mask, maskRequired, "mask");
+        }
+        if (histogram.isReadOnly()) {
+            throw new IllegalArgumentException(
+                "histogram buffer cannot be read-only");
+        }
+        checkRemaining(histogram, histRequired, "histogram");
+
+        MemorySegment imageSeg = MemorySegment.ofBuffer(image);
+        MemorySegment maskSeg =
+            mask != null ? MemorySegment.ofBuffer(mask) : MemorySegment.NULL;
+        MemorySegment histSeg = MemorySegment.ofBuffer(histogram);
+
+        boolean onHeap = !imageSeg.isNative() || !maskSeg.isNative() ||
+                         !histSeg.isNative();
+        try {
+            if (onHeap && pixels > BAND_PIXELS) {
+                long elementSize = maxBits / 8;
+                int bandRows = (int)Math.max(1, BAND_PIXELS / width);
+                MemorySegment indicesSeg =
+                    MemorySegment.ofArray(componentIndices);
+                for (int row = 0; row < height; row += bandRows) {
+                    int rows = Math.min(bandRows, height - row);
+                    MemorySegment imageBand = imageSeg.asSlice(
+                        (long)row * imageStride * nComponents * elementSize,
+                        ((long)(rows - 1) * imageStride + width) *
+                            nComponents * elementSize);
+                    MemorySegment maskBand =
+                        mask == null
+                            ? MemorySegment.NULL
+                            : maskSeg.asSlice(
+                                  (long)row * maskStride,
+                                  (long)(rows - 1) * maskStride + width);
+                    criticalHandle.invokeExact(
+                        sampleBits, imageBand, maskBand, rows, width,
+                        imageStride, maskStride, nComponents, nHist,
+                        indicesSeg, histSeg, parallel);
+                }
+            } else if (onHeap || pixels < CRITICAL_MAX_PIXELS) {
+                criticalHandle.invokeExact(
+                    sampleBits, imageSeg, maskSeg, height, width, imageStride,
+                    maskStride, nComponents, nHist,
+                    MemorySegment.ofArray(componentIndices), histSeg,
+                    parallel);
+            } else {
+                try (Arena arena = Arena.ofConfined()) {
+                    MemorySegment indicesSeg =
+                        arena.allocateFrom(JAVA_INT, componentIndices);
+                    handle.invokeExact(sampleBits, imageSeg, maskSeg, height,
+                                       width, imageStride, maskStride,
+                                       nComponents, nHist, indicesSeg,
+                                       histSeg, parallel);
+                }
+            }
+        } catch (RuntimeException | Error e) {
+            throw e;
+        } catch (Throwable t) {
+            throw new AssertionError(t);
+        }
+    }
+
+    private static void validateParams(int maxBits, int sampleBits,
+                                       int height, int width, int imageStride,
+                                       int maskStride, boolean hasMask,
+                                       int nComponents,
+                                       int[] componentIndices) {
+        if (sampleBits < 0 || sampleBits > maxBits) {
+            throw new IllegalArgumentException(
+                "sampleBits must be in range [0, " + maxBits + "] for " +
+                maxBits + "-bit");
+        }
+        if (height < 0 || width < 0) {
+            throw new IllegalArgumentException(
+                "height and width must be >= 0");
+        }
+        if ((long)width * height > Integer.MAX_VALUE) {
+            throw new IllegalArgumentException(
+                "width * height must not exceed Integer.MAX_VALUE");
+        }
+        if (imageStride < width) {
+            throw new IllegalArgumentException("imageStride must be >= width");
+        }
+        if (hasMask) {
+            if (maskStride < width) {
+                throw new IllegalArgumentException(
+                    "maskStride must be >= width");
+            }
+        } else if (maskStride != 0) {
+            throw new IllegalArgumentException(
+                "maskStride must be 0 when mask is null");
+        }
+        if (nComponents < 0) {
+            throw new IllegalArgumentException("nComponents must be >= 0");
+        }
+        if (componentIndices == null) {
+            throw new NullPointerException("componentIndices cannot be null");
+        }
+    }
+
+    private static void checkRemaining(Buffer buffer, long required,
+                                       String name) {
+        if (buffer.remaining() != required) {
+            throw new IllegalArgumentException(
+                name + " buffer has incorrect size " + buffer.remaining() +
+                " (expected " + required + ")");
+        }
+    }
+}
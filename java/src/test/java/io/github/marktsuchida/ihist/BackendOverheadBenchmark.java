@@ -0,0 +1,86 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Random;
+
+/**
+ * Per-call time of the JNI and FFM backends, for small to medium 8-bit
+ * images in heap and direct buffers.
+ *
+ * <p>
+ * Not a unit test; run with {@code just java-bench-backends} (which uses JDK
+ * 22+ so that the FFM backend is available). For small images, the
+ * difference between the backends is the per-call overhead.
+ */
+final class BackendOverheadBenchmark {
+
+    private BackendOverheadBenchmark() {}
+
+    private static final int[] SIZES = {1, 8, 32, 128, 512};
+    private static final long MIN_NANOS = 300_000_000L;
+
+    public static void main(String[] args) {
+        List<NativeBackend> backends = new ArrayList<>();
+        backends.add(NativeBackend.jni());
+        NativeBackend ffm = NativeBackend.ffm(false);
+        if (ffm != null) {
+            backends.add(ffm);
+        } else {
+            System.out.println("FFM backend not available (needs JDK 22+)");
+        }
+
+        System.out.printf("%-8s %-6s %-8s %12s%n", "size", "buffer",
+                          "backend", "ns/call");
+        Random rng = new Random(0);
+        for (int size : SIZES) {
+            byte[] pixels = new byte[size * size];
+            rng.nextBytes(pixels);
+            ByteBuffer direct = ByteBuffer.allocateDirect(pixels.length);
+            direct.put(pixels);
+            ((java.nio.Buffer)direct).flip();
+            IntBuffer directHist = ByteBuffer.allocateDirect(256 * 4)
+                                       .order(ByteOrder.nativeOrder())
+                                       .asIntBuffer();
+
+            for (boolean isDirect : new boolean[] {false, true}) {
+                ByteBuffer image = isDirect ? direct : ByteBuffer.wrap(pixels);
+                IntBuffer hist =
+                    isDirect ? directHist : IntBuffer.allocate(256);
+                for (NativeBackend backend : backends) {
+                    double ns = timePerCall(backend, image, hist, size);
+                    System.out.printf("%-8s %-6s %-8s %12.1f%n",
+                                      size + "x" + size,
+                                      isDirect ? "direct" : "heap",
+                                      backend.name(), ns);
+                }
+            }
+        }
+    }
+
+    private static double timePerCall(NativeBackend backend, ByteBuffer image,
+                                      IntBuffer hist, int size) {
+        int[] indices = {0};
+        long iterations = 1;
+        // Warm up (JIT compilation) and find the iteration count.
+        while (true) {
+            long start = System.nanoTime();
+            for (long i = 0; i < iterations; ++i) {
+                backend.histogram8(8, image, null, size, size, size, 0, 1,
+                                   indices, hist, false);
+            }
+            long elapsed = System.nanoTime() - start;
+            if (elapsed >= MIN_NANOS) {
+                return (double)elapsed / iterations;
+            }
+            iterations *= 2;
+        }
+    }
+}
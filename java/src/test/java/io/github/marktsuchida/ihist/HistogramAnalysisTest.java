@@ -0,0 +1,165 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import static org.junit.jupiter.api.Assertions.*;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import org.junit.jupiter.api.*;
+
+/**
+ * Tests for {@link HistogramAnalysis}.
+ */
+class HistogramAnalysisTest {
+
+    @BeforeAll
+    static void loadLibrary() {
+        IHistNative.loadNativeLibrary();
+    }
+
+    @Test
+    void cumsum() {
+        IntBuffer hist = IntBuffer.wrap(new int[] {1, 2, 0, 3, 4, 0, 0, 1});
+        long[] cumsum = HistogramAnalysis.cumsum(hist, 2);
+        assertArrayEquals(new long[] {1, 3, 3, 6, 4, 4, 4, 5}, cumsum);
+    }
+
+    @Test
+    void quantilesOfImage() {
+        byte[] image = new byte[100];
+        for (int i = 0; i < image.length; ++i) {
+            image[i] = (byte)(i + 10);
+        }
+        IntBuffer hist = HistogramRequest.forImage(image, 100, 1).compute();
+        int[] values =
+            HistogramAnalysis.quantiles(hist, 8, 0.0, 0.5, 0.99, 1.0);
+        assertArrayEquals(new int[] {10, 59, 108, 109}, values);
+    }
+
+    @Test
+    void quantilesPerComponent() {
+        int[] data = new int[2 * 16];
+        data[3] = 4;
+        data[16 + 8] = 1;
+        data[16 + 12] = 1;
+        int[] values =
+            HistogramAnalysis.quantiles(IntBuffer.wrap(data), 4, 0.5, 1.0);
+        assertArrayEquals(new int[] {3, 3, 8, 12}, values);
+    }
+
+    @Test
+    void quantileOutOfRange() {
+        IntBuffer hist = IntBuffer.allocate(256);
+        assertThrows(IllegalArgumentException.class,
+                     () -> HistogramAnalysis.quantiles(hist, 8, 1.5));
+    }
+
+    @Test
+    void otsuThresholdOfBimodal() {
+        int[] data = new int[256];
+        data[10] = 100;
+        data[200] = 100;
+        int[] thresholds =
+            HistogramAnalysis.otsuThresholds(IntBuffer.wrap(data), 8);
+        assertEquals(1, thresholds.length);
+        assertTrue(thresholds[0] >= 10 && thresholds[0] < 200);
+    }
+
+    @Test
+    void entropy() {
+        int[] data = new int[2 * 256];
+        for (int i = 0; i < 256; ++i) {
+            data[i] = 7;
+        }
+        double[] entropy = HistogramAnalysis.entropy(IntBuffer.wrap(data), 8);
+        assertEquals(8.0, entropy[0], 1e-12);
+        assertTrue(Double.isNaN(entropy[1]));
+    }
+
+    @Test
+    void modes() {
+        int[] data = new int[16];
+        data[5] = 3;
+        data[9] = 3;
+        assertArrayEquals(new int[] {5},
+                          HistogramAnalysis.modes(IntBuffer.wrap(data), 4));
+    }
+
+    @Test
+    void directBufferWithPosition() {
+        IntBuffer hist = ByteBuffer.allocateDirect(4 * 20)
+                             .order(ByteOrder.nativeOrder())
+                             .asIntBuffer();
+        hist.put(4 + 7, 2);
+        hist.position(4);
+        assertArrayEquals(new int[] {7}, HistogramAnalysis.modes(hist, 4));
+        assertEquals(4, hist.position());
+    }
+
+    @Test
+    void viewBuffer() {
+        // A read-only view of a heap buffer has no accessible array.
+        IntBuffer hist =
+            IntBuffer.wrap(new int[16]).put(2, 5).asReadOnlyBuffer();
+        assertArrayEquals(new int[] {2}, HistogramAnalysis.modes(hist, 4));
+    }
+
+    @Test
+    void sizeNotMultipleOfBins() {
+        IntBuffer hist = IntBuffer.allocate(300);
+        assertThrows(IllegalArgumentException.class,
+                     () -> HistogramAnalysis.entropy(hist, 8));
+    }
+
+    @Test
+    void distanceOfDisjointHistograms() {
+        int[] a = new int[16];
+        int[] b = new int[16];
+        a[2] = 10;
+        b[5] = 10;
+        IntBuffer ha = IntBuffer.wrap(a);
+        IntBuffer hb = IntBuffer.wrap(b);
+        assertArrayEquals(
+            new double[] {2.0},
+            HistogramAnalysis.distance(ha, hb, 4, DistanceMetric.CHI_SQUARE));
+        assertArrayEquals(
+            new double[] {3.0},
+            HistogramAnalysis.distance(ha, hb, 4, DistanceMetric.EMD));
+        assertTrue(Double.isInfinite(HistogramAnalysis.distance(
+            ha, hb, 4, DistanceMetric.KL_DIVERGENCE)[0]));
+        assertEquals(0.0,
+                     HistogramAnalysis.distance(
+                         ha, ha, 4, DistanceMetric.INTERSECTION)[0],
+                     1e-12);
+    }
+
+    @Test
+    void batchDistances() {
+        int[] query = new int[2 * 16];
+        query[1] = 5;
+        query[16 + 3] = 5;
+        int[] refs = new int[3 * 2 * 16];
+        for (int r = 0; r < 3; ++r) {
+            refs[r * 32 + 1 + r] = 4;
+            refs[r * 32 + 16 + 3] = 2;
+        }
+        double[] dist = HistogramAnalysis.distances(
+            IntBuffer.wrap(query), IntBuffer.wrap(refs), 4,
+            DistanceMetric.EMD);
+        assertArrayEquals(new double[] {0, 0, 1, 0, 2, 0}, dist, 1e-12);
+    }
+
+    @Test
+    void batchSizeMismatch() {
+        IntBuffer query = IntBuffer.allocate(16);
+        IntBuffer refs = IntBuffer.allocate(40);
+        assertThrows(IllegalArgumentException.class,
+                     ()
+                         -> HistogramAnalysis.distances(
+                             query, refs, 4, DistanceMetric.BHATTACHARYYA));
+    }
+}
@@ -0,0 +1,170 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import static org.junit.jupiter.api.Assertions.*;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import org.junit.jupiter.api.*;
+
+/**
+ * Tests for {@link HistogramSeriesReader}, using files assembled here
+ * according to the format description in README.md.
+ */
+class HistogramSeriesReaderTest {
+
+    private Path path;
+
+    @BeforeEach
+    void createFile() throws IOException {
+        path = Files.createTempFile("ihist-series-test", ".ihs");
+    }
+
+    @AfterEach
+    void deleteFile() throws IOException {
+        Files.deleteIfExists(path);
+    }
+
+    // Histograms of 2 components of 2 bits (8 counts).
+    private static final int[][] FRAMES = {
+        {1, 0, 0, 0, 0, 0, 0, 5},
+        {1, 0, 0, 0, 0, 0, 0, 5},
+        {0, 2, 0, 0, 0, 0, 0, -1},
+        {300, 2, 0, 0, 0, 0, 0, 0},
+        {300, 2, 0, 0, 0, 0, 200000, 0},
+    };
+
+    private static byte[] le(long v, int nBytes) {
+        byte[] b = new byte[nBytes];
+        for (int i = 0; i < nBytes; ++i) {
+            b[i] = (byte)(v >>> (8 * i));
+        }
+        return b;
+    }
+
+    private static void varint(ByteArrayOutputStream out, long v) {
+        while ((v & ~0x7fL) != 0) {
+            out.write((int)(v & 0x7f) | 0x80);
+            v >>>= 7;
+        }
+        out.write((int)v);
+    }
+
+    private static byte[] encode(int[] previous, int[] histogram) {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        int next = 0;
+        for (int i = 0; i < histogram.length; ++i) {
+            long prev =
+                previous == null ? 0 : Integer.toUnsignedLong(previous[i]);
+            long d = Integer.toUnsignedLong(histogram[i]) - prev;
+            if (d != 0) {
+                varint(out, i - next);
+                varint(out, (d << 1) ^ (d >> 63));
+                next = i + 1;
+            }
+        }
+        return out.toByteArray();
+    }
+
+    // Write FRAMES with the given keyframe interval; returns the offset of
+    // the index (the file size if withIndex is false).
+    private long writeSeries(int keyframeInterval, boolean withIndex)
+        throws IOException {
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        out.write("IHSERIES".getBytes(StandardCharsets.US_ASCII));
+        out.write(le(1, 4));
+        out.write(le(2, 4));
+        out.write(le(2, 4));
+        out.write(le(keyframeInterval, 4));
+        out.write(le(0, 8));
+        List<Long> offsets = new ArrayList<>();
+        for (int f = 0; f < FRAMES.length; ++f) {
+            boolean key = f % keyframeInterval == 0;
+            byte[] rec = encode(key ? null : FRAMES[f - 1], FRAMES[f]);
+            offsets.add((long)out.size());
+            out.write(le(rec.length, 4));
+            out.write(rec);
+        }
+        long indexOffset = out.size();
+        if (withIndex) {
+            for (long off : offsets) {
+                out.write(le(off, 8));
+            }
+            out.write(le(indexOffset, 8));
+            out.write(le(offsets.size(), 8));
+            out.write("IHSINDEX".getBytes(StandardCharsets.US_ASCII));
+        }
+        Files.write(path, out.toByteArray());
+        return indexOffset;
+    }
+
+    private static int[] toArray(IntBuffer buf) {
+        int[] a = new int[buf.remaining()];
+        buf.get(a);
+        return a;
+    }
+
+    @Test
+    void readInAnyOrder() throws IOException {
+        for (int interval : new int[] {1, 2, 64}) {
+            writeSeries(interval, true);
+            try (HistogramSeriesReader r = HistogramSeriesReader.open(path)) {
+                assertEquals(2, r.sampleBits());
+                assertEquals(2, r.componentCount());
+                assertEquals(FRAMES.length, r.frameCount());
+                for (int f : new int[] {0, 1, 2, 3, 4, 4, 2, 0, 3}) {
+                    assertArrayEquals(FRAMES[f], toArray(r.read(f)),
+                                      "interval " + interval + " frame " + f);
+                }
+                assertThrows(IndexOutOfBoundsException.class,
+                             () -> r.read(FRAMES.length));
+            }
+        }
+    }
+
+    @Test
+    void readUnclosedFile() throws IOException {
+        long size = writeSeries(2, false);
+        // Truncate the last record.
+        byte[] data = Files.readAllBytes(path);
+        Files.write(path, Arrays.copyOf(data, (int)size - 1));
+        try (HistogramSeriesReader r = HistogramSeriesReader.open(path)) {
+            assertEquals(FRAMES.length - 1, r.frameCount());
+            for (int f = 0; f < FRAMES.length - 1; ++f) {
+                assertArrayEquals(FRAMES[f], toArray(r.read(f)));
+            }
+        }
+    }
+
+    @Test
+    void rejectOtherFiles() throws IOException {
+        Files.write(path, new byte[100]);
+        assertThrows(IOException.class,
+                     () -> HistogramSeriesReader.open(path));
+    }
+
+    @Test
+    void rejectCorruptRecord() throws IOException {
+        writeSeries(64, true);
+        ByteBuffer data = ByteBuffer.wrap(Files.readAllBytes(path))
+                              .order(ByteOrder.LITTLE_ENDIAN);
+        // First record, first gap: point past the end.
+        data.put(32 + 4, (byte)8);
+        Files.write(path, data.array());
+        try (HistogramSeriesReader r = HistogramSeriesReader.open(path)) {
+            assertThrows(IOException.class, () -> r.read(0));
+        }
+    }
+}
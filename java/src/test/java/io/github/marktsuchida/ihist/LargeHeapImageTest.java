@@ -0,0 +1,130 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import static org.junit.jupiter.api.Assertions.*;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import java.util.Arrays;
+import java.util.Random;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicLong;
+import org.junit.jupiter.api.*;
+
+// Images in Java arrays above 4 Mpixels are histogrammed in bands of rows,
+// each accessed (as a critical region, which can block GC) separately.
+
+class LargeHeapImageTest {
+
+    @Test
+    void bandedMatchesDirect() {
+        int width = 1501; // Bands do not divide height evenly.
+        int height = 4000;
+        int stride = 1530;
+        int nComponents = 3;
+        Random rng = new Random(1);
+        byte[] pixels = new byte[height * stride * nComponents];
+        rng.nextBytes(pixels);
+        byte[] maskBytes = new byte[height * width];
+        for (int i = 0; i < maskBytes.length; ++i) {
+            maskBytes[i] = (byte)(rng.nextInt(4) == 0 ? 0 : 1);
+        }
+        ByteBuffer directPixels = ByteBuffer.allocateDirect(pixels.length);
+        directPixels.put(pixels);
+        ByteBuffer directMask = ByteBuffer.allocateDirect(maskBytes.length);
+        directMask.put(maskBytes);
+
+        int[] initial = new int[2 * 256];
+        Arrays.fill(initial, 7);
+        int[] heapHist = initial.clone();
+        IntBuffer directHist = ByteBuffer.allocateDirect(initial.length * 4)
+                                   .order(ByteOrder.nativeOrder())
+                                   .asIntBuffer();
+        directHist.put(initial);
+        directHist.rewind();
+
+        HistogramRequest.forImage(pixels, stride, height, nComponents)
+            .roi(0, 0, width, height)
+            .mask(maskBytes, width, height)
+            .selectComponents(2, 0)
+            .output(heapHist)
+            .accumulate(true)
+            .compute();
+        HistogramRequest
+            .forImage((ByteBuffer)directPixels.rewind(), stride, height,
+                      nComponents)
+            .roi(0, 0, width, height)
+            .mask((ByteBuffer)directMask.rewind(), width, height)
+            .selectComponents(2, 0)
+            .output(directHist)
+            .accumulate(true)
+            .compute();
+
+        int[] expected = new int[initial.length];
+        directHist.get(expected);
+        assertArrayEquals(expected, heapHist);
+        long total = 0;
+        for (int c : heapHist) {
+            total += c;
+        }
+        long masked = 0;
+        for (byte m : maskBytes) {
+            masked += m;
+        }
+        assertEquals(2 * masked + initial.length * 7L, total);
+    }
+
+    @Test
+    void gcProceedsDuringLargeHeapImage() throws Exception {
+        int width = 8192;
+        int height = 8192;
+        short[] image = new short[width * height];
+        Random rng = new Random(2);
+        for (int i = 0; i < image.length; ++i) {
+            image[i] = (short)rng.nextInt();
+        }
+
+        CountDownLatch started = new CountDownLatch(1);
+        AtomicBoolean done = new AtomicBoolean();
+        AtomicLong callNanos = new AtomicLong();
+        Thread worker = new Thread(() -> {
+            started.countDown();
+            long t0 = System.nanoTime();
+            HistogramRequest.forImage(image, width, height)
+                .parallel(false)
+                .compute();
+            callNanos.set(System.nanoTime() - t0);
+            done.set(true);
+        });
+        worker.start();
+        started.await();
+
+        // Each System.gc() must wait for any critical region to be exited.
+        // If the whole image were held as one, at most one GC could complete
+        // during the call (before the region is entered).
+        int gcsDuringCall = 0;
+        long maxGcNanos = 0;
+        while (!done.get()) {
+            long t0 = System.nanoTime();
+            System.gc();
+            long elapsed = System.nanoTime() - t0;
+            if (!done.get()) {
+                ++gcsDuringCall;
+                maxGcNanos = Math.max(maxGcNanos, elapsed);
+            }
+        }
+        worker.join();
+
+        assertTrue(gcsDuringCall >= 2,
+                   "only " + gcsDuringCall + " GCs during " +
+                       callNanos.get() / 1000000 + " ms histogram");
+        assertTrue(maxGcNanos < callNanos.get() * 3 / 4,
+                   "GC took up to " + maxGcNanos / 1000000 + " ms during " +
+                       callNanos.get() / 1000000 + " ms histogram");
+    }
+}
@@ -0,0 +1,181 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import static org.junit.jupiter.api.Assertions.*;
+import static org.junit.jupiter.api.Assumptions.*;
+
+import java.nio.Buffer;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import java.nio.ShortBuffer;
+import java.util.Random;
+import org.junit.jupiter.api.*;
+
+// The FFM backend is only available when the tests run on JDK 22+; these
+// tests are skipped otherwise.
+
+class NativeBackendTest {
+
+    @Test
+    void selection() {
+        NativeBackend ffm = NativeBackend.ffm(true);
+        String expected = ffm != null ? "ffm" : "jni";
+        String requested = System.getProperty(NativeBackend.PROPERTY, "");
+        if (!requested.isEmpty()) {
+            expected = requested;
+        }
+        assertEquals(expected, NativeBackend.get().name());
+        assertEquals("jni", NativeBackend.jni().name());
+    }
+
+    @Test
+    void ffmMatchesJni() {
+        NativeBackend ffm = NativeBackend.ffm(false);
+        assumeTrue(ffm != null, "FFM backend not available");
+        NativeBackend jni = NativeBackend.jni();
+
+        Random rng = new Random(42);
+        int width = 37;
+        int height = 23;
+        int stride = 41;
+        int nComponents = 3;
+        int[] indices = {2, 0};
+        short[] pixels = new short[height * stride * nComponents];
+        byte[] maskBytes = new byte[height * width];
+        for (int i = 0; i < pixels.length; ++i) {
+            pixels[i] = (short)rng.nextInt(4096);
+        }
+        for (int i = 0; i < maskBytes.length; ++i) {
+            maskBytes[i] = (byte)rng.nextInt(2);
+        }
+        int imageSize = ((height - 1) * stride + width) * nComponents;
+
+        for (int bits : new int[] {8, 12, 16}) {
+            for (ByteBuffer mask :
+                 new ByteBuffer[] {null, ByteBuffer.wrap(maskBytes)}) {
+                int maskStride = mask != null ? width : 0;
+                ShortBuffer image = ShortBuffer.wrap(pixels, 0, imageSize);
+                int[] expected = new int[indices.length << bits];
+                int[] actual = new int[indices.length << bits];
+                jni.histogram16(bits, image.slice(), mask, height, width,
+                                stride, maskStride, nComponents, indices,
+                                IntBuffer.wrap(expected), false);
+                ffm.histogram16(bits, image.slice(), mask, height, width,
+                                stride, maskStride, nComponents, indices,
+                                IntBuffer.wrap(actual), false);
+                assertArrayEquals(expected, actual,
+                                  "bits " + bits + ", mask " + (mask != null));
+            }
+        }
+    }
+
+    @Test
+    void ffmAcceptsHeapViewBuffers() {
+        NativeBackend ffm = NativeBackend.ffm(false);
+        assumeTrue(ffm != null, "FFM backend not available");
+
+        // Not usable with JNI (hasArray() is false), but fine with FFM.
+        ByteBuffer bytes =
+            ByteBuffer.allocate(6).order(ByteOrder.nativeOrder());
+        bytes.putShort((short)1).putShort((short)1).putShort((short)3);
+        ((Buffer)bytes).flip();
+        ShortBuffer image = bytes.asShortBuffer().asReadOnlyBuffer();
+        int[] hist = new int[4];
+        ffm.histogram16(2, image, null, 1, 3, 3, 0, 1, new int[] {0},
+                        IntBuffer.wrap(hist), false);
+        assertArrayEquals(new int[] {0, 2, 0, 1}, hist);
+    }
+
+    @Test
+    void ffmValidation() {
+        NativeBackend ffm = NativeBackend.ffm(false);
+        assumeTrue(ffm != null, "FFM backend not available");
+        NativeBackend jni = NativeBackend.jni();
+
+        for (NativeBackend backend : new NativeBackend[] {jni, ffm}) {
+            ByteBuffer image = ByteBuffer.allocate(4);
+            assertThrows(IllegalArgumentException.class,
+                         ()
+                             -> backend.histogram8(9, image, null, 1, 4, 4, 0,
+                                                   1, new int[] {0},
+                                                   IntBuffer.allocate(512),
+                                                   false));
+            assertThrows(IllegalArgumentException.class,
+                         ()
+                             -> backend.histogram8(8, image, null, 1, 4, 4, 0,
+                                                   1, new int[] {1},
+                                                   IntBuffer.allocate(256),
+                                                   false));
+            assertThrows(IllegalArgumentException.class,
+                         ()
+                             -> backend.histogram8(8, image, null, 1, 5, 5, 0,
+                                                   1, new int[] {0},
+                                                   IntBuffer.allocate(256),
+                                                   false));
+            assertThrows(IllegalArgumentException.class,
+                         ()
+                             -> backend.histogram8(8, image, null, 1, 4, 4, 0,
+                                                   1, new int[] {0},
+                                                   IntBuffer.allocate(255),
+                                                   false));
+            assertThrows(
+                IllegalArgumentException.class,
+                ()
+                    -> backend.histogram8(
+                        8, image, null, 1, 4, 4, 0, 1, new int[] {0},
+                        IntBuffer.allocate(256).asReadOnlyBuffer(), false));
+            assertThrows(NullPointerException.class,
+                         ()
+                             -> backend.histogram8(8, null, null, 1, 4, 4, 0,
+                                                   1, new int[] {0},
+                                                   IntBuffer.allocate(256),
+                                                   false));
+        }
+    }
+}
+
+class FfmHistogram8Tests extends Histogram8Tests {
+
+    private static NativeBackend ffm;
+
+    @BeforeAll
+    static void findBackend() {
+        ffm = NativeBackend.ffm(false);
+        assumeTrue(ffm != null, "FFM backend not available");
+    }
+
+    @Override
+    void invokeHistogram(int sampleBits, Buffer image, ByteBuffer mask,
+                         int rows, int width, int stride, int maskStride,
+                         int components, int[] indices, IntBuffer histogram,
+                         boolean parallel) {
+        ffm.histogram8(sampleBits, (ByteBuffer)image, mask, rows, width,
+                       stride, maskStride, components, indices, histogram,
+                       parallel);
+    }
+}
+
+class FfmHistogram16Tests extends Histogram16Tests {
+
+    private static NativeBackend ffm;
+
+    @BeforeAll
+    static void findBackend() {
+        ffm = NativeBackend.ffm(false);
+        assumeTrue(ffm != null, "FFM backend not available");
+    }
+
+    @Override
+    void invokeHistogram(int sampleBits, Buffer image, ByteBuffer mask,
+                         int rows, int width, int stride, int maskStride,
+                         int components, int[] indices, IntBuffer histogram,
+                         boolean parallel) {
+        ffm.histogram16(sampleBits, (ShortBuffer)image, mask, rows, width,
+                        stride, maskStride, components, indices, histogram,
+                        parallel);
+    }
+}
@@ -0,0 +1,285 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import static org.junit.jupiter.api.Assertions.*;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.IntBuffer;
+import java.nio.ShortBuffer;
+import java.util.Arrays;
+import java.util.Random;
+import org.junit.jupiter.api.*;
+
+class PreparedHistogramTest {
+
+    private static final int WIDTH = 13;
+    private static final int HEIGHT = 7;
+    private static final int STRIDE = 16;
+    private static final int N_COMPONENTS = 3;
+
+    private final Random rng = new Random(3);
+
+    private byte[] randomBytes(int n) {
+        byte[] a = new byte[n];
+        rng.nextBytes(a);
+        return a;
+    }
+
+    private short[] randomShorts(int n, int bits) {
+        short[] a = new short[n];
+        for (int i = 0; i < n; ++i) {
+            a[i] = (short)rng.nextInt(1 << bits);
+        }
+        return a;
+    }
+
+    private byte[] randomMask(int n) {
+        byte[] a = new byte[n];
+        for (int i = 0; i < n; ++i) {
+            a[i] = (byte)rng.nextInt(2);
+        }
+        return a;
+    }
+
+    private static int imageSize() {
+        return ((HEIGHT - 1) * STRIDE + WIDTH) * N_COMPONENTS;
+    }
+
+    private static int[] expected8(byte[] image, byte[] mask) {
+        HistogramRequest req =
+            HistogramRequest.forImage(image, STRIDE, HEIGHT, N_COMPONENTS)
+                .roi(0, 0, WIDTH, HEIGHT)
+                .selectComponents(2, 0);
+        if (mask != null) {
+            req.mask(mask, WIDTH, HEIGHT);
+        }
+        int[] hist = new int[2 * 256];
+        req.output(hist).compute();
+        return hist;
+    }
+
+    private static byte[] padded8(byte[] image) {
+        return Arrays.copyOf(image, STRIDE * HEIGHT * N_COMPONENTS);
+    }
+
+    @Test
+    void computeMatchesRequest() {
+        PreparedHistogram prepared =
+            PreparedHistogram.for8Bit(WIDTH, HEIGHT, N_COMPONENTS)
+                .stride(STRIDE)
+                .selectComponents(2, 0)
+                .build();
+        assertEquals(2 * 256, prepared.histogramSize());
+        assertEquals(imageSize(), prepared.imageSize());
+
+        int[] hist = new int[prepared.histogramSize()];
+        IntBuffer histBuf = IntBuffer.wrap(hist);
+        for (int i = 0; i < 3; ++i) {
+            byte[] image = randomBytes(imageSize());
+            byte[] mask = i == 1 ? randomMask(WIDTH * HEIGHT) : null;
+            Arrays.fill(hist, 5); // Overwritten when not accumulating.
+            prepared.compute(ByteBuffer.wrap(image),
+                             mask != null ? ByteBuffer.wrap(mask) : null,
+                             histBuf);
+            assertArrayEquals(expected8(padded8(image), mask), hist);
+            assertEquals(0, histBuf.position());
+        }
+    }
+
+    @Test
+    void compute16DirectAccumulate() {
+        PreparedHistogram prepared = PreparedHistogram.for16Bit(WIDTH, HEIGHT)
+                                         .bits(10)
+                                         .accumulate(true)
+                                         .build();
+        short[] image = randomShorts(WIDTH * HEIGHT, 10);
+        ShortBuffer direct = ByteBuffer.allocateDirect(image.length * 2)
+                                 .order(ByteOrder.nativeOrder())
+                                 .asShortBuffer();
+        direct.put(image);
+        direct.rewind();
+        IntBuffer hist = IntBuffer.allocate(prepared.histogramSize());
+        prepared.compute(direct, null, hist);
+        prepared.compute(direct, null, hist);
+
+        int[] expected = new int[1 << 10];
+        HistogramRequest.forImage(image, WIDTH, HEIGHT)
+            .bits(10)
+            .output(expected)
+            .compute();
+        for (int i = 0; i < expected.length; ++i) {
+            expected[i] *= 2;
+        }
+        assertArrayEquals(expected, hist.array());
+    }
+
+    @Test
+    void batchMatchesRequest() {
+        PreparedHistogram prepared =
+            PreparedHistogram.for8Bit(WIDTH, HEIGHT, N_COMPONENTS)
+                .stride(STRIDE)
+                .selectComponents(2, 0)
+                .build();
+        int n = 5;
+        int histSize = prepared.histogramSize();
+        byte[][] images = new byte[n][];
+        byte[][] masks = new byte[n][];
+        ByteBuffer[] imageBufs = new ByteBuffer[n];
+        ByteBuffer[] maskBufs = new ByteBuffer[n];
+        for (int i = 0; i < n; ++i) {
+            images[i] = randomBytes(imageSize());
+            masks[i] = i == 2 ? null : randomMask(WIDTH * HEIGHT);
+            if (i % 2 == 0) {
+                imageBufs[i] = ByteBuffer.wrap(images[i]);
+            } else {
+                imageBufs[i] = ByteBuffer.allocateDirect(imageSize());
+                imageBufs[i].put(images[i]);
+                imageBufs[i].rewind();
+            }
+            maskBufs[i] = masks[i] != null ? ByteBuffer.wrap(masks[i]) : null;
+        }
+
+        int[] hists = new int[n * histSize + 2];
+        Arrays.fill(hists, 9);
+        IntBuffer histBuf = IntBuffer.wrap(hists, 1, n * histSize).slice();
+        prepared.computeBatch(imageBufs, maskBufs, histBuf);
+        assertEquals(9, hists[0]);
+        assertEquals(9, hists[hists.length - 1]);
+        for (int i = 0; i < n; ++i) {
+            assertArrayEquals(expected8(padded8(images[i]), masks[i]),
+                              Arrays.copyOfRange(hists, 1 + i * histSize,
+                                                 1 + (i + 1) * histSize),
+                              "image " + i);
+        }
+
+        int[] unmasked = new int[n * histSize];
+        prepared.computeBatch(imageBufs, null, IntBuffer.wrap(unmasked));
+        for (int i = 0; i < n; ++i) {
+            assertArrayEquals(expected8(padded8(images[i]), null),
+                              Arrays.copyOfRange(unmasked, i * histSize,
+                                                 (i + 1) * histSize));
+        }
+    }
+
+    @Test
+    void roisMatchRequest() {
+        int frameWidth = 40;
+        int frameHeight = 30;
+        PreparedHistogram prepared = PreparedHistogram.for16Bit(WIDTH, HEIGHT)
+                                         .stride(frameWidth)
+                                         .bits(12)
+                                         .build();
+        short[] frame = randomShorts(frameWidth * frameHeight, 12);
+        byte[] mask = randomMask(WIDTH * HEIGHT);
+        int[] xs = {0, 5, frameWidth - WIDTH, 11};
+        int[] ys = {0, 3, frameHeight - HEIGHT, 0};
+        int histSize = prepared.histogramSize();
+        int[] hists = new int[xs.length * histSize];
+        prepared.computeRois(ShortBuffer.wrap(frame), frameWidth, frameHeight,
+                             xs, ys, ByteBuffer.wrap(mask),
+                             IntBuffer.wrap(hists));
+        for (int r = 0; r < xs.length; ++r) {
+            int[] expected = new int[histSize];
+            HistogramRequest.forImage(frame, frameWidth, frameHeight)
+                .roi(xs[r], ys[r], WIDTH, HEIGHT)
+                .mask(mask, WIDTH, HEIGHT)
+                .bits(12)
+                .output(expected)
+                .compute();
+            assertArrayEquals(expected,
+                              Arrays.copyOfRange(hists, r * histSize,
+                                                 (r + 1) * histSize),
+                              "ROI " + r);
+        }
+    }
+
+    @Test
+    void validation() {
+        assertThrows(IllegalArgumentException.class,
+                     () -> PreparedHistogram.for8Bit(4, 4).bits(9).build());
+        assertThrows(IllegalArgumentException.class,
+                     () -> PreparedHistogram.for8Bit(4, 4).stride(3).build());
+        assertThrows(IllegalArgumentException.class,
+                     ()
+                         -> PreparedHistogram.for8Bit(4, 4, 2)
+                                .selectComponents(2)
+                                .build());
+
+        PreparedHistogram p8 = PreparedHistogram.for8Bit(4, 4).build();
+        IntBuffer hist = IntBuffer.allocate(256);
+        assertThrows(IllegalStateException.class,
+                     ()
+                         -> p8.compute(ShortBuffer.allocate(16), null, hist));
+        assertThrows(IllegalArgumentException.class,
+                     () -> p8.compute(ByteBuffer.allocate(15), null, hist));
+        assertThrows(
+            IllegalArgumentException.class,
+            ()
+                -> p8.computeBatch(
+                    new ByteBuffer[] {ByteBuffer.allocate(16)},
+                    new ByteBuffer[0], hist));
+        assertThrows(NullPointerException.class,
+                     ()
+                         -> p8.computeBatch(new ByteBuffer[] {null}, null,
+                                            hist));
+
+        PreparedHistogram rois =
+            PreparedHistogram.for8Bit(4, 4).stride(8).build();
+        assertThrows(IllegalArgumentException.class,
+                     ()
+                         -> rois.computeRois(ByteBuffer.allocate(64), 8, 8,
+                                             new int[] {5}, new int[] {0},
+                                             null, hist));
+        assertThrows(IllegalArgumentException.class,
+                     ()
+                         -> rois.computeRois(ByteBuffer.allocate(64), 8, 8,
+                                             new int[] {0, 1}, new int[] {0},
+                                             null, IntBuffer.allocate(512)));
+    }
+
+    @Test
+    void failedComputeLeavesOutput() {
+        PreparedHistogram p8 =
+            PreparedHistogram.for8Bit(4, 4).stride(8).build();
+        int[] hist = new int[256];
+        Arrays.fill(hist, 7);
+        IntBuffer histBuf = IntBuffer.wrap(hist);
+
+        assertThrows(IllegalArgumentException.class,
+                     () -> p8.compute(ByteBuffer.allocate(27), null, histBuf));
+        assertThrows(IllegalArgumentException.class,
+                     ()
+                         -> p8.compute(ByteBuffer.allocate(28),
+                                       ByteBuffer.allocate(15), histBuf));
+        assertThrows(NullPointerException.class,
+                     () -> p8.compute((ByteBuffer)null, null, histBuf));
+        assertThrows(IllegalArgumentException.class,
+                     ()
+                         -> p8.compute(ByteBuffer.allocate(28)
+                                           .asReadOnlyBuffer(),
+                                       null, histBuf));
+        assertThrows(IllegalArgumentException.class,
+                     ()
+                         -> p8.computeBatch(
+                             new ByteBuffer[] {ByteBuffer.allocate(27)},
+                             null, histBuf));
+        assertThrows(IllegalArgumentException.class,
+                     ()
+                         -> p8.computeRois(ByteBuffer.allocate(64), 8, 8,
+                                           new int[] {5}, new int[] {0},
+                                           null, histBuf));
+        assertThrows(IllegalArgumentException.class,
+                     ()
+                         -> p8.computeRois(ByteBuffer.allocate(63), 8, 8,
+                                           new int[] {0}, new int[] {0},
+                                           null, histBuf));
+
+        int[] expected = new int[256];
+        Arrays.fill(expected, 7);
+        assertArrayEquals(expected, hist);
+    }
+}
@@ -0,0 +1,92 @@
+// This file is part of ihist
+// Copyright 2025 Board of Regents of the University of Wisconsin System
+// SPDX-License-Identifier: MIT
+
+package io.github.marktsuchida.ihist;
+
+import static org.junit.jupiter.api.Assertions.*;
+
+import java.nio.IntBuffer;
+import java.util.Random;
+import org.junit.jupiter.api.*;
+
+/**
+ * Tests for {@link HistogramRequest#computeSparse()} and
+ * {@link SparseHistogram}.
+ */
+class SparseHistogramTest {
+
+    @BeforeAll
+    static void loadLibrary() {
+        IHistNative.loadNativeLibrary();
+    }
+
+    private static short[] image16(int size, int seed) {
+        Random rng = new Random(seed);
+        short[] image = new short[size];
+        for (int i = 0; i < size; ++i) {
+            image[i] = (short)(40000 + rng.nextInt(3000));
+        }
+        return image;
+    }
+
+    @Test
+    void smallRoiMatchesDense() {
+        short[] image = image16(100 * 80, 1);
+        HistogramRequest request =
+            HistogramRequest.forImage(image, 100, 80).roi(10, 20, 16, 12);
+        SparseHistogram sparse = request.computeSparse();
+        IntBuffer dense = request.compute();
+
+        assertEquals(16, sparse.sampleBits());
+        assertEquals(1, sparse.componentCount());
+        assertEquals(dense, sparse.toDense());
+        for (int i = 1; i < sparse.nonzeroCount(0); ++i) {
+            assertTrue(sparse.bin(0, i) > sparse.bin(0, i - 1));
+            assertTrue(sparse.bin(0, i) >= 40000);
+            assertTrue(sparse.count(0, i) > 0);
+        }
+    }
+
+    @Test
+    void componentsAndMask() {
+        short[] image = image16(200 * 150 * 3, 2);
+        byte[] mask = new byte[200 * 150];
+        for (int i = 0; i < mask.length; i += 3) {
+            mask[i] = 1;
+        }
+        HistogramRequest request =
+            HistogramRequest.forImage(image, 200, 150, 3)
+                .selectComponents(2, 0)
+                .mask(mask, 200, 150)
+                .bits(16);
+        SparseHistogram sparse = request.computeSparse();
+        assertEquals(2, sparse.componentCount());
+        assertEquals(request.compute(), sparse.toDense());
+    }
+
+    @Test
+    void eightBit() {
+        byte[] image = new byte[] {(byte)200, 3, 3, (byte)200, 7};
+        SparseHistogram sparse =
+            HistogramRequest.forImage(image, 5, 1).computeSparse();
+        assertEquals(3, sparse.nonzeroCount(0));
+        assertEquals(3, sparse.bin(0, 0));
+        assertEquals(2, sparse.count(0, 0));
+        assertEquals(7, sparse.bin(0, 1));
+        assertEquals(200, sparse.bin(0, 2));
+        assertEquals(2, sparse.count(0, 2));
+        assertThrows(IndexOutOfBoundsException.class,
+                     () -> sparse.bin(0, 3));
+    }
+
+    @Test
+    void outputNotAllowed() {
+        byte[] image = new byte[4];
+        assertThrows(IllegalArgumentException.class,
+                     ()
+                         -> HistogramRequest.forImage(image, 2, 2)
+                                .output(new int[256])
+                                .computeSparse());
+    }
+}
@@ -0,0 +1,296 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Benchmarks of the Python API, with NumPy and OpenCV baselines.
+
+Measures ihist.histogram() including the binding layer (layout analysis,
+copies of incompatible layouts, output allocation), over image sizes from
+tiny (where per-call overhead dominates) to large, and compares with
+np.bincount(), np.histogram(), and cv2.calcHist() (if OpenCV is installed).
+
+Results are written in the JSON format of Google Benchmark, with benchmark
+names of the same form as benchmarks/api_bench.cpp, so that they can be
+loaded with scripts/plot_benchmarks.py --results FILE. The implementation
+part of each name tells the variant:
+
+ihist              C-contiguous input, new output array per call
+ihist-st           Same, with parallel=False
+ihist-out          Preallocated output reused with accumulate=True
+ihist-roi          View of a larger array (padded rows; no copy)
+ihist-transposed   Transposed (F-ordered) view (no copy)
+ihist-copy         Every other column (layout that requires a copy)
+numpy-bincount     np.bincount() of each component
+numpy-histogram    np.histogram() of each component
+opencv             cv2.calcHist() of each component
+
+For masked cases, the mask has the same layout as the image.
+
+Example: python python/benchmarks/api_bench.py --bits 12 --out py.json
+"""
+
+import argparse
+import json
+import platform
+import re
+import sys
+import time
+from collections.abc import Callable
+
+import numpy as np
+
+import ihist
+
+try:
+    import cv2
+except ImportError:
+    cv2 = None
+
+# (n_components, component indices), as in benchmarks/api_bench.cpp.
+PIXEL_TYPES = {
+    "mono": (1, [0]),
+    "abc": (3, [0, 1, 2]),
+    "abcx": (4, [0, 1, 2]),
+}
+
+
+def generate_data(bits, shape, spread_percent, seed=0):
+    """Uniform values in a band of the given width around mid-range."""
+    maximum = (1 << bits) - 1
+    mean = maximum // 2
+    dtype = np.uint8 if bits <= 8 else np.uint16
+    half_spread = min(round(0.5 * spread_percent / 100 * maximum), mean)
+    rng = np.random.default_rng(seed)
+    return rng.integers(
+        mean - half_spread,
+        mean + half_spread,
+        shape,
+        dtype=dtype,
+        endpoint=True,
+    )
+
+
+def circle_mask(height, width):
+    """Elliptical mask inscribed in the image, as in the C++ benchmarks."""
+    y, x = np.ogrid[:height, :width]
+    cy, cx = height // 2, width // 2
+    inside = (x - cx) ** 2 * cy**2 + (y - cy) ** 2 * cx**2 < cx**2 * cy**2
+    return inside.astype(np.uint8)
+
+
+def _as_3d(image):
+    return image if image.ndim == 3 else image[:, :, np.newaxis]
+
+
+def make_cases(pixel_type, bits, size, spread, masked):
+    """Return {impl: zero-argument callable} for one configuration."""
+    n_components, indices = PIXEL_TYPES[pixel_type]
+    shape = (size, size) if n_components == 1 else (size, size, n_components)
+    image = generate_data(bits, shape, spread)
+    mask = circle_mask(size, size) if masked else None
+    components = None if n_components == 1 else indices
+    n_bins = 1 << bits
+
+    def ihist_call(img, msk, **kwargs):
+        return lambda: ihist.histogram(
+            img, bits=bits, mask=msk, components=components, **kwargs
+        )
+
+    cases = {
+        "ihist": ihist_call(image, mask),
+        "ihist-st": ihist_call(image, mask, parallel=False),
+    }
+
+    out = ihist.histogram(image, bits=bits, mask=mask, components=components)
+    cases["ihist-out"] = ihist_call(image, mask, out=out, accumulate=True)
+
+    # Views of larger arrays.
+    padded = np.zeros((size + 1, size + 16, *shape[2:]), dtype=image.dtype)
+    padded[:size, :size] = image
+    mask_padded = None
+    if masked:
+        mask_padded = np.zeros((size + 1, size + 16), dtype=np.uint8)
+        mask_padded[:size, :size] = mask
+    cases["ihist-roi"] = ihist_call(
+        padded[:size, :size],
+        None if mask_padded is None else mask_padded[:size, :size],
+    )
+
+    transposed = np.ascontiguousarray(np.swapaxes(image, 0, 1))
+    cases["ihist-transposed"] = ihist_call(
+        np.swapaxes(transposed, 0, 1),
+        None if mask is None else np.ascontiguousarray(mask.T).T,
+    )
+
+    doubled = np.repeat(image, 2, axis=1)
+    mask_doubled = None if mask is None else np.repeat(mask, 2, axis=1)
+    cases["ihist-copy"] = ihist_call(
+        doubled[:, ::2], None if mask_doubled is None else mask_doubled[:, ::2]
+    )
+
+    # Baselines histogram each selected component separately.
+    planes = [np.ascontiguousarray(_as_3d(image)[:, :, c]) for c in indices]
+    selected = None if mask is None else mask.astype(bool)
+
+    def numpy_bincount():
+        return [
+            np.bincount(
+                (p if selected is None else p[selected]).ravel(),
+                minlength=n_bins,
+            )
+            for p in planes
+        ]
+
+    def numpy_histogram():
+        return [
+            np.histogram(
+                p if selected is None else p[selected],
+                bins=n_bins,
+                range=(0, n_bins),
+            )[0]
+            for p in planes
+        ]
+
+    cases["numpy-bincount"] = numpy_bincount
+    cases["numpy-histogram"] = numpy_histogram
+
+    if cv2 is not None:
+        cv_image = _as_3d(image)
+
+        def opencv():
+            return [
+                cv2.calcHist([cv_image], [c], mask, [n_bins], [0, n_bins])
+                for c in indices
+            ]
+
+        cases["opencv"] = opencv
+
+    return cases
+
+
+def measure(func: Callable[[], object], min_time: float):
+    """Return (iterations, real seconds, CPU seconds) of repeated calls."""
+    func()  # Warm up (first-call allocation, thread pool startup).
+    iterations = 1
+    while True:
+        real_start = time.perf_counter()
+        cpu_start = time.process_time()
+        for _ in range(iterations):
+            func()
+        real = time.perf_counter() - real_start
+        cpu = time.process_time() - cpu_start
+        if real >= min_time:
+            return iterations, real, cpu
+        iterations = max(
+            iterations + 1, int(iterations * min_time * 1.4 / max(real, 1e-9))
+        )
+
+
+def run(args):
+    pattern = re.compile(args.filter)
+    entries = []
+    for size in args.sizes:
+        for spread in args.spreads:
+            for masked in args.masks:
+                cases = make_cases(
+                    args.pixel_type, args.bits, size, spread, masked
+                )
+                for impl, func in cases.items():
+                    name = (
+                        f"{impl}/{args.pixel_type}/bits:{args.bits}"
+                        f"/mask:{int(masked)}/size:{size}/spread:{spread}"
+                        "/real_time/process_time"
+                    )
+                    if not pattern.search(name):
+                        continue
+                    for rep in range(args.repetitions):
+                        iters, real, cpu = measure(func, args.min_time)
+                        entries.append(
+                            {
+                                "name": name,
+                                "run_name": name,
+                                "run_type": "iteration",
+                                "repetitions": args.repetitions,
+                                "repetition_index": rep,
+                                "iterations": iters,
+                                "real_time": real / iters * 1e3,
+                                "cpu_time": cpu / iters * 1e3,
+                                "time_unit": "ms",
+                                "pixels_per_second": size
+                                * size
+                                * iters
+                                / real,
+                            }
+                        )
+                        print(
+                            f"{name:<72} {real / iters * 1e3:10.4f} ms",
+                            file=sys.stderr,
+                        )
+    return {
+        "context": {
+            "date": time.strftime("%Y-%m-%dT%H:%M:%S%z"),
+            "executable": "python/benchmarks/api_bench.py",
+            "python_version": platform.python_version(),
+            "numpy_version": np.__version__,
+            "opencv_version": None if cv2 is None else cv2.__version__,
+            "host_name": platform.node(),
+        },
+        "benchmarks": entries,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument(
+        "--pixel-type", choices=tuple(PIXEL_TYPES), default="mono"
+    )
+    parser.add_argument("--bits", type=int, default=8)
+    parser.add_argument(
+        "--sizes",
+        type=int,
+        nargs="+",
+        default=[8, 32, 128, 512, 2048],
+        metavar="SIZE",
+        help="image sizes (square root of pixel count)",
+    )
+    parser.add_argument(
+        "--spreads",
+        type=int,
+        nargs="+",
+        default=[0, 6, 100],
+        metavar="PERCENT",
+        help="data spread, as percent of the value range",
+    )
+    parser.add_argument(
+        "--masks",
+        type=int,
+        nargs="+",
+        choices=(0, 1),
+        default=[0, 1],
+        help="run unmasked (0) and/or masked (1) cases",
+    )
+    parser.add_argument("--repetitions", type=int, default=3)
+    parser.add_argument(
+        "--min-time",
+        type=float,
+        default=0.1,
+        metavar="SECONDS",
+        help="minimum time per measurement",
+    )
+    parser.add_argument(
+        "--filter", default="", help="regex to select benchmark names"
+    )
+    parser.add_argument("--out", help="JSON output file (default: stdout)")
+    args = parser.parse_args()
+    args.masks = [bool(m) for m in args.masks]
+
+    results = run(args)
+    if args.out:
+        with open(args.out, "w") as f:
+            json.dump(results, f, indent=2)
+    else:
+        json.dump(results, sys.stdout, indent=2)
+
+
+if __name__ == "__main__":
+    main()
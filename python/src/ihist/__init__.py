@@ -9,8 +9,52 @@ It supports uint8 and uint16 data types, arbitrary bit depths, multi-component
 images, optional per-pixel masking, and histogram accumulation.
 """
 
-from ihist._ihist import histogram
+from ihist._ihist import (
+    Accumulator,
+    HistogramSeriesReader,
+    HistogramSeriesWriter,
+    auto_contrast_lut,
+    c_api,
+    c_api_address,
+    histogram,
+    histogram_copy,
+    histogram_corrected,
+    histogram_cumsum,
+    histogram_derived,
+    histogram_difference,
+    histogram_distance,
+    histogram_entropy,
+    histogram_lut8,
+    histogram_many,
+    histogram_mode,
+    histogram_otsu,
+    histogram_quantiles,
+    histogram_sparse,
+    histogram_stats,
+    histogram_tiles,
+)
 
 __all__ = [
+    "Accumulator",
+    "HistogramSeriesReader",
+    "HistogramSeriesWriter",
+    "auto_contrast_lut",
+    "c_api",
+    "c_api_address",
     "histogram",
+    "histogram_copy",
+    "histogram_corrected",
+    "histogram_cumsum",
+    "histogram_derived",
+    "histogram_difference",
+    "histogram_distance",
+    "histogram_entropy",
+    "histogram_lut8",
+    "histogram_many",
+    "histogram_mode",
+    "histogram_otsu",
+    "histogram_quantiles",
+    "histogram_sparse",
+    "histogram_stats",
+    "histogram_tiles",
 ]
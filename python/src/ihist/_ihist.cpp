@@ -11,9 +11,12 @@
 #include <cstdint>
 #include <cstring>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <numeric>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace nb = nanobind;
@@ -28,10 +31,10 @@ namespace {
 class ImageView {
   public:
     ImageView(nb::ndarray<nb::ro> &image, std::size_t ndim, std::size_t height,
-              std::size_t width, std::size_t n_components, bool is_8bit)
+              std::size_t width, std::size_t n_components,
+              std::size_t elem_size)
         : data_(image.data()), height_(height), width_(width), stride_(width),
-          pixel_size_((is_8bit ? 1 : 2) * n_components), transposed_(false) {
-        std::size_t const elem_size = is_8bit ? 1 : 2;
+          pixel_size_(elem_size * n_components), transposed_(false) {
         bool compat = false;
 
         if (ndim == 1) {
@@ -196,14 +199,279 @@ class MaskView {
     nb::object owner_;         // Prevents deallocation of any copy
 };
 
+// Analyzed histogram array (as produced by histogram()) for read-only
+// analysis. The last axis holds the bins, whose count must be a power of 2; a
+// 2D array holds one histogram per row. Non-C-contiguous arrays are copied.
+class HistogramView {
+  public:
+    explicit HistogramView(nb::ndarray<nb::ro> &hist) {
+        if (hist.dtype() != nb::dtype<std::uint32_t>()) {
+            throw std::invalid_argument("Histogram must have dtype uint32");
+        }
+        if (hist.ndim() != 1 && hist.ndim() != 2) {
+            throw std::invalid_argument("Histogram must be 1D or 2D, got " +
+                                        std::to_string(hist.ndim()) + "D");
+        }
+        ndim_ = hist.ndim();
+        n_hist_components_ = ndim_ == 1 ? 1 : hist.shape(0);
+        std::size_t const n_bins = hist.shape(ndim_ - 1);
+        while (n_bins > (std::size_t(1) << sample_bits_) &&
+               sample_bits_ < 16) {
+            ++sample_bits_;
+        }
+        if (n_bins != (std::size_t(1) << sample_bits_)) {
+            throw std::invalid_argument(
+                "Histogram bin count must be a power of 2 up to 65536, got " +
+                std::to_string(n_bins));
+        }
+
+        auto hist_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(hist.cast());
+        owner_ = nb::cast(hist_c);
+        data_ = static_cast<std::uint32_t const *>(hist_c.data());
+    }
+
+    [[nodiscard]] auto data() const -> std::uint32_t const * { return data_; }
+    [[nodiscard]] auto ndim() const -> std::size_t { return ndim_; }
+    [[nodiscard]] auto sample_bits() const -> std::size_t {
+        return sample_bits_;
+    }
+    [[nodiscard]] auto n_hist_components() const -> std::size_t {
+        return n_hist_components_;
+    }
+
+  private:
+    std::uint32_t const *data_ = nullptr;
+    std::size_t ndim_ = 1;
+    std::size_t sample_bits_ = 0;
+    std::size_t n_hist_components_ = 1;
+    nb::object owner_; // Keeps any copy alive
+};
+
+// Return a scalar if the histogram was 1D, else a 1D array with one element
+// per component.
+template <typename T, typename Field>
+auto per_component(HistogramView const &hv, std::vector<ihist_stats> const &st,
+                   Field field) -> nb::object {
+    if (hv.ndim() == 1) {
+        return nb::cast(static_cast<T>(st[0].*field));
+    }
+    std::size_t const shape[1] = {st.size()};
+    nb::ndarray<nb::numpy, T> arr(nullptr, 1, shape, nb::handle());
+    auto obj = nb::cast(arr);
+    auto *ptr = nb::cast<nb::ndarray<T>>(obj).data();
+    for (std::size_t i = 0; i < st.size(); ++i) {
+        ptr[i] = static_cast<T>(st[i].*field);
+    }
+    return obj;
+}
+
+// Same as above, for a plain vector of per-component values.
+template <typename T>
+auto per_component(HistogramView const &hv, std::vector<T> const &values)
+    -> nb::object {
+    if (hv.ndim() == 1) {
+        return nb::cast(values[0]);
+    }
+    std::size_t const shape[1] = {values.size()};
+    nb::ndarray<nb::numpy, T> arr(nullptr, 1, shape, nb::handle());
+    auto obj = nb::cast(arr);
+    std::copy(values.begin(), values.end(),
+              nb::cast<nb::ndarray<T>>(obj).data());
+    return obj;
+}
+
 } // namespace
 
+nb::dict histogram_stats(nb::ndarray<nb::ro> histogram) {
+    HistogramView const hv(histogram);
+    std::vector<ihist_stats> st(hv.n_hist_components());
+    {
+        nb::gil_scoped_release gil_released;
+        ihist_histogram_stats(hv.sample_bits(), hv.n_hist_components(),
+                              hv.data(), st.data());
+    }
+
+    nb::dict result;
+    result["count"] =
+        per_component<std::uint64_t>(hv, st, &ihist_stats::count);
+    result["sum"] = per_component<std::uint64_t>(hv, st, &ihist_stats::sum);
+    result["sum_of_squares"] =
+        per_component<std::uint64_t>(hv, st, &ihist_stats::sum_of_squares);
+    result["min"] = per_component<std::uint32_t>(hv, st, &ihist_stats::min);
+    result["max"] = per_component<std::uint32_t>(hv, st, &ihist_stats::max);
+    result["n_saturated"] =
+        per_component<std::uint64_t>(hv, st, &ihist_stats::n_saturated);
+    result["mean"] = per_component<double>(hv, st, &ihist_stats::mean);
+    result["std"] = per_component<double>(hv, st, &ihist_stats::stddev);
+    return result;
+}
+
+nb::object histogram_cumsum(nb::ndarray<nb::ro> histogram) {
+    HistogramView const hv(histogram);
+    std::size_t const n_bins = std::size_t(1) << hv.sample_bits();
+    std::size_t shape[2];
+    if (hv.ndim() == 1) {
+        shape[0] = n_bins;
+    } else {
+        shape[0] = hv.n_hist_components();
+        shape[1] = n_bins;
+    }
+    nb::ndarray<nb::numpy, std::uint64_t> arr(nullptr, hv.ndim(), shape,
+                                              nb::handle());
+    auto obj = nb::cast(arr);
+    auto *ptr = nb::cast<nb::ndarray<std::uint64_t>>(obj).data();
+    {
+        nb::gil_scoped_release gil_released;
+        ihist_histogram_cumsum(hv.sample_bits(), hv.n_hist_components(),
+                               hv.data(), ptr);
+    }
+    return obj;
+}
+
+nb::object histogram_quantiles(nb::ndarray<nb::ro> histogram,
+                               nb::object q_obj) {
+    HistogramView const hv(histogram);
+
+    bool const scalar_q = !nb::isinstance<nb::sequence>(q_obj);
+    std::vector<double> qs;
+    if (scalar_q) {
+        qs.push_back(nb::cast<double>(q_obj));
+    } else {
+        auto const seq = nb::cast<nb::sequence>(q_obj);
+        qs.resize(nb::len(seq));
+        for (std::size_t i = 0; i < qs.size(); ++i) {
+            qs[i] = nb::cast<double>(seq[i]);
+        }
+    }
+    for (double const q : qs) {
+        if (!(q >= 0.0 && q <= 1.0)) {
+            throw std::invalid_argument(
+                "Quantiles must be in range [0, 1], got " +
+                std::to_string(q));
+        }
+    }
+
+    std::size_t const n_hist = hv.n_hist_components();
+    std::vector<std::uint32_t> values(n_hist * qs.size());
+    {
+        nb::gil_scoped_release gil_released;
+        ihist_histogram_quantiles(hv.sample_bits(), n_hist, hv.data(),
+                                  qs.size(), qs.data(), values.data());
+    }
+
+    if (scalar_q) {
+        return per_component(hv, values);
+    }
+    // Shape is the histogram's leading shape followed by the quantiles.
+    std::size_t shape[2];
+    std::size_t ndim = 0;
+    if (hv.ndim() == 2) {
+        shape[ndim++] = n_hist;
+    }
+    shape[ndim++] = qs.size();
+    nb::ndarray<nb::numpy, std::uint32_t> arr(nullptr, ndim, shape,
+                                              nb::handle());
+    auto obj = nb::cast(arr);
+    std::copy(values.begin(), values.end(),
+              nb::cast<nb::ndarray<std::uint32_t>>(obj).data());
+    return obj;
+}
+
+// Analyses producing one value per component.
+template <typename T, void (*Func)(std::size_t, std::size_t,
+                                   std::uint32_t const *, T *)>
+nb::object histogram_per_component(nb::ndarray<nb::ro> histogram) {
+    HistogramView const hv(histogram);
+    std::vector<T> values(hv.n_hist_components());
+    {
+        nb::gil_scoped_release gil_released;
+        Func(hv.sample_bits(), hv.n_hist_components(), hv.data(),
+             values.data());
+    }
+    return per_component(hv, values);
+}
+
+auto parse_distance_metric(std::string const &name) -> ihist_distance_metric {
+    if (name == "chi_square") {
+        return IHIST_DISTANCE_CHI_SQUARE;
+    }
+    if (name == "bhattacharyya") {
+        return IHIST_DISTANCE_BHATTACHARYYA;
+    }
+    if (name == "intersection") {
+        return IHIST_DISTANCE_INTERSECTION;
+    }
+    if (name == "emd") {
+        return IHIST_DISTANCE_EMD;
+    }
+    if (name == "kl_divergence") {
+        return IHIST_DISTANCE_KL_DIVERGENCE;
+    }
+    throw std::invalid_argument(
+        "metric must be one of 'chi_square', 'bhattacharyya', "
+        "'intersection', 'emd', 'kl_divergence', got '" +
+        name + "'");
+}
+
+nb::object histogram_distance(nb::ndarray<nb::ro> histogram,
+                              nb::ndarray<nb::ro> other,
+                              std::string const &metric_name, bool parallel) {
+    auto const metric = parse_distance_metric(metric_name);
+    HistogramView const hv(histogram);
+
+    // 'other' is either a histogram of the same shape (pairwise comparison)
+    // or a stack of such histograms along a new leading axis (batch).
+    if (other.dtype() != nb::dtype<std::uint32_t>()) {
+        throw std::invalid_argument("Other histogram must have dtype uint32");
+    }
+    bool const batch = other.ndim() == hv.ndim() + 1;
+    if (!batch && other.ndim() != hv.ndim()) {
+        throw std::invalid_argument(
+            "Other histogram must have the same shape as histogram, or one "
+            "extra leading axis, got " +
+            std::to_string(other.ndim()) + "D");
+    }
+    std::size_t const axis_offset = batch ? 1 : 0;
+    for (std::size_t i = 0; i < hv.ndim(); ++i) {
+        if (other.shape(i + axis_offset) != histogram.shape(i)) {
+            throw std::invalid_argument(
+                "Other histogram shape does not match histogram shape");
+        }
+    }
+    std::size_t const n_refs = batch ? other.shape(0) : 1;
+    std::size_t const n_hist = hv.n_hist_components();
+
+    auto other_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(other.cast());
+    auto const *other_ptr = static_cast<std::uint32_t const *>(other_c.data());
+
+    std::vector<double> distances(n_refs * n_hist);
+    {
+        nb::gil_scoped_release gil_released;
+        ihist_histogram_distance_batch(hv.sample_bits(), n_hist, hv.data(),
+                                       n_refs, other_ptr, metric,
+                                       distances.data(), parallel);
+    }
+
+    if (!batch) {
+        return per_component(hv, distances);
+    }
+    // Shape is the batch axis followed by the histogram's leading shape.
+    std::size_t shape[2] = {n_refs, n_hist};
+    nb::ndarray<nb::numpy, double> arr(nullptr, hv.ndim(), shape,
+                                       nb::handle());
+    auto obj = nb::cast(arr);
+    std::copy(distances.begin(), distances.end(),
+              nb::cast<nb::ndarray<double>>(obj).data());
+    return obj;
+}
+
 nb::object histogram(nb::ndarray<nb::ro> image,
                      nb::object bits_obj = nb::none(),
                      nb::object mask_obj = nb::none(),
                      nb::object components_obj = nb::none(),
                      nb::object out_obj = nb::none(), bool accumulate = false,
-                     bool parallel = true) {
+                     bool parallel = true, bool return_overflow = false,
+                     nb::object levels_obj = nb::none()) {
     bool const is_8bit = image.dtype() == nb::dtype<std::uint8_t>();
     bool const is_16bit = image.dtype() == nb::dtype<std::uint16_t>();
     if (!is_8bit && !is_16bit) {
@@ -232,7 +500,8 @@ nb::object histogram(nb::ndarray<nb::ro> image,
         n_components = image.shape(2);
     }
 
-    ImageView const img(image, ndim, height, width, n_components, is_8bit);
+    ImageView const img(image, ndim, height, width, n_components,
+                        is_8bit ? 1 : 2);
 
     std::size_t const n_pixels = height * width;
     if (n_pixels > std::numeric_limits<std::uint32_t>::max()) {
@@ -321,6 +590,7 @@ nb::object histogram(nb::ndarray<nb::ro> image,
     std::size_t const hist_size = n_hist_components * n_bins;
 
     std::uint32_t *hist_ptr = nullptr;
+    std::size_t hist_ndim = 0;
     nb::object out_array;
     if (!out_obj.is_none()) {
         auto out = nb::cast<nb::ndarray<nb::c_contig>>(out_obj);
@@ -364,6 +634,7 @@ nb::object histogram(nb::ndarray<nb::ro> image,
 
         out_array = out_obj;
         hist_ptr = static_cast<std::uint32_t *>(out.data());
+        hist_ndim = out.ndim();
     } else {
         std::size_t shape[2];
         std::size_t out_ndim;
@@ -386,94 +657,2168 @@ nb::object histogram(nb::ndarray<nb::ro> image,
         out_array = nb::cast(arr);
         auto out_arr = nb::cast<nb::ndarray<std::uint32_t>>(out_array);
         hist_ptr = out_arr.data();
+        hist_ndim = out_ndim;
     }
 
     if (out_obj.is_none() || !accumulate) {
         std::fill(hist_ptr, std::next(hist_ptr, hist_size), 0);
     }
 
+    std::vector<std::uint32_t> overflow;
+    if (return_overflow) {
+        overflow.resize(n_hist_components);
+    }
+
+    // Coarse levels, each shaped like the histogram.
+    std::vector<std::size_t> level_bits;
+    nb::list levels;
+    std::vector<std::uint32_t *> level_ptrs;
+    if (!levels_obj.is_none()) {
+        auto const levels_seq = nb::cast<nb::sequence>(levels_obj);
+        for (std::size_t i = 0; i < nb::len(levels_seq); ++i) {
+            auto const lb = nb::cast<std::int64_t>(levels_seq[i]);
+            if (lb < 0 || static_cast<std::size_t>(lb) > sample_bits) {
+                throw std::invalid_argument(
+                    "Level bits must be in range [0, " +
+                    std::to_string(sample_bits) + "], got " +
+                    std::to_string(lb));
+            }
+            level_bits.push_back(static_cast<std::size_t>(lb));
+            std::size_t const shape[2] = {
+                hist_ndim == 1 ? std::size_t(1) << lb : n_hist_components,
+                std::size_t(1) << lb};
+            nb::ndarray<nb::numpy, std::uint32_t> arr(nullptr, hist_ndim,
+                                                      shape, nb::handle());
+            auto level = nb::cast(arr);
+            level_ptrs.push_back(
+                nb::cast<nb::ndarray<std::uint32_t>>(level).data());
+            levels.append(level);
+        }
+    }
+
     // We could keep the GIL acquired when data size is small (say, less than
     // 500 elements; should benchmark), but always release for now.
     if (n_hist_components > 0) {
         nb::gil_scoped_release gil_released;
 
+        std::uint32_t *const overflow_ptr =
+            return_overflow ? overflow.data() : nullptr;
         if (is_8bit) {
-            ihist_hist8_2d(sample_bits,
-                           static_cast<std::uint8_t const *>(img.data()),
-                           msk.data(), img.height(), img.width(), img.stride(),
-                           msk.stride(), n_components, n_hist_components,
-                           component_indices.data(), hist_ptr, parallel);
+            ihist_hist8_2d_overflow(
+                sample_bits, static_cast<std::uint8_t const *>(img.data()),
+                msk.data(), img.height(), img.width(), img.stride(),
+                msk.stride(), n_components, n_hist_components,
+                component_indices.data(), hist_ptr, overflow_ptr, parallel);
         } else {
-            ihist_hist16_2d(
+            ihist_hist16_2d_overflow(
                 sample_bits, static_cast<std::uint16_t const *>(img.data()),
                 msk.data(), img.height(), img.width(), img.stride(),
                 msk.stride(), n_components, n_hist_components,
-                component_indices.data(), hist_ptr, parallel);
+                component_indices.data(), hist_ptr, overflow_ptr, parallel);
+        }
+        for (std::size_t i = 0; i < level_bits.size(); ++i) {
+            ihist_histogram_rebin(sample_bits, n_hist_components, hist_ptr,
+                                  level_bits[i], level_ptrs[i]);
         }
     }
 
-    return out_array;
+    if (!return_overflow && levels_obj.is_none()) {
+        return out_array;
+    }
+    if (!return_overflow) {
+        return nb::make_tuple(out_array, levels);
+    }
+
+    // Match the histogram's dimensionality: a scalar count for a 1D
+    // histogram, else one count per histogrammed component.
+    nb::object overflow_obj;
+    if (hist_ndim == 1) {
+        overflow_obj = nb::int_(overflow[0]);
+    } else {
+        std::size_t shape[1] = {n_hist_components};
+        nb::ndarray<nb::numpy, std::uint32_t> arr(nullptr, 1, shape,
+                                                  nb::handle());
+        overflow_obj = nb::cast(arr);
+        auto out_arr = nb::cast<nb::ndarray<std::uint32_t>>(overflow_obj);
+        std::copy(overflow.begin(), overflow.end(), out_arr.data());
+    }
+    if (levels_obj.is_none()) {
+        return nb::make_tuple(out_array, overflow_obj);
+    }
+    return nb::make_tuple(out_array, overflow_obj, levels);
 }
 
-NB_MODULE(_ihist, m) {
-    m.doc() = "Fast image histograms";
+// Fused histogram and 16-to-8-bit LUT application. Unlike histogram(), this
+// takes the image as C-contiguous (copying other layouts) so that the output
+// can share its layout, and always histograms all components.
+nb::tuple histogram_lut8(nb::ndarray<nb::ro> image, nb::ndarray<nb::ro> lut,
+                         nb::object bits_obj, nb::object mask_obj,
+                         nb::object out_obj, nb::object display_out_obj,
+                         bool accumulate, bool parallel) {
+    if (image.dtype() != nb::dtype<std::uint16_t>()) {
+        throw std::invalid_argument("Image must have dtype uint16");
+    }
+    std::size_t const ndim = image.ndim();
+    if (ndim < 1 || ndim > 3) {
+        throw std::invalid_argument("Image must be 1D, 2D, or 3D, got " +
+                                    std::to_string(ndim) + "D");
+    }
+    std::size_t const height = ndim == 1 ? 1 : image.shape(0);
+    std::size_t const width = ndim == 1 ? image.shape(0) : image.shape(1);
+    std::size_t const n_components = ndim == 3 ? image.shape(2) : 1;
+    if (height * width > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("Image has too many pixels");
+    }
 
-    m.def("histogram", &histogram, nb::arg("image"), nb::kw_only(),
-          nb::arg("bits") = nb::none(), nb::arg("mask") = nb::none(),
-          nb::arg("components") = nb::none(), nb::arg("out") = nb::none(),
-          nb::arg("accumulate") = false, nb::arg("parallel") = true,
-          R"doc(
-        Compute histogram of image pixel values.
+    std::size_t sample_bits = 16;
+    if (!bits_obj.is_none()) {
+        auto const bits_signed = nb::cast<std::int64_t>(bits_obj);
+        if (bits_signed < 0 || bits_signed > 16) {
+            throw std::invalid_argument("bits must be in range [0, 16], got " +
+                                        std::to_string(bits_signed));
+        }
+        sample_bits = static_cast<std::size_t>(bits_signed);
+    }
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
 
-        Parameters
-        ----------
-        image : array_like
-            Input image data. Must be uint8 or uint16, and 1D, 2D, or 3D.
-            - 1D arrays (W,) are interpreted as (1, W, 1)
-            - 2D arrays (H, W) are interpreted as (H, W, 1)
-            - 3D arrays (H, W, C) use C as number of components per pixel
-            Total pixel count must not exceed `2^32-1`.
+    if (lut.dtype() != nb::dtype<std::uint8_t>() || lut.ndim() != 1 ||
+        lut.shape(0) != n_bins) {
+        throw std::invalid_argument("LUT must be a 1D uint8 array of length "
+                                    "2^bits (" +
+                                    std::to_string(n_bins) + ")");
+    }
+    auto lut_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(lut.cast());
+    auto image_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(image.cast());
 
-        bits : int, optional
-            Number of significant bits per sample. If not specified, defaults
-            to full depth (8 for uint8, 16 for uint16). Valid range: [0, 8] for
-            uint8, [0, 16] for uint16.
+    nb::ndarray<nb::ro, nb::c_contig> mask_c;
+    std::uint8_t const *mask_ptr = nullptr;
+    if (!mask_obj.is_none()) {
+        auto mask = nb::cast<nb::ndarray<nb::ro>>(mask_obj);
+        bool const shape_ok =
+            ndim == 1 ? mask.ndim() == 1 && mask.shape(0) == width
+                      : mask.ndim() == 2 && mask.shape(0) == height &&
+                            mask.shape(1) == width;
+        if (mask.dtype() != nb::dtype<std::uint8_t>() || !shape_ok) {
+            throw std::invalid_argument(
+                "Mask must be uint8 with the image's height and width");
+        }
+        mask_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(mask.cast());
+        mask_ptr = static_cast<std::uint8_t const *>(mask_c.data());
+    }
 
-        mask : array_like, optional
-            Per-pixel mask. Must be uint8. Shape must match image dimensions:
-            - For 1D images: mask must be 1D with shape (W,)
-            - For 2D/3D images: mask must be 2D with shape (H, W)
-            Only pixels with non-zero mask values are included. If not
-            specified, all pixels are included.
+    // Histogram shape follows histogram(): 2D only for a 3D image.
+    std::size_t const hist_ndim = ndim == 3 ? 2 : 1;
+    std::size_t const hist_shape[2] = {ndim == 3 ? n_components : n_bins,
+                                       n_bins};
+    nb::object hist_obj = out_obj;
+    if (out_obj.is_none()) {
+        nb::ndarray<nb::numpy, std::uint32_t> arr(nullptr, hist_ndim,
+                                                  hist_shape, nb::handle());
+        hist_obj = nb::cast(arr);
+        accumulate = false;
+    }
+    auto hist = nb::cast<nb::ndarray<std::uint32_t, nb::c_contig>>(hist_obj);
+    if (hist.ndim() != hist_ndim || hist.shape(0) != hist_shape[0] ||
+        (hist_ndim == 2 && hist.shape(1) != hist_shape[1])) {
+        throw std::invalid_argument("Output histogram has incorrect shape");
+    }
 
-        components : sequence of int, optional
-            Indices of components to histogram. If not specified, all
-            components are histogrammed. Each index must be in range
-            [0, n_components). For example, given an RGBA image (C = 4),
-            components=[0, 1, 2] will histogram the R, G, and B components only.
+    nb::object display_obj = display_out_obj;
+    if (display_out_obj.is_none()) {
+        std::size_t const shape[3] = {image.shape(0),
+                                      ndim > 1 ? image.shape(1) : 0,
+                                      ndim > 2 ? image.shape(2) : 0};
+        nb::ndarray<nb::numpy, std::uint8_t> arr(nullptr, ndim, shape,
+                                                 nb::handle());
+        display_obj = nb::cast(arr);
+    }
+    auto display =
+        nb::cast<nb::ndarray<std::uint8_t, nb::c_contig>>(display_obj);
+    bool shape_match = display.ndim() == ndim;
+    for (std::size_t i = 0; shape_match && i < ndim; ++i) {
+        shape_match = display.shape(i) == image.shape(i);
+    }
+    if (!shape_match) {
+        throw std::invalid_argument(
+            "Display output must have the same shape as the image");
+    }
 
-        out : array_like, optional
-            Pre-allocated output buffer. Must be uint32, and either 1D with
-            shape (2^bits,) for single-component histogram, or 2D with shape
-            (n_hist_components, 2^bits). If not specified, a new array is
-            allocated and returned.
+    std::uint32_t *hist_ptr = hist.data();
+    if (!accumulate) {
+        std::fill(hist_ptr, hist_ptr + n_components * n_bins, 0);
+    }
+    std::vector<std::size_t> indices(n_components);
+    std::iota(indices.begin(), indices.end(), 0);
+    {
+        nb::gil_scoped_release gil_released;
+        ihist_hist16_2d_lut8(
+            sample_bits, static_cast<std::uint16_t const *>(image_c.data()),
+            mask_ptr, height, width, width, width, n_components, n_components,
+            indices.data(), hist_ptr,
+            static_cast<std::uint8_t const *>(lut_c.data()), display.data(),
+            width, parallel);
+    }
+    return nb::make_tuple(hist_obj, display_obj);
+}
 
-        accumulate : bool, optional
-            If False (default), the output buffer is zeroed before computing
-            the histogram. If True, histogram values are accumulated into the
-            existing buffer values. No effect if 'out' is not given.
+// Histogram of a dark- and gain-corrected uint16 image. Like histogram_lut8(),
+// takes the image (and the correction planes) as C-contiguous.
+nb::object histogram_corrected(nb::ndarray<nb::ro> image, nb::object dark_obj,
+                               nb::object gain_obj, std::size_t gain_bits,
+                               nb::object bits_obj, nb::object mask_obj,
+                               bool parallel) {
+    if (image.dtype() != nb::dtype<std::uint16_t>()) {
+        throw std::invalid_argument("Image must have dtype uint16");
+    }
+    std::size_t const ndim = image.ndim();
+    if (ndim < 1 || ndim > 3) {
+        throw std::invalid_argument("Image must be 1D, 2D, or 3D, got " +
+                                    std::to_string(ndim) + "D");
+    }
+    std::size_t const height = ndim == 1 ? 1 : image.shape(0);
+    std::size_t const width = ndim == 1 ? image.shape(0) : image.shape(1);
+    std::size_t const n_components = ndim == 3 ? image.shape(2) : 1;
+    if (height * width > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("Image has too many pixels");
+    }
+    if (gain_bits > 16) {
+        throw std::invalid_argument(
+            "gain_bits must be in range [0, 16], got " +
+            std::to_string(gain_bits));
+    }
 
-        parallel : bool, optional
-            If True (default), allows automatic multi-threaded execution for
-            large images. If False, guarantees single-threaded execution.
+    std::size_t sample_bits = 16;
+    if (!bits_obj.is_none()) {
+        auto const bits_signed = nb::cast<std::int64_t>(bits_obj);
+        if (bits_signed < 0 || bits_signed > 16) {
+            throw std::invalid_argument("bits must be in range [0, 16], got " +
+                                        std::to_string(bits_signed));
+        }
+        sample_bits = static_cast<std::size_t>(bits_signed);
+    }
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
 
-        Returns
-        -------
-        histogram : ndarray
-            Histogram(s) as uint32 array. If the image is 1D or 2D and
-            'components' is not specified, returns 1D array of shape
-            (2^bits,). If the image is 3D or 'components' is explicitly
-            specified, returns 2D array of shape (n_hist_components, 2^bits).
-            If 'out' was provided, returns the same array after filling.
+    auto image_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(image.cast());
+
+    // Correction planes must match the image exactly.
+    auto const plane = [&](nb::object obj, char const *name,
+                           nb::ndarray<nb::ro, nb::c_contig> &plane_c)
+        -> std::uint16_t const * {
+        if (obj.is_none()) {
+            return nullptr;
+        }
+        auto arr = nb::cast<nb::ndarray<nb::ro>>(obj);
+        bool shape_match = arr.ndim() == ndim;
+        for (std::size_t i = 0; shape_match && i < ndim; ++i) {
+            shape_match = arr.shape(i) == image.shape(i);
+        }
+        if (arr.dtype() != nb::dtype<std::uint16_t>() || !shape_match) {
+            throw std::invalid_argument(
+                std::string(name) +
+                " must be uint16 with the same shape as the image");
+        }
+        plane_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(arr.cast());
+        return static_cast<std::uint16_t const *>(plane_c.data());
+    };
+    nb::ndarray<nb::ro, nb::c_contig> dark_c, gain_c;
+    std::uint16_t const *dark_ptr = plane(dark_obj, "dark", dark_c);
+    std::uint16_t const *gain_ptr = plane(gain_obj, "gain", gain_c);
+
+    nb::ndarray<nb::ro, nb::c_contig> mask_c;
+    std::uint8_t const *mask_ptr = nullptr;
+    if (!mask_obj.is_none()) {
+        auto mask = nb::cast<nb::ndarray<nb::ro>>(mask_obj);
+        bool const shape_ok =
+            ndim == 1 ? mask.ndim() == 1 && mask.shape(0) == width
+                      : mask.ndim() == 2 && mask.shape(0) == height &&
+                            mask.shape(1) == width;
+        if (mask.dtype() != nb::dtype<std::uint8_t>() || !shape_ok) {
+            throw std::invalid_argument(
+                "Mask must be uint8 with the image's height and width");
+        }
+        mask_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(mask.cast());
+        mask_ptr = static_cast<std::uint8_t const *>(mask_c.data());
+    }
+
+    // Histogram shape follows histogram(): 2D only for a 3D image.
+    std::size_t const hist_ndim = ndim == 3 ? 2 : 1;
+    std::size_t const hist_shape[2] = {ndim == 3 ? n_components : n_bins,
+                                       n_bins};
+    nb::ndarray<nb::numpy, std::uint32_t> arr(nullptr, hist_ndim, hist_shape,
+                                              nb::handle());
+    auto hist_obj = nb::cast(arr);
+    std::uint32_t *hist_ptr =
+        nb::cast<nb::ndarray<std::uint32_t>>(hist_obj).data();
+    std::fill(hist_ptr, hist_ptr + n_components * n_bins, 0);
+
+    std::vector<std::size_t> indices(n_components);
+    std::iota(indices.begin(), indices.end(), 0);
+    {
+        nb::gil_scoped_release gil_released;
+        ihist_hist16_2d_corrected(
+            sample_bits, static_cast<std::uint16_t const *>(image_c.data()),
+            mask_ptr, height, width, width, width, n_components, n_components,
+            indices.data(), dark_ptr, gain_ptr, gain_bits, hist_ptr,
+            parallel);
+    }
+    return hist_obj;
+}
+
+// Histogram of the difference between two frames. Like histogram_lut8(),
+// takes the images as C-contiguous.
+nb::object histogram_difference(nb::ndarray<nb::ro> image,
+                                nb::ndarray<nb::ro> previous, bool is_signed,
+                                nb::object bits_obj, nb::object mask_obj,
+                                bool parallel) {
+    bool const is_8bit = image.dtype() == nb::dtype<std::uint8_t>();
+    if (!is_8bit && image.dtype() != nb::dtype<std::uint16_t>()) {
+        throw std::invalid_argument("Image must have dtype uint8 or uint16");
+    }
+    std::size_t const ndim = image.ndim();
+    if (ndim < 1 || ndim > 3) {
+        throw std::invalid_argument("Image must be 1D, 2D, or 3D, got " +
+                                    std::to_string(ndim) + "D");
+    }
+    bool shape_match =
+        previous.dtype() == image.dtype() && previous.ndim() == ndim;
+    for (std::size_t i = 0; shape_match && i < ndim; ++i) {
+        shape_match = previous.shape(i) == image.shape(i);
+    }
+    if (!shape_match) {
+        throw std::invalid_argument(
+            "Previous frame must have the same dtype and shape as the image");
+    }
+    std::size_t const height = ndim == 1 ? 1 : image.shape(0);
+    std::size_t const width = ndim == 1 ? image.shape(0) : image.shape(1);
+    std::size_t const n_components = ndim == 3 ? image.shape(2) : 1;
+    if (height * width > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("Image has too many pixels");
+    }
+
+    std::size_t const max_bits = is_8bit ? 8 : 16;
+    std::size_t sample_bits = max_bits;
+    if (!bits_obj.is_none()) {
+        auto const bits_signed = nb::cast<std::int64_t>(bits_obj);
+        if (bits_signed < 0 ||
+            static_cast<std::size_t>(bits_signed) > max_bits) {
+            throw std::invalid_argument("bits must be in range [0, " +
+                                        std::to_string(max_bits) + "], got " +
+                                        std::to_string(bits_signed));
+        }
+        sample_bits = static_cast<std::size_t>(bits_signed);
+    }
+    std::size_t const n_bins = std::size_t(1)
+                               << (is_signed ? sample_bits + 1 : sample_bits);
+
+    auto image_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(image.cast());
+    auto previous_c =
+        nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(previous.cast());
+
+    nb::ndarray<nb::ro, nb::c_contig> mask_c;
+    std::uint8_t const *mask_ptr = nullptr;
+    if (!mask_obj.is_none()) {
+        auto mask = nb::cast<nb::ndarray<nb::ro>>(mask_obj);
+        bool const shape_ok =
+            ndim == 1 ? mask.ndim() == 1 && mask.shape(0) == width
+                      : mask.ndim() == 2 && mask.shape(0) == height &&
+                            mask.shape(1) == width;
+        if (mask.dtype() != nb::dtype<std::uint8_t>() || !shape_ok) {
+            throw std::invalid_argument(
+                "Mask must be uint8 with the image's height and width");
+        }
+        mask_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(mask.cast());
+        mask_ptr = static_cast<std::uint8_t const *>(mask_c.data());
+    }
+
+    // Histogram shape follows histogram(): 2D only for a 3D image.
+    std::size_t const hist_ndim = ndim == 3 ? 2 : 1;
+    std::size_t const hist_shape[2] = {ndim == 3 ? n_components : n_bins,
+                                       n_bins};
+    nb::ndarray<nb::numpy, std::uint32_t> arr(nullptr, hist_ndim, hist_shape,
+                                              nb::handle());
+    auto hist_obj = nb::cast(arr);
+    std::uint32_t *hist_ptr =
+        nb::cast<nb::ndarray<std::uint32_t>>(hist_obj).data();
+    std::fill(hist_ptr, hist_ptr + n_components * n_bins, 0);
+
+    auto const mode =
+        is_signed ? IHIST_DIFFERENCE_SIGNED : IHIST_DIFFERENCE_ABSOLUTE;
+    std::vector<std::size_t> indices(n_components);
+    std::iota(indices.begin(), indices.end(), 0);
+    {
+        nb::gil_scoped_release gil_released;
+        if (is_8bit) {
+            ihist_hist8_2d_difference(
+                sample_bits, static_cast<std::uint8_t const *>(image_c.data()),
+                static_cast<std::uint8_t const *>(previous_c.data()), mask_ptr,
+                height, width, width, width, n_components, n_components,
+                indices.data(), mode, hist_ptr, parallel);
+        } else {
+            ihist_hist16_2d_difference(
+                sample_bits,
+                static_cast<std::uint16_t const *>(image_c.data()),
+                static_cast<std::uint16_t const *>(previous_c.data()),
+                mask_ptr, height, width, width, width, n_components,
+                n_components, indices.data(), mode, hist_ptr, parallel);
+        }
+    }
+    return hist_obj;
+}
+
+// Histogram an image while copying it to a caller-provided array. Like
+// histogram_lut8(), takes the image as C-contiguous.
+nb::object histogram_copy(nb::ndarray<nb::ro> image, nb::object dest_obj,
+                          nb::object bits_obj, nb::object mask_obj,
+                          bool non_temporal, bool parallel) {
+    bool const is_8bit = image.dtype() == nb::dtype<std::uint8_t>();
+    if (!is_8bit && image.dtype() != nb::dtype<std::uint16_t>()) {
+        throw std::invalid_argument("Image must have dtype uint8 or uint16");
+    }
+    std::size_t const ndim = image.ndim();
+    if (ndim < 1 || ndim > 3) {
+        throw std::invalid_argument("Image must be 1D, 2D, or 3D, got " +
+                                    std::to_string(ndim) + "D");
+    }
+    std::size_t const height = ndim == 1 ? 1 : image.shape(0);
+    std::size_t const width = ndim == 1 ? image.shape(0) : image.shape(1);
+    std::size_t const n_components = ndim == 3 ? image.shape(2) : 1;
+    if (height * width > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("Image has too many pixels");
+    }
+
+    std::size_t const max_bits = is_8bit ? 8 : 16;
+    std::size_t sample_bits = max_bits;
+    if (!bits_obj.is_none()) {
+        auto const bits_signed = nb::cast<std::int64_t>(bits_obj);
+        if (bits_signed < 0 ||
+            static_cast<std::size_t>(bits_signed) > max_bits) {
+            throw std::invalid_argument("bits must be in range [0, " +
+                                        std::to_string(max_bits) + "], got " +
+                                        std::to_string(bits_signed));
+        }
+        sample_bits = static_cast<std::size_t>(bits_signed);
+    }
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+
+    auto dest = nb::cast<nb::ndarray<nb::c_contig>>(dest_obj);
+    bool shape_match = dest.dtype() == image.dtype() && dest.ndim() == ndim;
+    for (std::size_t i = 0; shape_match && i < ndim; ++i) {
+        shape_match = dest.shape(i) == image.shape(i);
+    }
+    if (!shape_match) {
+        throw std::invalid_argument("Destination must be C-contiguous with "
+                                    "the same dtype and shape as the image");
+    }
+
+    auto image_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(image.cast());
+    if (dest.data() == image_c.data()) {
+        throw std::invalid_argument("Destination must not be the image");
+    }
+
+    nb::ndarray<nb::ro, nb::c_contig> mask_c;
+    std::uint8_t const *mask_ptr = nullptr;
+    if (!mask_obj.is_none()) {
+        auto mask = nb::cast<nb::ndarray<nb::ro>>(mask_obj);
+        bool const shape_ok =
+            ndim == 1 ? mask.ndim() == 1 && mask.shape(0) == width
+                      : mask.ndim() == 2 && mask.shape(0) == height &&
+                            mask.shape(1) == width;
+        if (mask.dtype() != nb::dtype<std::uint8_t>() || !shape_ok) {
+            throw std::invalid_argument(
+                "Mask must be uint8 with the image's height and width");
+        }
+        mask_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(mask.cast());
+        mask_ptr = static_cast<std::uint8_t const *>(mask_c.data());
+    }
+
+    // Histogram shape follows histogram(): 2D only for a 3D image.
+    std::size_t const hist_ndim = ndim == 3 ? 2 : 1;
+    std::size_t const hist_shape[2] = {ndim == 3 ? n_components : n_bins,
+                                       n_bins};
+    nb::ndarray<nb::numpy, std::uint32_t> arr(nullptr, hist_ndim, hist_shape,
+                                              nb::handle());
+    auto hist_obj = nb::cast(arr);
+    std::uint32_t *hist_ptr =
+        nb::cast<nb::ndarray<std::uint32_t>>(hist_obj).data();
+    std::fill(hist_ptr, hist_ptr + n_components * n_bins, 0);
+
+    std::vector<std::size_t> indices(n_components);
+    std::iota(indices.begin(), indices.end(), 0);
+    {
+        nb::gil_scoped_release gil_released;
+        if (is_8bit) {
+            ihist_hist8_2d_copy(
+                sample_bits, static_cast<std::uint8_t const *>(image_c.data()),
+                mask_ptr, height, width, width, width, n_components,
+                n_components, indices.data(), hist_ptr,
+                static_cast<std::uint8_t *>(dest.data()), width, non_temporal,
+                parallel);
+        } else {
+            ihist_hist16_2d_copy(
+                sample_bits,
+                static_cast<std::uint16_t const *>(image_c.data()), mask_ptr,
+                height, width, width, width, n_components, n_components,
+                indices.data(), hist_ptr,
+                static_cast<std::uint16_t *>(dest.data()), width, non_temporal,
+                parallel);
+        }
+    }
+    return hist_obj;
+}
+
+// One histogram of many tiles. Each tile is taken as C-contiguous (copying
+// other layouts), and must share dtype and component count with the others.
+nb::object histogram_tiles(nb::sequence tiles_seq, nb::object bits_obj,
+                           nb::object masks_obj, bool parallel) {
+    std::size_t const n_tiles = nb::len(tiles_seq);
+    if (n_tiles == 0) {
+        throw std::invalid_argument("At least one tile is required");
+    }
+
+    std::vector<nb::ndarray<nb::ro, nb::c_contig>> images, masks;
+    images.reserve(n_tiles);
+    masks.reserve(n_tiles);
+    nb::sequence masks_seq;
+    if (!masks_obj.is_none()) {
+        masks_seq = nb::cast<nb::sequence>(masks_obj);
+        if (nb::len(masks_seq) != n_tiles) {
+            throw std::invalid_argument(
+                "masks must have one entry (or None) per tile");
+        }
+    }
+
+    bool is_8bit = false;
+    std::size_t ndim = 0;
+    std::size_t n_components = 0;
+    std::size_t total_pixels = 0;
+    for (std::size_t t = 0; t < n_tiles; ++t) {
+        auto tile = nb::cast<nb::ndarray<nb::ro>>(tiles_seq[t]);
+        bool const tile_8bit = tile.dtype() == nb::dtype<std::uint8_t>();
+        if (!tile_8bit && tile.dtype() != nb::dtype<std::uint16_t>()) {
+            throw std::invalid_argument(
+                "Tiles must have dtype uint8 or uint16");
+        }
+        if (tile.ndim() != 2 && tile.ndim() != 3) {
+            throw std::invalid_argument("Tiles must be 2D or 3D, got " +
+                                        std::to_string(tile.ndim()) + "D");
+        }
+        std::size_t const nc = tile.ndim() == 3 ? tile.shape(2) : 1;
+        if (t == 0) {
+            is_8bit = tile_8bit;
+            ndim = tile.ndim();
+            n_components = nc;
+        } else if (tile_8bit != is_8bit || tile.ndim() != ndim ||
+                   nc != n_components) {
+            throw std::invalid_argument(
+                "All tiles must have the same dtype and number of components");
+        }
+        total_pixels += tile.shape(0) * tile.shape(1);
+        images.push_back(
+            nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(tile.cast()));
+
+        nb::ndarray<nb::ro, nb::c_contig> mask_c;
+        if (!masks_obj.is_none() && !masks_seq[t].is_none()) {
+            auto mask = nb::cast<nb::ndarray<nb::ro>>(masks_seq[t]);
+            if (mask.dtype() != nb::dtype<std::uint8_t>() ||
+                mask.ndim() != 2 || mask.shape(0) != tile.shape(0) ||
+                mask.shape(1) != tile.shape(1)) {
+                throw std::invalid_argument(
+                    "Mask must be uint8 with the tile's height and width");
+            }
+            mask_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(mask.cast());
+        }
+        masks.push_back(mask_c);
+    }
+    if (total_pixels > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("Tiles have too many pixels");
+    }
+
+    std::size_t const max_bits = is_8bit ? 8 : 16;
+    std::size_t sample_bits = max_bits;
+    if (!bits_obj.is_none()) {
+        auto const bits_signed = nb::cast<std::int64_t>(bits_obj);
+        if (bits_signed < 0 ||
+            static_cast<std::size_t>(bits_signed) > max_bits) {
+            throw std::invalid_argument("bits must be in range [0, " +
+                                        std::to_string(max_bits) + "], got " +
+                                        std::to_string(bits_signed));
+        }
+        sample_bits = static_cast<std::size_t>(bits_signed);
+    }
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+
+    // Histogram shape follows histogram(): 2D only for 3D tiles.
+    std::size_t const hist_ndim = ndim == 3 ? 2 : 1;
+    std::size_t const hist_shape[2] = {ndim == 3 ? n_components : n_bins,
+                                       n_bins};
+    nb::ndarray<nb::numpy, std::uint32_t> arr(nullptr, hist_ndim, hist_shape,
+                                              nb::handle());
+    auto hist_obj = nb::cast(arr);
+    std::uint32_t *hist_ptr =
+        nb::cast<nb::ndarray<std::uint32_t>>(hist_obj).data();
+    std::fill(hist_ptr, hist_ptr + n_components * n_bins, 0);
+
+    std::vector<std::size_t> indices(n_components);
+    std::iota(indices.begin(), indices.end(), 0);
+    auto const fill_tile = [&](auto &tile, std::size_t t) {
+        using P = std::remove_const_t<
+            std::remove_pointer_t<decltype(tile.image)>>;
+        tile.image = static_cast<P const *>(images[t].data());
+        tile.mask = masks[t].is_valid()
+                        ? static_cast<std::uint8_t const *>(masks[t].data())
+                        : nullptr;
+        tile.height = images[t].shape(0);
+        tile.width = images[t].shape(1);
+        tile.image_stride = tile.width;
+        tile.mask_stride = tile.mask != nullptr ? tile.width : 0;
+    };
+    if (is_8bit) {
+        std::vector<ihist_tile8> tiles(n_tiles);
+        for (std::size_t t = 0; t < n_tiles; ++t) {
+            fill_tile(tiles[t], t);
+        }
+        nb::gil_scoped_release gil_released;
+        ihist_hist8_tiles(sample_bits, n_tiles, tiles.data(), n_components,
+                          n_components, indices.data(), hist_ptr, parallel);
+    } else {
+        std::vector<ihist_tile16> tiles(n_tiles);
+        for (std::size_t t = 0; t < n_tiles; ++t) {
+            fill_tile(tiles[t], t);
+        }
+        nb::gil_scoped_release gil_released;
+        ihist_hist16_tiles(sample_bits, n_tiles, tiles.data(), n_components,
+                           n_components, indices.data(), hist_ptr, parallel);
+    }
+    return hist_obj;
+}
+
+// Histograms of many images (such as ROIs), validated up front and computed
+// in a single GIL-released call, distributing the images across threads.
+nb::list histogram_many(nb::sequence images_seq, nb::object bits_obj,
+                        nb::object masks_obj, nb::object components_obj,
+                        bool parallel) {
+    std::size_t const n_images = nb::len(images_seq);
+    nb::list result;
+    if (n_images == 0) {
+        return result;
+    }
+    nb::sequence masks_seq;
+    if (!masks_obj.is_none()) {
+        masks_seq = nb::cast<nb::sequence>(masks_obj);
+        if (nb::len(masks_seq) != n_images) {
+            throw std::invalid_argument(
+                "masks must have one entry (or None) per image");
+        }
+    }
+
+    // The arrays (and any copies made by the views) must stay alive until
+    // the call completes.
+    std::vector<nb::ndarray<nb::ro>> arrays;
+    std::vector<ImageView> imgs;
+    std::vector<MaskView> msks;
+    arrays.reserve(2 * n_images);
+    imgs.reserve(n_images);
+    msks.reserve(n_images);
+    bool is_8bit = false;
+    std::size_t ndim = 0;
+    std::size_t n_components = 0;
+    for (std::size_t i = 0; i < n_images; ++i) {
+        auto &image =
+            arrays.emplace_back(nb::cast<nb::ndarray<nb::ro>>(images_seq[i]));
+        bool const image_8bit = image.dtype() == nb::dtype<std::uint8_t>();
+        if (!image_8bit && image.dtype() != nb::dtype<std::uint16_t>()) {
+            throw std::invalid_argument(
+                "Images must have dtype uint8 or uint16");
+        }
+        if (image.ndim() < 1 || image.ndim() > 3) {
+            throw std::invalid_argument("Images must be 1D, 2D, or 3D, got " +
+                                        std::to_string(image.ndim()) + "D");
+        }
+        std::size_t const nc = image.ndim() == 3 ? image.shape(2) : 1;
+        if (i == 0) {
+            is_8bit = image_8bit;
+            ndim = image.ndim();
+            n_components = nc;
+        } else if (image_8bit != is_8bit || image.ndim() != ndim ||
+                   nc != n_components) {
+            throw std::invalid_argument(
+                "All images must have the same dtype, dimensionality, and "
+                "number of components");
+        }
+        std::size_t const height = ndim == 1 ? 1 : image.shape(0);
+        std::size_t const width = ndim == 1 ? image.shape(0) : image.shape(1);
+        if (height * width > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::invalid_argument("Image has too many pixels");
+        }
+        imgs.emplace_back(image, ndim, height, width, nc, is_8bit ? 1 : 2);
+
+        msks.emplace_back(imgs.back().width());
+        if (!masks_obj.is_none() && !masks_seq[i].is_none()) {
+            auto &mask = arrays.emplace_back(
+                nb::cast<nb::ndarray<nb::ro>>(masks_seq[i]));
+            bool const shape_ok =
+                ndim == 1 ? mask.ndim() == 1 && mask.shape(0) == width
+                          : mask.ndim() == 2 && mask.shape(0) == height &&
+                                mask.shape(1) == width;
+            if (mask.dtype() != nb::dtype<std::uint8_t>() || !shape_ok) {
+                throw std::invalid_argument(
+                    "Mask must be uint8 with the image's height and width");
+            }
+            msks.back() =
+                ndim == 1 ? MaskView(mask, width)
+                          : MaskView(mask, height, width,
+                                     imgs.back().transposed());
+        }
+    }
+
+    std::size_t const max_bits = is_8bit ? 8 : 16;
+    std::size_t sample_bits = max_bits;
+    if (!bits_obj.is_none()) {
+        auto const bits_signed = nb::cast<std::int64_t>(bits_obj);
+        if (bits_signed < 0 ||
+            static_cast<std::size_t>(bits_signed) > max_bits) {
+            throw std::invalid_argument("bits must be in range [0, " +
+                                        std::to_string(max_bits) + "], got " +
+                                        std::to_string(bits_signed));
+        }
+        sample_bits = static_cast<std::size_t>(bits_signed);
+    }
+
+    std::vector<std::size_t> indices(n_components);
+    std::iota(indices.begin(), indices.end(), 0);
+    if (!components_obj.is_none()) {
+        auto const seq = nb::cast<nb::sequence>(components_obj);
+        indices.resize(nb::len(seq));
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            auto const idx = nb::cast<std::int64_t>(seq[i]);
+            if (idx < 0 || static_cast<std::size_t>(idx) >= n_components) {
+                throw std::invalid_argument(
+                    "Component index " + std::to_string(idx) +
+                    " out of range [0, " + std::to_string(n_components) + ")");
+            }
+            indices[i] = static_cast<std::size_t>(idx);
+        }
+    }
+    std::size_t const n_hist = indices.size();
+
+    // Same shape rule as histogram().
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    bool const hist_2d = ndim == 3 || !components_obj.is_none();
+    std::size_t const shape[2] = {hist_2d ? n_hist : n_bins, n_bins};
+    std::vector<std::uint32_t *> hist_ptrs(n_images);
+    for (std::size_t i = 0; i < n_images; ++i) {
+        nb::ndarray<nb::numpy, std::uint32_t> arr(nullptr, hist_2d ? 2 : 1,
+                                                  shape, nb::handle());
+        auto hist_obj = nb::cast(arr);
+        hist_ptrs[i] = nb::cast<nb::ndarray<std::uint32_t>>(hist_obj).data();
+        std::fill(hist_ptrs[i], hist_ptrs[i] + n_hist * n_bins, 0);
+        result.append(hist_obj);
+    }
+
+    auto const fill_image = [&](auto &image, std::size_t i) {
+        using P = std::remove_const_t<
+            std::remove_pointer_t<decltype(image.image)>>;
+        image.image = static_cast<P const *>(imgs[i].data());
+        image.mask = msks[i].data();
+        image.height = imgs[i].height();
+        image.width = imgs[i].width();
+        image.image_stride = imgs[i].stride();
+        image.mask_stride = msks[i].stride();
+    };
+    if (is_8bit) {
+        std::vector<ihist_tile8> images(n_images);
+        for (std::size_t i = 0; i < n_images; ++i) {
+            fill_image(images[i], i);
+        }
+        nb::gil_scoped_release gil_released;
+        ihist_hist8_2d_batch(sample_bits, n_images, images.data(),
+                             n_components, n_hist, indices.data(),
+                             hist_ptrs.data(), parallel);
+    } else {
+        std::vector<ihist_tile16> images(n_images);
+        for (std::size_t i = 0; i < n_images; ++i) {
+            fill_image(images[i], i);
+        }
+        nb::gil_scoped_release gil_released;
+        ihist_hist16_2d_batch(sample_bits, n_images, images.data(),
+                              n_components, n_hist, indices.data(),
+                              hist_ptrs.data(), parallel);
+    }
+    return result;
+}
+
+// Sparse histogram: (bins, counts) arrays of the nonzero bins, or a list of
+// them (one per component) where histogram() would return a 2D array.
+nb::object histogram_sparse(nb::ndarray<nb::ro> image, nb::object bits_obj,
+                            nb::object mask_obj, nb::object components_obj,
+                            bool parallel) {
+    bool const is_8bit = image.dtype() == nb::dtype<std::uint8_t>();
+    bool const is_32bit = image.dtype() == nb::dtype<std::uint32_t>();
+    if (!is_8bit && !is_32bit &&
+        image.dtype() != nb::dtype<std::uint16_t>()) {
+        throw std::invalid_argument(
+            "Image must have dtype uint8, uint16, or uint32");
+    }
+    std::size_t const elem_size = is_8bit ? 1 : is_32bit ? 4 : 2;
+    std::size_t const ndim = image.ndim();
+    if (ndim < 1 || ndim > 3) {
+        throw std::invalid_argument("Image must be 1D, 2D, or 3D, got " +
+                                    std::to_string(ndim) + "D");
+    }
+    std::size_t const height = ndim == 1 ? 1 : image.shape(0);
+    std::size_t const width = ndim == 1 ? image.shape(0) : image.shape(1);
+    std::size_t const n_components = ndim == 3 ? image.shape(2) : 1;
+    if (height * width > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("Image has too many pixels");
+    }
+    ImageView const img(image, ndim, height, width, n_components,
+                        elem_size);
+
+    std::size_t const max_bits = 8 * elem_size;
+    std::size_t sample_bits = max_bits;
+    if (!bits_obj.is_none()) {
+        auto const bits_signed = nb::cast<std::int64_t>(bits_obj);
+        if (bits_signed < 0 ||
+            static_cast<std::size_t>(bits_signed) > max_bits) {
+            throw std::invalid_argument("bits must be in range [0, " +
+                                        std::to_string(max_bits) + "], got " +
+                                        std::to_string(bits_signed));
+        }
+        sample_bits = static_cast<std::size_t>(bits_signed);
+    }
+
+    std::vector<std::size_t> indices(n_components);
+    std::iota(indices.begin(), indices.end(), 0);
+    if (!components_obj.is_none()) {
+        auto const seq = nb::cast<nb::sequence>(components_obj);
+        indices.resize(nb::len(seq));
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            auto const idx = nb::cast<std::int64_t>(seq[i]);
+            if (idx < 0 || static_cast<std::size_t>(idx) >= n_components) {
+                throw std::invalid_argument(
+                    "Component index " + std::to_string(idx) +
+                    " out of range [0, " + std::to_string(n_components) + ")");
+            }
+            indices[i] = static_cast<std::size_t>(idx);
+        }
+    }
+    std::size_t const n_hist = indices.size();
+
+    MaskView msk(img.width());
+    if (!mask_obj.is_none()) {
+        auto mask = nb::cast<nb::ndarray<nb::ro>>(mask_obj);
+        bool const shape_ok =
+            ndim == 1 ? mask.ndim() == 1 && mask.shape(0) == width
+                      : mask.ndim() == 2 && mask.shape(0) == height &&
+                            mask.shape(1) == width;
+        if (mask.dtype() != nb::dtype<std::uint8_t>() || !shape_ok) {
+            throw std::invalid_argument(
+                "Mask must be uint8 with the image's height and width");
+        }
+        msk = ndim == 1 ? MaskView(mask, width)
+                        : MaskView(mask, height, width, img.transposed());
+    }
+
+    // Sparse output is at most as large as the number of pixels, so for the
+    // small images where it pays off, these buffers are small too.
+    std::size_t const capacity =
+        ihist_sparse_capacity(sample_bits, n_hist, height * width);
+    std::vector<std::uint16_t> bins(is_32bit ? 0 : capacity);
+    std::vector<std::uint32_t> keys(is_32bit ? capacity : 0);
+    std::vector<std::uint32_t> counts(capacity);
+    std::vector<std::size_t> n_nonzero(n_hist);
+    {
+        nb::gil_scoped_release gil_released;
+        if (is_8bit) {
+            ihist_hist8_2d_sparse(
+                sample_bits, static_cast<std::uint8_t const *>(img.data()),
+                msk.data(), img.height(), img.width(), img.stride(),
+                msk.stride(), n_components, n_hist, indices.data(),
+                bins.data(), counts.data(), n_nonzero.data(), parallel);
+        } else if (is_32bit) {
+            ihist_hist32_2d_sparse(
+                sample_bits, static_cast<std::uint32_t const *>(img.data()),
+                msk.data(), img.height(), img.width(), img.stride(),
+                msk.stride(), n_components, n_hist, indices.data(),
+                keys.data(), counts.data(), n_nonzero.data(), parallel);
+        } else {
+            ihist_hist16_2d_sparse(
+                sample_bits, static_cast<std::uint16_t const *>(img.data()),
+                msk.data(), img.height(), img.width(), img.stride(),
+                msk.stride(), n_components, n_hist, indices.data(),
+                bins.data(), counts.data(), n_nonzero.data(), parallel);
+        }
+    }
+
+    auto const make_array = [](auto const *src, std::size_t n) {
+        using V = std::remove_const_t<std::remove_pointer_t<decltype(src)>>;
+        std::size_t const shape[1] = {n};
+        nb::ndarray<nb::numpy, V> arr(nullptr, 1, shape, nb::handle());
+        auto obj = nb::cast(arr);
+        std::copy_n(src, n, nb::cast<nb::ndarray<V>>(obj).data());
+        return obj;
+    };
+    nb::list result;
+    std::size_t offset = 0;
+    for (std::size_t c = 0; c < n_hist; ++c) {
+        auto bins_obj = is_32bit
+                            ? make_array(keys.data() + offset, n_nonzero[c])
+                            : make_array(bins.data() + offset, n_nonzero[c]);
+        auto counts_obj = make_array(counts.data() + offset, n_nonzero[c]);
+        result.append(nb::make_tuple(bins_obj, counts_obj));
+        offset += n_nonzero[c];
+    }
+    // Same rule as histogram() for 1D versus 2D results.
+    if (ndim == 3 || !components_obj.is_none()) {
+        return result;
+    }
+    return result[0];
+}
+
+// Wrapper for ihist_accumulator, for histogramming images that arrive in row
+// bands. Feeds accept any layout that histogram() accepts without copying.
+class Accumulator {
+  public:
+    Accumulator(std::size_t sample_bits, std::size_t n_components,
+                nb::object components_obj)
+        : sample_bits_(sample_bits), n_components_(n_components) {
+        if (sample_bits > 16) {
+            throw std::invalid_argument("bits must be in range [0, 16], got " +
+                                        std::to_string(sample_bits));
+        }
+        if (n_components == 0) {
+            throw std::invalid_argument("n_components must be positive");
+        }
+        indices_.resize(n_components);
+        std::iota(indices_.begin(), indices_.end(), 0);
+        if (!components_obj.is_none()) {
+            auto const seq = nb::cast<nb::sequence>(components_obj);
+            indices_.resize(nb::len(seq));
+            for (std::size_t i = 0; i < indices_.size(); ++i) {
+                auto const idx = nb::cast<std::int64_t>(seq[i]);
+                if (idx < 0 || static_cast<std::size_t>(idx) >= n_components) {
+                    throw std::invalid_argument(
+                        "Component index " + std::to_string(idx) +
+                        " out of range [0, " + std::to_string(n_components) +
+                        ")");
+                }
+                indices_[i] = static_cast<std::size_t>(idx);
+            }
+        }
+        hist_2d_ = n_components > 1 || !components_obj.is_none();
+        acc_.reset(ihist_accumulator_create(sample_bits, n_components,
+                                            indices_.size(), indices_.data()));
+        if (!acc_) {
+            throw std::bad_alloc();
+        }
+    }
+
+    void feed(nb::ndarray<nb::ro> rows, nb::object mask_obj, bool parallel) {
+        bool const is_8bit = rows.dtype() == nb::dtype<std::uint8_t>();
+        if (!is_8bit && rows.dtype() != nb::dtype<std::uint16_t>()) {
+            throw std::invalid_argument("Rows must have dtype uint8 or uint16");
+        }
+        std::size_t const ndim = rows.ndim();
+        std::size_t const nc = ndim == 3 ? rows.shape(2) : 1;
+        if (ndim < 1 || ndim > 3 || nc != n_components_) {
+            throw std::invalid_argument(
+                "Rows must be 1D, 2D, or 3D with n_components (" +
+                std::to_string(n_components_) + ") components");
+        }
+        std::size_t const height = ndim == 1 ? 1 : rows.shape(0);
+        std::size_t const width = ndim == 1 ? rows.shape(0) : rows.shape(1);
+        ImageView const img(rows, ndim, height, width, nc, is_8bit ? 1 : 2);
+
+        MaskView msk(img.width());
+        if (!mask_obj.is_none()) {
+            auto mask = nb::cast<nb::ndarray<nb::ro>>(mask_obj);
+            bool const shape_ok =
+                ndim == 1 ? mask.ndim() == 1 && mask.shape(0) == width
+                          : mask.ndim() == 2 && mask.shape(0) == height &&
+                                mask.shape(1) == width;
+            if (mask.dtype() != nb::dtype<std::uint8_t>() || !shape_ok) {
+                throw std::invalid_argument(
+                    "Mask must be uint8 with the rows' height and width");
+            }
+            msk = ndim == 1 ? MaskView(mask, width)
+                            : MaskView(mask, height, width, img.transposed());
+        }
+
+        // With free-threaded Python, or while the GIL is released, feeds and
+        // finishes may come from several threads. Lock only without the GIL,
+        // so that waiting for the lock cannot deadlock with the GIL.
+        nb::gil_scoped_release gil_released;
+        std::lock_guard<std::mutex> const lock(mutex_);
+        if (is_8bit) {
+            ihist_accumulator_feed8(
+                acc_.get(), static_cast<std::uint8_t const *>(img.data()),
+                msk.data(), img.height(), img.width(), img.stride(),
+                msk.stride(), parallel);
+        } else {
+            ihist_accumulator_feed16(
+                acc_.get(), static_cast<std::uint16_t const *>(img.data()),
+                msk.data(), img.height(), img.width(), img.stride(),
+                msk.stride(), parallel);
+        }
+    }
+
+    auto finish(bool return_overflow) -> nb::object {
+        std::size_t const n_bins = std::size_t(1) << sample_bits_;
+        std::size_t const shape[2] = {hist_2d_ ? indices_.size() : n_bins,
+                                      n_bins};
+        nb::ndarray<nb::numpy, std::uint32_t> arr(nullptr, hist_2d_ ? 2 : 1,
+                                                  shape, nb::handle());
+        auto hist_obj = nb::cast(arr);
+        std::uint32_t *hist_ptr =
+            nb::cast<nb::ndarray<std::uint32_t>>(hist_obj).data();
+        std::fill(hist_ptr, hist_ptr + indices_.size() * n_bins, 0);
+        std::vector<std::uint32_t> overflow(indices_.size());
+        {
+            nb::gil_scoped_release gil_released;
+            std::lock_guard<std::mutex> const lock(mutex_);
+            ihist_accumulator_finish(acc_.get(), hist_ptr, overflow.data());
+        }
+        if (!return_overflow) {
+            return hist_obj;
+        }
+        if (!hist_2d_) {
+            return nb::make_tuple(hist_obj, nb::int_(overflow[0]));
+        }
+        std::size_t const ov_shape[1] = {indices_.size()};
+        nb::ndarray<nb::numpy, std::uint32_t> ov_arr(nullptr, 1, ov_shape,
+                                                     nb::handle());
+        auto ov_obj = nb::cast(ov_arr);
+        std::copy(overflow.begin(), overflow.end(),
+                  nb::cast<nb::ndarray<std::uint32_t>>(ov_obj).data());
+        return nb::make_tuple(hist_obj, ov_obj);
+    }
+
+  private:
+    struct deleter {
+        void operator()(ihist_accumulator *acc) const {
+            ihist_accumulator_destroy(acc);
+        }
+    };
+
+    std::size_t sample_bits_;
+    std::size_t n_components_;
+    std::vector<std::size_t> indices_;
+    bool hist_2d_;
+    std::unique_ptr<ihist_accumulator, deleter> acc_;
+    std::mutex mutex_;
+};
+
+// Wrappers for ihist_series_writer/reader. Histograms are passed as numpy
+// arrays of shape (2^bits,) or (n_components, 2^bits).
+auto fspath(nb::handle path) -> std::string {
+    return nb::str(nb::module_::import_("os").attr("fspath")(path)).c_str();
+}
+
+class HistogramSeriesWriter {
+  public:
+    HistogramSeriesWriter(nb::object const &path_obj, std::size_t sample_bits,
+                          std::size_t n_components,
+                          std::size_t keyframe_interval)
+        : n_counts_(n_components << sample_bits) {
+        if (sample_bits > 16) {
+            throw std::invalid_argument("bits must be in range [0, 16], got " +
+                                        std::to_string(sample_bits));
+        }
+        if (n_components == 0 || keyframe_interval == 0) {
+            throw std::invalid_argument(
+                "n_components and keyframe_interval must be positive");
+        }
+        std::string const path = fspath(path_obj);
+        writer_ = ihist_series_create(path.c_str(), sample_bits, n_components,
+                                      keyframe_interval);
+        if (writer_ == nullptr) {
+            throw std::runtime_error("Cannot create " + path);
+        }
+    }
+
+    ~HistogramSeriesWriter() {
+        if (writer_ != nullptr) {
+            ihist_series_close(writer_);
+        }
+    }
+
+    HistogramSeriesWriter(HistogramSeriesWriter const &) = delete;
+    auto operator=(HistogramSeriesWriter const &)
+        -> HistogramSeriesWriter & = delete;
+
+    void append(nb::ndarray<std::uint32_t const, nb::c_contig> histogram) {
+        if (histogram.size() != n_counts_) {
+            throw std::invalid_argument(
+                "Histogram must have n_components * 2^bits (" +
+                std::to_string(n_counts_) + ") counts");
+        }
+        bool closed = false;
+        bool ok = false;
+        {
+            // As for Accumulator, lock only without the GIL.
+            nb::gil_scoped_release gil_released;
+            std::lock_guard<std::mutex> const lock(mutex_);
+            closed = writer_ == nullptr;
+            ok = closed || ihist_series_append(writer_, histogram.data());
+        }
+        if (closed) {
+            throw std::runtime_error("Series writer is closed");
+        }
+        if (!ok) {
+            throw std::runtime_error("Write error in histogram series");
+        }
+    }
+
+    void close() {
+        bool ok = true;
+        {
+            nb::gil_scoped_release gil_released;
+            std::lock_guard<std::mutex> const lock(mutex_);
+            if (writer_ != nullptr) {
+                ok = ihist_series_close(writer_);
+                writer_ = nullptr;
+            }
+        }
+        if (!ok) {
+            throw std::runtime_error("Write error in histogram series");
+        }
+    }
+
+  private:
+    std::size_t n_counts_;
+    ihist_series_writer *writer_ = nullptr;
+    std::mutex mutex_;
+};
+
+class HistogramSeriesReader {
+  public:
+    explicit HistogramSeriesReader(nb::object const &path_obj) {
+        std::string const path = fspath(path_obj);
+        reader_ = ihist_series_open(path.c_str());
+        if (reader_ == nullptr) {
+            throw std::runtime_error("Cannot open " + path +
+                                     " as a histogram series");
+        }
+        ihist_series_info(reader_, &sample_bits_, &n_components_, &size_);
+    }
+
+    ~HistogramSeriesReader() { ihist_series_free(reader_); }
+
+    HistogramSeriesReader(HistogramSeriesReader const &) = delete;
+    auto operator=(HistogramSeriesReader const &)
+        -> HistogramSeriesReader & = delete;
+
+    auto bits() const -> std::size_t { return sample_bits_; }
+    auto n_components() const -> std::size_t { return n_components_; }
+    auto size() const -> std::size_t { return size_; }
+
+    auto get(std::int64_t index) -> nb::object {
+        auto const n = static_cast<std::int64_t>(size_);
+        if (index < -n || index >= n) {
+            throw nb::index_error("Histogram index out of range");
+        }
+        if (index < 0) {
+            index += n;
+        }
+        std::size_t const n_bins = std::size_t(1) << sample_bits_;
+        bool const hist_2d = n_components_ > 1;
+        std::size_t const shape[2] = {hist_2d ? n_components_ : n_bins,
+                                      n_bins};
+        nb::ndarray<nb::numpy, std::uint32_t> arr(nullptr, hist_2d ? 2 : 1,
+                                                  shape, nb::handle());
+        auto hist_obj = nb::cast(arr);
+        std::uint32_t *hist_ptr =
+            nb::cast<nb::ndarray<std::uint32_t>>(hist_obj).data();
+        bool closed = false;
+        bool ok = false;
+        {
+            // As for Accumulator, lock only without the GIL.
+            nb::gil_scoped_release gil_released;
+            std::lock_guard<std::mutex> const lock(mutex_);
+            closed = reader_ == nullptr;
+            ok = closed ||
+                 ihist_series_read(reader_, static_cast<std::size_t>(index),
+                                   hist_ptr);
+        }
+        if (closed) {
+            throw std::runtime_error("Series reader is closed");
+        }
+        if (!ok) {
+            throw std::runtime_error("Corrupt or unreadable histogram series");
+        }
+        return hist_obj;
+    }
+
+    void close() {
+        nb::gil_scoped_release gil_released;
+        std::lock_guard<std::mutex> const lock(mutex_);
+        ihist_series_free(reader_);
+        reader_ = nullptr;
+    }
+
+  private:
+    ihist_series_reader *reader_ = nullptr;
+    std::mutex mutex_;
+    std::size_t sample_bits_ = 0;
+    std::size_t n_components_ = 0;
+    std::size_t size_ = 0;
+};
+
+auto parse_derived_channel(std::string const &name) -> ihist_derived_channel {
+    if (name == "luma709") {
+        return IHIST_DERIVED_LUMA_709;
+    }
+    if (name == "luma601") {
+        return IHIST_DERIVED_LUMA_601;
+    }
+    if (name == "max") {
+        return IHIST_DERIVED_MAX;
+    }
+    if (name == "mean") {
+        return IHIST_DERIVED_MEAN;
+    }
+    throw std::invalid_argument("Unknown derived channel '" + name +
+                                "'; expected 'luma709', 'luma601', 'max', "
+                                "or 'mean'");
+}
+
+// Per-component histograms of a color image plus derived channels, in one
+// pass. Like histogram_lut8(), takes the image as C-contiguous.
+nb::object histogram_derived(nb::ndarray<nb::ro> image, nb::object derived_obj,
+                             nb::object bits_obj, nb::object mask_obj,
+                             nb::object rgb_obj, bool parallel) {
+    bool const is_8bit = image.dtype() == nb::dtype<std::uint8_t>();
+    if (!is_8bit && image.dtype() != nb::dtype<std::uint16_t>()) {
+        throw std::invalid_argument("Image must have dtype uint8 or uint16");
+    }
+    if (image.ndim() != 3) {
+        throw std::invalid_argument("Image must be 3D (H, W, C), got " +
+                                    std::to_string(image.ndim()) + "D");
+    }
+    std::size_t const height = image.shape(0);
+    std::size_t const width = image.shape(1);
+    std::size_t const n_components = image.shape(2);
+    if (height * width > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("Image has too many pixels");
+    }
+
+    std::size_t const max_bits = is_8bit ? 8 : 16;
+    std::size_t sample_bits = max_bits;
+    if (!bits_obj.is_none()) {
+        auto const bits_signed = nb::cast<std::int64_t>(bits_obj);
+        if (bits_signed < 0 ||
+            static_cast<std::size_t>(bits_signed) > max_bits) {
+            throw std::invalid_argument("bits must be in range [0, " +
+                                        std::to_string(max_bits) + "], got " +
+                                        std::to_string(bits_signed));
+        }
+        sample_bits = static_cast<std::size_t>(bits_signed);
+    }
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+
+    auto const derived_seq = nb::cast<nb::sequence>(derived_obj);
+    std::vector<ihist_derived_channel> derived;
+    for (std::size_t i = 0; i < nb::len(derived_seq); ++i) {
+        derived.push_back(
+            parse_derived_channel(nb::cast<std::string>(derived_seq[i])));
+    }
+
+    auto const rgb_seq = nb::cast<nb::sequence>(rgb_obj);
+    if (nb::len(rgb_seq) != 3) {
+        throw std::invalid_argument("rgb must have 3 component indices");
+    }
+    std::size_t rgb[3];
+    for (std::size_t i = 0; i < 3; ++i) {
+        auto const idx = nb::cast<std::int64_t>(rgb_seq[i]);
+        if (idx < 0 || static_cast<std::size_t>(idx) >= n_components) {
+            throw std::invalid_argument(
+                "Component index " + std::to_string(idx) +
+                " out of range [0, " + std::to_string(n_components) + ")");
+        }
+        rgb[i] = static_cast<std::size_t>(idx);
+    }
+
+    auto image_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(image.cast());
+    nb::ndarray<nb::ro, nb::c_contig> mask_c;
+    std::uint8_t const *mask_ptr = nullptr;
+    if (!mask_obj.is_none()) {
+        auto mask = nb::cast<nb::ndarray<nb::ro>>(mask_obj);
+        if (mask.dtype() != nb::dtype<std::uint8_t>() || mask.ndim() != 2 ||
+            mask.shape(0) != height || mask.shape(1) != width) {
+            throw std::invalid_argument(
+                "Mask must be uint8 with the image's height and width");
+        }
+        mask_c = nb::cast<nb::ndarray<nb::ro, nb::c_contig>>(mask.cast());
+        mask_ptr = static_cast<std::uint8_t const *>(mask_c.data());
+    }
+
+    std::size_t const n_hist = n_components + derived.size();
+    std::size_t const shape[2] = {n_hist, n_bins};
+    nb::ndarray<nb::numpy, std::uint32_t> arr(nullptr, 2, shape, nb::handle());
+    auto hist_obj = nb::cast(arr);
+    std::uint32_t *hist_ptr =
+        nb::cast<nb::ndarray<std::uint32_t>>(hist_obj).data();
+    std::fill(hist_ptr, hist_ptr + n_hist * n_bins, 0);
+
+    std::vector<std::size_t> indices(n_components);
+    std::iota(indices.begin(), indices.end(), 0);
+    {
+        nb::gil_scoped_release gil_released;
+        if (is_8bit) {
+            ihist_hist8_2d_derived(
+                sample_bits, static_cast<std::uint8_t const *>(image_c.data()),
+                mask_ptr, height, width, width, width, n_components,
+                n_components, indices.data(), rgb, derived.size(),
+                derived.data(), hist_ptr, parallel);
+        } else {
+            ihist_hist16_2d_derived(
+                sample_bits,
+                static_cast<std::uint16_t const *>(image_c.data()), mask_ptr,
+                height, width, width, width, n_components, n_components,
+                indices.data(), rgb, derived.size(), derived.data(), hist_ptr,
+                parallel);
+        }
+    }
+    return hist_obj;
+}
+
+nb::object auto_contrast_lut(nb::ndarray<nb::ro> histogram, double low,
+                             double high) {
+    HistogramView const hv(histogram);
+    if (hv.ndim() != 1) {
+        throw std::invalid_argument("Histogram must be 1D");
+    }
+    if (!(low >= 0.0 && low <= high && high <= 1.0)) {
+        throw std::invalid_argument(
+            "Quantiles must satisfy 0 <= low <= high <= 1");
+    }
+    std::size_t const shape[1] = {std::size_t(1) << hv.sample_bits()};
+    nb::ndarray<nb::numpy, std::uint8_t> arr(nullptr, 1, shape, nb::handle());
+    auto obj = nb::cast(arr);
+    ihist_auto_contrast_lut8(hv.sample_bits(), hv.data(), low, high,
+                             nb::cast<nb::ndarray<std::uint8_t>>(obj).data());
+    return obj;
+}
+
+// C functions exported for direct calls from compiled code (Numba, Cython,
+// cffi), bypassing the Python layer. Each capsule is named with the
+// function's signature, following the convention of
+// scipy.LowLevelCallable, so that callers can check it.
+struct c_api_entry {
+    char const *name;
+    void *address;
+    char const *signature;
+};
+
+template <typename F> auto c_api_address(F *f) -> void * {
+    return reinterpret_cast<void *>(f);
+}
+
+auto c_api_table() -> std::vector<c_api_entry> const & {
+    static std::vector<c_api_entry> const table{
+        {"ihist_hist8_2d", c_api_address(&ihist_hist8_2d),
+         "void (size_t, uint8_t const *, uint8_t const *, size_t, size_t, "
+         "size_t, size_t, size_t, size_t, size_t const *, uint32_t *, "
+         "bool)"},
+        {"ihist_hist16_2d", c_api_address(&ihist_hist16_2d),
+         "void (size_t, uint16_t const *, uint8_t const *, size_t, size_t, "
+         "size_t, size_t, size_t, size_t, size_t const *, uint32_t *, "
+         "bool)"},
+        {"ihist_hist8_2d_batch", c_api_address(&ihist_hist8_2d_batch),
+         "void (size_t, size_t, ihist_tile8 const *, size_t, size_t, "
+         "size_t const *, uint32_t *const *, bool)"},
+        {"ihist_hist16_2d_batch", c_api_address(&ihist_hist16_2d_batch),
+         "void (size_t, size_t, ihist_tile16 const *, size_t, size_t, "
+         "size_t const *, uint32_t *const *, bool)"},
+        {"ihist_accumulator_create", c_api_address(&ihist_accumulator_create),
+         "ihist_accumulator *(size_t, size_t, size_t, size_t const *)"},
+        {"ihist_accumulator_destroy",
+         c_api_address(&ihist_accumulator_destroy),
+         "void (ihist_accumulator *)"},
+        {"ihist_accumulator_feed8", c_api_address(&ihist_accumulator_feed8),
+         "void (ihist_accumulator *, uint8_t const *, uint8_t const *, "
+         "size_t, size_t, size_t, size_t, bool)"},
+        {"ihist_accumulator_feed16", c_api_address(&ihist_accumulator_feed16),
+         "void (ihist_accumulator *, uint16_t const *, uint8_t const *, "
+         "size_t, size_t, size_t, size_t, bool)"},
+        {"ihist_accumulator_finish", c_api_address(&ihist_accumulator_finish),
+         "void (ihist_accumulator *, uint32_t *, uint32_t *)"},
+        {"ihist_sparse_capacity", c_api_address(&ihist_sparse_capacity),
+         "size_t (size_t, size_t, size_t)"},
+        {"ihist_hist16_2d_sparse", c_api_address(&ihist_hist16_2d_sparse),
+         "size_t (size_t, uint16_t const *, uint8_t const *, size_t, size_t, "
+         "size_t, size_t, size_t, size_t, size_t const *, uint16_t *, "
+         "uint32_t *, size_t *, bool)"},
+        {"ihist_hist32_2d_sparse", c_api_address(&ihist_hist32_2d_sparse),
+         "size_t (size_t, uint32_t const *, uint8_t const *, size_t, size_t, "
+         "size_t, size_t, size_t, size_t, size_t const *, uint32_t *, "
+         "uint32_t *, size_t *, bool)"},
+    };
+    return table;
+}
+
+NB_MODULE(_ihist, m) {
+    m.doc() = "Fast image histograms";
+
+    nb::dict c_api;
+    for (auto const &entry : c_api_table()) {
+        c_api[entry.name] = nb::capsule(entry.address, entry.signature);
+    }
+    m.attr("c_api") = c_api;
+
+    m.def(
+        "c_api_address",
+        [](std::string const &name) -> std::uintptr_t {
+            for (auto const &entry : c_api_table()) {
+                if (name == entry.name) {
+                    return reinterpret_cast<std::uintptr_t>(entry.address);
+                }
+            }
+            throw std::invalid_argument("No exported C function named " +
+                                        name);
+        },
+        nb::arg("name"),
+        R"doc(
+        Return the address of an exported C function.
+
+        For calling the C API directly from compiled code, such as via a
+        ctypes function pointer in a Numba-jitted function, without going
+        through Python for each call. The available functions and their
+        signatures (as C declarations) are given by the ``c_api`` dict,
+        which maps each name to a PyCapsule named with the signature. See
+        README.md.
+
+        Parameters
+        ----------
+        name : str
+            Name of a C function in ``c_api``, such as "ihist_hist16_2d".
+
+        Returns
+        -------
+        int
+            The function's address.
+        )doc");
+
+    m.def("histogram", &histogram, nb::arg("image"), nb::kw_only(),
+          nb::arg("bits") = nb::none(), nb::arg("mask") = nb::none(),
+          nb::arg("components") = nb::none(), nb::arg("out") = nb::none(),
+          nb::arg("accumulate") = false, nb::arg("parallel") = true,
+          nb::arg("return_overflow") = false, nb::arg("levels") = nb::none(),
+          R"doc(
+        Compute histogram of image pixel values.
+
+        Parameters
+        ----------
+        image : array_like
+            Input image data. Must be uint8 or uint16, and 1D, 2D, or 3D.
+            - 1D arrays (W,) are interpreted as (1, W, 1)
+            - 2D arrays (H, W) are interpreted as (H, W, 1)
+            - 3D arrays (H, W, C) use C as number of components per pixel
+            Total pixel count must not exceed `2^32-1`.
+
+        bits : int, optional
+            Number of significant bits per sample. If not specified, defaults
+            to full depth (8 for uint8, 16 for uint16). Valid range: [0, 8] for
+            uint8, [0, 16] for uint16.
+
+        mask : array_like, optional
+            Per-pixel mask. Must be uint8. Shape must match image dimensions:
+            - For 1D images: mask must be 1D with shape (W,)
+            - For 2D/3D images: mask must be 2D with shape (H, W)
+            Only pixels with non-zero mask values are included. If not
+            specified, all pixels are included.
+
+        components : sequence of int, optional
+            Indices of components to histogram. If not specified, all
+            components are histogrammed. Each index must be in range
+            [0, n_components). For example, given an RGBA image (C = 4),
+            components=[0, 1, 2] will histogram the R, G, and B components only.
+
+        out : array_like, optional
+            Pre-allocated output buffer. Must be uint32, and either 1D with
+            shape (2^bits,) for single-component histogram, or 2D with shape
+            (n_hist_components, 2^bits). If not specified, a new array is
+            allocated and returned.
+
+        accumulate : bool, optional
+            If False (default), the output buffer is zeroed before computing
+            the histogram. If True, histogram values are accumulated into the
+            existing buffer values. No effect if 'out' is not given.
+
+        parallel : bool, optional
+            If True (default), allows automatic multi-threaded execution for
+            large images. If False, guarantees single-threaded execution.
+
+        return_overflow : bool, optional
+            If True, also count the (unmasked) samples whose value is 2^bits
+            or greater, which are otherwise silently excluded from the
+            histogram. Default False.
+        levels : sequence of int, optional
+            If given, also return coarser histograms of the same samples, one
+            per element, with 2^level bins (each level <= bits) binning the
+            top 'level' bits of each sample. They are derived from the full
+            histogram (after any accumulation) without another pass over the
+            image.
+
+        Returns
+        -------
+        histogram : ndarray
+            Histogram(s) as uint32 array. If the image is 1D or 2D and
+            'components' is not specified, returns 1D array of shape
+            (2^bits,). If the image is 3D or 'components' is explicitly
+            specified, returns 2D array of shape (n_hist_components, 2^bits).
+            If 'out' was provided, returns the same array after filling.
+
+        overflow : int or ndarray
+            Only returned (as the second element of a tuple) if
+            'return_overflow' is True. Number of out-of-range samples: an int
+            if 'histogram' is 1D, else a uint32 array of shape
+            (n_hist_components,). Not accumulated, even if 'accumulate' is
+            True.
+
+        levels : list of ndarray
+            Only returned (as the last element of a tuple) if 'levels' is
+            given. One uint32 array per requested level, with the same number
+            of dimensions as 'histogram'.
+        )doc");
+
+    m.def("histogram_stats", &histogram_stats, nb::arg("histogram"),
+          R"doc(
+        Compute summary statistics from histogram(s).
+
+        The statistics are derived from the bins, so they reflect exactly the
+        samples that were counted (honoring mask, components, and bits)
+        without another pass over the image.
+
+        Parameters
+        ----------
+        histogram : array_like
+            Histogram(s) as returned by histogram(). Must be uint32, either 1D
+            with shape (2^bits,) or 2D with shape (n_hist_components, 2^bits).
+
+        Returns
+        -------
+        stats : dict
+            Keys 'count', 'sum', 'sum_of_squares', 'min', 'max', 'n_saturated'
+            (count in the top bin, 2^bits - 1), 'mean', and 'std' (population
+            standard deviation). Values are scalars if 'histogram' is 1D, or
+            1D arrays of length n_hist_components if it is 2D. For an empty
+            histogram, 'min' and 'max' are 0 and 'mean' and 'std' are NaN.
+        )doc");
+
+    m.def("histogram_cumsum", &histogram_cumsum, nb::arg("histogram"),
+          R"doc(
+        Compute the cumulative sum of histogram(s) along the bins.
+
+        Parameters
+        ----------
+        histogram : array_like
+            Histogram(s) as returned by histogram(). Must be uint32, either 1D
+            with shape (2^bits,) or 2D with shape (n_hist_components, 2^bits).
+
+        Returns
+        -------
+        cumsum : ndarray
+            uint64 array of the same shape as 'histogram'.
+        )doc");
+
+    m.def("histogram_quantiles", &histogram_quantiles, nb::arg("histogram"),
+          nb::arg("q"),
+          R"doc(
+        Find sample values at the given quantiles (e.g., percentiles / 100).
+
+        All quantiles are found in a single pass over the bins. The value for
+        quantile q is the smallest bin value v such that at least
+        max(1, ceil(q * count)) samples are <= v; thus q = 0 gives the
+        minimum and q = 1 the maximum.
+
+        Parameters
+        ----------
+        histogram : array_like
+            Histogram(s) as returned by histogram(). Must be uint32, either 1D
+            with shape (2^bits,) or 2D with shape (n_hist_components, 2^bits).
+        q : float or sequence of float
+            Quantile(s), each in the range [0, 1].
+
+        Returns
+        -------
+        values : int or ndarray
+            An int if 'histogram' is 1D and 'q' is a scalar. Otherwise a
+            uint32 array whose shape is the histogram's leading dimension (if
+            2D) followed by the length of 'q' (if a sequence). Values are 0
+            for an empty histogram.
+        )doc");
+
+    m.def("histogram_otsu",
+          &histogram_per_component<std::uint32_t, ihist_histogram_otsu>,
+          nb::arg("histogram"),
+          R"doc(
+        Compute Otsu threshold(s) from histogram(s).
+
+        Parameters
+        ----------
+        histogram : array_like
+            Histogram(s) as returned by histogram(). Must be uint32, either 1D
+            with shape (2^bits,) or 2D with shape (n_hist_components, 2^bits).
+
+        Returns
+        -------
+        threshold : int or ndarray
+            The threshold t maximizing the between-class variance of the
+            classes (values <= t) and (values > t). An int if 'histogram' is
+            1D, else a uint32 array of length n_hist_components. 0 if the
+            histogram has fewer than 2 occupied bins.
+        )doc");
+
+    m.def("histogram_entropy",
+          &histogram_per_component<double, ihist_histogram_entropy>,
+          nb::arg("histogram"),
+          R"doc(
+        Compute the Shannon entropy (in bits) of histogram(s).
+
+        Parameters
+        ----------
+        histogram : array_like
+            Histogram(s) as returned by histogram(). Must be uint32, either 1D
+            with shape (2^bits,) or 2D with shape (n_hist_components, 2^bits).
+
+        Returns
+        -------
+        entropy : float or ndarray
+            A float if 'histogram' is 1D, else a float64 array of length
+            n_hist_components. NaN for an empty histogram.
+        )doc");
+
+    m.def("histogram_distance", &histogram_distance, nb::arg("histogram"),
+          nb::arg("other"), nb::arg("metric") = "chi_square", nb::kw_only(),
+          nb::arg("parallel") = true,
+          R"doc(
+        Compare histogram(s) with another, or with many stored histograms.
+
+        Both sides are normalized to unit sum before comparison, and all
+        metrics are 0 for identical histograms. With histogram as p and
+        other as q, the metrics are:
+
+        - 'chi_square': sum((p - q)^2 / (p + q)), in [0, 2]
+        - 'bhattacharyya': sqrt(1 - sum(sqrt(p * q))), in [0, 1]
+        - 'intersection': 1 - sum(min(p, q)), in [0, 1]
+        - 'emd': 1D earth mover's distance, in units of bins
+        - 'kl_divergence': sum(p * log2(p / q)); inf if q has an empty bin
+          where p does not
+
+        Parameters
+        ----------
+        histogram : array_like
+            Histogram(s) as returned by histogram(). Must be uint32, either 1D
+            with shape (2^bits,) or 2D with shape (n_hist_components, 2^bits).
+        other : array_like
+            uint32 histogram(s) of the same shape as 'histogram', or a batch
+            of them stacked along a new leading axis of length n.
+        metric : str, optional
+            One of the metric names listed above. Default: 'chi_square'.
+        parallel : bool, optional
+            If True (default), allows a large batch to be compared using
+            multiple threads.
+
+        Returns
+        -------
+        distance : float or ndarray
+            For a pairwise comparison, a float if 'histogram' is 1D, else a
+            float64 array of length n_hist_components. For a batch, a float64
+            array of shape (n,) or (n, n_hist_components). NaN where either
+            histogram is empty.
+        )doc");
+
+    m.def("histogram_lut8", &histogram_lut8, nb::arg("image"), nb::arg("lut"),
+          nb::kw_only(), nb::arg("bits") = nb::none(),
+          nb::arg("mask") = nb::none(), nb::arg("out") = nb::none(),
+          nb::arg("display_out") = nb::none(), nb::arg("accumulate") = false,
+          nb::arg("parallel") = true,
+          R"doc(
+        Histogram a uint16 image and map it through an 8-bit LUT in one pass.
+
+        This is the display stage of an auto-contrast viewer: apply the LUT
+        derived from the previous frame's histogram (see auto_contrast_lut())
+        while computing the current frame's histogram, reading the frame from
+        memory only once.
+
+        Parameters
+        ----------
+        image : array_like
+            uint16 image of shape (W,), (H, W), or (H, W, C). Layouts other
+            than C-contiguous are copied. All components are histogrammed.
+        lut : array_like
+            uint8 LUT of length 2^bits. Samples >= 2^bits (which are not
+            counted in the histogram) are mapped through the last entry.
+        bits : int, optional
+            Number of significant bits per sample (0-16). Default: 16.
+        mask : array_like, optional
+            uint8 mask of shape (W,) or (H, W); only pixels with nonzero mask
+            values are histogrammed. The mask does not affect the output
+            image.
+        out : array_like, optional
+            C-contiguous uint32 histogram to fill, of the shape histogram()
+            would return.
+        display_out : array_like, optional
+            C-contiguous uint8 array of the image's shape to receive the
+            mapped image.
+        accumulate : bool, optional
+            If True and 'out' is given, add to its existing values.
+        parallel : bool, optional
+            If True (default), allows processing large images in parallel
+            row bands.
+
+        Returns
+        -------
+        histogram, display : tuple of ndarray
+            The histogram and the uint8 mapped image.
+        )doc");
+
+    m.def("histogram_copy", &histogram_copy, nb::arg("image"),
+          nb::arg("dest"), nb::kw_only(), nb::arg("bits") = nb::none(),
+          nb::arg("mask") = nb::none(), nb::arg("non_temporal") = false,
+          nb::arg("parallel") = true,
+          R"doc(
+        Copy an image into a destination array while histogramming it.
+
+        For copying frames out of a camera buffer: the copy and the histogram
+        are computed in the same pass, so the frame is read from memory only
+        once.
+
+        Parameters
+        ----------
+        image : array_like
+            uint8 or uint16 image of shape (W,), (H, W), or (H, W, C).
+            Layouts other than C-contiguous are copied first (which defeats
+            the purpose). All components are histogrammed.
+        dest : array_like
+            Writable C-contiguous array of the same dtype and shape as
+            'image', which receives the copy.
+        bits : int, optional
+            Number of significant bits per sample. Default: 8 for uint8, 16
+            for uint16.
+        mask : array_like, optional
+            uint8 mask of shape (W,) or (H, W); only pixels with nonzero mask
+            values are histogrammed. The whole image is copied regardless.
+        non_temporal : bool, optional
+            If True, write 'dest' with cache-bypassing stores where
+            supported. This helps when 'dest' will not be read soon (such as
+            a large ring buffer). Default: False.
+        parallel : bool, optional
+            If True (default), allows processing large images in parallel
+            row bands.
+
+        Returns
+        -------
+        ndarray
+            uint32 histogram of the shape histogram() would return.
+        )doc");
+
+    nb::class_<Accumulator>(m, "Accumulator", R"doc(
+        Histogram an image that arrives a few rows at a time.
+
+        For line-scan cameras and images too large to hold in memory: feed()
+        row bands in any number of calls, then finish() to get the histogram
+        of everything fed since construction or the previous finish(). Partial
+        results are kept per thread between feeds and combined only once, so
+        many small feeds cost little more than one large one. Calls on one
+        Accumulator from multiple threads are serialized.
+
+        Parameters
+        ----------
+        bits : int
+            Number of significant bits per sample (0-16). The histogram has
+            2^bits bins per component.
+        n_components : int, optional
+            Number of components per pixel in the rows to be fed (C). Default:
+            1.
+        components : sequence of int, optional
+            Indices of components to histogram. Default: all.
+        )doc")
+        .def(nb::init<std::size_t, std::size_t, nb::object>(), nb::arg("bits"),
+             nb::arg("n_components") = 1, nb::arg("components") = nb::none())
+        .def("feed", &Accumulator::feed, nb::arg("rows"), nb::kw_only(),
+             nb::arg("mask") = nb::none(), nb::arg("parallel") = true,
+             R"doc(
+        Add a band of rows.
+
+        Parameters
+        ----------
+        rows : array_like
+            uint8 or uint16 array of shape (W,), (H, W), or (H, W, C), with C
+            equal to n_components. Bands may differ in height and width.
+        mask : array_like, optional
+            uint8 mask of shape (W,) or (H, W); only pixels with nonzero mask
+            values are counted.
+        parallel : bool, optional
+            If True (default), allows processing large bands in parallel.
+        )doc")
+        .def("finish", &Accumulator::finish, nb::kw_only(),
+             nb::arg("return_overflow") = false,
+             R"doc(
+        Return the histogram of all rows fed so far and reset.
+
+        Parameters
+        ----------
+        return_overflow : bool, optional
+            If True, also return the count of samples >= 2^bits, as for
+            histogram().
+
+        Returns
+        -------
+        ndarray or tuple
+            uint32 histogram, 2D (n_hist_components, 2^bits) if n_components
+            > 1 or components was given, else 1D; with return_overflow,
+            (histogram, overflow).
+        )doc");
+
+    nb::class_<HistogramSeriesWriter>(m, "HistogramSeriesWriter", R"doc(
+        Write a time series of histograms to a compact file.
+
+        Each histogram is stored as its differences from the previous one, so
+        a series of histograms of similar frames takes a small fraction of the
+        raw size. Use as a context manager, or call close(), to write the
+        index; a file that was not closed is still readable up to its last
+        complete histogram. See README.md for the file format.
+
+        Parameters
+        ----------
+        path : str or os.PathLike
+            File to create (overwritten if it exists).
+        bits : int
+            Number of bits per sample (0-16); histograms have 2^bits bins per
+            component.
+        n_components : int, optional
+            Number of components per histogram. Default: 1.
+        keyframe_interval : int, optional
+            Store every keyframe_interval-th histogram in full, bounding the
+            work to read an arbitrary histogram. Default: 64.
+        )doc")
+        .def(nb::init<nb::object const &, std::size_t, std::size_t,
+                      std::size_t>(),
+             nb::arg("path"), nb::arg("bits"), nb::arg("n_components") = 1,
+             nb::arg("keyframe_interval") = 64)
+        .def("append", &HistogramSeriesWriter::append, nb::arg("histogram"),
+             R"doc(
+        Append a histogram.
+
+        Parameters
+        ----------
+        histogram : ndarray
+            C-contiguous uint32 array of n_components * 2^bits counts, such
+            as returned by histogram().
+        )doc")
+        .def("close", &HistogramSeriesWriter::close,
+             "Write the index and close the file.")
+        .def("__enter__",
+             [](HistogramSeriesWriter &self) -> HistogramSeriesWriter & {
+                 return self;
+             },
+             nb::rv_policy::reference)
+        .def("__exit__", [](HistogramSeriesWriter &self,
+                            nb::args) { self.close(); });
+
+    nb::class_<HistogramSeriesReader>(m, "HistogramSeriesReader", R"doc(
+        Read a histogram series written by HistogramSeriesWriter.
+
+        Histograms are read by indexing. Reading in increasing order decodes
+        one record per histogram; other access decodes from the nearest
+        preceding keyframe.
+
+        Parameters
+        ----------
+        path : str or os.PathLike
+            File to open.
+        )doc")
+        .def(nb::init<nb::object const &>(), nb::arg("path"))
+        .def_prop_ro("bits", &HistogramSeriesReader::bits,
+                     "Number of bits per sample.")
+        .def_prop_ro("n_components", &HistogramSeriesReader::n_components,
+                     "Number of components per histogram.")
+        .def("__len__", &HistogramSeriesReader::size)
+        .def("__getitem__", &HistogramSeriesReader::get, nb::arg("index"),
+             R"doc(
+        Return histogram number index (negative indices count from the end)
+        as a uint32 array of shape (2^bits,), or (n_components, 2^bits) if
+        n_components > 1.
+        )doc")
+        .def("close", &HistogramSeriesReader::close, "Close the file.")
+        .def("__enter__",
+             [](HistogramSeriesReader &self) -> HistogramSeriesReader & {
+                 return self;
+             },
+             nb::rv_policy::reference)
+        .def("__exit__", [](HistogramSeriesReader &self,
+                            nb::args) { self.close(); });
+
+    m.def("histogram_sparse", &histogram_sparse, nb::arg("image"),
+          nb::kw_only(), nb::arg("bits") = nb::none(),
+          nb::arg("mask") = nb::none(), nb::arg("components") = nb::none(),
+          nb::arg("parallel") = true,
+          R"doc(
+        Compute a histogram as its nonzero bins only.
+
+        For small regions of 16-bit images, which occupy a few of the 65536
+        bins, this avoids allocating, clearing, and scanning the dense
+        histogram: small images are counted without touching most bins, and
+        for larger ones the dense histogram stays internal and is scanned in
+        native code.
+
+        uint32 images (such as label images) are also accepted, with any
+        sample values: they are counted in hash tables, without a dense
+        histogram.
+
+        Parameters
+        ----------
+        image : array_like
+            As for histogram(), but may also have dtype uint32.
+        bits : int, optional
+            As for histogram(); default 32 for uint32.
+        mask : array_like, optional
+            As for histogram().
+        components : sequence of int, optional
+            As for histogram().
+        parallel : bool, optional
+            As for histogram().
+
+        Returns
+        -------
+        tuple or list of tuple
+            (bins, counts): uint16 array (uint32 for uint32 images) of the
+            bins with nonzero counts, in increasing order, and uint32 array
+            of their counts. If
+            histogram() would return a 2D array (3D image or components
+            given), a list with one such tuple per histogrammed component.
+        )doc");
+
+    m.def("histogram_many", &histogram_many, nb::arg("images"),
+          nb::kw_only(), nb::arg("bits") = nb::none(),
+          nb::arg("masks") = nb::none(), nb::arg("components") = nb::none(),
+          nb::arg("parallel") = true,
+          R"doc(
+        Compute a separate histogram of each of many images.
+
+        Equivalent to calling histogram() on each image, but all images are
+        validated first and then histogrammed in a single call without the
+        GIL, distributing small images (such as ROIs of one frame) across
+        threads. This avoids most of the per-call overhead, which otherwise
+        dominates for small images.
+
+        Parameters
+        ----------
+        images : sequence of array_like
+            Images as for histogram(), which may differ in size and layout
+            but must share dtype (uint8 or uint16), dimensionality, and
+            number of components.
+        bits : int, optional
+            As for histogram().
+        masks : sequence of array_like or None, optional
+            One mask (as for histogram()) or None per image.
+        components : sequence of int, optional
+            As for histogram().
+        parallel : bool, optional
+            If True (default), allows processing in parallel.
+
+        Returns
+        -------
+        list of ndarray
+            One histogram per image, shaped as histogram() would return.
+        )doc");
+
+    m.def("histogram_tiles", &histogram_tiles, nb::arg("tiles"),
+          nb::kw_only(), nb::arg("bits") = nb::none(),
+          nb::arg("masks") = nb::none(), nb::arg("parallel") = true,
+          R"doc(
+        Compute one histogram of an image stored as tiles.
+
+        Equivalent to histogramming the assembled image (or summing the
+        histograms of the tiles), but without assembling the image and with
+        a single parallel loop over the rows of all tiles.
+
+        Parameters
+        ----------
+        tiles : sequence of array_like
+            Tiles of shape (H, W) or (H, W, C), which may differ in height and
+            width but must share dtype (uint8 or uint16), dimensionality, and
+            C. Layouts other than C-contiguous are copied.
+        bits : int, optional
+            Number of significant bits per sample. Default: 8 for uint8, 16
+            for uint16.
+        masks : sequence of array_like or None, optional
+            One uint8 mask of shape (H, W), or None, per tile; only pixels
+            with nonzero mask values are histogrammed.
+        parallel : bool, optional
+            If True (default), allows processing large inputs in parallel.
+
+        Returns
+        -------
+        ndarray
+            uint32 histogram, 2D (C, 2^bits) for 3D tiles, else 1D.
+        )doc");
+
+    m.def("histogram_corrected", &histogram_corrected, nb::arg("image"),
+          nb::kw_only(), nb::arg("dark") = nb::none(),
+          nb::arg("gain") = nb::none(), nb::arg("gain_bits") = 12,
+          nb::arg("bits") = nb::none(), nb::arg("mask") = nb::none(),
+          nb::arg("parallel") = true,
+          R"doc(
+        Histogram a uint16 image after dark subtraction and gain correction.
+
+        Each sample is corrected to max(raw - dark, 0) * gain / 2^gain_bits
+        (rounded to nearest) before binning, without materializing the
+        corrected image.
+
+        Parameters
+        ----------
+        image : array_like
+            uint16 image of shape (W,), (H, W), or (H, W, C). Layouts other
+            than C-contiguous are copied. All components are histogrammed.
+        dark : array_like, optional
+            uint16 offset plane of the image's shape, subtracted from each
+            sample (clamping at 0).
+        gain : array_like, optional
+            uint16 fixed-point gain plane of the image's shape, with
+            'gain_bits' fractional bits.
+        gain_bits : int, optional
+            Number of fractional bits of 'gain' (0-16). Default: 12, so that
+            4096 is unit gain.
+        bits : int, optional
+            Number of significant bits per sample (0-16). Default: 16.
+            Corrected values >= 2^bits are not counted.
+        mask : array_like, optional
+            uint8 mask of shape (W,) or (H, W); only pixels with nonzero mask
+            values are histogrammed.
+        parallel : bool, optional
+            If True (default), allows processing large images in parallel
+            row bands.
+
+        Returns
+        -------
+        ndarray
+            uint32 histogram of the shape histogram() would return.
+        )doc");
+
+    m.def("histogram_difference", &histogram_difference, nb::arg("image"),
+          nb::arg("previous"), nb::kw_only(), nb::arg("signed") = false,
+          nb::arg("bits") = nb::none(), nb::arg("mask") = nb::none(),
+          nb::arg("parallel") = true,
+          R"doc(
+        Histogram the difference between two frames.
+
+        Computes the histogram of |image - previous| (or of the signed
+        difference) for change detection, without materializing the
+        difference image.
+
+        Parameters
+        ----------
+        image : array_like
+            uint8 or uint16 image of shape (W,), (H, W), or (H, W, C).
+            Layouts other than C-contiguous are copied. All components are
+            histogrammed.
+        previous : array_like
+            Frame to subtract, of the same dtype and shape as 'image'.
+        signed : bool, optional
+            If False (default), histogram the absolute difference in 2^bits
+            bins. If True, histogram image - previous + 2^bits in
+            2^(bits + 1) bins, so that bin 2^bits counts unchanged samples.
+        bits : int, optional
+            Number of significant bits per sample. Default: 8 for uint8, 16
+            for uint16. Samples >= 2^bits in either frame are not counted.
+        mask : array_like, optional
+            uint8 mask of shape (W,) or (H, W); only pixels with nonzero mask
+            values are histogrammed.
+        parallel : bool, optional
+            If True (default), allows processing large images in parallel
+            row bands.
+
+        Returns
+        -------
+        ndarray
+            uint32 histogram, 2D (n_components, n_bins) if the image is 3D,
+            else 1D.
+        )doc");
+
+    m.def("histogram_derived", &histogram_derived, nb::arg("image"),
+          nb::arg("derived"), nb::kw_only(), nb::arg("bits") = nb::none(),
+          nb::arg("mask") = nb::none(),
+          nb::arg("rgb") = nb::make_tuple(0, 1, 2),
+          nb::arg("parallel") = true,
+          R"doc(
+        Histogram the components of a color image and derived channels.
+
+        Computes per-component histograms together with histograms of
+        channels derived from each pixel's red, green, and blue samples (such
+        as luma for exposure control), reading the image only once.
+
+        Parameters
+        ----------
+        image : array_like
+            uint8 or uint16 image of shape (H, W, C). Layouts other than
+            C-contiguous are copied.
+        derived : sequence of str
+            Derived channels to histogram: 'luma709' (Rec. 709 luma),
+            'luma601' (Rec. 601 luma), 'max' (max of R, G, B), or 'mean'
+            (sum of R, G, B divided by 3, rounded down).
+        bits : int, optional
+            Number of significant bits per sample. Default: 8 for uint8, 16
+            for uint16. Derived values >= 2^bits are not counted.
+        mask : array_like, optional
+            uint8 mask of shape (H, W); only pixels with nonzero mask values
+            are histogrammed.
+        rgb : sequence of int, optional
+            Indices of the red, green, and blue components. Default: (0, 1,
+            2).
+        parallel : bool, optional
+            If True (default), allows processing large images in parallel
+            row bands.
+
+        Returns
+        -------
+        ndarray
+            uint32 array of shape (C + len(derived), 2^bits): the histogram
+            of each component followed by those of the derived channels.
+        )doc");
+
+    m.def("auto_contrast_lut", &auto_contrast_lut, nb::arg("histogram"),
+          nb::arg("low") = 0.001, nb::arg("high") = 0.999,
+          R"doc(
+        Build an 8-bit display LUT from a histogram.
+
+        The LUT maps values at or below the 'low' quantile of the histogram
+        to 0 and values at or above the 'high' quantile to 255, with a linear
+        ramp in between.
+
+        Parameters
+        ----------
+        histogram : array_like
+            1D uint32 histogram as returned by histogram().
+        low, high : float, optional
+            Quantiles (0 <= low <= high <= 1) defining the display window.
+            Default: 0.001 and 0.999.
+
+        Returns
+        -------
+        lut : ndarray
+            uint8 array of the same length as 'histogram'.
+        )doc");
+
+    m.def("histogram_mode",
+          &histogram_per_component<std::uint32_t, ihist_histogram_mode>,
+          nb::arg("histogram"),
+          R"doc(
+        Find the most frequent value(s) in histogram(s).
+
+        Parameters
+        ----------
+        histogram : array_like
+            Histogram(s) as returned by histogram(). Must be uint32, either 1D
+            with shape (2^bits,) or 2D with shape (n_hist_components, 2^bits).
+
+        Returns
+        -------
+        mode : int or ndarray
+            The bin with the highest count (the lowest such bin if tied). An
+            int if 'histogram' is 1D, else a uint32 array of length
+            n_hist_components.
         )doc");
 }
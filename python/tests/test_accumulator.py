@@ -0,0 +1,60 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for streaming accumulation."""
+
+import numpy as np
+import pytest
+
+import ihist
+
+
+def _image(seed, shape, dtype=np.uint16):
+    rng = np.random.default_rng(seed)
+    return rng.integers(0, 4096, shape, dtype=dtype)
+
+
+class TestAccumulator:
+    """One histogram from row bands fed separately."""
+
+    @pytest.mark.parametrize("band", [1, 7, 100])
+    def test_matches_whole_image(self, band):
+        """Test against histogramming the whole image at once."""
+        image = _image(1, (100, 37))
+        acc = ihist.Accumulator(bits=12)
+        for y in range(0, image.shape[0], band):
+            acc.feed(image[y : y + band])
+        np.testing.assert_array_equal(
+            acc.finish(), ihist.histogram(image, bits=12)
+        )
+
+    def test_components_and_mask(self):
+        """Test component selection, masks, and 1D rows."""
+        image = _image(2, (20, 30, 3))
+        mask = (_image(3, (20, 30)) & 1).astype(np.uint8)
+        acc = ihist.Accumulator(12, 3, components=[2, 0])
+        for y in range(20):
+            acc.feed(image[y], mask=mask[y])
+        expected = ihist.histogram(
+            image, bits=12, mask=mask, components=[2, 0]
+        )
+        np.testing.assert_array_equal(acc.finish(), expected)
+
+    def test_finish_resets(self):
+        """Test that finish() returns only what was fed since the last."""
+        image = _image(4, (10, 10))
+        acc = ihist.Accumulator(bits=8)
+        acc.feed(image)
+        hist, overflow = acc.finish(return_overflow=True)
+        assert hist.sum() + overflow == image.size
+        assert overflow == np.count_nonzero(image >= 256)
+        assert acc.finish().sum() == 0
+
+    def test_invalid(self):
+        """Test rejection of mismatched input."""
+        acc = ihist.Accumulator(bits=12, n_components=3)
+        with pytest.raises(ValueError):
+            acc.feed(_image(5, (4, 4)))
+        with pytest.raises(ValueError):
+            ihist.Accumulator(bits=12, components=[1])
@@ -0,0 +1,147 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for histogram analysis functions."""
+
+import math
+
+import numpy as np
+import pytest
+
+import ihist
+
+
+def _skewed_image(seed, shape, bits=12):
+    rng = np.random.default_rng(seed)
+    image = rng.integers(0, 1 << bits, shape, dtype=np.uint16)
+    return image >> rng.integers(0, 4, shape, dtype=np.uint16)
+
+
+class TestCumsum:
+    """Cumulative sums of histograms."""
+
+    def test_matches_numpy(self):
+        """Test that cumsum agrees with np.cumsum for 1D and 2D."""
+        image = _skewed_image(1, (30, 40, 3))
+        hist = ihist.histogram(image, bits=12)
+        cumsum = ihist.histogram_cumsum(hist)
+        assert cumsum.dtype == np.uint64
+        np.testing.assert_array_equal(cumsum, np.cumsum(hist, axis=-1))
+
+        cumsum0 = ihist.histogram_cumsum(hist[0])
+        assert cumsum0.shape == (4096,)
+        np.testing.assert_array_equal(cumsum0, np.cumsum(hist[0]))
+
+
+class TestQuantiles:
+    """Quantiles of histograms."""
+
+    def test_matches_sorted_samples(self):
+        """Test quantiles against the inverse empirical CDF."""
+        image = _skewed_image(2, (50, 60))
+        hist = ihist.histogram(image, bits=12)
+        qs = [0.001, 0.5, 0.999, 0.0, 1.0]
+        values = ihist.histogram_quantiles(hist, qs)
+        assert values.shape == (len(qs),)
+
+        flat = np.sort(image, axis=None)
+        for q, v in zip(qs, values, strict=True):
+            rank = max(1, math.ceil(q * flat.size))
+            assert v == flat[rank - 1]
+
+    def test_scalar_and_multi_component_shapes(self):
+        """Test result shapes for scalar/sequence q and 1D/2D histograms."""
+        image = _skewed_image(3, (20, 20, 3))
+        hist = ihist.histogram(image, bits=12)
+        assert ihist.histogram_quantiles(hist, 0.5).shape == (3,)
+        assert ihist.histogram_quantiles(hist, [0.1, 0.9]).shape == (3, 2)
+        assert isinstance(ihist.histogram_quantiles(hist[1], 0.5), int)
+        np.testing.assert_array_equal(
+            ihist.histogram_quantiles(hist, 0.0), image.min(axis=(0, 1))
+        )
+        np.testing.assert_array_equal(
+            ihist.histogram_quantiles(hist, 1.0), image.max(axis=(0, 1))
+        )
+
+    def test_out_of_range_quantile(self):
+        """Test that quantiles outside [0, 1] are rejected."""
+        hist = np.zeros(256, dtype=np.uint32)
+        with pytest.raises(ValueError, match="range"):
+            ihist.histogram_quantiles(hist, 1.5)
+        with pytest.raises(ValueError, match="range"):
+            ihist.histogram_quantiles(hist, [0.5, -0.1])
+
+
+class TestOtsu:
+    """Otsu thresholds of histograms."""
+
+    def test_matches_brute_force(self):
+        """Test that the threshold maximizes between-class variance."""
+        image = _skewed_image(4, (40, 40), bits=8).astype(np.uint8)
+        hist = ihist.histogram(image).astype(np.float64)
+        bins = np.arange(256)
+
+        w0 = np.cumsum(hist)[:-1]
+        w1 = hist.sum() - w0
+        m0 = np.cumsum(hist * bins)[:-1]
+        m1 = (hist * bins).sum() - m0
+        with np.errstate(divide="ignore", invalid="ignore"):
+            between = w0 * w1 * (m0 / w0 - m1 / w1) ** 2
+        between[(w0 == 0) | (w1 == 0)] = -1
+
+        threshold = ihist.histogram_otsu(ihist.histogram(image))
+        assert between[threshold] == pytest.approx(between.max())
+
+    def test_bimodal(self):
+        """Test that the threshold separates two well-separated modes."""
+        image = np.array([10] * 100 + [200] * 100, dtype=np.uint8)
+        threshold = ihist.histogram_otsu(ihist.histogram(image))
+        assert 10 <= threshold < 200
+
+    def test_multi_component(self):
+        """Test per-component thresholds."""
+        image = np.zeros((2, 2, 2), dtype=np.uint8)
+        image[0, :, 0] = 20
+        image[0, :, 1] = 100
+        image[1, :, 1] = 150
+        thresholds = ihist.histogram_otsu(ihist.histogram(image))
+        assert thresholds.dtype == np.uint32
+        assert thresholds.shape == (2,)
+        assert 0 <= thresholds[0] < 20
+        assert 100 <= thresholds[1] < 150
+
+
+class TestEntropy:
+    """Shannon entropy of histograms."""
+
+    def test_matches_definition(self):
+        """Test entropy against -sum(p log2 p)."""
+        image = _skewed_image(5, (30, 30, 2))
+        hist = ihist.histogram(image, bits=12)
+        entropy = ihist.histogram_entropy(hist)
+        for h, e in zip(hist, entropy, strict=True):
+            p = h[h > 0] / h.sum()
+            assert e == pytest.approx(-(p * np.log2(p)).sum())
+
+    def test_uniform_and_empty(self):
+        """Test entropy of uniform and empty histograms."""
+        assert ihist.histogram_entropy(
+            np.ones(256, dtype=np.uint32)
+        ) == pytest.approx(8.0)
+        assert math.isnan(
+            ihist.histogram_entropy(np.zeros(256, dtype=np.uint32))
+        )
+
+
+class TestMode:
+    """Mode of histograms."""
+
+    def test_mode(self):
+        """Test that the mode is the lowest most-frequent bin."""
+        hist = np.zeros((2, 16), dtype=np.uint32)
+        hist[0, 7] = 9
+        hist[0, 9] = 9
+        hist[1, 15] = 1
+        np.testing.assert_array_equal(ihist.histogram_mode(hist), [7, 15])
+        assert ihist.histogram_mode(hist[1]) == 15
@@ -17,6 +17,7 @@ Tests how Python objects are converted to/from C, including:
 import array
 
 import numpy as np
+import pytest
 
 import ihist
 
@@ -807,3 +808,80 @@ class TestFOrderOptimization:
         assert hist.shape == (2, 4096)
         assert hist[0, 100] == h * w
         assert hist[1, 200] == h * w
+
+
+class TestReturnOverflow:
+    """Test counting of out-of-range samples."""
+
+    def test_default_returns_histogram_only(self):
+        """Test that return_overflow=False returns just the histogram."""
+        image = np.array([0, 1, 200], dtype=np.uint8)
+        hist = ihist.histogram(image, bits=4)
+        assert isinstance(hist, np.ndarray)
+
+    def test_1d_histogram_gives_scalar(self):
+        """Test overflow count for single-component histogram."""
+        image = np.array([0, 1, 15, 16, 200, 255], dtype=np.uint8)
+        hist, overflow = ihist.histogram(image, bits=4, return_overflow=True)
+        assert hist.sum() == 3
+        assert overflow == 3
+
+    def test_multi_component_with_mask(self):
+        """Test per-component overflow counts respect the mask."""
+        rng = np.random.default_rng(44)
+        image = rng.integers(0, 65536, (17, 19, 3), dtype=np.uint16)
+        mask = rng.integers(0, 2, (17, 19), dtype=np.uint8)
+        hist, overflow = ihist.histogram(
+            image, bits=12, mask=mask, return_overflow=True
+        )
+        selected = image[mask != 0]
+        assert overflow.dtype == np.uint32
+        assert overflow.shape == (3,)
+        np.testing.assert_array_equal(overflow, (selected >= 4096).sum(axis=0))
+        np.testing.assert_array_equal(
+            hist.sum(axis=1) + overflow, [selected.shape[0]] * 3
+        )
+
+    def test_full_depth_has_no_overflow(self):
+        """Test that full bit depth never overflows."""
+        image = np.full((4, 4), 255, dtype=np.uint8)
+        _, overflow = ihist.histogram(image, return_overflow=True)
+        assert overflow == 0
+
+
+class TestLevels:
+    """Test coarse histogram levels."""
+
+    def test_levels_match_rebinned_histogram(self):
+        """Test that each level sums adjacent bins of the full histogram."""
+        rng = np.random.default_rng(45)
+        image = rng.integers(0, 65536, (30, 40), dtype=np.uint16)
+        hist, levels = ihist.histogram(image, levels=[8, 4])
+        assert len(levels) == 2
+        np.testing.assert_array_equal(
+            levels[0], hist.reshape(256, 256).sum(axis=1)
+        )
+        np.testing.assert_array_equal(
+            levels[1], hist.reshape(16, 4096).sum(axis=1)
+        )
+
+    def test_levels_with_overflow_and_components(self):
+        """Test levels of a 2D histogram together with overflow counts."""
+        rng = np.random.default_rng(46)
+        image = rng.integers(0, 4096, (10, 10, 3), dtype=np.uint16)
+        hist, overflow, levels = ihist.histogram(
+            image, bits=10, return_overflow=True, levels=[2]
+        )
+        assert levels[0].shape == (3, 4)
+        np.testing.assert_array_equal(
+            levels[0], hist.reshape(3, 4, 256).sum(axis=2)
+        )
+        np.testing.assert_array_equal(
+            overflow, (image >= 1024).sum(axis=(0, 1))
+        )
+
+    def test_level_out_of_range(self):
+        """Test that levels finer than bits are rejected."""
+        image = np.zeros(10, dtype=np.uint8)
+        with pytest.raises(ValueError, match="Level bits"):
+            ihist.histogram(image, bits=4, levels=[5])
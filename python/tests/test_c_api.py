@@ -0,0 +1,85 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for the exported C function addresses and capsules."""
+
+import ctypes
+
+import numpy as np
+import pytest
+
+import ihist
+
+_size = ctypes.c_size_t
+_ptr = ctypes.c_void_p
+
+_PyCapsule_GetName = ctypes.pythonapi.PyCapsule_GetName
+_PyCapsule_GetName.restype = ctypes.c_char_p
+_PyCapsule_GetName.argtypes = [ctypes.py_object]
+_PyCapsule_GetPointer = ctypes.pythonapi.PyCapsule_GetPointer
+_PyCapsule_GetPointer.restype = ctypes.c_void_p
+_PyCapsule_GetPointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+
+
+def test_capsules_match_addresses():
+    """Test that each capsule holds the address and is named by signature."""
+    assert "ihist_hist8_2d" in ihist.c_api
+    assert "ihist_hist16_2d" in ihist.c_api
+    for name, capsule in ihist.c_api.items():
+        signature = _PyCapsule_GetName(capsule)
+        assert b"(" in signature
+        assert _PyCapsule_GetPointer(
+            capsule, signature
+        ) == ihist.c_api_address(name)
+    assert _PyCapsule_GetName(ihist.c_api["ihist_hist8_2d"]).startswith(
+        b"void (size_t, uint8_t const *,"
+    )
+
+
+def test_unknown_name():
+    """Test that unknown names are rejected."""
+    with pytest.raises(ValueError):
+        ihist.c_api_address("ihist_no_such_function")
+
+
+def test_call_through_function_pointer():
+    """Test calling ihist_hist16_2d as a ctypes function pointer."""
+    hist16 = ctypes.CFUNCTYPE(
+        None,
+        _size,
+        _ptr,
+        _ptr,
+        _size,
+        _size,
+        _size,
+        _size,
+        _size,
+        _size,
+        _ptr,
+        _ptr,
+        ctypes.c_bool,
+    )(ihist.c_api_address("ihist_hist16_2d"))
+
+    rng = np.random.default_rng(1)
+    image = rng.integers(0, 4096, (30, 40, 3), dtype=np.uint16)
+    indices = np.array([2, 0], dtype=np.uintp)
+    hist = np.zeros((2, 4096), dtype=np.uint32)
+    roi = image[5:25, 10:30]
+    hist16(
+        12,
+        roi.ctypes.data,
+        None,
+        20,
+        20,
+        40,
+        0,
+        3,
+        2,
+        indices.ctypes.data,
+        hist.ctypes.data,
+        False,
+    )
+    np.testing.assert_array_equal(
+        hist, ihist.histogram(roi, bits=12, components=[2, 0])
+    )
@@ -0,0 +1,47 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for histogramming during copy."""
+
+import numpy as np
+import pytest
+
+import ihist
+
+
+def _image(seed, shape, dtype=np.uint8):
+    rng = np.random.default_rng(seed)
+    return rng.integers(0, np.iinfo(dtype).max + 1, shape, dtype=dtype)
+
+
+class TestHistogramCopy:
+    """Fused copy and histogram."""
+
+    @pytest.mark.parametrize("dtype", [np.uint8, np.uint16])
+    @pytest.mark.parametrize("shape", [(100,), (40, 50), (20, 30, 3)])
+    @pytest.mark.parametrize("non_temporal", [False, True])
+    def test_copy(self, dtype, shape, non_temporal):
+        """Test that the copy and histogram match separate operations."""
+        image = _image(1, shape, dtype)
+        dest = np.zeros_like(image)
+        hist = ihist.histogram_copy(image, dest, non_temporal=non_temporal)
+        np.testing.assert_array_equal(dest, image)
+        np.testing.assert_array_equal(hist, ihist.histogram(image))
+
+    def test_mask_copies_everything(self):
+        """Test that masked-out pixels are still copied."""
+        image = _image(2, (20, 20))
+        mask = np.zeros((20, 20), dtype=np.uint8)
+        dest = np.zeros_like(image)
+        hist = ihist.histogram_copy(image, dest, mask=mask)
+        assert hist.sum() == 0
+        np.testing.assert_array_equal(dest, image)
+
+    def test_invalid_dest(self):
+        """Test rejection of mismatched destinations."""
+        image = _image(3, (10, 10))
+        with pytest.raises(ValueError, match="Destination"):
+            ihist.histogram_copy(image, np.zeros((10, 9), dtype=np.uint8))
+        with pytest.raises(ValueError, match="Destination"):
+            ihist.histogram_copy(image, np.zeros((10, 10), dtype=np.uint16))
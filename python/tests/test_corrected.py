@@ -0,0 +1,57 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for dark- and gain-corrected histograms."""
+
+import numpy as np
+import pytest
+
+import ihist
+
+
+def _plane(seed, shape, high):
+    rng = np.random.default_rng(seed)
+    return rng.integers(0, high, shape, dtype=np.uint16)
+
+
+class TestHistogramCorrected:
+    """Fused dark subtraction and gain correction."""
+
+    @pytest.mark.parametrize("shape", [(100,), (40, 50), (20, 30, 3)])
+    def test_matches_corrected_image(self, shape):
+        """Test against histogramming a corrected image."""
+        image = _plane(1, shape, 4096)
+        dark = _plane(2, shape, 200)
+        gain = _plane(3, shape, 4096) + 2048
+        hist = ihist.histogram_corrected(image, dark=dark, gain=gain, bits=12)
+        v = np.maximum(image.astype(np.int64) - dark, 0)
+        v = (v * gain + 2048) >> 12
+        # Values amplified past 12 bits are not counted.
+        v = v.reshape(-1, shape[2] if len(shape) == 3 else 1)
+        expected = np.stack(
+            [np.bincount(c[c < 4096], minlength=4096) for c in v.T]
+        )
+        if len(shape) != 3:
+            expected = expected[0]
+        np.testing.assert_array_equal(hist, expected)
+
+    def test_dark_only(self):
+        """Test that dark subtraction clamps at zero."""
+        image = np.array([10, 20, 30, 40], dtype=np.uint16)
+        dark = np.full(4, 15, dtype=np.uint16)
+        hist = ihist.histogram_corrected(image, dark=dark, bits=8)
+        assert list(np.flatnonzero(hist)) == [0, 5, 15, 25]
+
+    def test_no_correction(self):
+        """Test that without planes the result equals histogram()."""
+        image = _plane(4, (30, 30), 65535)
+        np.testing.assert_array_equal(
+            ihist.histogram_corrected(image), ihist.histogram(image)
+        )
+
+    def test_invalid_plane(self):
+        """Test that a mismatched correction plane is rejected."""
+        image = _plane(5, (10, 10), 100)
+        with pytest.raises(ValueError, match="dark"):
+            ihist.histogram_corrected(image, dark=image[:5])
@@ -0,0 +1,76 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for derived-channel histograms."""
+
+import numpy as np
+import pytest
+
+import ihist
+
+
+def _image(seed, shape, dtype=np.uint8):
+    rng = np.random.default_rng(seed)
+    return rng.integers(0, np.iinfo(dtype).max + 1, shape, dtype=dtype)
+
+
+def _bincount(values, n_bins):
+    return np.bincount(values.ravel(), minlength=n_bins).astype(np.uint32)
+
+
+class TestHistogramDerived:
+    """Component histograms plus derived channels."""
+
+    @pytest.mark.parametrize("dtype", [np.uint8, np.uint16])
+    def test_max_and_mean(self, dtype):
+        """Test max and mean channels against NumPy."""
+        image = _image(1, (40, 50, 3), dtype)
+        n_bins = np.iinfo(dtype).max + 1
+        hist = ihist.histogram_derived(image, ["max", "mean"])
+        assert hist.shape == (5, n_bins)
+        np.testing.assert_array_equal(hist[:3], ihist.histogram(image))
+        wide = image.astype(np.uint32)
+        np.testing.assert_array_equal(
+            hist[3], _bincount(wide.max(axis=2), n_bins)
+        )
+        np.testing.assert_array_equal(
+            hist[4], _bincount(wide.sum(axis=2) // 3, n_bins)
+        )
+
+    def test_luma(self):
+        """Test luma channels against a floating-point reference."""
+        image = _image(2, (30, 30, 4))
+        hist = ihist.histogram_derived(
+            image, ["luma709", "luma601"], rgb=(2, 1, 0)
+        )
+        assert hist.shape == (6, 256)
+        rgb = image[..., [2, 1, 0]].astype(np.float64)
+        for row, weights in [
+            (hist[4], [0.2126, 0.7152, 0.0722]),
+            (hist[5], [0.299, 0.587, 0.114]),
+        ]:
+            luma = rgb @ np.array(weights)
+            assert row.sum() == 900
+            # Fixed-point rounding may differ by one bin from floating point.
+            ref = np.floor(luma + 0.5).astype(np.int64)
+            got = np.repeat(np.arange(256), row)
+            assert np.abs(np.sort(ref.ravel()) - got).max() <= 1
+
+    def test_mask(self):
+        """Test that the mask applies to derived channels."""
+        image = _image(3, (20, 20, 3))
+        mask = np.zeros((20, 20), dtype=np.uint8)
+        mask[:5] = 1
+        hist = ihist.histogram_derived(image, ["max"], mask=mask)
+        assert (hist.sum(axis=1) == 100).all()
+
+    def test_invalid_arguments(self):
+        """Test rejection of bad channel names and layouts."""
+        image = _image(4, (10, 10, 3))
+        with pytest.raises(ValueError, match="derived channel"):
+            ihist.histogram_derived(image, ["hue"])
+        with pytest.raises(ValueError, match="3D"):
+            ihist.histogram_derived(image[..., 0], ["max"])
+        with pytest.raises(ValueError, match="out of range"):
+            ihist.histogram_derived(image, ["max"], rgb=(0, 1, 3))
@@ -0,0 +1,56 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for frame-difference histograms."""
+
+import numpy as np
+import pytest
+
+import ihist
+
+
+def _image(seed, shape, dtype=np.uint8):
+    rng = np.random.default_rng(seed)
+    return rng.integers(0, np.iinfo(dtype).max + 1, shape, dtype=dtype)
+
+
+class TestHistogramDifference:
+    """Absolute and signed frame differences."""
+
+    @pytest.mark.parametrize("dtype", [np.uint8, np.uint16])
+    @pytest.mark.parametrize("shape", [(100,), (40, 50), (20, 30, 3)])
+    def test_absolute(self, dtype, shape):
+        """Test against histogramming the absolute difference image."""
+        a = _image(1, shape, dtype)
+        b = _image(2, shape, dtype)
+        hist = ihist.histogram_difference(a, b)
+        diff = np.abs(a.astype(np.int64) - b).astype(dtype)
+        np.testing.assert_array_equal(hist, ihist.histogram(diff))
+
+    @pytest.mark.parametrize("dtype", [np.uint8, np.uint16])
+    def test_signed(self, dtype):
+        """Test the biased signed difference."""
+        a = _image(3, (30, 40), dtype)
+        b = _image(4, (30, 40), dtype)
+        n = np.iinfo(dtype).max + 1
+        hist = ihist.histogram_difference(a, b, signed=True)
+        assert hist.shape == (2 * n,)
+        diff = a.astype(np.int64) - b + n
+        np.testing.assert_array_equal(
+            hist, np.bincount(diff.ravel(), minlength=2 * n)
+        )
+
+    def test_bits_and_mask(self):
+        """Test exclusion of out-of-range samples and masked pixels."""
+        a = np.array([[10, 300, 5, 7]], dtype=np.uint16)
+        b = np.array([[3, 0, 5, 9]], dtype=np.uint16)
+        mask = np.array([[1, 1, 1, 0]], dtype=np.uint8)
+        hist = ihist.histogram_difference(a, b, bits=8, mask=mask)
+        assert list(np.flatnonzero(hist)) == [0, 7]
+
+    def test_mismatched_frames(self):
+        """Test that frames of different shapes are rejected."""
+        a = _image(5, (10, 10))
+        with pytest.raises(ValueError, match="same dtype and shape"):
+            ihist.histogram_difference(a, a[:5])
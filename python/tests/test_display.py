@@ -0,0 +1,97 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for the fused histogram and display LUT functions."""
+
+import numpy as np
+import pytest
+
+import ihist
+
+
+def _image(seed, shape, bits=12):
+    rng = np.random.default_rng(seed)
+    return rng.integers(0, 1 << bits, shape, dtype=np.uint16)
+
+
+class TestHistogramLut8:
+    """Fused histogram and LUT application."""
+
+    @pytest.mark.parametrize("shape", [(100,), (40, 50), (20, 30, 3)])
+    def test_matches_separate_passes(self, shape):
+        """Test against histogram() followed by LUT indexing."""
+        image = _image(1, shape)
+        lut = (np.arange(4096) // 16).astype(np.uint8)
+        hist, display = ihist.histogram_lut8(image, lut, bits=12)
+        np.testing.assert_array_equal(hist, ihist.histogram(image, bits=12))
+        np.testing.assert_array_equal(display, lut[image])
+        assert display.dtype == np.uint8
+
+    def test_out_of_range_uses_last_entry(self):
+        """Test that samples >= 2^bits map through the last LUT entry."""
+        image = np.array([[0, 255, 256, 65535]], dtype=np.uint16)
+        lut = np.arange(256, dtype=np.uint8)
+        hist, display = ihist.histogram_lut8(image, lut, bits=8)
+        np.testing.assert_array_equal(display, [[0, 255, 255, 255]])
+        assert hist.sum() == 2
+
+    def test_mask_and_outputs(self):
+        """Test mask, preallocated outputs, and accumulation."""
+        image = _image(2, (30, 40))
+        mask = _image(3, (30, 40), bits=1).astype(np.uint8)
+        lut = np.zeros(4096, dtype=np.uint8)
+        out = np.ones(4096, dtype=np.uint32)
+        display_out = np.full((30, 40), 7, dtype=np.uint8)
+        hist, display = ihist.histogram_lut8(
+            image,
+            lut,
+            bits=12,
+            mask=mask,
+            out=out,
+            display_out=display_out,
+            accumulate=True,
+        )
+        assert hist is out
+        assert display is display_out
+        np.testing.assert_array_equal(
+            out, ihist.histogram(image, bits=12, mask=mask) + 1
+        )
+        assert not display_out.any()
+
+    def test_invalid_lut(self):
+        """Test that a LUT of the wrong length is rejected."""
+        image = _image(4, (10, 10))
+        with pytest.raises(ValueError, match="LUT"):
+            ihist.histogram_lut8(image, np.zeros(256, dtype=np.uint8))
+
+
+class TestAutoContrastLut:
+    """Percentile-based display LUTs."""
+
+    def test_window(self):
+        """Test that the LUT ramps between the requested quantiles."""
+        hist = np.zeros(4096, dtype=np.uint32)
+        hist[100] = 1
+        hist[3000] = 1
+        lut = ihist.auto_contrast_lut(hist, 0.0, 1.0)
+        assert lut.shape == (4096,)
+        assert lut[100] == 0
+        assert lut[1550] == 128
+        assert lut[3000] == 255
+        assert np.all(np.diff(lut.astype(int)) >= 0)
+
+    def test_viewer_loop(self):
+        """Test the previous-frame LUT pattern."""
+        frames = [_image(10 + i, (64, 64)) for i in range(3)]
+        lut = np.arange(65536, dtype=np.uint64).astype(np.uint8)
+        for frame in frames:
+            hist, display = ihist.histogram_lut8(frame, lut)
+            np.testing.assert_array_equal(display, lut[frame])
+            lut = ihist.auto_contrast_lut(hist)
+
+    def test_invalid_quantiles(self):
+        """Test that inverted quantiles are rejected."""
+        hist = np.ones(256, dtype=np.uint32)
+        with pytest.raises(ValueError, match="Quantiles"):
+            ihist.auto_contrast_lut(hist, 0.9, 0.1)
@@ -0,0 +1,98 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for histogram distance functions."""
+
+import math
+
+import numpy as np
+import pytest
+
+import ihist
+
+METRICS = [
+    "chi_square",
+    "bhattacharyya",
+    "intersection",
+    "emd",
+    "kl_divergence",
+]
+
+
+def _reference(metric, a, b):
+    p = a / a.sum()
+    q = b / b.sum()
+    if metric == "chi_square":
+        s = p + q
+        nz = s > 0
+        return (((p - q) ** 2)[nz] / s[nz]).sum()
+    if metric == "bhattacharyya":
+        return math.sqrt(max(0.0, 1.0 - np.sqrt(p * q).sum()))
+    if metric == "intersection":
+        return 1.0 - np.minimum(p, q).sum()
+    if metric == "emd":
+        return np.abs(np.cumsum(p) - np.cumsum(q)).sum()
+    nz = p > 0
+    return (p[nz] * np.log2(p[nz] / q[nz])).sum()
+
+
+def _hist(seed, shape):
+    rng = np.random.default_rng(seed)
+    image = rng.integers(0, 256, shape, dtype=np.uint8)
+    return ihist.histogram(image)
+
+
+class TestDistance:
+    """Pairwise and batch histogram distances."""
+
+    @pytest.mark.parametrize("metric", METRICS)
+    def test_matches_reference(self, metric):
+        """Test each metric against a NumPy implementation."""
+        a = _hist(1, (100, 100, 2))
+        b = _hist(2, (100, 100, 2))
+        dist = ihist.histogram_distance(a, b, metric)
+        assert dist.shape == (2,)
+        for i in range(2):
+            assert dist[i] == pytest.approx(_reference(metric, a[i], b[i]))
+
+        assert ihist.histogram_distance(a[0], a[0], metric) == pytest.approx(
+            0.0, abs=1e-6
+        )
+
+    @pytest.mark.parametrize("metric", METRICS)
+    def test_batch(self, metric):
+        """Test that batch results match pairwise results."""
+        query = _hist(3, (50, 50))
+        refs = np.stack([_hist(10 + i, (50, 50)) for i in range(20)])
+        dist = ihist.histogram_distance(query, refs, metric)
+        assert dist.shape == (20,)
+        for i in range(20):
+            assert dist[i] == ihist.histogram_distance(query, refs[i], metric)
+
+    def test_batch_multi_component(self):
+        """Test the batch result shape for 2D histograms."""
+        query = _hist(4, (10, 10, 3))
+        refs = np.stack([_hist(20 + i, (10, 10, 3)) for i in range(5)])
+        dist = ihist.histogram_distance(query, refs, "emd", parallel=False)
+        assert dist.shape == (5, 3)
+
+    def test_empty_and_disjoint(self):
+        """Test NaN for empty histograms and inf for unsupported KL."""
+        a = np.zeros(16, dtype=np.uint32)
+        b = np.zeros(16, dtype=np.uint32)
+        b[3] = 1
+        assert math.isnan(ihist.histogram_distance(a, b))
+        a[4] = 1
+        assert ihist.histogram_distance(a, b, "chi_square") == 2.0
+        assert math.isinf(ihist.histogram_distance(a, b, "kl_divergence"))
+
+    def test_invalid_arguments(self):
+        """Test rejection of bad metric names and mismatched shapes."""
+        a = np.zeros(256, dtype=np.uint32)
+        with pytest.raises(ValueError, match="metric"):
+            ihist.histogram_distance(a, a, "euclidean")
+        with pytest.raises(ValueError, match="shape"):
+            ihist.histogram_distance(a, np.zeros(16, dtype=np.uint32))
+        with pytest.raises(ValueError, match="dtype"):
+            ihist.histogram_distance(a, a.astype(np.float64))
@@ -0,0 +1,78 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for histograms of many images in one call."""
+
+import numpy as np
+import pytest
+
+import ihist
+
+
+def _image(seed, shape, dtype=np.uint16):
+    rng = np.random.default_rng(seed)
+    return rng.integers(0, 4096, shape, dtype=dtype)
+
+
+class TestHistogramMany:
+    """Separate histograms of many images."""
+
+    @pytest.mark.parametrize("shape", [(200, 300), (100, 120, 3)])
+    def test_matches_histogram(self, shape):
+        """Test many ROIs against separate histogram() calls."""
+        image = _image(1, shape)
+        rois = [
+            image[y : y + 1 + y % 17, x : x + 1 + x % 23]
+            for y in range(0, shape[0] - 20, 7)
+            for x in range(0, shape[1] - 30, 29)
+        ]
+        results = ihist.histogram_many(rois, bits=12)
+        assert len(results) == len(rois)
+        for roi, hist in zip(rois, results, strict=True):
+            np.testing.assert_array_equal(hist, ihist.histogram(roi, bits=12))
+
+    def test_masks_and_components(self):
+        """Test per-image masks (or None) and component selection."""
+        images = [_image(i, (10 + i, 20, 4)) for i in range(5)]
+        masks = [
+            None if i % 2 else (_image(i, (10 + i, 20)) & 1).astype(np.uint8)
+            for i in range(5)
+        ]
+        results = ihist.histogram_many(
+            images, bits=12, masks=masks, components=[3, 1]
+        )
+        for image, mask, hist in zip(images, masks, results, strict=True):
+            expected = ihist.histogram(
+                image, bits=12, mask=mask, components=[3, 1]
+            )
+            assert hist.shape == (2, 4096)
+            np.testing.assert_array_equal(hist, expected)
+
+    def test_layouts(self):
+        """Test 1D, transposed, and 8-bit images."""
+        image = _image(2, (40, 60), dtype=np.uint8)
+        for images in ([image[3], image[:, 5]], [image.T, image[::2, ::3]]):
+            results = ihist.histogram_many(images, parallel=False)
+            for im, hist in zip(images, results, strict=True):
+                np.testing.assert_array_equal(hist, ihist.histogram(im))
+
+    def test_empty(self):
+        """Test an empty sequence and an empty image."""
+        assert ihist.histogram_many([]) == []
+        (hist,) = ihist.histogram_many([np.zeros((0, 5), dtype=np.uint16)])
+        assert hist.shape == (65536,)
+        assert hist.sum() == 0
+
+    def test_mismatched_images(self):
+        """Test that images must share dtype and dimensionality."""
+        with pytest.raises(ValueError):
+            ihist.histogram_many(
+                [np.zeros(4, dtype=np.uint8), np.zeros(4, dtype=np.uint16)]
+            )
+        with pytest.raises(ValueError):
+            ihist.histogram_many(
+                [np.zeros(4, dtype=np.uint8), np.zeros((2, 2), dtype=np.uint8)]
+            )
+        with pytest.raises(ValueError):
+            ihist.histogram_many([np.zeros(4, dtype=np.uint8)], masks=[])
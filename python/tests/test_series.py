@@ -0,0 +1,72 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for histogram time-series files."""
+
+import numpy as np
+import pytest
+
+import ihist
+
+
+def _histograms(n, bits=12, n_components=1):
+    rng = np.random.default_rng(1)
+    base = rng.integers(0, 2**bits - 16, (64, 64, n_components))
+    hists = []
+    for i in range(n):
+        frame = (base + rng.integers(0, 4, base.shape) + i % 16).astype(
+            np.uint16
+        )
+        if n_components == 1:
+            frame = frame[:, :, 0]
+        hists.append(ihist.histogram(frame, bits=bits))
+    return hists
+
+
+class TestHistogramSeries:
+    """Writing and reading histogram series files."""
+
+    @pytest.mark.parametrize("n_components", [1, 3])
+    def test_round_trip(self, tmp_path, n_components):
+        """Test that every histogram reads back unchanged, in any order."""
+        hists = _histograms(40, n_components=n_components)
+        path = tmp_path / "series.ihs"
+        with ihist.HistogramSeriesWriter(
+            path, 12, n_components, keyframe_interval=16
+        ) as w:
+            for h in hists:
+                w.append(h)
+        with ihist.HistogramSeriesReader(path) as r:
+            assert r.bits == 12
+            assert r.n_components == n_components
+            assert len(r) == len(hists)
+            for i in [*range(40), 39, 0, 17, 16, 5]:
+                np.testing.assert_array_equal(r[i], hists[i])
+            np.testing.assert_array_equal(r[-1], hists[-1])
+            with pytest.raises(IndexError):
+                r[40]
+
+    def test_compact(self, tmp_path):
+        """Test that similar histograms take much less than raw size."""
+        hists = _histograms(64, bits=16)
+        path = tmp_path / "series.ihs"
+        with ihist.HistogramSeriesWriter(path, 16) as w:
+            for h in hists:
+                w.append(h)
+        assert path.stat().st_size < 0.1 * sum(h.nbytes for h in hists)
+
+    def test_wrong_size(self, tmp_path):
+        """Test that histograms of the wrong size are rejected."""
+        with (
+            ihist.HistogramSeriesWriter(tmp_path / "s.ihs", 8) as w,
+            pytest.raises(ValueError),
+        ):
+            w.append(np.zeros(255, dtype=np.uint32))
+
+    def test_not_a_series(self, tmp_path):
+        """Test that other files are rejected."""
+        path = tmp_path / "other"
+        path.write_bytes(b"\0" * 100)
+        with pytest.raises(RuntimeError):
+            ihist.HistogramSeriesReader(path)
@@ -0,0 +1,89 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for sparse histogram output."""
+
+import numpy as np
+import pytest
+
+import ihist
+
+
+def _image(seed, shape, dtype=np.uint16, low=1000, high=5096):
+    rng = np.random.default_rng(seed)
+    return rng.integers(low, high, shape, dtype=dtype)
+
+
+def _dense(bins, counts, n_bins):
+    dense = np.zeros(n_bins, dtype=np.uint32)
+    dense[bins] = counts
+    return dense
+
+
+class TestHistogramSparse:
+    """Nonzero bins of a histogram."""
+
+    @pytest.mark.parametrize("shape", [(5,), (10, 7), (300, 200)])
+    def test_matches_dense(self, shape):
+        """Test against histogram() for small and large images."""
+        image = _image(1, shape)
+        bins, counts = ihist.histogram_sparse(image)
+        assert bins.dtype == np.uint16
+        assert counts.dtype == np.uint32
+        assert np.all(np.diff(bins.astype(np.int64)) > 0)
+        assert np.all(counts > 0)
+        np.testing.assert_array_equal(
+            _dense(bins, counts, 65536), ihist.histogram(image)
+        )
+
+    def test_components_mask_and_bits(self):
+        """Test per-component output with a mask and reduced bits."""
+        image = _image(2, (20, 30, 3))
+        mask = (_image(3, (20, 30)) & 1).astype(np.uint8)
+        result = ihist.histogram_sparse(
+            image, bits=12, mask=mask, components=[2, 0]
+        )
+        expected = ihist.histogram(
+            image, bits=12, mask=mask, components=[2, 0]
+        )
+        assert len(result) == 2
+        for (bins, counts), hist in zip(result, expected, strict=True):
+            np.testing.assert_array_equal(_dense(bins, counts, 4096), hist)
+
+    def test_uint8_and_non_contiguous(self):
+        """Test 8-bit input and a strided view."""
+        image = _image(4, (40, 60), dtype=np.uint8, low=100, high=200)[
+            ::2, ::3
+        ]
+        bins, counts = ihist.histogram_sparse(image)
+        np.testing.assert_array_equal(
+            _dense(bins, counts, 256), ihist.histogram(image)
+        )
+
+    def test_empty(self):
+        """Test that an empty image gives empty arrays."""
+        bins, counts = ihist.histogram_sparse(np.zeros(0, dtype=np.uint16))
+        assert len(bins) == 0
+        assert len(counts) == 0
+
+    def test_uint32_labels(self):
+        """Test 32-bit keys against np.unique, with a mask and an ROI."""
+        rng = np.random.default_rng(5)
+        labels = rng.integers(0, 2**32, 50, dtype=np.uint32)
+        image = labels[rng.integers(0, 50, (64, 80))]
+        mask = rng.integers(0, 2, (64, 80), dtype=np.uint8)
+        roi = (slice(3, 50), slice(10, 70))
+        keys, counts = ihist.histogram_sparse(image[roi], mask=mask[roi])
+        assert keys.dtype == np.uint32
+        assert counts.dtype == np.uint32
+        expected = np.unique(image[roi][mask[roi] != 0], return_counts=True)
+        np.testing.assert_array_equal(keys, expected[0])
+        np.testing.assert_array_equal(counts, expected[1])
+
+    def test_uint32_bits(self):
+        """Test that keys of 2^bits or more are excluded."""
+        image = np.array([[1, 70000, 3, 1], [2**31, 3, 3, 0]], dtype=np.uint32)
+        keys, counts = ihist.histogram_sparse(image, bits=17)
+        np.testing.assert_array_equal(keys, [0, 1, 3, 70000])
+        np.testing.assert_array_equal(counts, [1, 2, 3, 1])
@@ -0,0 +1,67 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for histogram_stats()."""
+
+import math
+
+import numpy as np
+import pytest
+
+import ihist
+
+
+class TestHistogramStats:
+    """Statistics derived from histograms."""
+
+    def test_matches_numpy_mono(self):
+        """Test that stats agree with NumPy over the same samples."""
+        rng = np.random.default_rng(42)
+        image = rng.integers(0, 4096, (37, 41), dtype=np.uint16)
+        stats = ihist.histogram_stats(ihist.histogram(image, bits=12))
+
+        assert stats["count"] == image.size
+        assert stats["sum"] == image.sum(dtype=np.uint64)
+        assert stats["sum_of_squares"] == (image.astype(np.uint64) ** 2).sum()
+        assert stats["min"] == image.min()
+        assert stats["max"] == image.max()
+        assert stats["n_saturated"] == np.count_nonzero(image == 4095)
+        assert stats["mean"] == pytest.approx(image.mean())
+        assert stats["std"] == pytest.approx(image.std())
+
+    def test_masked_multi_component(self):
+        """Test that stats respect the mask and are per component."""
+        rng = np.random.default_rng(43)
+        image = rng.integers(0, 256, (20, 30, 3), dtype=np.uint8)
+        mask = rng.integers(0, 2, (20, 30), dtype=np.uint8)
+        stats = ihist.histogram_stats(ihist.histogram(image, mask=mask))
+
+        selected = image[mask != 0]
+        assert stats["count"].shape == (3,)
+        np.testing.assert_array_equal(stats["min"], selected.min(axis=0))
+        np.testing.assert_array_equal(stats["max"], selected.max(axis=0))
+        np.testing.assert_array_equal(
+            stats["n_saturated"], (selected == 255).sum(axis=0)
+        )
+        np.testing.assert_allclose(stats["mean"], selected.mean(axis=0))
+        np.testing.assert_allclose(stats["std"], selected.std(axis=0))
+
+    def test_empty_histogram(self):
+        """Test that an empty histogram yields NaN mean and std."""
+        stats = ihist.histogram_stats(np.zeros(256, dtype=np.uint32))
+        assert stats["count"] == 0
+        assert stats["min"] == 0
+        assert stats["max"] == 0
+        assert math.isnan(stats["mean"])
+        assert math.isnan(stats["std"])
+
+    def test_invalid_bin_count(self):
+        """Test that a non-power-of-2 bin count is rejected."""
+        with pytest.raises(ValueError, match="power of 2"):
+            ihist.histogram_stats(np.zeros(100, dtype=np.uint32))
+
+    def test_invalid_dtype(self):
+        """Test that a non-uint32 histogram is rejected."""
+        with pytest.raises(ValueError, match="dtype uint32"):
+            ihist.histogram_stats(np.zeros(256, dtype=np.int64))
@@ -0,0 +1,78 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for calling ihist from several Python threads at once.
+
+On free-threaded CPython these run truly concurrently; elsewhere they still
+exercise the GIL-released sections.
+"""
+
+import sys
+import sysconfig
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+import pytest
+
+import ihist
+
+N_THREADS = 8
+
+
+def _image(seed, shape):
+    rng = np.random.default_rng(seed)
+    return rng.integers(0, 4096, shape, dtype=np.uint16)
+
+
+@pytest.mark.skipif(
+    not sysconfig.get_config_var("Py_GIL_DISABLED"),
+    reason="requires free-threaded CPython",
+)
+def test_gil_stays_disabled():
+    """Test that importing the module did not re-enable the GIL."""
+    assert not sys._is_gil_enabled()
+
+
+def test_concurrent_histograms():
+    """Test that concurrent calls on separate images are correct."""
+    images = [_image(i, (64, 100)) for i in range(N_THREADS * 4)]
+    expected = [np.bincount(im.ravel(), minlength=4096) for im in images]
+    with ThreadPoolExecutor(N_THREADS) as pool:
+        for _ in range(10):
+            results = list(
+                pool.map(lambda im: ihist.histogram(im, bits=12), images)
+            )
+            for hist, exp in zip(results, expected, strict=True):
+                np.testing.assert_array_equal(hist, exp)
+
+
+def test_concurrent_histogram_many():
+    """Test concurrent batch calls, each itself parallel."""
+    image = _image(1, (300, 400))
+    rois = [
+        image[y : y + 20, x : x + 30]
+        for y in range(0, 280, 20)
+        for x in range(0, 370, 30)
+    ]
+    expected = [ihist.histogram(roi, bits=12) for roi in rois]
+    with ThreadPoolExecutor(N_THREADS) as pool:
+        futures = [
+            pool.submit(ihist.histogram_many, rois, bits=12)
+            for _ in range(N_THREADS)
+        ]
+        for future in futures:
+            for hist, exp in zip(future.result(), expected, strict=True):
+                np.testing.assert_array_equal(hist, exp)
+
+
+def test_shared_accumulator():
+    """Test that feeds to one accumulator from several threads all count."""
+    bands = [_image(i, (10, 50)) for i in range(N_THREADS * 10)]
+    acc = ihist.Accumulator(bits=12)
+    with ThreadPoolExecutor(N_THREADS) as pool:
+        list(pool.map(acc.feed, bands))
+    expected = np.bincount(
+        np.concatenate([b.ravel() for b in bands]), minlength=4096
+    )
+    np.testing.assert_array_equal(acc.finish(), expected)
@@ -0,0 +1,59 @@
+# This file is part of ihist
+# Copyright 2025 Board of Regents of the University of Wisconsin System
+# SPDX-License-Identifier: MIT
+
+"""Tests for tiled input."""
+
+import numpy as np
+import pytest
+
+import ihist
+
+
+def _image(seed, shape, dtype=np.uint16):
+    rng = np.random.default_rng(seed)
+    return rng.integers(0, 4096, shape, dtype=dtype)
+
+
+def _tiles(image, th, tw):
+    return [
+        image[y : y + th, x : x + tw]
+        for y in range(0, image.shape[0], th)
+        for x in range(0, image.shape[1], tw)
+    ]
+
+
+class TestHistogramTiles:
+    """One histogram from many tiles."""
+
+    @pytest.mark.parametrize("shape", [(65, 63), (50, 40, 3)])
+    def test_matches_assembled(self, shape):
+        """Test against histogramming the assembled image."""
+        image = _image(1, shape)
+        tiles = _tiles(image, 16, 20)
+        hist = ihist.histogram_tiles(tiles, bits=12)
+        np.testing.assert_array_equal(hist, ihist.histogram(image, bits=12))
+
+    def test_masks(self):
+        """Test per-tile masks, including None."""
+        image = _image(2, (40, 40))
+        mask = np.zeros((40, 40), dtype=np.uint8)
+        mask[:20, :20] = 1
+        tiles = _tiles(image, 20, 20)
+        masks = [m if m.any() else None for m in _tiles(mask, 20, 20)]
+        hist = ihist.histogram_tiles(tiles, bits=12, masks=masks)
+        expected = ihist.histogram(image, bits=12, mask=mask)
+        # Unmasked tiles (None) are counted in full.
+        for tile in tiles[1:]:
+            expected += ihist.histogram(tile, bits=12)
+        np.testing.assert_array_equal(hist, expected)
+
+    def test_invalid_tiles(self):
+        """Test rejection of inconsistent tiles."""
+        a = _image(3, (10, 10))
+        with pytest.raises(ValueError, match="same dtype"):
+            ihist.histogram_tiles([a, a.astype(np.uint8)])
+        with pytest.raises(ValueError, match="At least one"):
+            ihist.histogram_tiles([])
+        with pytest.raises(ValueError, match="one entry"):
+            ihist.histogram_tiles([a, a], masks=[None])
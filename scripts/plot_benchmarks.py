@@ -235,8 +235,22 @@ def main() -> None:
     parser.add_argument("--repetitions", type=int, metavar="N", default=3)
     parser.add_argument("--plot", action="store_true", dest="plot")
     parser.add_argument("--rerun", action="store_true")
+    parser.add_argument(
+        "--results",
+        type=Path,
+        nargs="+",
+        metavar="FILE",
+        help="plot existing results (e.g., from python/benchmarks/api_bench.py)"
+        " instead of running the C++ benchmarks",
+    )
     args = parser.parse_args()
 
+    if args.results:
+        df = pd.concat(map(load_results, args.results), ignore_index=True)
+        for _, group in df.groupby(["pixel_type", "bits", "n_pixels"]):
+            plot_results(group)
+        return
+
     pixel_formats = (
         all_pixel_formats() if args.all else [(args.pixel_type, args.bits)]
     )
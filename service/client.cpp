@@ -0,0 +1,100 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "client.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace ihist::service {
+
+client::client(std::string const &socket_path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("invalid socket path: " + socket_path);
+    }
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0 || connect(fd_, reinterpret_cast<sockaddr const *>(&addr),
+                           sizeof(addr)) != 0) {
+        int const err = errno;
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+        throw std::runtime_error("cannot connect to " + socket_path + ": " +
+                                 std::strerror(err));
+    }
+}
+
+client::~client() { close(fd_); }
+
+auto client::submit(frame_request const &request) -> frame_reply {
+    frame_reply reply{};
+    if (!send_all(fd_, &request, sizeof(request)) ||
+        !recv_all(fd_, &reply, sizeof(reply))) {
+        throw std::runtime_error("connection to ihistd lost");
+    }
+    return reply;
+}
+
+region_reader::region_reader(std::string const &region_name)
+    : shm_(shared_memory::open(region_name)),
+      header_(static_cast<region_header const *>(shm_.data())) {
+    if (shm_.size() < sizeof(region_header) ||
+        header_->magic != region_magic ||
+        header_->version != protocol_version ||
+        shm_.size() < region_bytes(header_->capacity)) {
+        throw std::runtime_error(region_name + " is not an ihistd region");
+    }
+}
+
+auto region_reader::sequence() const -> std::uint64_t {
+    return header_->sequence.load(std::memory_order_acquire);
+}
+
+auto region_reader::read_latest(snapshot &out) const -> bool {
+    for (;;) {
+        auto const seq = header_->sequence.load(std::memory_order_acquire);
+        if (seq == 0) {
+            return false;
+        }
+        if (seq % 2 != 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        out.sequence = seq;
+        out.frame_id = header_->frame_id;
+        out.publish_time_ns = header_->publish_time_ns;
+        out.sample_bits = header_->sample_bits;
+        out.n_components = header_->n_components;
+        // A torn read can give nonsense sizes; the sequence check below
+        // rejects it, but the copy must stay in bounds regardless.
+        if (out.sample_bits <= 16 &&
+            (out.n_components << out.sample_bits) <= header_->capacity) {
+            std::size_t const n = out.n_components << out.sample_bits;
+            out.histogram.resize(n);
+            std::memcpy(out.histogram.data(), region_counts(header_),
+                        n * sizeof(std::uint32_t));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header_->sequence.load(std::memory_order_relaxed) == seq) {
+            return true;
+        }
+    }
+}
+
+} // namespace ihist::service
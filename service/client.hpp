@@ -0,0 +1,63 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "posix.hpp"
+#include "protocol.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ihist::service {
+
+// Connection to ihistd for submitting frames. Throws std::runtime_error if
+// the service cannot be reached.
+class client {
+  public:
+    explicit client(std::string const &socket_path);
+    ~client();
+
+    client(client const &) = delete;
+    auto operator=(client const &) -> client & = delete;
+
+    // Send a request and wait until the histogram has been published.
+    auto submit(frame_request const &request) -> frame_reply;
+
+  private:
+    int fd_ = -1;
+};
+
+struct snapshot {
+    std::uint64_t sequence;
+    std::uint64_t frame_id;
+    std::uint64_t publish_time_ns;
+    std::size_t sample_bits;
+    std::size_t n_components;
+    std::vector<std::uint32_t> histogram;
+};
+
+// Read-only view of the published histogram region. Any number of processes
+// may read concurrently with the service publishing.
+class region_reader {
+  public:
+    explicit region_reader(std::string const &region_name);
+
+    // Copy the latest histogram into out, retrying while it is being
+    // published. Returns false if nothing has been published yet.
+    auto read_latest(snapshot &out) const -> bool;
+
+    // Sequence number of the latest publication, for cheap change detection.
+    [[nodiscard]] auto sequence() const -> std::uint64_t;
+
+  private:
+    shared_memory shm_;
+    region_header const *header_;
+};
+
+} // namespace ihist::service
@@ -0,0 +1,112 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+// ihistd: histogram frames in shared memory on behalf of other processes and
+// publish the results in shared memory. See README.md.
+
+#include "server.hpp"
+
+#include <csignal>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr char const *usage = R"(usage:
+  ihistd --socket PATH --region NAME [--max-bits B] [--max-components C]
+         [--serial]
+
+Listen for frame requests on the Unix socket PATH and publish each histogram
+in the POSIX shared memory object NAME (e.g., /ihistd). Histograms of up to
+C components (default 4) of up to B bits (default 16) are accepted.
+)";
+
+ihist::service::server *running_server = nullptr;
+
+extern "C" void handle_signal(int) {
+    if (running_server != nullptr) {
+        running_server->stop();
+    }
+}
+
+auto parse_count(std::string const &name, std::string const &value)
+    -> std::size_t {
+    std::size_t pos = 0;
+    unsigned long v = 0;
+    try {
+        v = std::stoul(value, &pos);
+    } catch (std::exception const &) {
+        pos = 0;
+    }
+    if (pos == 0 || pos != value.size() || value[0] == '-') {
+        throw std::invalid_argument("Invalid value for " + name + ": " +
+                                    value);
+    }
+    return v;
+}
+
+auto parse_args(int argc, char **argv) -> ihist::service::server_config {
+    ihist::service::server_config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string const arg = argv[i];
+        if (arg == "--serial") {
+            config.parallel = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for " + arg);
+        }
+        std::string const value = argv[++i];
+        if (arg == "--socket") {
+            config.socket_path = value;
+        } else if (arg == "--region") {
+            config.region_name = value;
+        } else if (arg == "--max-bits") {
+            config.max_sample_bits = parse_count(arg, value);
+        } else if (arg == "--max-components") {
+            config.max_components = parse_count(arg, value);
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    if (config.socket_path.empty() || config.region_name.empty()) {
+        throw std::invalid_argument("--socket and --region are required");
+    }
+    if (config.max_sample_bits > 16 || config.max_components == 0 ||
+        config.max_components > 64) {
+        throw std::invalid_argument("--max-bits must be at most 16 and "
+                                    "--max-components in [1, 64]");
+    }
+    return config;
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+    ihist::service::server_config config;
+    try {
+        config = parse_args(argc, argv);
+    } catch (std::invalid_argument const &e) {
+        std::cerr << "ihistd: " << e.what() << "\n\n" << usage;
+        return 2;
+    }
+    try {
+        ihist::service::server srv(config);
+        running_server = &srv;
+        std::signal(SIGPIPE, SIG_IGN);
+        std::signal(SIGINT, handle_signal);
+        std::signal(SIGTERM, handle_signal);
+        srv.run();
+        running_server = nullptr;
+    } catch (std::exception const &e) {
+        std::cerr << "ihistd: error: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "posix.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace ihist::service {
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+constexpr int send_flags = MSG_NOSIGNAL;
+#else
+constexpr int send_flags = 0; // Callers should ignore SIGPIPE
+#endif
+
+[[noreturn]] void throw_errno(std::string const &what, int err) {
+    throw std::runtime_error(what + ": " + std::strerror(err));
+}
+
+auto map_fd(int fd, std::size_t size, bool writable, std::string const &name)
+    -> void * {
+    int const prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *p = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        throw_errno("cannot map shared memory " + name, errno);
+    }
+    return p;
+}
+
+auto id_of(struct stat const &st) -> object_id {
+    return {static_cast<std::uint64_t>(st.st_dev),
+            static_cast<std::uint64_t>(st.st_ino)};
+}
+
+} // namespace
+
+auto shared_memory::create(std::string const &name, std::size_t size)
+    -> shared_memory {
+    shm_unlink(name.c_str());
+    int const fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        throw_errno("cannot create shared memory " + name, errno);
+    }
+    shared_memory shm;
+    shm.unlink_name_ = name;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        int const err = errno;
+        close(fd);
+        throw_errno("cannot size shared memory " + name, err);
+    }
+    try {
+        shm.data_ = map_fd(fd, size, true, name);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    shm.size_ = size;
+    close(fd);
+    return shm;
+}
+
+auto shared_memory::open(std::string const &name, bool writable)
+    -> shared_memory {
+    int const fd = shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+        throw_errno("cannot open shared memory " + name, errno);
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        int const err = errno;
+        close(fd);
+        throw_errno("cannot stat shared memory " + name, err);
+    }
+    shared_memory shm;
+    shm.size_ = static_cast<std::size_t>(st.st_size);
+    shm.id_ = id_of(st);
+    if (shm.size_ > 0) {
+        try {
+            shm.data_ = map_fd(fd, shm.size_, writable, name);
+        } catch (...) {
+            close(fd);
+            throw;
+        }
+    }
+    close(fd);
+    return shm;
+}
+
+auto shared_memory::identify(std::string const &name) -> object_id {
+    int const fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw_errno("cannot open shared memory " + name, errno);
+    }
+    struct stat st {};
+    int const ret = fstat(fd, &st);
+    int const err = errno;
+    close(fd);
+    if (ret != 0) {
+        throw_errno("cannot stat shared memory " + name, err);
+    }
+    return id_of(st);
+}
+
+shared_memory::~shared_memory() { release(); }
+
+shared_memory::shared_memory(shared_memory &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)), id_(std::exchange(other.id_, {})),
+      unlink_name_(std::move(other.unlink_name_)) {
+    other.unlink_name_.clear();
+}
+
+auto shared_memory::operator=(shared_memory &&other) noexcept
+    -> shared_memory & {
+    if (this != &other) {
+        release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        id_ = std::exchange(other.id_, {});
+        unlink_name_ = std::move(other.unlink_name_);
+        other.unlink_name_.clear();
+    }
+    return *this;
+}
+
+void shared_memory::release() noexcept {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+        data_ = nullptr;
+    }
+    if (!unlink_name_.empty()) {
+        shm_unlink(unlink_name_.c_str());
+        unlink_name_.clear();
+    }
+    size_ = 0;
+    id_ = {};
+}
+
+auto send_all(int fd, void const *data, std::size_t size) -> bool {
+    auto const *p = static_cast<char const *>(data);
+    while (size > 0) {
+        ssize_t const n = send(fd, p, size, send_flags);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+auto recv_all(int fd, void *data, std::size_t size) -> bool {
+    auto *p = static_cast<char *>(data);
+    while (size > 0) {
+        ssize_t const n = recv(fd, p, size, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+} // namespace ihist::service
@@ -0,0 +1,67 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ihist::service {
+
+// Identifies a shared memory object independently of its name, so that one
+// unlinked and recreated under the same name can be told apart.
+struct object_id {
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+
+    friend auto operator==(object_id const &a, object_id const &b) -> bool {
+        return a.device == b.device && a.inode == b.inode;
+    }
+    friend auto operator!=(object_id const &a, object_id const &b) -> bool {
+        return !(a == b);
+    }
+};
+
+// A mapped POSIX shared memory object. Throws std::runtime_error on failure.
+class shared_memory {
+  public:
+    // Create (replacing any existing object of the same name) and map
+    // read-write; the object is unlinked on destruction.
+    static auto create(std::string const &name, std::size_t size)
+        -> shared_memory;
+
+    // Map an existing object, read-only unless writable.
+    static auto open(std::string const &name, bool writable = false)
+        -> shared_memory;
+
+    // Identity of the object currently under the name, without mapping it.
+    static auto identify(std::string const &name) -> object_id;
+
+    shared_memory() = default;
+    ~shared_memory();
+    shared_memory(shared_memory &&other) noexcept;
+    auto operator=(shared_memory &&other) noexcept -> shared_memory &;
+
+    [[nodiscard]] auto data() const -> void * { return data_; }
+    [[nodiscard]] auto size() const -> std::size_t { return size_; }
+    [[nodiscard]] auto id() const -> object_id { return id_; }
+
+  private:
+    void release() noexcept;
+
+    void *data_ = nullptr;
+    std::size_t size_ = 0;
+    object_id id_;            // Set by open()
+    std::string unlink_name_; // Non-empty if created by us
+};
+
+// Write or read exactly size bytes on a socket, retrying on EINTR and partial
+// transfers. Return false if the peer closed the connection or on error.
+auto send_all(int fd, void const *data, std::size_t size) -> bool;
+auto recv_all(int fd, void *data, std::size_t size) -> bool;
+
+} // namespace ihist::service
@@ -0,0 +1,81 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+// Wire format of the ihistd service (see README.md). Clients send one
+// frame_request per frame over a Unix stream socket and receive one
+// frame_reply per request, in order. Histograms are published in a POSIX
+// shared memory region laid out as region_header followed by the counts.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ihist::service {
+
+constexpr std::uint32_t protocol_version = 1;
+constexpr std::uint32_t region_magic = 0x54534849; // "IHST" little-endian
+
+struct frame_request {
+    std::uint32_t version;      // protocol_version
+    std::uint32_t sample_size;  // Bytes per sample: 1 or 2
+    std::uint32_t sample_bits;  // Histogram has 2^sample_bits bins
+    std::uint32_t n_components; // Interleaved; all are histogrammed
+    std::uint64_t frame_id;     // Echoed in the reply and the region
+    std::uint64_t offset;       // Of the frame in the shared memory, bytes
+    std::uint64_t height;
+    std::uint64_t width;
+    std::uint64_t stride; // Row stride, pixels
+    char shm_name[64];    // POSIX shared memory object, NUL-terminated
+};
+
+enum class status : std::int32_t {
+    ok = 0,
+    bad_request = 1, // Malformed or exceeds the service's limits
+    shm_error = 2,   // Frame shared memory cannot be opened or is too small
+};
+
+struct frame_reply {
+    status result;
+    std::uint32_t reserved;
+    std::uint64_t frame_id;
+    std::uint64_t sequence; // Region sequence number after publishing
+};
+
+// Published histogram, guarded by a seqlock: the service makes sequence odd,
+// writes the fields and counts, then makes it even again. Readers copy
+// everything between two loads of the same even sequence (read_latest() in
+// client.hpp does this). A sequence of 0 means nothing has been published.
+struct region_header {
+    std::uint32_t magic;   // region_magic
+    std::uint32_t version; // protocol_version
+    std::uint64_t capacity; // Maximum number of counts
+    alignas(64) std::atomic<std::uint64_t> sequence;
+    std::uint64_t frame_id;
+    std::uint64_t publish_time_ns; // std::chrono::steady_clock
+    std::uint32_t sample_bits;
+    std::uint32_t n_components;
+    // Followed by n_components histograms of 2^sample_bits uint32 counts.
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "region sequence must be usable across processes");
+
+inline auto region_bytes(std::size_t capacity) -> std::size_t {
+    return sizeof(region_header) + capacity * sizeof(std::uint32_t);
+}
+
+inline auto region_counts(region_header *region) -> std::uint32_t * {
+    return reinterpret_cast<std::uint32_t *>(region + 1);
+}
+
+inline auto region_counts(region_header const *region)
+    -> std::uint32_t const * {
+    return reinterpret_cast<std::uint32_t const *>(region + 1);
+}
+
+} // namespace ihist::service
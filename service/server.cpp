@@ -0,0 +1,275 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "server.hpp"
+
+#include "ihist/ihist.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ihist::service {
+
+namespace {
+
+// Frame memory objects kept mapped between requests. Producers normally
+// reuse a few ring buffers, so this is only reached by misbehaving clients.
+constexpr std::size_t max_mapped_frames = 16;
+
+auto make_listen_socket(std::string const &path) -> int {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("invalid socket path: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int const fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("cannot create socket: ") +
+                                 std::strerror(errno));
+    }
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr const *>(&addr), sizeof(addr)) !=
+            0 ||
+        listen(fd, 16) != 0) {
+        int const err = errno;
+        close(fd);
+        throw std::runtime_error("cannot listen on " + path + ": " +
+                                 std::strerror(err));
+    }
+    return fd;
+}
+
+// Bytes spanned by the frame, or 0 if it cannot be valid. Runs before the
+// rest of the request is validated, so checks everything the arithmetic
+// divides by.
+auto frame_span(frame_request const &r) -> std::uint64_t {
+    constexpr auto max = std::numeric_limits<std::uint64_t>::max();
+    if (r.height == 0 || r.width == 0 || r.stride < r.width ||
+        (r.sample_size != 1 && r.sample_size != 2) || r.n_components == 0) {
+        return 0;
+    }
+    std::uint64_t const pixel_bytes =
+        std::uint64_t(r.sample_size) * r.n_components;
+    if (r.stride > max / pixel_bytes ||
+        r.height - 1 > max / (r.stride * pixel_bytes)) {
+        return 0;
+    }
+    std::uint64_t const span =
+        (r.height - 1) * r.stride * pixel_bytes + r.width * pixel_bytes;
+    return r.offset > max - span ? 0 : span;
+}
+
+} // namespace
+
+server::server(server_config config) : config_(std::move(config)) {
+    std::size_t const capacity = config_.max_components
+                                 << config_.max_sample_bits;
+    region_ = shared_memory::create(config_.region_name,
+                                    region_bytes(capacity));
+    auto *header = new (region_.data()) region_header{};
+    header->magic = region_magic;
+    header->version = protocol_version;
+    header->capacity = capacity;
+    counts_.resize(capacity);
+
+    if (pipe(wake_fds_) != 0) {
+        throw std::runtime_error(std::string("cannot create pipe: ") +
+                                 std::strerror(errno));
+    }
+    fcntl(wake_fds_[1], F_SETFL, O_NONBLOCK);
+    try {
+        listen_fd_ = make_listen_socket(config_.socket_path);
+    } catch (...) {
+        close(wake_fds_[0]);
+        close(wake_fds_[1]);
+        throw;
+    }
+}
+
+server::~server() {
+    for (int fd : clients_) {
+        close(fd);
+    }
+    close(listen_fd_);
+    unlink(config_.socket_path.c_str());
+    close(wake_fds_[0]);
+    close(wake_fds_[1]);
+}
+
+void server::stop() noexcept {
+    char const c = 0;
+    // Ignoring failure: a full pipe already has a pending wake-up.
+    [[maybe_unused]] auto const n = write(wake_fds_[1], &c, 1);
+}
+
+void server::run() {
+    std::vector<pollfd> fds;
+    for (;;) {
+        fds.clear();
+        fds.push_back({wake_fds_[0], POLLIN, 0});
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (int fd : clients_) {
+            fds.push_back({fd, POLLIN, 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("poll failed: ") +
+                                     std::strerror(errno));
+        }
+        if (fds[0].revents != 0) {
+            char c;
+            [[maybe_unused]] auto const n = read(wake_fds_[0], &c, 1);
+            return;
+        }
+        if ((fds[1].revents & POLLIN) != 0) {
+            int const fd = accept(listen_fd_, nullptr, nullptr);
+            if (fd >= 0) {
+                clients_.push_back(fd);
+            }
+        }
+        std::vector<int> closed;
+        for (std::size_t i = 2; i < fds.size(); ++i) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            frame_request request{};
+            if (!recv_all(fds[i].fd, &request, sizeof(request))) {
+                closed.push_back(fds[i].fd);
+                continue;
+            }
+            frame_reply const reply = handle(request);
+            if (!send_all(fds[i].fd, &reply, sizeof(reply))) {
+                closed.push_back(fds[i].fd);
+            }
+        }
+        for (int fd : closed) {
+            close(fd);
+            clients_.erase(std::find(clients_.begin(), clients_.end(), fd));
+        }
+    }
+}
+
+auto server::frame_memory(std::string const &name, std::uint64_t min_size)
+    -> shared_memory const & {
+    // Producers may unlink a frame object and create another under the same
+    // name; a stale mapping would then silently histogram the old pages.
+    auto const id = shared_memory::identify(name);
+    auto it = frames_.find(name);
+    if (it != frames_.end() && it->second.id() == id &&
+        it->second.size() >= min_size) {
+        return it->second;
+    }
+    // Not yet mapped, replaced, or grown since: map it afresh.
+    if (it == frames_.end() && frames_.size() >= max_mapped_frames) {
+        frames_.clear();
+    }
+    auto &shm = frames_[name];
+    shm = shared_memory::open(name);
+    return shm;
+}
+
+auto server::handle(frame_request const &r) -> frame_reply {
+    frame_reply reply{status::bad_request, 0, r.frame_id, 0};
+    bool const name_ok =
+        std::memchr(r.shm_name, '\0', sizeof(r.shm_name)) != nullptr &&
+        r.shm_name[0] == '/';
+    std::uint64_t const span = frame_span(r);
+    if (r.version != protocol_version || !name_ok || span == 0 ||
+        (r.sample_size != 1 && r.sample_size != 2) ||
+        r.sample_bits > 8 * r.sample_size ||
+        r.sample_bits > config_.max_sample_bits || r.n_components == 0 ||
+        r.n_components > config_.max_components || r.width > r.stride ||
+        r.offset % r.sample_size != 0 ||
+        r.height * r.width >= std::numeric_limits<std::uint32_t>::max()) {
+        return reply;
+    }
+
+    shared_memory const *shm = nullptr;
+    try {
+        shm = &frame_memory(r.shm_name, r.offset + span);
+    } catch (std::runtime_error const &) {
+        frames_.erase(r.shm_name);
+        reply.result = status::shm_error;
+        return reply;
+    }
+    if (shm->size() < r.offset + span) {
+        reply.result = status::shm_error;
+        return reply;
+    }
+
+    std::size_t const n_counts = std::size_t(r.n_components)
+                                 << r.sample_bits;
+    std::fill_n(counts_.begin(), n_counts, 0);
+    component_indices_.resize(r.n_components);
+    std::iota(component_indices_.begin(), component_indices_.end(),
+              std::size_t(0));
+    auto const *frame = static_cast<unsigned char const *>(shm->data()) +
+                        static_cast<std::size_t>(r.offset);
+    auto const height = static_cast<std::size_t>(r.height);
+    auto const width = static_cast<std::size_t>(r.width);
+    auto const stride = static_cast<std::size_t>(r.stride);
+    if (r.sample_size == 1) {
+        ihist_hist8_2d(r.sample_bits, frame, nullptr, height, width, stride,
+                       stride, r.n_components, r.n_components,
+                       component_indices_.data(), counts_.data(),
+                       config_.parallel);
+    } else {
+        ihist_hist16_2d(r.sample_bits,
+                        reinterpret_cast<std::uint16_t const *>(frame),
+                        nullptr, height, width, stride, stride,
+                        r.n_components, r.n_components,
+                        component_indices_.data(), counts_.data(),
+                        config_.parallel);
+    }
+
+    publish(r, n_counts);
+    reply.result = status::ok;
+    reply.sequence = static_cast<region_header *>(region_.data())
+                         ->sequence.load(std::memory_order_relaxed);
+    return reply;
+}
+
+void server::publish(frame_request const &r, std::size_t n_counts) {
+    auto *header = static_cast<region_header *>(region_.data());
+    auto const seq = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    header->frame_id = r.frame_id;
+    header->publish_time_ns = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+    header->sample_bits = r.sample_bits;
+    header->n_components = r.n_components;
+    std::copy_n(counts_.begin(), n_counts, region_counts(header));
+
+    header->sequence.store(seq + 2, std::memory_order_release);
+}
+
+} // namespace ihist::service
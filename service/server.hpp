@@ -0,0 +1,64 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "posix.hpp"
+#include "protocol.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ihist::service {
+
+struct server_config {
+    std::string socket_path; // Unix socket to listen on
+    std::string region_name; // Shared memory for published histograms
+    std::size_t max_sample_bits = 16;
+    std::size_t max_components = 4;
+    bool parallel = true;
+};
+
+// The ihistd service: histograms frames named by clients and publishes each
+// result in the region. Requests from all clients are handled one at a time
+// in arrival order, each with the multithreaded histogram functions, so a
+// frame is histogrammed once however many processes read the result.
+class server {
+  public:
+    // Create the region and start listening. Throws std::runtime_error.
+    explicit server(server_config config);
+    ~server();
+
+    server(server const &) = delete;
+    auto operator=(server const &) -> server & = delete;
+
+    // Serve requests until stop() is called.
+    void run();
+
+    // Make run() return. Safe to call from another thread or from a signal
+    // handler.
+    void stop() noexcept;
+
+  private:
+    auto handle(frame_request const &request) -> frame_reply;
+    auto frame_memory(std::string const &name, std::uint64_t min_size)
+        -> shared_memory const &;
+    void publish(frame_request const &request, std::size_t n_counts);
+
+    server_config config_;
+    shared_memory region_;
+    int listen_fd_ = -1;
+    int wake_fds_[2] = {-1, -1};
+    std::vector<int> clients_;
+    std::map<std::string, shared_memory> frames_; // Mapped frame memory
+    std::vector<std::uint32_t> counts_;
+    std::vector<std::size_t> component_indices_;
+};
+
+} // namespace ihist::service
@@ -0,0 +1,188 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include "fused_rows.hpp"
+#include "ihist/phys_core_count.hpp"
+
+#ifdef IHIST_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/combinable.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <vector>
+
+// Each thread that has processed a feed (with TBB, including the calling
+// thread for small feeds) owns histograms at kernel resolution, filled with
+// the tuned kernels: one for 8-bit feeds and one for 16-bit feeds, created on
+// first use. They live as long as the accumulator, so that they are reduced
+// once per finish() rather than once per feed.
+struct ihist_accumulator {
+    struct thread_hists {
+        std::optional<ihist::internal::band_histogram> hist8;
+        std::optional<ihist::internal::band_histogram> hist16;
+    };
+
+    std::size_t sample_bits;
+    std::size_t n_components;
+    std::vector<std::size_t> component_indices;
+#ifdef IHIST_USE_TBB
+    tbb::combinable<thread_hists> hists;
+    std::unique_ptr<tbb::task_arena> arena;
+#else
+    thread_hists hists;
+#endif
+
+    ihist_accumulator(std::size_t sample_bits, std::size_t n_components,
+                      std::size_t n_hist_components,
+                      std::size_t const *indices)
+        : sample_bits(sample_bits), n_components(n_components),
+          component_indices(indices, indices + n_hist_components) {}
+
+    [[nodiscard]] auto n_hist_components() const -> std::size_t {
+        return component_indices.size();
+    }
+
+    template <typename T>
+    void feed_rows(T const *image, std::uint8_t const *mask,
+                   std::size_t y_begin, std::size_t y_end, std::size_t width,
+                   std::size_t image_stride, std::size_t mask_stride,
+                   thread_hists &h) const {
+        auto &hist = sizeof(T) == 1 ? h.hist8 : h.hist16;
+        if (!hist) {
+            hist.emplace(ihist::internal::tuned_kernel_bits<T>(sample_bits),
+                         n_hist_components());
+        }
+        hist->add(image + y_begin * image_stride * n_components,
+                  mask == nullptr ? nullptr : mask + y_begin * mask_stride,
+                  y_end - y_begin, width, image_stride, mask_stride,
+                  n_components, n_hist_components(),
+                  component_indices.data());
+    }
+
+    template <typename T>
+    void feed(T const *image, std::uint8_t const *mask, std::size_t height,
+              std::size_t width, std::size_t image_stride,
+              std::size_t mask_stride, bool maybe_parallel) {
+        if (height == 0 || width == 0 || n_hist_components() == 0) {
+            return;
+        }
+#ifdef IHIST_USE_TBB
+        if (maybe_parallel &&
+            width * height >=
+                ihist::internal::fused_parallel_size_threshold) {
+            if (!arena) {
+                // The arena is kept so that its threads (and their histograms)
+                // are reused by later feeds.
+                arena = std::make_unique<tbb::task_arena>(
+                    ihist::internal::phys_core_arena());
+            }
+            auto const h_grain_size = std::max(
+                std::size_t(1),
+                ihist::internal::fused_parallel_grain_size / width);
+            arena->execute([&] {
+                tbb::parallel_for(
+                    tbb::blocked_range<std::size_t>(0, height, h_grain_size),
+                    [&](tbb::blocked_range<std::size_t> const &r) {
+                        feed_rows(image, mask, r.begin(), r.end(), width,
+                                  image_stride, mask_stride, hists.local());
+                    });
+            });
+            return;
+        }
+        feed_rows(image, mask, 0, height, width, image_stride, mask_stride,
+                  hists.local());
+#else
+        (void)maybe_parallel;
+        feed_rows(image, mask, 0, height, width, image_stride, mask_stride,
+                  hists);
+#endif
+    }
+
+    void reduce(thread_hists &h, std::uint32_t *histogram,
+                std::uint32_t *overflow) {
+        for (auto *hist : {&h.hist8, &h.hist16}) {
+            if (*hist) {
+                (*hist)->reduce(sample_bits, histogram, overflow);
+            }
+        }
+    }
+
+    void finish(std::uint32_t *histogram, std::uint32_t *overflow) {
+#ifdef IHIST_USE_TBB
+        hists.combine_each(
+            [&](thread_hists &h) { reduce(h, histogram, overflow); });
+#else
+        reduce(hists, histogram, overflow);
+#endif
+    }
+};
+
+extern "C" IHIST_PUBLIC ihist_accumulator *
+ihist_accumulator_create(size_t sample_bits, size_t n_components,
+                         size_t n_hist_components,
+                         size_t const *IHIST_RESTRICT component_indices) {
+    assert(sample_bits <= 16);
+    assert(std::all_of(component_indices,
+                       component_indices + n_hist_components,
+                       [&](std::size_t i) { return i < n_components; }));
+    try {
+        return new ihist_accumulator(sample_bits, n_components,
+                                     n_hist_components, component_indices);
+    } catch (std::bad_alloc const &) {
+        return nullptr;
+    }
+}
+
+extern "C" IHIST_PUBLIC void
+ihist_accumulator_destroy(ihist_accumulator *accumulator) {
+    delete accumulator;
+}
+
+extern "C" IHIST_PUBLIC void ihist_accumulator_feed8(
+    ihist_accumulator *IHIST_RESTRICT accumulator,
+    uint8_t const *IHIST_RESTRICT image, uint8_t const *IHIST_RESTRICT mask,
+    size_t height, size_t width, size_t image_stride, size_t mask_stride,
+    bool maybe_parallel) {
+    assert(accumulator != nullptr);
+    assert(image != nullptr || height * width == 0);
+    assert(width <= image_stride || height == 0);
+    assert(mask == nullptr || width <= mask_stride || height == 0);
+    accumulator->feed(image, mask, height, width, image_stride, mask_stride,
+                      maybe_parallel);
+}
+
+extern "C" IHIST_PUBLIC void ihist_accumulator_feed16(
+    ihist_accumulator *IHIST_RESTRICT accumulator,
+    uint16_t const *IHIST_RESTRICT image, uint8_t const *IHIST_RESTRICT mask,
+    size_t height, size_t width, size_t image_stride, size_t mask_stride,
+    bool maybe_parallel) {
+    assert(accumulator != nullptr);
+    assert(image != nullptr || height * width == 0);
+    assert(width <= image_stride || height == 0);
+    assert(mask == nullptr || width <= mask_stride || height == 0);
+    accumulator->feed(image, mask, height, width, image_stride, mask_stride,
+                      maybe_parallel);
+}
+
+extern "C" IHIST_PUBLIC void
+ihist_accumulator_finish(ihist_accumulator *IHIST_RESTRICT accumulator,
+                         uint32_t *IHIST_RESTRICT histogram,
+                         uint32_t *IHIST_RESTRICT overflow) {
+    assert(accumulator != nullptr);
+    assert(histogram != nullptr || accumulator->n_hist_components() == 0);
+    accumulator->finish(histogram, overflow);
+}
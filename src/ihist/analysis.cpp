@@ -0,0 +1,216 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+// Like the statistics, these analyses work on the histogram (one pass, or a
+// few passes, over the bins) and never touch the image again.
+
+auto component_count(std::size_t n_bins, std::uint32_t const *hist)
+    -> std::uint64_t {
+    return std::accumulate(hist, hist + n_bins, std::uint64_t(0));
+}
+
+// Rank (1-based) of the sample at quantile q among count samples: the
+// smallest rank r such that r >= q * count, but at least 1 so that q = 0
+// selects the minimum.
+auto quantile_rank(double q, std::uint64_t count) -> std::uint64_t {
+    auto const r =
+        static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count)));
+    return std::clamp<std::uint64_t>(r, 1, count);
+}
+
+// Find all quantiles in a single sweep over the bins. 'order' lists the
+// quantile indices in ascending order of quantile.
+void component_quantiles(std::size_t n_bins, std::uint32_t const *hist,
+                         std::size_t n_quantiles, double const *quantiles,
+                         std::size_t const *order, std::uint32_t *values) {
+    auto const count = component_count(n_bins, hist);
+    if (count == 0) {
+        std::fill_n(values, n_quantiles, std::uint32_t(0));
+        return;
+    }
+
+    std::uint64_t cumsum = 0;
+    std::size_t bin = 0;
+    for (std::size_t k = 0; k < n_quantiles; ++k) {
+        auto const qi = order[k];
+        auto const rank = quantile_rank(quantiles[qi], count);
+        while (cumsum + hist[bin] < rank) {
+            cumsum += hist[bin];
+            ++bin;
+        }
+        values[qi] = static_cast<std::uint32_t>(bin);
+    }
+}
+
+// Otsu's method: the threshold t maximizing the between-class variance when
+// the samples are split into [0, t] and [t + 1, n_bins). For the running sums
+// we use integers so that the class weights and means are exact.
+auto component_otsu(std::size_t n_bins, std::uint32_t const *hist)
+    -> std::uint32_t {
+    std::uint64_t total = 0;
+    std::uint64_t total_sum = 0;
+    for (std::size_t bin = 0; bin < n_bins; ++bin) {
+        total += hist[bin];
+        total_sum += std::uint64_t(hist[bin]) * bin;
+    }
+
+    std::uint32_t threshold = 0;
+    double best = 0.0;
+    std::uint64_t w0 = 0;
+    std::uint64_t sum0 = 0;
+    for (std::size_t t = 0; t + 1 < n_bins; ++t) {
+        w0 += hist[t];
+        sum0 += std::uint64_t(hist[t]) * t;
+        if (w0 == 0) {
+            continue;
+        }
+        if (w0 == total) {
+            break;
+        }
+        // sigma_b^2 * total^2 = (total_sum * w0 - sum0 * total)^2 /
+        // (w0 * w1); the constant factor does not affect the argmax.
+        double const w1 = static_cast<double>(total - w0);
+        double const diff =
+            static_cast<double>(total_sum) * static_cast<double>(w0) -
+            static_cast<double>(sum0) * static_cast<double>(total);
+        double const between = diff / static_cast<double>(w0) * (diff / w1);
+        if (between > best) {
+            best = between;
+            threshold = static_cast<std::uint32_t>(t);
+        }
+    }
+    return threshold;
+}
+
+auto component_entropy(std::size_t n_bins, std::uint32_t const *hist)
+    -> double {
+    // H = log2(N) - (1/N) sum(c log2 c), which needs only one pass and one
+    // division.
+    std::uint64_t count = 0;
+    double c_log_c = 0.0;
+    for (std::size_t bin = 0; bin < n_bins; ++bin) {
+        std::uint32_t const c = hist[bin];
+        if (c > 1) {
+            c_log_c +=
+                static_cast<double>(c) * std::log2(static_cast<double>(c));
+        }
+        count += c;
+    }
+    if (count == 0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double const n = static_cast<double>(count);
+    return std::max(0.0, std::log2(n) - c_log_c / n);
+}
+
+} // namespace
+
+extern "C" IHIST_PUBLIC void
+ihist_histogram_cumsum(size_t sample_bits, size_t n_hist_components,
+                       uint32_t const *IHIST_RESTRICT histogram,
+                       uint64_t *IHIST_RESTRICT cumsum) {
+    assert(sample_bits <= 16);
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(cumsum != nullptr || n_hist_components == 0);
+
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    for (std::size_t i = 0; i < n_hist_components; ++i) {
+        std::uint32_t const *hist = histogram + i * n_bins;
+        std::uint64_t *out = cumsum + i * n_bins;
+        std::uint64_t sum = 0;
+        for (std::size_t bin = 0; bin < n_bins; ++bin) {
+            sum += hist[bin];
+            out[bin] = sum;
+        }
+    }
+}
+
+extern "C" IHIST_PUBLIC void
+ihist_histogram_quantiles(size_t sample_bits, size_t n_hist_components,
+                          uint32_t const *IHIST_RESTRICT histogram,
+                          size_t n_quantiles,
+                          double const *IHIST_RESTRICT quantiles,
+                          uint32_t *IHIST_RESTRICT values) {
+    assert(sample_bits <= 16);
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(quantiles != nullptr || n_quantiles == 0);
+    assert(values != nullptr || n_hist_components * n_quantiles == 0);
+    assert(std::all_of(quantiles, quantiles + n_quantiles,
+                       [](double q) { return q >= 0.0 && q <= 1.0; }));
+
+    // Sort once; the sweep for each component then visits each bin at most
+    // once regardless of the number of quantiles.
+    std::vector<std::size_t> order(n_quantiles);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return quantiles[a] < quantiles[b];
+    });
+
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    for (std::size_t i = 0; i < n_hist_components; ++i) {
+        component_quantiles(n_bins, histogram + i * n_bins, n_quantiles,
+                            quantiles, order.data(),
+                            values + i * n_quantiles);
+    }
+}
+
+extern "C" IHIST_PUBLIC void
+ihist_histogram_otsu(size_t sample_bits, size_t n_hist_components,
+                     uint32_t const *IHIST_RESTRICT histogram,
+                     uint32_t *IHIST_RESTRICT thresholds) {
+    assert(sample_bits <= 16);
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(thresholds != nullptr || n_hist_components == 0);
+
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    for (std::size_t i = 0; i < n_hist_components; ++i) {
+        thresholds[i] = component_otsu(n_bins, histogram + i * n_bins);
+    }
+}
+
+extern "C" IHIST_PUBLIC void
+ihist_histogram_entropy(size_t sample_bits, size_t n_hist_components,
+                        uint32_t const *IHIST_RESTRICT histogram,
+                        double *IHIST_RESTRICT entropy) {
+    assert(sample_bits <= 16);
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(entropy != nullptr || n_hist_components == 0);
+
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    for (std::size_t i = 0; i < n_hist_components; ++i) {
+        entropy[i] = component_entropy(n_bins, histogram + i * n_bins);
+    }
+}
+
+extern "C" IHIST_PUBLIC void
+ihist_histogram_mode(size_t sample_bits, size_t n_hist_components,
+                     uint32_t const *IHIST_RESTRICT histogram,
+                     uint32_t *IHIST_RESTRICT modes) {
+    assert(sample_bits <= 16);
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(modes != nullptr || n_hist_components == 0);
+
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    for (std::size_t i = 0; i < n_hist_components; ++i) {
+        std::uint32_t const *hist = histogram + i * n_bins;
+        modes[i] = static_cast<std::uint32_t>(
+            std::distance(hist, std::max_element(hist, hist + n_bins)));
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include "ihist/phys_core_count.hpp"
+
+#ifdef IHIST_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+// Images of at least this many pixels are parallelized internally (by the
+// single-image functions), one after another. Smaller images are instead
+// distributed across threads, if there are at least this many pixels in
+// total.
+constexpr std::size_t large_image_size = 1uLL << 20;
+constexpr std::size_t parallel_size_threshold = 1uLL << 16;
+
+template <typename Tile>
+void hist_one(std::size_t sample_bits, Tile const &image,
+              std::size_t n_components, std::size_t n_hist_components,
+              std::size_t const *component_indices, std::uint32_t *histogram,
+              bool maybe_parallel) {
+    // Empty images may have null image pointers, unlike for ihist_hist*_2d().
+    if (image.height == 0 || image.width == 0) {
+        return;
+    }
+    if constexpr (std::is_same_v<Tile, ihist_tile8>) {
+        ihist_hist8_2d(sample_bits, image.image, image.mask, image.height,
+                       image.width, image.image_stride, image.mask_stride,
+                       n_components, n_hist_components, component_indices,
+                       histogram, maybe_parallel);
+    } else {
+        ihist_hist16_2d(sample_bits, image.image, image.mask, image.height,
+                        image.width, image.image_stride, image.mask_stride,
+                        n_components, n_hist_components, component_indices,
+                        histogram, maybe_parallel);
+    }
+}
+
+template <typename Tile>
+void hist_batch(std::size_t sample_bits, std::size_t n_images,
+                Tile const *images, std::size_t n_components,
+                std::size_t n_hist_components,
+                std::size_t const *component_indices,
+                std::uint32_t *const *histograms, bool maybe_parallel) {
+    assert(images != nullptr || n_images == 0);
+    assert(histograms != nullptr || n_images == 0);
+
+    std::vector<std::size_t> small;
+    std::size_t small_pixels = 0;
+    for (std::size_t i = 0; i < n_images; ++i) {
+        std::size_t const size = images[i].height * images[i].width;
+        if (maybe_parallel && size >= large_image_size) {
+            hist_one(sample_bits, images[i], n_components, n_hist_components,
+                     component_indices, histograms[i], true);
+        } else {
+            small.push_back(i);
+            small_pixels += size;
+        }
+    }
+
+#ifdef IHIST_USE_TBB
+    if (maybe_parallel && small.size() > 1 &&
+        small_pixels >= parallel_size_threshold) {
+        auto arena = ihist::internal::phys_core_arena();
+        arena.execute([&] {
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(0, small.size()),
+                [&](tbb::blocked_range<std::size_t> const &r) {
+                    for (std::size_t j = r.begin(); j < r.end(); ++j) {
+                        std::size_t const i = small[j];
+                        hist_one(sample_bits, images[i], n_components,
+                                 n_hist_components, component_indices,
+                                 histograms[i], false);
+                    }
+                });
+        });
+        return;
+    }
+#endif
+
+    for (std::size_t i : small) {
+        hist_one(sample_bits, images[i], n_components, n_hist_components,
+                 component_indices, histograms[i], false);
+    }
+}
+
+} // namespace
+
+extern "C" IHIST_PUBLIC void
+ihist_hist8_2d_batch(size_t sample_bits, size_t n_images,
+                     ihist_tile8 const *IHIST_RESTRICT images,
+                     size_t n_components, size_t n_hist_components,
+                     size_t const *IHIST_RESTRICT component_indices,
+                     uint32_t *const *IHIST_RESTRICT histograms,
+                     bool maybe_parallel) {
+    hist_batch(sample_bits, n_images, images, n_components,
+               n_hist_components, component_indices, histograms,
+               maybe_parallel);
+}
+
+extern "C" IHIST_PUBLIC void
+ihist_hist16_2d_batch(size_t sample_bits, size_t n_images,
+                      ihist_tile16 const *IHIST_RESTRICT images,
+                      size_t n_components, size_t n_hist_components,
+                      size_t const *IHIST_RESTRICT component_indices,
+                      uint32_t *const *IHIST_RESTRICT histograms,
+                      bool maybe_parallel) {
+    hist_batch(sample_bits, n_images, images, n_components,
+               n_hist_components, component_indices, histograms,
+               maybe_parallel);
+}
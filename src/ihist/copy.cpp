@@ -0,0 +1,144 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include "fused_rows.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define IHIST_HAVE_STREAM_STORES 1
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// Copy n bytes, bypassing the cache for the destination where supported, so
+// that a large copy does not evict the source rows (and histogram) that are
+// still being worked on. Falls back to memcpy. The caller must call
+// fence_streaming() before the copied data is read (possibly on another
+// thread).
+void copy_streaming(void *dst, void const *src, std::size_t n) {
+#ifdef IHIST_HAVE_STREAM_STORES
+    auto *d = static_cast<char *>(dst);
+    auto const *s = static_cast<char const *>(src);
+    std::size_t const head = std::min(
+        n, (16 - reinterpret_cast<std::uintptr_t>(d) % 16) % std::size_t(16));
+    std::memcpy(d, s, head);
+    std::size_t i = head;
+    for (; i + 16 <= n; i += 16) {
+        __m128i const v =
+            _mm_loadu_si128(reinterpret_cast<__m128i const *>(s + i));
+        _mm_stream_si128(reinterpret_cast<__m128i *>(d + i), v);
+    }
+    std::memcpy(d + i, s + i, n - i);
+#else
+    std::memcpy(dst, src, n);
+#endif
+}
+
+void fence_streaming() {
+#ifdef IHIST_HAVE_STREAM_STORES
+    _mm_sfence();
+#endif
+}
+
+template <typename T>
+void hist_2d_copy(std::size_t sample_bits, T const *image,
+                  std::uint8_t const *mask, std::size_t height,
+                  std::size_t width, std::size_t image_stride,
+                  std::size_t mask_stride, std::size_t n_components,
+                  std::size_t n_hist_components,
+                  std::size_t const *component_indices,
+                  std::uint32_t *histogram, T *dest, std::size_t dest_stride,
+                  bool non_temporal, bool maybe_parallel) {
+    assert(sample_bits <= 8 * sizeof(T));
+    assert(image != nullptr || height * width == 0);
+    assert(dest != nullptr || height * width == 0);
+    assert(width <= image_stride || height == 0);
+    assert(width <= dest_stride || height == 0);
+    assert(mask == nullptr || width <= mask_stride || height == 0);
+    assert(width * height < std::numeric_limits<std::uint32_t>::max());
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(std::all_of(component_indices,
+                       component_indices + n_hist_components,
+                       [&](std::size_t i) { return i < n_components; }));
+
+    namespace internal = ihist::internal;
+    std::size_t const row_bytes = width * n_components * sizeof(T);
+    internal::fused_band_params const p{
+        sample_bits,
+        internal::tuned_kernel_bits<T>(sample_bits),
+        n_hist_components,
+        width,
+        internal::fused_band_rows(row_bytes),
+        0};
+
+    // Each band is copied and then histogrammed from the source with the
+    // tuned kernels, while the band is still in cache. Streaming stores are
+    // fenced once per task rather than per row.
+    internal::fused_histogram_bands<T>(
+        p, height, histogram, nullptr, maybe_parallel,
+        [&](std::size_t y_begin, std::size_t y_end,
+            internal::band_state<T> &state) {
+            internal::for_each_band(p, y_begin, y_end, [&](std::size_t y0,
+                                                           std::size_t y1) {
+                for (std::size_t y = y0; y < y1; ++y) {
+                    T const *row = image + y * image_stride * n_components;
+                    T *out = dest + y * dest_stride * n_components;
+                    if (non_temporal) {
+                        copy_streaming(out, row, row_bytes);
+                    } else {
+                        std::memcpy(out, row, row_bytes);
+                    }
+                }
+                if (n_hist_components > 0) {
+                    state.hist.add(
+                        image + y0 * image_stride * n_components,
+                        mask == nullptr ? nullptr : mask + y0 * mask_stride,
+                        y1 - y0, width, image_stride, mask_stride,
+                        n_components, n_hist_components, component_indices);
+                }
+            });
+            if (non_temporal) {
+                fence_streaming();
+            }
+        });
+}
+
+} // namespace
+
+extern "C" IHIST_PUBLIC void ihist_hist8_2d_copy(
+    size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, uint8_t *IHIST_RESTRICT dest,
+    size_t dest_stride, bool non_temporal, bool maybe_parallel) {
+    hist_2d_copy(sample_bits, image, mask, height, width, image_stride,
+                 mask_stride, n_components, n_hist_components,
+                 component_indices, histogram, dest, dest_stride, non_temporal,
+                 maybe_parallel);
+}
+
+extern "C" IHIST_PUBLIC void ihist_hist16_2d_copy(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, uint16_t *IHIST_RESTRICT dest,
+    size_t dest_stride, bool non_temporal, bool maybe_parallel) {
+    hist_2d_copy(sample_bits, image, mask, height, width, image_stride,
+                 mask_stride, n_components, n_hist_components,
+                 component_indices, histogram, dest, dest_stride, non_temporal,
+                 maybe_parallel);
+}
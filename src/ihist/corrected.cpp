@@ -0,0 +1,149 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include "fused_rows.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// Correct component ci of rows of pixels into a plane of height x width
+// samples, saturated to 16 bits. If CountSaturated, return the number of
+// samples selected by mask (if not null) that were saturated, i.e., that
+// landed in the top bin although they were out of range. The products fit in
+// 32 bits because both factors are 16-bit and the rounding term is at most
+// 2^15.
+template <bool Dark, bool Gain, bool CountSaturated>
+auto correct_rows(std::uint16_t const *image, std::uint16_t const *dark,
+                  std::uint16_t const *gain, std::size_t gain_frac_bits,
+                  std::uint8_t const *mask, std::size_t height,
+                  std::size_t width, std::size_t image_stride,
+                  std::size_t mask_stride, std::size_t n_components,
+                  std::size_t ci, std::uint16_t *out) -> std::uint32_t {
+    std::uint32_t const rounding =
+        gain_frac_bits > 0 ? std::uint32_t(1) << (gain_frac_bits - 1) : 0;
+    std::uint32_t n_saturated = 0;
+    for (std::size_t y = 0; y < height; ++y) {
+        std::size_t const offset = y * image_stride * n_components + ci;
+        std::uint16_t const *row = image + offset;
+        std::uint16_t const *drow = Dark ? dark + offset : nullptr;
+        std::uint16_t const *grow = Gain ? gain + offset : nullptr;
+        std::uint8_t const *mask_row =
+            mask == nullptr ? nullptr : mask + y * mask_stride;
+        std::uint16_t *out_row = out + y * width;
+        for (std::size_t x = 0; x < width; ++x) {
+            std::size_t const i = x * n_components;
+            std::uint32_t v = row[i];
+            if constexpr (Dark) {
+                std::uint32_t const d = drow[i];
+                v = v > d ? v - d : 0;
+            }
+            if constexpr (Gain) {
+                v = (v * grow[i] + rounding) >> gain_frac_bits;
+            }
+            out_row[x] = static_cast<std::uint16_t>(
+                std::min(v, std::uint32_t(0xffff)));
+            if constexpr (CountSaturated) {
+                n_saturated += v > 0xffff &&
+                               (mask_row == nullptr || mask_row[x] != 0);
+            }
+        }
+    }
+    return n_saturated;
+}
+
+} // namespace
+
+extern "C" IHIST_PUBLIC void ihist_hist16_2d_corrected(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint16_t const *IHIST_RESTRICT dark, uint16_t const *IHIST_RESTRICT gain,
+    size_t gain_frac_bits, uint32_t *IHIST_RESTRICT histogram,
+    bool maybe_parallel) {
+    assert(sample_bits <= 16);
+    assert(image != nullptr || height * width == 0);
+    assert(width <= image_stride || height == 0);
+    assert(mask == nullptr || width <= mask_stride || height == 0);
+    assert(width * height < std::numeric_limits<std::uint32_t>::max());
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(gain_frac_bits <= 16);
+    assert(std::all_of(component_indices,
+                       component_indices + n_hist_components,
+                       [&](std::size_t i) { return i < n_components; }));
+
+    namespace internal = ihist::internal;
+
+    // Each selected component is corrected, a band of rows at a time, into a
+    // 16-bit scratch plane that is histogrammed with the tuned mono kernel
+    // while it is in cache. Saturating to 16 bits keeps values amplified out
+    // of range out of the histogram when sample_bits < 16; with 16-bit
+    // samples and a gain, they are counted and taken back out of the top bin.
+    std::size_t const band_rows = internal::fused_band_rows(
+        width * n_components * sizeof(std::uint16_t));
+    std::size_t const band_size = band_rows * width;
+    bool const count_saturated = sample_bits == 16 && gain != nullptr;
+    internal::fused_band_params const p{
+        sample_bits,
+        internal::tuned_kernel_bits<std::uint16_t>(sample_bits),
+        n_hist_components,
+        width,
+        band_rows,
+        band_size};
+    constexpr std::size_t plane_index = 0;
+
+    auto const correct = [&](auto... args) -> std::uint32_t {
+        if (count_saturated && dark != nullptr) {
+            return correct_rows<true, true, true>(args...);
+        } else if (count_saturated) {
+            return correct_rows<false, true, true>(args...);
+        } else if (dark != nullptr && gain != nullptr) {
+            return correct_rows<true, true, false>(args...);
+        } else if (dark != nullptr) {
+            return correct_rows<true, false, false>(args...);
+        } else if (gain != nullptr) {
+            return correct_rows<false, true, false>(args...);
+        } else {
+            return correct_rows<false, false, false>(args...);
+        }
+    };
+
+    internal::fused_histogram_bands<std::uint16_t>(
+        p, height, histogram, nullptr, maybe_parallel,
+        [&](std::size_t y_begin, std::size_t y_end,
+            internal::band_state<std::uint16_t> &state) {
+            std::uint16_t *plane = state.scratch.data();
+            internal::for_each_band(p, y_begin, y_end, [&](std::size_t y0,
+                                                           std::size_t y1) {
+                std::size_t const rows = y1 - y0;
+                std::size_t const offset = y0 * image_stride * n_components;
+                std::uint8_t const *band_mask =
+                    mask == nullptr ? nullptr : mask + y0 * mask_stride;
+                for (std::size_t s = 0; s < n_hist_components; ++s) {
+                    std::uint32_t const n_saturated = correct(
+                        image + offset,
+                        dark == nullptr ? nullptr : dark + offset,
+                        gain == nullptr ? nullptr : gain + offset,
+                        gain_frac_bits, band_mask, rows, width, image_stride,
+                        mask_stride, n_components, component_indices[s],
+                        plane);
+                    state.hist.add(plane, band_mask, rows, width, width,
+                                   mask_stride, 1, 1, &plane_index, s);
+                    if (count_saturated) {
+                        state.hist.bins(s)[0xffff] -= n_saturated;
+                    }
+                }
+            });
+        });
+}
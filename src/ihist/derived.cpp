@@ -0,0 +1,269 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include "fused_rows.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace {
+
+// Luma weights in 16-bit fixed point, each set summing to 65536 so that the
+// result never exceeds max(R, G, B). With 16-bit samples the weighted sum
+// (plus rounding) still fits in 32 bits.
+constexpr std::uint32_t luma709[] = {13933, 46871, 4732};
+constexpr std::uint32_t luma601[] = {19595, 38470, 7471};
+
+// Derived channel formulas, as function objects of (r, g, b).
+struct luma709_fn {
+    auto operator()(std::uint32_t r, std::uint32_t g, std::uint32_t b) const
+        -> std::uint32_t {
+        return (luma709[0] * r + luma709[1] * g + luma709[2] * b + 32768) >>
+               16;
+    }
+};
+
+struct luma601_fn {
+    auto operator()(std::uint32_t r, std::uint32_t g, std::uint32_t b) const
+        -> std::uint32_t {
+        return (luma601[0] * r + luma601[1] * g + luma601[2] * b + 32768) >>
+               16;
+    }
+};
+
+struct max_fn {
+    auto operator()(std::uint32_t r, std::uint32_t g, std::uint32_t b) const
+        -> std::uint32_t {
+        return std::max({r, g, b});
+    }
+};
+
+struct mean_fn {
+    auto operator()(std::uint32_t r, std::uint32_t g, std::uint32_t b) const
+        -> std::uint32_t {
+        return (r + g + b) / 3;
+    }
+};
+
+// Call fn with the function object for the channel, so that the channel is
+// selected outside the loop and the loop body is branch-free.
+template <typename Fn>
+void with_channel(ihist_derived_channel channel, Fn fn) {
+    switch (channel) {
+    case IHIST_DERIVED_LUMA_709:
+        fn(luma709_fn{});
+        break;
+    case IHIST_DERIVED_LUMA_601:
+        fn(luma601_fn{});
+        break;
+    case IHIST_DERIVED_MAX:
+        fn(max_fn{});
+        break;
+    case IHIST_DERIVED_MEAN:
+        fn(mean_fn{});
+        break;
+    }
+}
+
+// Pixel layout with the RGB positions fixed at compile time, so that the
+// loops reading the pixels can be vectorized.
+template <std::size_t NComponents, std::size_t R, std::size_t G,
+          std::size_t B>
+struct fixed_layout {
+    static constexpr std::size_t n_components = NComponents;
+    static constexpr std::size_t ri = R;
+    static constexpr std::size_t gi = G;
+    static constexpr std::size_t bi = B;
+};
+
+struct dynamic_layout {
+    std::size_t n_components;
+    std::size_t ri;
+    std::size_t gi;
+    std::size_t bi;
+};
+
+// Call fn with a fixed layout for packed RGB or BGR with or without a fourth
+// component, or a dynamic layout otherwise.
+template <typename Fn>
+void with_layout(std::size_t n_components, std::size_t const *rgb_indices,
+                 Fn fn) {
+    bool const rgb = rgb_indices[0] == 0 && rgb_indices[1] == 1 &&
+                     rgb_indices[2] == 2;
+    bool const bgr = rgb_indices[0] == 2 && rgb_indices[1] == 1 &&
+                     rgb_indices[2] == 0;
+    if (n_components == 3 && rgb) {
+        fn(fixed_layout<3, 0, 1, 2>{});
+    } else if (n_components == 3 && bgr) {
+        fn(fixed_layout<3, 2, 1, 0>{});
+    } else if (n_components == 4 && rgb) {
+        fn(fixed_layout<4, 0, 1, 2>{});
+    } else if (n_components == 4 && bgr) {
+        fn(fixed_layout<4, 2, 1, 0>{});
+    } else {
+        fn(dynamic_layout{n_components, rgb_indices[0], rgb_indices[1],
+                          rgb_indices[2]});
+    }
+}
+
+// Compute one or more derived channels for rows of pixels, each into a plane
+// of height x width samples, the planes placed plane_size apart from out.
+// Deriving two channels in one pass is worthwhile because picking apart the
+// interleaved pixels is what dominates the loop.
+template <typename T, typename Layout, typename... F>
+void derive_rows(Layout layout, T const *image, std::size_t height,
+                 std::size_t width, std::size_t image_stride,
+                 std::size_t plane_size, T *out, F... f) {
+    for (std::size_t y = 0; y < height; ++y) {
+        T const *row = image + y * image_stride * layout.n_components;
+        T *out_row = out + y * width;
+        for (std::size_t x = 0; x < width; ++x) {
+            T const *px = row + x * layout.n_components;
+            auto const r = std::uint32_t(px[layout.ri]);
+            auto const g = std::uint32_t(px[layout.gi]);
+            auto const b = std::uint32_t(px[layout.bi]);
+            std::size_t plane = 0;
+            ((out_row[plane++ * plane_size + x] = static_cast<T>(f(r, g, b))),
+             ...);
+        }
+    }
+}
+
+// The selected components are histogrammed straight from the image with the
+// tuned kernels. Each derived channel is computed for a band of rows into a
+// scratch plane and histogrammed with the tuned mono kernel while the band is
+// still in cache, so the image is read from memory only once.
+template <typename T>
+void hist_2d_derived(std::size_t sample_bits, T const *image,
+                     std::uint8_t const *mask, std::size_t height,
+                     std::size_t width, std::size_t image_stride,
+                     std::size_t mask_stride, std::size_t n_components,
+                     std::size_t n_hist_components,
+                     std::size_t const *component_indices,
+                     std::size_t const *rgb_indices, std::size_t n_derived,
+                     ihist_derived_channel const *derived,
+                     std::uint32_t *histogram, bool maybe_parallel) {
+    assert(sample_bits <= 8 * sizeof(T));
+    assert(image != nullptr || height * width == 0);
+    assert(width <= image_stride || height == 0);
+    assert(mask == nullptr || width <= mask_stride || height == 0);
+    assert(width * height < std::numeric_limits<std::uint32_t>::max());
+    assert(histogram != nullptr || n_hist_components + n_derived == 0);
+    assert(std::all_of(component_indices,
+                       component_indices + n_hist_components,
+                       [&](std::size_t i) { return i < n_components; }));
+    assert(n_derived == 0 ||
+           std::all_of(rgb_indices, rgb_indices + 3,
+                       [&](std::size_t i) { return i < n_components; }));
+
+    namespace internal = ihist::internal;
+
+    if (n_derived == 0) {
+        if constexpr (sizeof(T) == 1) {
+            ihist_hist8_2d(sample_bits, image, mask, height, width,
+                           image_stride, mask_stride, n_components,
+                           n_hist_components, component_indices, histogram,
+                           maybe_parallel);
+        } else {
+            ihist_hist16_2d(sample_bits, image, mask, height, width,
+                            image_stride, mask_stride, n_components,
+                            n_hist_components, component_indices, histogram,
+                            maybe_parallel);
+        }
+        return;
+    }
+
+    std::size_t const band_rows =
+        internal::fused_band_rows(width * n_components * sizeof(T));
+    std::size_t const band_size = band_rows * width;
+    internal::fused_band_params const p{
+        sample_bits,
+        internal::tuned_kernel_bits<T>(sample_bits),
+        n_hist_components + n_derived,
+        width,
+        band_rows,
+        std::min<std::size_t>(n_derived, 2) * band_size};
+    constexpr std::size_t plane_index = 0;
+
+    internal::fused_histogram_bands<T>(
+        p, height, histogram, nullptr, maybe_parallel,
+        [&](std::size_t y_begin, std::size_t y_end,
+            internal::band_state<T> &state) {
+            T *planes = state.scratch.data();
+            internal::for_each_band(p, y_begin, y_end, [&](std::size_t y0,
+                                                           std::size_t y1) {
+                std::size_t const rows = y1 - y0;
+                T const *band = image + y0 * image_stride * n_components;
+                std::uint8_t const *band_mask =
+                    mask == nullptr ? nullptr : mask + y0 * mask_stride;
+                if (n_hist_components > 0) {
+                    state.hist.add(band, band_mask, rows, width, image_stride,
+                                   mask_stride, n_components,
+                                   n_hist_components, component_indices);
+                }
+                for (std::size_t d = 0; d < n_derived; d += 2) {
+                    std::size_t const n = std::min<std::size_t>(
+                        n_derived - d, 2);
+                    with_layout(n_components, rgb_indices, [&](auto layout) {
+                        with_channel(derived[d], [&](auto f0) {
+                            if (n == 1) {
+                                derive_rows(layout, band, rows, width,
+                                            image_stride, band_size, planes,
+                                            f0);
+                                return;
+                            }
+                            with_channel(derived[d + 1], [&](auto f1) {
+                                derive_rows(layout, band, rows, width,
+                                            image_stride, band_size, planes,
+                                            f0, f1);
+                            });
+                        });
+                    });
+                    for (std::size_t i = 0; i < n; ++i) {
+                        state.hist.add(planes + i * band_size, band_mask,
+                                       rows, width, width, mask_stride, 1, 1,
+                                       &plane_index,
+                                       n_hist_components + d + i);
+                    }
+                }
+            });
+        });
+}
+
+} // namespace
+
+extern "C" IHIST_PUBLIC void ihist_hist8_2d_derived(
+    size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    size_t const *IHIST_RESTRICT rgb_indices, size_t n_derived,
+    ihist_derived_channel const *IHIST_RESTRICT derived,
+    uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel) {
+    hist_2d_derived(sample_bits, image, mask, height, width, image_stride,
+                    mask_stride, n_components, n_hist_components,
+                    component_indices, rgb_indices, n_derived, derived,
+                    histogram, maybe_parallel);
+}
+
+extern "C" IHIST_PUBLIC void ihist_hist16_2d_derived(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    size_t const *IHIST_RESTRICT rgb_indices, size_t n_derived,
+    ihist_derived_channel const *IHIST_RESTRICT derived,
+    uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel) {
+    hist_2d_derived(sample_bits, image, mask, height, width, image_stride,
+                    mask_stride, n_components, n_hist_components,
+                    component_indices, rgb_indices, n_derived, derived,
+                    histogram, maybe_parallel);
+}
@@ -0,0 +1,183 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include "fused_rows.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace {
+
+// Compute the difference of component ci of rows of pixels into a plane of
+// height x width samples of type U. With CheckRange, samples where either
+// frame is out of range get the value out_of_range, which is outside the
+// histogram.
+template <bool Signed, bool CheckRange, typename U, typename T>
+void difference_rows(T const *image, T const *previous, std::size_t height,
+                     std::size_t width, std::size_t image_stride,
+                     std::size_t n_components, std::size_t ci,
+                     std::size_t sample_bits, std::uint32_t out_of_range,
+                     U *out) {
+    std::uint32_t const bias = Signed ? std::uint32_t(1) << sample_bits : 0;
+    for (std::size_t y = 0; y < height; ++y) {
+        std::size_t const offset = y * image_stride * n_components + ci;
+        T const *row = image + offset;
+        T const *prev = previous + offset;
+        U *out_row = out + y * width;
+        for (std::size_t x = 0; x < width; ++x) {
+            std::size_t const i = x * n_components;
+            std::uint32_t const a = row[i];
+            std::uint32_t const b = prev[i];
+            std::uint32_t d = Signed ? a + bias - b : (a > b ? a - b : b - a);
+            if constexpr (CheckRange) {
+                d = (a | b) >> sample_bits ? out_of_range : d;
+            }
+            out_row[x] = static_cast<U>(d);
+        }
+    }
+}
+
+// The difference of each selected component is computed a band of rows at a
+// time into a scratch plane of U, wide enough for the difference (and the
+// out-of-range value), which is histogrammed with the tuned mono kernel while
+// it is in cache.
+template <typename U, typename T>
+void hist_2d_difference_bands(std::size_t sample_bits, std::size_t hist_bits,
+                              T const *image, T const *previous,
+                              std::uint8_t const *mask, std::size_t height,
+                              std::size_t width, std::size_t image_stride,
+                              std::size_t mask_stride,
+                              std::size_t n_components,
+                              std::size_t n_hist_components,
+                              std::size_t const *component_indices,
+                              bool is_signed, std::uint32_t *histogram,
+                              bool maybe_parallel) {
+    namespace internal = ihist::internal;
+    std::size_t const band_rows =
+        internal::fused_band_rows(width * n_components * sizeof(T));
+    internal::fused_band_params const p{
+        hist_bits,         internal::tuned_kernel_bits<U>(hist_bits),
+        n_hist_components, width,
+        band_rows,         band_rows * width};
+    bool const check_range = sample_bits < 8 * sizeof(T);
+    std::uint32_t const out_of_range = std::uint32_t(1) << hist_bits;
+    assert(!check_range || out_of_range <= std::numeric_limits<U>::max());
+    constexpr std::size_t plane_index = 0;
+
+    auto const difference = [&](auto... args) {
+        if (is_signed && check_range) {
+            difference_rows<true, true>(args...);
+        } else if (is_signed) {
+            difference_rows<true, false>(args...);
+        } else if (check_range) {
+            difference_rows<false, true>(args...);
+        } else {
+            difference_rows<false, false>(args...);
+        }
+    };
+
+    internal::fused_histogram_bands<U>(
+        p, height, histogram, nullptr, maybe_parallel,
+        [&](std::size_t y_begin, std::size_t y_end,
+            internal::band_state<U> &state) {
+            U *plane = state.scratch.data();
+            internal::for_each_band(p, y_begin, y_end, [&](std::size_t y0,
+                                                           std::size_t y1) {
+                std::size_t const rows = y1 - y0;
+                std::size_t const offset = y0 * image_stride * n_components;
+                std::uint8_t const *band_mask =
+                    mask == nullptr ? nullptr : mask + y0 * mask_stride;
+                for (std::size_t s = 0; s < n_hist_components; ++s) {
+                    difference(image + offset, previous + offset, rows, width,
+                               image_stride, n_components,
+                               component_indices[s], sample_bits,
+                               out_of_range, plane);
+                    state.hist.add(plane, band_mask, rows, width, width,
+                                   mask_stride, 1, 1, &plane_index, s);
+                }
+            });
+        });
+}
+
+template <typename T>
+void hist_2d_difference(std::size_t sample_bits, T const *image,
+                        T const *previous, std::uint8_t const *mask,
+                        std::size_t height, std::size_t width,
+                        std::size_t image_stride, std::size_t mask_stride,
+                        std::size_t n_components,
+                        std::size_t n_hist_components,
+                        std::size_t const *component_indices,
+                        ihist_difference_mode mode, std::uint32_t *histogram,
+                        bool maybe_parallel) {
+    assert(sample_bits <= 8 * sizeof(T));
+    assert(image != nullptr || height * width == 0);
+    assert(previous != nullptr || height * width == 0);
+    assert(width <= image_stride || height == 0);
+    assert(mask == nullptr || width <= mask_stride || height == 0);
+    assert(width * height < std::numeric_limits<std::uint32_t>::max());
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(std::all_of(component_indices,
+                       component_indices + n_hist_components,
+                       [&](std::size_t i) { return i < n_components; }));
+
+    bool const is_signed = mode == IHIST_DIFFERENCE_SIGNED;
+    std::size_t const hist_bits = is_signed ? sample_bits + 1 : sample_bits;
+
+    // The narrowest scratch type that holds the difference and, if samples
+    // can be out of range, the out-of-range value 2^hist_bits.
+    bool const check_range = sample_bits < 8 * sizeof(T);
+    std::size_t const scratch_bits = check_range ? hist_bits + 1 : hist_bits;
+    auto const hist_bands = [&](auto scratch_type) {
+        using U = decltype(scratch_type);
+        hist_2d_difference_bands<U>(sample_bits, hist_bits, image, previous,
+                                    mask, height, width, image_stride,
+                                    mask_stride, n_components,
+                                    n_hist_components, component_indices,
+                                    is_signed, histogram, maybe_parallel);
+    };
+    if (scratch_bits <= 8) {
+        hist_bands(std::uint8_t{});
+    } else if (scratch_bits <= 16) {
+        hist_bands(std::uint16_t{});
+    } else {
+        hist_bands(std::uint32_t{});
+    }
+}
+
+} // namespace
+
+extern "C" IHIST_PUBLIC void ihist_hist8_2d_difference(
+    size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT previous,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    ihist_difference_mode mode, uint32_t *IHIST_RESTRICT histogram,
+    bool maybe_parallel) {
+    hist_2d_difference(sample_bits, image, previous, mask, height, width,
+                       image_stride, mask_stride, n_components,
+                       n_hist_components, component_indices, mode, histogram,
+                       maybe_parallel);
+}
+
+extern "C" IHIST_PUBLIC void ihist_hist16_2d_difference(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint16_t const *IHIST_RESTRICT previous,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    ihist_difference_mode mode, uint32_t *IHIST_RESTRICT histogram,
+    bool maybe_parallel) {
+    hist_2d_difference(sample_bits, image, previous, mask, height, width,
+                       image_stride, mask_stride, n_components,
+                       n_hist_components, component_indices, mode, histogram,
+                       maybe_parallel);
+}
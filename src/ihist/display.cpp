@@ -0,0 +1,126 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include "fused_rows.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+extern "C" IHIST_PUBLIC void ihist_hist16_2d_lut8(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, uint8_t const *IHIST_RESTRICT lut,
+    uint8_t *IHIST_RESTRICT output, size_t output_stride,
+    bool maybe_parallel) {
+    assert(sample_bits <= 16);
+    assert(image != nullptr || height * width == 0);
+    assert(width <= image_stride || height == 0);
+    assert(mask == nullptr || width <= mask_stride || height == 0);
+    assert(width <= output_stride || height == 0);
+    assert(width * height < std::numeric_limits<std::uint32_t>::max());
+    assert(lut != nullptr);
+    assert(output != nullptr || height * width == 0);
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(std::all_of(component_indices,
+                       component_indices + n_hist_components,
+                       [&](std::size_t i) { return i < n_components; }));
+
+    namespace internal = ihist::internal;
+
+    // Extend the LUT to all 16-bit values, so that out-of-range samples are
+    // clamped without a comparison in the loop.
+    std::vector<std::uint8_t> extended_lut;
+    std::uint8_t const *full_lut = lut;
+    if (sample_bits < 16) {
+        std::size_t const lut_size = std::size_t(1) << sample_bits;
+        extended_lut.assign(std::size_t(1) << 16, lut[lut_size - 1]);
+        std::copy(lut, lut + lut_size, extended_lut.begin());
+        full_lut = extended_lut.data();
+    }
+
+    std::size_t const row_samples = width * n_components;
+    internal::fused_band_params const p{
+        sample_bits,
+        internal::tuned_kernel_bits<std::uint16_t>(sample_bits),
+        n_hist_components,
+        width,
+        internal::fused_band_rows(row_samples * sizeof(std::uint16_t)),
+        0};
+
+    // Each band is mapped through the LUT and then histogrammed from the
+    // original samples with the tuned kernels, while the band is still in
+    // cache.
+    internal::fused_histogram_bands<std::uint16_t>(
+        p, height, histogram, nullptr, maybe_parallel,
+        [&](std::size_t y_begin, std::size_t y_end,
+            internal::band_state<std::uint16_t> &state) {
+            internal::for_each_band(p, y_begin, y_end, [&](std::size_t y0,
+                                                           std::size_t y1) {
+                std::uint16_t const *band =
+                    image + y0 * image_stride * n_components;
+                std::uint8_t const *band_mask =
+                    mask == nullptr ? nullptr : mask + y0 * mask_stride;
+                for (std::size_t y = y0; y < y1; ++y) {
+                    std::uint16_t const *row =
+                        image + y * image_stride * n_components;
+                    std::uint8_t *out =
+                        output + y * output_stride * n_components;
+                    for (std::size_t i = 0; i < row_samples; ++i) {
+                        out[i] = full_lut[row[i]];
+                    }
+                }
+                if (n_hist_components > 0) {
+                    state.hist.add(band, band_mask, y1 - y0, width,
+                                   image_stride, mask_stride, n_components,
+                                   n_hist_components, component_indices);
+                }
+            });
+        });
+}
+
+extern "C" IHIST_PUBLIC void ihist_window_lut8(size_t sample_bits,
+                                               uint32_t low, uint32_t high,
+                                               uint8_t *IHIST_RESTRICT lut) {
+    assert(sample_bits <= 16);
+    assert(lut != nullptr);
+
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    for (std::size_t v = 0; v < n_bins; ++v) {
+        if (v <= low) {
+            lut[v] = 0;
+        } else if (v >= high) {
+            lut[v] = 255;
+        } else {
+            // Linear ramp, rounded to nearest.
+            std::uint64_t const range = high - low;
+            lut[v] = static_cast<std::uint8_t>(
+                ((v - low) * std::uint64_t(255) + range / 2) / range);
+        }
+    }
+}
+
+extern "C" IHIST_PUBLIC void
+ihist_auto_contrast_lut8(size_t sample_bits,
+                         uint32_t const *IHIST_RESTRICT histogram,
+                         double low_quantile, double high_quantile,
+                         uint8_t *IHIST_RESTRICT lut) {
+    assert(low_quantile >= 0.0 && low_quantile <= high_quantile &&
+           high_quantile <= 1.0);
+
+    double const quantiles[] = {low_quantile, high_quantile};
+    std::uint32_t limits[2];
+    ihist_histogram_quantiles(sample_bits, 1, histogram, 2, quantiles,
+                              limits);
+    ihist_window_lut8(sample_bits, limits[0], limits[1], lut);
+}
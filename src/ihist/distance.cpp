@@ -0,0 +1,273 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+#include "ihist/phys_core_count.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#ifdef IHIST_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+// Distances compare histograms normalized to unit sum, so that histograms of
+// differently sized images or masks are comparable. The query side is
+// converted to doubles once (in the form the metric needs), so that comparing
+// it against many references costs one pass over each reference's integer
+// bins, with no per-call conversion of the references.
+
+constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+auto total_count(std::size_t n_bins, std::uint32_t const *hist)
+    -> std::uint64_t {
+    return std::accumulate(hist, hist + n_bins, std::uint64_t(0));
+}
+
+// The query histogram of one component, prepared for a metric: the
+// normalized bins for chi-square, intersection, and KL; their square roots for
+// Bhattacharyya; and the normalized cumulative sums for EMD. Empty if the
+// histogram is empty.
+auto prepare_query(ihist_distance_metric metric, std::size_t n_bins,
+                   std::uint32_t const *hist) -> std::vector<double> {
+    auto const count = total_count(n_bins, hist);
+    if (count == 0) {
+        return {};
+    }
+    double const inv = 1.0 / static_cast<double>(count);
+    std::vector<double> prepared(n_bins);
+    std::uint64_t cumsum = 0;
+    for (std::size_t bin = 0; bin < n_bins; ++bin) {
+        double const p = hist[bin] * inv;
+        switch (metric) {
+        case IHIST_DISTANCE_BHATTACHARYYA:
+            prepared[bin] = std::sqrt(p);
+            break;
+        case IHIST_DISTANCE_EMD:
+            cumsum += hist[bin];
+            prepared[bin] = static_cast<double>(cumsum) * inv;
+            break;
+        default:
+            prepared[bin] = p;
+            break;
+        }
+    }
+    return prepared;
+}
+
+// Sum of term(bin) over the bins, accumulated in independent partial sums.
+// Floating-point addition is not associative, so the compiler cannot split a
+// single running sum itself; with the partial sums, the block loop vectorizes
+// (as long as term is branch-free and makes no library calls) and, where it
+// does not, still overlaps the additions. term must capture by value, so that
+// the compiler sees the pointers it reads through as loop-invariant locals.
+template <typename Term>
+auto sum_bins(std::size_t n_bins, Term term) -> double {
+    constexpr std::size_t n_partial = 4;
+    double partial[n_partial] = {};
+    std::size_t bin = 0;
+    for (; bin + n_partial <= n_bins; bin += n_partial) {
+        for (std::size_t j = 0; j < n_partial; ++j) {
+            partial[j] += term(bin + j);
+        }
+    }
+    double sum = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+    for (; bin < n_bins; ++bin) {
+        sum += term(bin);
+    }
+    return sum;
+}
+
+auto chi_square(std::size_t n_bins, double const *p, std::uint32_t const *ref,
+                double inv) -> double {
+    // p + q is 0 only where both are (and so is p - q); dividing by the
+    // smallest normal then gives 0 without a branch. Nonzero p + q is never
+    // below it, since both are multiples of a reciprocal 64-bit count.
+    constexpr double tiny = std::numeric_limits<double>::min();
+    return sum_bins(n_bins, [=](std::size_t bin) {
+        double const q = ref[bin] * inv;
+        double const d = p[bin] - q;
+        double const s = p[bin] + q;
+        return d * d / (s > tiny ? s : tiny);
+    });
+}
+
+auto bhattacharyya(std::size_t n_bins, double const *sqrt_p,
+                   std::uint32_t const *ref, double inv) -> double {
+    double bc = 0.0;
+    std::size_t bin = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+    // std::sqrt() may set errno, which keeps the compiler from vectorizing
+    // it; the SSE2 square root does not.
+    __m128d const inv2 = _mm_set1_pd(inv);
+    __m128d bc2 = _mm_setzero_pd();
+    for (; bin + 2 <= n_bins; bin += 2) {
+        __m128d const q = _mm_mul_pd(
+            _mm_set_pd(ref[bin + 1], ref[bin]), inv2);
+        bc2 = _mm_add_pd(bc2, _mm_mul_pd(_mm_loadu_pd(sqrt_p + bin),
+                                         _mm_sqrt_pd(q)));
+    }
+    double halves[2];
+    _mm_storeu_pd(halves, bc2);
+    bc = halves[0] + halves[1];
+#endif
+    for (; bin < n_bins; ++bin) {
+        bc += sqrt_p[bin] * std::sqrt(ref[bin] * inv);
+    }
+    return std::sqrt(std::max(0.0, 1.0 - bc));
+}
+
+auto intersection(std::size_t n_bins, double const *p,
+                  std::uint32_t const *ref, double inv) -> double {
+    double const sum = sum_bins(n_bins, [=](std::size_t bin) {
+        double const q = ref[bin] * inv;
+        return p[bin] < q ? p[bin] : q;
+    });
+    return std::max(0.0, 1.0 - sum);
+}
+
+// EMD and KL stay scalar: the running sum of reference counts is a serial
+// scan, and the logarithm is a library call. EMD still uses partial sums so
+// that its additions overlap.
+
+auto emd(std::size_t n_bins, double const *cdf_p, std::uint32_t const *ref,
+         double inv) -> double {
+    std::uint64_t cumsum = 0;
+    return sum_bins(n_bins, [=](std::size_t bin) mutable {
+        cumsum += ref[bin];
+        return std::abs(cdf_p[bin] - static_cast<double>(cumsum) * inv);
+    });
+}
+
+auto kl_divergence(std::size_t n_bins, double const *p,
+                   std::uint32_t const *ref, double inv) -> double {
+    double sum = 0.0;
+    for (std::size_t bin = 0; bin < n_bins; ++bin) {
+        if (p[bin] > 0.0) {
+            if (ref[bin] == 0) {
+                return std::numeric_limits<double>::infinity();
+            }
+            sum += p[bin] * std::log2(p[bin] / (ref[bin] * inv));
+        }
+    }
+    return std::max(0.0, sum);
+}
+
+auto component_distance(ihist_distance_metric metric, std::size_t n_bins,
+                        std::vector<double> const &prepared,
+                        std::uint32_t const *ref) -> double {
+    if (prepared.empty()) {
+        return nan;
+    }
+    auto const count = total_count(n_bins, ref);
+    if (count == 0) {
+        return nan;
+    }
+    double const inv = 1.0 / static_cast<double>(count);
+    double const *p = prepared.data();
+    switch (metric) {
+    case IHIST_DISTANCE_CHI_SQUARE:
+        return chi_square(n_bins, p, ref, inv);
+    case IHIST_DISTANCE_BHATTACHARYYA:
+        return bhattacharyya(n_bins, p, ref, inv);
+    case IHIST_DISTANCE_INTERSECTION:
+        return intersection(n_bins, p, ref, inv);
+    case IHIST_DISTANCE_EMD:
+        return emd(n_bins, p, ref, inv);
+    case IHIST_DISTANCE_KL_DIVERGENCE:
+        return kl_divergence(n_bins, p, ref, inv);
+    }
+    assert(false);
+    return nan;
+}
+
+auto prepare_queries(ihist_distance_metric metric, std::size_t n_bins,
+                     std::size_t n_hist_components,
+                     std::uint32_t const *query)
+    -> std::vector<std::vector<double>> {
+    std::vector<std::vector<double>> prepared(n_hist_components);
+    for (std::size_t i = 0; i < n_hist_components; ++i) {
+        prepared[i] = prepare_query(metric, n_bins, query + i * n_bins);
+    }
+    return prepared;
+}
+
+} // namespace
+
+extern "C" IHIST_PUBLIC void
+ihist_histogram_distance(size_t sample_bits, size_t n_hist_components,
+                         uint32_t const *IHIST_RESTRICT histogram_a,
+                         uint32_t const *IHIST_RESTRICT histogram_b,
+                         ihist_distance_metric metric,
+                         double *IHIST_RESTRICT distances) {
+    ihist_histogram_distance_batch(sample_bits, n_hist_components,
+                                   histogram_a, 1, histogram_b, metric,
+                                   distances, false);
+}
+
+extern "C" IHIST_PUBLIC void ihist_histogram_distance_batch(
+    size_t sample_bits, size_t n_hist_components,
+    uint32_t const *IHIST_RESTRICT query, size_t n_references,
+    uint32_t const *IHIST_RESTRICT references, ihist_distance_metric metric,
+    double *IHIST_RESTRICT distances, bool maybe_parallel) {
+    assert(sample_bits <= 16);
+    assert(query != nullptr || n_hist_components == 0);
+    assert(references != nullptr || n_hist_components * n_references == 0);
+    assert(distances != nullptr || n_hist_components * n_references == 0);
+
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    auto const prepared =
+        prepare_queries(metric, n_bins, n_hist_components, query);
+    std::size_t const ref_size = n_hist_components * n_bins;
+
+    auto const compare = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            for (std::size_t i = 0; i < n_hist_components; ++i) {
+                distances[r * n_hist_components + i] = component_distance(
+                    metric, n_bins, prepared[i],
+                    references + r * ref_size + i * n_bins);
+            }
+        }
+    };
+
+#ifdef IHIST_USE_TBB
+    // Each reference is independent; parallelize only when there is enough
+    // work to amortize the scheduling.
+    if (maybe_parallel && n_references > 1 &&
+        n_references * ref_size >= (std::size_t(1) << 20)) {
+        std::size_t const grain_size =
+            std::max<std::size_t>(1, (std::size_t(1) << 16) / ref_size);
+        // Stay within the library-wide thread budget of one per physical core,
+        // like every other parallel call.
+        auto arena = ihist::internal::phys_core_arena();
+        arena.execute([&] {
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(0, n_references, grain_size),
+                [&](tbb::blocked_range<std::size_t> const &range) {
+                    compare(range.begin(), range.end());
+                });
+        });
+        return;
+    }
+#else
+    (void)maybe_parallel;
+#endif
+    compare(0, n_references);
+}
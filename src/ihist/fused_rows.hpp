@@ -0,0 +1,242 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include "ihist/ihist.h"
+#include "ihist/phys_core_count.hpp"
+
+#ifdef IHIST_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/combinable.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+namespace ihist::internal {
+
+// Support for histogramming that is fused with another operation (applying a
+// LUT, computing derived or corrected samples, copying, etc.). The image is
+// processed in bands of rows small enough to stay in cache: each band is
+// transformed (into a per-thread scratch buffer if needed) and then
+// histogrammed with the same tuned kernels as the plain histogram functions,
+// so the source is read from memory only once. The kernels accumulate into
+// per-thread histograms at kernel resolution, which are reduced into the
+// caller's histogram once at the end rather than once per band.
+
+// Same values as for the plain histogram functions (see ihist.cpp); the
+// per-thread reduction here is also proportional to the bin count.
+constexpr std::size_t fused_parallel_size_threshold = 1uLL << 20;
+constexpr std::size_t fused_parallel_grain_size = 1uLL << 20;
+
+// Histogram with the tuned kernels of ihist_hist8_2d() and ihist_hist16_2d(),
+// single-threaded, accumulating into a histogram of n_hist_components <<
+// kernel_bits bins; samples with higher bits set are added to overflow (if not
+// null). kernel_bits must be tuned_kernel_bits<T>() for some sample bits.
+// Defined in ihist.cpp.
+void tuned_hist_2d(std::size_t kernel_bits,
+                   std::uint8_t const *IHIST_RESTRICT image,
+                   std::uint8_t const *IHIST_RESTRICT mask, std::size_t height,
+                   std::size_t width, std::size_t image_stride,
+                   std::size_t mask_stride, std::size_t n_components,
+                   std::size_t n_hist_components,
+                   std::size_t const *IHIST_RESTRICT component_indices,
+                   std::uint32_t *IHIST_RESTRICT histogram,
+                   std::uint32_t *IHIST_RESTRICT overflow);
+void tuned_hist_2d(std::size_t kernel_bits,
+                   std::uint16_t const *IHIST_RESTRICT image,
+                   std::uint8_t const *IHIST_RESTRICT mask, std::size_t height,
+                   std::size_t width, std::size_t image_stride,
+                   std::size_t mask_stride, std::size_t n_components,
+                   std::size_t n_hist_components,
+                   std::size_t const *IHIST_RESTRICT component_indices,
+                   std::uint32_t *IHIST_RESTRICT histogram,
+                   std::uint32_t *IHIST_RESTRICT overflow);
+void tuned_hist_2d(std::size_t kernel_bits,
+                   std::uint32_t const *IHIST_RESTRICT image,
+                   std::uint8_t const *IHIST_RESTRICT mask, std::size_t height,
+                   std::size_t width, std::size_t image_stride,
+                   std::size_t mask_stride, std::size_t n_components,
+                   std::size_t n_hist_components,
+                   std::size_t const *IHIST_RESTRICT component_indices,
+                   std::uint32_t *IHIST_RESTRICT histogram,
+                   std::uint32_t *IHIST_RESTRICT overflow);
+
+// The bin count of the kernel that tuned_hist_2d() uses for samples of
+// sample_bits (as in ihist_hist16_2d(), 12-bit and narrower 16-bit samples
+// share the 12-bit kernel). 32-bit samples are only supported as mono, 17-bit.
+template <typename T>
+constexpr auto tuned_kernel_bits(std::size_t sample_bits) -> std::size_t {
+    if constexpr (sizeof(T) == 1) {
+        (void)sample_bits;
+        return 8;
+    } else if constexpr (sizeof(T) == 2) {
+        return sample_bits <= 12 ? 12 : 16;
+    } else {
+        (void)sample_bits;
+        return 17;
+    }
+}
+
+// Per-thread histogram of the fused operations. It is kept at kernel
+// resolution, with per-component overflow counts, so that it can be fed any
+// number of bands and reduced into the caller's histogram once at the end.
+class band_histogram {
+  public:
+    band_histogram(std::size_t kernel_bits, std::size_t n_hist_components)
+        : kernel_bits_(kernel_bits), n_hist_components_(n_hist_components),
+          counts_((n_hist_components << kernel_bits) + n_hist_components) {}
+
+    [[nodiscard]] auto kernel_bits() const -> std::size_t {
+        return kernel_bits_;
+    }
+
+    // The 2^kernel_bits bins of component c.
+    [[nodiscard]] auto bins(std::size_t c) -> std::uint32_t * {
+        return counts_.data() + (c << kernel_bits_);
+    }
+
+    // The count of samples of component c that were out of range for the
+    // kernel.
+    [[nodiscard]] auto overflow(std::size_t c) -> std::uint32_t * {
+        return counts_.data() + (n_hist_components_ << kernel_bits_) + c;
+    }
+
+    // Histogram the given rows with the tuned kernels into components
+    // [first, first + n_hist_components).
+    template <typename T>
+    void add(T const *image, std::uint8_t const *mask, std::size_t height,
+             std::size_t width, std::size_t image_stride,
+             std::size_t mask_stride, std::size_t n_components,
+             std::size_t n_hist_components,
+             std::size_t const *component_indices, std::size_t first = 0) {
+        assert(first + n_hist_components <= n_hist_components_);
+        tuned_hist_2d(kernel_bits_, image, mask, height, width, image_stride,
+                      mask_stride, n_components, n_hist_components,
+                      component_indices, bins(first), overflow(first));
+    }
+
+    // Add the counts to a histogram of sample_bits (and bins beyond it to
+    // overflow, if not null), then reset.
+    void reduce(std::size_t sample_bits, std::uint32_t *histogram,
+                std::uint32_t *overflow_out) {
+        std::size_t const n_bins = std::size_t(1) << sample_bits;
+        std::size_t const n_kernel_bins = std::size_t(1) << kernel_bits_;
+        std::size_t const n_in_range = std::min(n_bins, n_kernel_bins);
+        for (std::size_t c = 0; c < n_hist_components_; ++c) {
+            std::uint32_t const *src = bins(c);
+            std::uint32_t *dst = histogram + c * n_bins;
+            std::transform(src, src + n_in_range, dst, dst, std::plus{});
+            if (overflow_out != nullptr) {
+                overflow_out[c] += std::accumulate(
+                    src + n_in_range, src + n_kernel_bins, *overflow(c));
+            }
+        }
+        std::fill(counts_.begin(), counts_.end(), 0);
+    }
+
+  private:
+    std::size_t kernel_bits_;
+    std::size_t n_hist_components_;
+    std::vector<std::uint32_t> counts_;
+};
+
+// Size of the bands in which the fused operations produce (or read) samples
+// and histogram them: small enough that the band is still in L2 cache when
+// the kernel reads it, but large enough that the kernel's per-call stripe
+// reduction is negligible.
+constexpr std::size_t fused_band_bytes = std::size_t(256) << 10;
+
+inline auto fused_band_rows(std::size_t row_bytes) -> std::size_t {
+    return std::max(std::size_t(1),
+                    fused_band_bytes / std::max(std::size_t(1), row_bytes));
+}
+
+struct fused_band_params {
+    std::size_t sample_bits; // Of the caller's histogram
+    std::size_t kernel_bits; // Of the per-thread band_histogram
+    std::size_t n_hist_components;
+    std::size_t width;
+    std::size_t band_rows;
+    std::size_t scratch_size; // Per-thread scratch elements for the tasks
+};
+
+template <typename S> struct band_state {
+    band_histogram hist;
+    std::vector<S> scratch;
+
+    explicit band_state(fused_band_params const &p)
+        : hist(p.kernel_bits, p.n_hist_components), scratch(p.scratch_size) {}
+};
+
+// Call fn(y_begin, y_end) for the bands of p.band_rows rows in [y_begin,
+// y_end).
+template <typename Fn>
+void for_each_band(fused_band_params const &p, std::size_t y_begin,
+                   std::size_t y_end, Fn fn) {
+    for (std::size_t y = y_begin; y < y_end; y += p.band_rows) {
+        fn(y, std::min(y_end, y + p.band_rows));
+    }
+}
+
+// Driver for histogramming fused with another operation (applying a LUT,
+// computing derived or corrected samples, copying, etc.). task_fn(y_begin,
+// y_end, state) processes rows [y_begin, y_end), band by band (see
+// for_each_band()), histogramming into state.hist; the ranges are multiples
+// of p.band_rows, and cover [0, height) once. Ranges are processed
+// concurrently (each thread with its own state) if maybe_parallel and the
+// image is large. The states are then reduced into histogram and overflow
+// (which may be null).
+template <typename S, typename TaskFn>
+void fused_histogram_bands(fused_band_params const &p, std::size_t height,
+                           std::uint32_t *histogram, std::uint32_t *overflow,
+                           bool maybe_parallel, TaskFn task_fn) {
+    if (height == 0 || p.width == 0) {
+        return;
+    }
+
+#ifdef IHIST_USE_TBB
+    if (maybe_parallel && p.width * height >= fused_parallel_size_threshold) {
+        tbb::combinable<band_state<S>> local_states(
+            [&p] { return band_state<S>(p); });
+        std::size_t const n_bands = (height + p.band_rows - 1) / p.band_rows;
+        std::size_t const grain_bands = std::max(
+            std::size_t(1),
+            fused_parallel_grain_size / (p.band_rows * p.width));
+
+        auto arena = phys_core_arena();
+        arena.execute([&] {
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(0, n_bands, grain_bands),
+                [&](tbb::blocked_range<std::size_t> const &r) {
+                    task_fn(r.begin() * p.band_rows,
+                            std::min(height, r.end() * p.band_rows),
+                            local_states.local());
+                });
+        });
+        local_states.combine_each([&](band_state<S> &s) {
+            s.hist.reduce(p.sample_bits, histogram, overflow);
+        });
+        return;
+    }
+#else
+    (void)maybe_parallel;
+#endif
+
+    band_state<S> state(p);
+    task_fn(0, height, state);
+    state.hist.reduce(p.sample_bits, histogram, overflow);
+}
+
+} // namespace ihist::internal
@@ -6,7 +6,8 @@
 
 #include "ihist/ihist.h"
 
-#include "ihist.hpp"
+#include "fused_rows.hpp"
+#include "ihist/ihist.hpp"
 
 #include <algorithm>
 #include <cstddef>
@@ -113,6 +114,24 @@ void copy_hist_from_higher_bits(
     }
 }
 
+// Samples that land in the buffer bins beyond 2^sample_bits are out of range
+// for the caller's histogram; count them as overflow.
+template <std::size_t Bits>
+void add_truncated_bins_to_overflow(std::size_t sample_bits,
+                                    std::size_t n_hist_components,
+                                    std::vector<std::uint32_t> const &hist,
+                                    std::uint32_t *overflow) {
+    for (std::size_t i = 0; i < n_hist_components; ++i) {
+        auto const first = std::next(hist.begin(), i << Bits);
+        std::uint32_t sum = 0;
+        for (auto it = std::next(first, std::size_t(1) << sample_bits);
+             it != std::next(first, std::size_t(1) << Bits); ++it) {
+            sum += *it;
+        }
+        overflow[i] += sum;
+    }
+}
+
 template <typename T, std::size_t Bits>
 auto hist_buffer_of_higher_bits_dynamic(std::size_t sample_bits,
                                         std::size_t n_hist_components,
@@ -139,6 +158,7 @@ void hist_2d_impl(std::size_t sample_bits, T const *IHIST_RESTRICT image,
                   std::size_t width, std::size_t image_stride,
                   std::size_t mask_stride,
                   std::uint32_t *IHIST_RESTRICT histogram,
+                  std::uint32_t *IHIST_RESTRICT overflow,
                   bool maybe_parallel) {
     assert(sample_bits <= Bits);
     assert(image != nullptr);
@@ -154,33 +174,29 @@ void hist_2d_impl(std::size_t sample_bits, T const *IHIST_RESTRICT image,
         hist = buffer.data();
     }
 
-    if (maybe_parallel && width * height >= parallel_size_threshold) {
-        if (mask != nullptr) {
-            ihist::histxy_striped_mt<MaskedTuning, T, true, Bits, 0,
-                                     SamplesPerPixel, SampleIndices...>(
-                image, mask, height, width, image_stride, mask_stride, hist,
-                parallel_grain_size);
-        } else {
-            ihist::histxy_striped_mt<NomaskTuning, T, false, Bits, 0,
-                                     SamplesPerPixel, SampleIndices...>(
-                image, mask, height, width, image_stride, mask_stride, hist,
-                parallel_grain_size);
-        }
+    bool const mt =
+        maybe_parallel && width * height >= parallel_size_threshold;
+    if (mask != nullptr) {
+        ihist::internal::histxy_striped_maybe_mt<MaskedTuning, T, true, Bits,
+                                                 0, SamplesPerPixel,
+                                                 SampleIndices...>(
+            image, mask, height, width, image_stride, mask_stride, hist,
+            overflow, mt, parallel_grain_size);
     } else {
-        if (mask != nullptr) {
-            ihist::histxy_striped_st<MaskedTuning, T, true, Bits, 0,
-                                     SamplesPerPixel, SampleIndices...>(
-                image, mask, height, width, image_stride, mask_stride, hist);
-        } else {
-            ihist::histxy_striped_st<NomaskTuning, T, false, Bits, 0,
-                                     SamplesPerPixel, SampleIndices...>(
-                image, mask, height, width, image_stride, mask_stride, hist);
-        }
+        ihist::internal::histxy_striped_maybe_mt<NomaskTuning, T, false, Bits,
+                                                 0, SamplesPerPixel,
+                                                 SampleIndices...>(
+            image, mask, height, width, image_stride, mask_stride, hist,
+            overflow, mt, parallel_grain_size);
     }
 
     if (sample_bits < Bits) {
         copy_hist_from_higher_bits<T, Bits, sizeof...(SampleIndices)>(
             sample_bits, histogram, buffer);
+        if (overflow != nullptr) {
+            add_truncated_bins_to_overflow<Bits>(
+                sample_bits, sizeof...(SampleIndices), buffer, overflow);
+        }
     }
 }
 
@@ -192,6 +208,7 @@ void hist_2d_dynamic(std::size_t sample_bits, T const *IHIST_RESTRICT image,
                      std::size_t n_components, std::size_t n_hist_components,
                      std::size_t const *IHIST_RESTRICT component_indices,
                      std::uint32_t *IHIST_RESTRICT histogram,
+                     std::uint32_t *IHIST_RESTRICT overflow,
                      bool maybe_parallel) {
     assert(sample_bits <= Bits);
     assert(image != nullptr);
@@ -214,28 +231,34 @@ void hist_2d_dynamic(std::size_t sample_bits, T const *IHIST_RESTRICT image,
             ihist::histxy_dynamic_mt<T, true, Bits, 0>(
                 image, mask, height, width, image_stride, mask_stride,
                 n_components, n_hist_components, component_indices, hist,
-                parallel_grain_size);
+                parallel_grain_size, overflow);
         } else {
             ihist::histxy_dynamic_mt<T, false, Bits, 0>(
                 image, mask, height, width, image_stride, mask_stride,
                 n_components, n_hist_components, component_indices, hist,
-                parallel_grain_size);
+                parallel_grain_size, overflow);
         }
     } else {
         if (mask != nullptr) {
             ihist::histxy_dynamic_st<T, true, Bits, 0>(
                 image, mask, height, width, image_stride, mask_stride,
-                n_components, n_hist_components, component_indices, hist);
+                n_components, n_hist_components, component_indices, hist,
+                overflow);
         } else {
             ihist::histxy_dynamic_st<T, false, Bits, 0>(
                 image, mask, height, width, image_stride, mask_stride,
-                n_components, n_hist_components, component_indices, hist);
+                n_components, n_hist_components, component_indices, hist,
+                overflow);
         }
     }
 
     if (sample_bits < Bits) {
         copy_hist_from_higher_bits_dynamic<T, Bits>(
             sample_bits, n_hist_components, histogram, buffer);
+        if (overflow != nullptr) {
+            add_truncated_bins_to_overflow<Bits>(
+                sample_bits, n_hist_components, buffer, overflow);
+        }
     }
 }
 
@@ -268,53 +291,120 @@ void dispatch_common_pixel_formats(
     std::size_t width, std::size_t image_stride, std::size_t mask_stride,
     std::size_t n_components, std::size_t n_hist_components,
     std::size_t const *IHIST_RESTRICT component_indices,
-    std::uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel) {
+    std::uint32_t *IHIST_RESTRICT histogram,
+    std::uint32_t *IHIST_RESTRICT overflow, bool maybe_parallel) {
 
     if (n_components == 1 && n_hist_components == 1 &&
         component_indices[0] == 0) {
         // Mono: optimized path
         hist_2d_impl<T, Bits, MonoMask0, MonoMask1, 1, 0>(
             sample_bits, image, mask, height, width, image_stride, mask_stride,
-            histogram, maybe_parallel);
+            histogram, overflow, maybe_parallel);
     } else if (n_components == 3 && n_hist_components == 3 &&
                indices_match(n_hist_components, component_indices,
                              {0, 1, 2})) {
         // RGB: optimized path
         hist_2d_impl<T, Bits, AbcMask0, AbcMask1, 3, 0, 1, 2>(
             sample_bits, image, mask, height, width, image_stride, mask_stride,
-            histogram, maybe_parallel);
+            histogram, overflow, maybe_parallel);
     } else if (n_components == 4 && n_hist_components == 3 &&
                indices_match(n_hist_components, component_indices,
                              {0, 1, 2})) {
         // RGBA (skip last): optimized path
         hist_2d_impl<T, Bits, AbcxMask0, AbcxMask1, 4, 0, 1, 2>(
             sample_bits, image, mask, height, width, image_stride, mask_stride,
-            histogram, maybe_parallel);
+            histogram, overflow, maybe_parallel);
     } else if (n_components == 4 && n_hist_components == 3 &&
                indices_match(n_hist_components, component_indices,
                              {1, 2, 3})) {
         // ARGB (skip first): optimized path
         hist_2d_impl<T, Bits, XabcMask0, XabcMask1, 4, 1, 2, 3>(
             sample_bits, image, mask, height, width, image_stride, mask_stride,
-            histogram, maybe_parallel);
+            histogram, overflow, maybe_parallel);
     } else {
         // General case: dynamic implementation
         hist_2d_dynamic<T, Bits>(sample_bits, image, mask, height, width,
                                  image_stride, mask_stride, n_components,
                                  n_hist_components, component_indices,
-                                 histogram, maybe_parallel);
+                                 histogram, overflow, maybe_parallel);
     }
 }
 
 } // namespace
 
+namespace ihist::internal {
+
+void tuned_hist_2d(std::size_t kernel_bits,
+                   std::uint8_t const *IHIST_RESTRICT image,
+                   std::uint8_t const *IHIST_RESTRICT mask, std::size_t height,
+                   std::size_t width, std::size_t image_stride,
+                   std::size_t mask_stride, std::size_t n_components,
+                   std::size_t n_hist_components,
+                   std::size_t const *IHIST_RESTRICT component_indices,
+                   std::uint32_t *IHIST_RESTRICT histogram,
+                   std::uint32_t *IHIST_RESTRICT overflow) {
+    assert(kernel_bits == 8);
+    ihist_hist8_2d_overflow(kernel_bits, image, mask, height, width,
+                            image_stride, mask_stride, n_components,
+                            n_hist_components, component_indices, histogram,
+                            overflow, false);
+}
+
+void tuned_hist_2d(std::size_t kernel_bits,
+                   std::uint16_t const *IHIST_RESTRICT image,
+                   std::uint8_t const *IHIST_RESTRICT mask, std::size_t height,
+                   std::size_t width, std::size_t image_stride,
+                   std::size_t mask_stride, std::size_t n_components,
+                   std::size_t n_hist_components,
+                   std::size_t const *IHIST_RESTRICT component_indices,
+                   std::uint32_t *IHIST_RESTRICT histogram,
+                   std::uint32_t *IHIST_RESTRICT overflow) {
+    assert(kernel_bits == 12 || kernel_bits == 16);
+    ihist_hist16_2d_overflow(kernel_bits, image, mask, height, width,
+                             image_stride, mask_stride, n_components,
+                             n_hist_components, component_indices, histogram,
+                             overflow, false);
+}
+
+void tuned_hist_2d(std::size_t kernel_bits,
+                   std::uint32_t const *IHIST_RESTRICT image,
+                   std::uint8_t const *IHIST_RESTRICT mask, std::size_t height,
+                   std::size_t width, std::size_t image_stride,
+                   std::size_t mask_stride, std::size_t n_components,
+                   std::size_t n_hist_components,
+                   std::size_t const *IHIST_RESTRICT component_indices,
+                   std::uint32_t *IHIST_RESTRICT histogram,
+                   std::uint32_t *IHIST_RESTRICT overflow) {
+    // Only needed for 17-bit signed differences of 16-bit samples, so mono
+    // only, reusing the 16-bit mono tuning.
+    assert(kernel_bits == 17);
+    assert(n_components == 1 && n_hist_components == 1);
+    assert(component_indices[0] == 0);
+    (void)kernel_bits;
+    (void)n_components;
+    (void)n_hist_components;
+    (void)component_indices;
+    if (mask != nullptr) {
+        histxy_striped<tuning_16bit_mono_mask1, std::uint32_t, true, 17, 0, 1,
+                       0>(image, mask, height, width, image_stride,
+                          mask_stride, histogram, overflow);
+    } else {
+        histxy_striped<tuning_16bit_mono_mask0, std::uint32_t, false, 17, 0,
+                       1, 0>(image, mask, height, width, image_stride,
+                             mask_stride, histogram, overflow);
+    }
+}
+
+} // namespace ihist::internal
+
 extern "C" IHIST_PUBLIC void
-ihist_hist8_2d(size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
-               uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
-               size_t image_stride, size_t mask_stride, size_t n_components,
-               size_t n_hist_components,
-               size_t const *IHIST_RESTRICT component_indices,
-               uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel) {
+ihist_hist8_2d_overflow(
+    size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, uint32_t *IHIST_RESTRICT overflow,
+    bool maybe_parallel) {
 
     dispatch_common_pixel_formats<
         std::uint8_t, 8, tuning_8bit_mono_mask0, tuning_8bit_mono_mask1,
@@ -323,16 +413,17 @@ ihist_hist8_2d(size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
         tuning_8bit_xabc_mask1>(sample_bits, image, mask, height, width,
                                 image_stride, mask_stride, n_components,
                                 n_hist_components, component_indices,
-                                histogram, maybe_parallel);
+                                histogram, overflow, maybe_parallel);
 }
 
 extern "C" IHIST_PUBLIC void
-ihist_hist16_2d(size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
-                uint8_t const *IHIST_RESTRICT mask, size_t height,
-                size_t width, size_t image_stride, size_t mask_stride,
-                size_t n_components, size_t n_hist_components,
-                size_t const *IHIST_RESTRICT component_indices,
-                uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel) {
+ihist_hist16_2d_overflow(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, uint32_t *IHIST_RESTRICT overflow,
+    bool maybe_parallel) {
 
     // For 16-bit, use 12-bit path for sample_bits <= 12, otherwise 16-bit
     if (sample_bits <= 12) {
@@ -344,7 +435,7 @@ ihist_hist16_2d(size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
             tuning_12bit_xabc_mask1>(sample_bits, image, mask, height, width,
                                      image_stride, mask_stride, n_components,
                                      n_hist_components, component_indices,
-                                     histogram, maybe_parallel);
+                                     histogram, overflow, maybe_parallel);
     } else {
         dispatch_common_pixel_formats<
             std::uint16_t, 16, tuning_16bit_mono_mask0,
@@ -354,6 +445,32 @@ ihist_hist16_2d(size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
             tuning_16bit_xabc_mask1>(sample_bits, image, mask, height, width,
                                      image_stride, mask_stride, n_components,
                                      n_hist_components, component_indices,
-                                     histogram, maybe_parallel);
+                                     histogram, overflow, maybe_parallel);
     }
 }
+
+extern "C" IHIST_PUBLIC void
+ihist_hist8_2d(size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+               uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+               size_t image_stride, size_t mask_stride, size_t n_components,
+               size_t n_hist_components,
+               size_t const *IHIST_RESTRICT component_indices,
+               uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel) {
+    ihist_hist8_2d_overflow(sample_bits, image, mask, height, width,
+                            image_stride, mask_stride, n_components,
+                            n_hist_components, component_indices, histogram,
+                            nullptr, maybe_parallel);
+}
+
+extern "C" IHIST_PUBLIC void
+ihist_hist16_2d(size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+                uint8_t const *IHIST_RESTRICT mask, size_t height,
+                size_t width, size_t image_stride, size_t mask_stride,
+                size_t n_components, size_t n_hist_components,
+                size_t const *IHIST_RESTRICT component_indices,
+                uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel) {
+    ihist_hist16_2d_overflow(sample_bits, image, mask, height, width,
+                             image_stride, mask_stride, n_components,
+                             n_hist_components, component_indices, histogram,
+                             nullptr, maybe_parallel);
+}
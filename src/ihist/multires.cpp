@@ -0,0 +1,105 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+// Coarse levels are derived from the full-resolution histogram rather than
+// counted separately: summing adjacent bins costs O(bins), which is far less
+// than any per-pixel work for images larger than the bin count, and leaves
+// the tuned kernels untouched.
+
+void rebin(std::size_t fine_bits, std::size_t n_hist_components,
+           std::uint32_t const *fine, std::size_t coarse_bits,
+           std::uint32_t *coarse) {
+    std::size_t const n_fine = std::size_t(1) << fine_bits;
+    std::size_t const n_coarse = std::size_t(1) << coarse_bits;
+    std::size_t const factor = n_fine / n_coarse;
+    for (std::size_t i = 0; i < n_hist_components; ++i) {
+        std::uint32_t const *src = fine + i * n_fine;
+        std::uint32_t *dst = coarse + i * n_coarse;
+        for (std::size_t bin = 0; bin < n_coarse; ++bin) {
+            dst[bin] = std::accumulate(src + bin * factor,
+                                       src + (bin + 1) * factor,
+                                       std::uint32_t(0));
+        }
+    }
+}
+
+// Fill the levels from finest to coarsest, deriving each from the previous
+// (finer) one so that the total work is dominated by the first reduction.
+void fill_levels(std::size_t sample_bits, std::size_t n_hist_components,
+                 std::uint32_t const *histogram, std::size_t n_levels,
+                 std::size_t const *level_bits,
+                 std::uint32_t *const *level_histograms) {
+    std::vector<std::size_t> order(n_levels);
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return level_bits[a] > level_bits[b];
+    });
+
+    std::size_t src_bits = sample_bits;
+    std::uint32_t const *src = histogram;
+    for (std::size_t const lv : order) {
+        assert(level_bits[lv] <= sample_bits);
+        rebin(src_bits, n_hist_components, src, level_bits[lv],
+              level_histograms[lv]);
+        src_bits = level_bits[lv];
+        src = level_histograms[lv];
+    }
+}
+
+} // namespace
+
+extern "C" IHIST_PUBLIC void
+ihist_histogram_rebin(size_t sample_bits, size_t n_hist_components,
+                      uint32_t const *IHIST_RESTRICT histogram,
+                      size_t coarse_bits, uint32_t *IHIST_RESTRICT coarse) {
+    assert(sample_bits <= 16);
+    assert(coarse_bits <= sample_bits);
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(coarse != nullptr || n_hist_components == 0);
+
+    rebin(sample_bits, n_hist_components, histogram, coarse_bits, coarse);
+}
+
+extern "C" IHIST_PUBLIC void ihist_hist8_2d_multires(
+    size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, size_t n_levels,
+    size_t const *IHIST_RESTRICT level_bits,
+    uint32_t *const *IHIST_RESTRICT level_histograms, bool maybe_parallel) {
+    ihist_hist8_2d(sample_bits, image, mask, height, width, image_stride,
+                   mask_stride, n_components, n_hist_components,
+                   component_indices, histogram, maybe_parallel);
+    fill_levels(sample_bits, n_hist_components, histogram, n_levels,
+                level_bits, level_histograms);
+}
+
+extern "C" IHIST_PUBLIC void ihist_hist16_2d_multires(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT histogram, size_t n_levels,
+    size_t const *IHIST_RESTRICT level_bits,
+    uint32_t *const *IHIST_RESTRICT level_histograms, bool maybe_parallel) {
+    ihist_hist16_2d(sample_bits, image, mask, height, width, image_stride,
+                    mask_stride, n_components, n_hist_components,
+                    component_indices, histogram, maybe_parallel);
+    fill_levels(sample_bits, n_hist_components, histogram, n_levels,
+                level_bits, level_histograms);
+}
@@ -0,0 +1,438 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <vector>
+
+// File layout (all integers little-endian):
+//
+//   header:  "IHSERIES", u32 version, u32 sample_bits, u32 n_components,
+//            u32 keyframe_interval, u64 reserved (32 bytes)
+//   records: per histogram, u32 size followed by size bytes of encoding
+//   index:   per histogram, u64 file offset of its record
+//   trailer: u64 index offset, u64 n_histograms, "IHSINDEX" (24 bytes)
+//
+// The index and trailer are written on close; without them, readers recover
+// the record offsets by walking the size prefixes.
+//
+// A record is a sequence of (gap, delta) pairs, both LEB128 varints: gap is
+// the number of unchanged counts skipped since the previous pair and delta
+// the zigzag-encoded signed change of the next count. Record i is relative
+// to record i - 1, except that every keyframe_interval-th record (starting
+// with the first) is relative to zero.
+
+namespace {
+
+constexpr char file_magic[8] = {'I', 'H', 'S', 'E', 'R', 'I', 'E', 'S'};
+constexpr char index_magic[8] = {'I', 'H', 'S', 'I', 'N', 'D', 'E', 'X'};
+constexpr std::uint32_t format_version = 1;
+constexpr std::size_t header_size = 32;
+constexpr std::size_t trailer_size = 24;
+
+// Upper bound on n_components << sample_bits, so that a corrupt header
+// cannot make a reader allocate an unbounded histogram (2^24 counts is
+// 256 components of 16 bits).
+constexpr std::uint64_t max_counts = std::uint64_t(1) << 24;
+
+// Counts are compared in blocks of this many; a block with no change (most
+// of a typical 16-bit histogram between consecutive frames) costs a single
+// vectorized compare-and-reduce.
+constexpr std::size_t scan_block = 32;
+
+void put_le(std::uint8_t *p, std::uint64_t v, std::size_t n_bytes) {
+    for (std::size_t i = 0; i < n_bytes; ++i) {
+        p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+    }
+}
+
+auto get_le(std::uint8_t const *p, std::size_t n_bytes) -> std::uint64_t {
+    std::uint64_t v = 0;
+    for (std::size_t i = 0; i < n_bytes; ++i) {
+        v |= std::uint64_t(p[i]) << (8 * i);
+    }
+    return v;
+}
+
+auto put_varint(std::uint8_t *p, std::uint64_t v) -> std::uint8_t * {
+    while (v >= 0x80) {
+        *p++ = static_cast<std::uint8_t>(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = static_cast<std::uint8_t>(v);
+    return p;
+}
+
+auto get_varint(std::uint8_t const *&p, std::uint8_t const *end,
+                std::uint64_t &v) -> bool {
+    v = 0;
+    for (unsigned shift = 0; shift < 64 && p < end; shift += 7) {
+        std::uint8_t const b = *p++;
+        v |= std::uint64_t(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <bool HasPrevious>
+auto encode(std::size_t n_counts, std::uint32_t const *previous,
+            std::uint32_t const *histogram, std::uint8_t *out) -> std::size_t {
+    auto const prev = [&](std::size_t i) -> std::uint32_t {
+        if constexpr (HasPrevious) {
+            return previous[i];
+        } else {
+            return 0;
+        }
+    };
+    std::uint8_t *p = out;
+    std::size_t next = 0; // First count not yet covered by a pair
+    for (std::size_t base = 0; base < n_counts; base += scan_block) {
+        std::size_t const n = std::min(scan_block, n_counts - base);
+        if (n == scan_block) {
+            std::uint32_t changed = 0;
+            for (std::size_t j = 0; j < scan_block; ++j) {
+                changed |= histogram[base + j] ^ prev(base + j);
+            }
+            if (changed == 0) {
+                continue;
+            }
+        }
+        for (std::size_t i = base; i < base + n; ++i) {
+            auto const d = std::int64_t(histogram[i]) - std::int64_t(prev(i));
+            if (d != 0) {
+                auto const zz = (static_cast<std::uint64_t>(d) << 1) ^
+                                static_cast<std::uint64_t>(d >> 63);
+                p = put_varint(p, i - next);
+                p = put_varint(p, zz);
+                next = i + 1;
+            }
+        }
+    }
+    return static_cast<std::size_t>(p - out);
+}
+
+} // namespace
+
+struct ihist_series_writer {
+    std::ofstream file;
+    std::size_t n_counts;
+    std::size_t keyframe_interval;
+    std::vector<std::uint32_t> previous;
+    std::vector<std::uint8_t> buffer;
+    std::vector<std::uint64_t> offsets;
+    std::uint64_t position = header_size;
+};
+
+struct ihist_series_reader {
+    std::ifstream file;
+    std::size_t sample_bits;
+    std::size_t n_components;
+    std::size_t n_counts;
+    std::size_t keyframe_interval;
+    std::vector<std::uint64_t> offsets;
+    std::uint64_t records_end; // Start of the index, or end of file
+    // The most recently decoded histogram, so that sequential reads decode
+    // one record each.
+    std::vector<std::uint32_t> current;
+    std::size_t current_index = std::numeric_limits<std::size_t>::max();
+    std::vector<std::uint8_t> buffer;
+
+    auto read_at(std::uint64_t offset, void *dest, std::size_t size) -> bool {
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(static_cast<char *>(dest),
+                  static_cast<std::streamsize>(size));
+        return static_cast<std::size_t>(file.gcount()) == size;
+    }
+
+    // Size of the record at offset, or 0 if there is none (or it is
+    // truncated). An empty record has size 4 here, including the prefix.
+    auto record_size(std::uint64_t offset, std::uint64_t end)
+        -> std::uint64_t {
+        std::uint8_t prefix[4];
+        if (offset > end || end - offset < 4 ||
+            !read_at(offset, prefix, 4)) {
+            return 0;
+        }
+        std::uint64_t const size = get_le(prefix, 4);
+        if (size > ihist_series_encoded_bound(n_counts) ||
+            size > end - offset - 4) {
+            return 0;
+        }
+        return 4 + size;
+    }
+
+    auto apply_record(std::size_t index) -> bool {
+        std::uint64_t const offset = offsets[index];
+        std::uint64_t const size = record_size(offset, records_end);
+        if (size == 0) {
+            return false;
+        }
+        buffer.resize(static_cast<std::size_t>(size - 4));
+        return read_at(offset + 4, buffer.data(), buffer.size()) &&
+               ihist_series_decode(n_counts, buffer.data(), buffer.size(),
+                                   current.data());
+    }
+};
+
+extern "C" IHIST_PUBLIC size_t ihist_series_encoded_bound(size_t n_counts) {
+    // Each changed count takes a gap of at most 64 bits (10 bytes) and a
+    // zigzag delta of at most 33 bits (5 bytes).
+    return n_counts * 15;
+}
+
+extern "C" IHIST_PUBLIC size_t
+ihist_series_encode(size_t n_counts, uint32_t const *IHIST_RESTRICT previous,
+                    uint32_t const *IHIST_RESTRICT histogram,
+                    uint8_t *IHIST_RESTRICT out) {
+    assert(histogram != nullptr || n_counts == 0);
+    assert(out != nullptr || n_counts == 0);
+    return previous == nullptr
+               ? encode<false>(n_counts, previous, histogram, out)
+               : encode<true>(n_counts, previous, histogram, out);
+}
+
+extern "C" IHIST_PUBLIC bool
+ihist_series_decode(size_t n_counts, uint8_t const *IHIST_RESTRICT data,
+                    size_t size, uint32_t *IHIST_RESTRICT histogram) {
+    assert(data != nullptr || size == 0);
+    std::uint8_t const *p = data;
+    std::uint8_t const *const end = data + size;
+    std::size_t i = 0;
+    while (p < end) {
+        std::uint64_t gap = 0;
+        std::uint64_t zz = 0;
+        if (!get_varint(p, end, gap) || !get_varint(p, end, zz) ||
+            gap >= n_counts - i) {
+            return false;
+        }
+        i += static_cast<std::size_t>(gap);
+        auto const d = static_cast<std::int64_t>(zz >> 1) ^
+                       -static_cast<std::int64_t>(zz & 1);
+        std::int64_t const v = std::int64_t(histogram[i]) + d;
+        if (v < 0 || v > std::numeric_limits<std::uint32_t>::max()) {
+            return false;
+        }
+        histogram[i] = static_cast<std::uint32_t>(v);
+        ++i;
+    }
+    return true;
+}
+
+extern "C" IHIST_PUBLIC ihist_series_writer *
+ihist_series_create(char const *path, size_t sample_bits, size_t n_components,
+                    size_t keyframe_interval) {
+    assert(path != nullptr);
+    assert(sample_bits <= 16);
+    assert((std::uint64_t(n_components) << sample_bits) <= max_counts);
+    assert(keyframe_interval > 0);
+    try {
+        auto *w = new ihist_series_writer;
+        w->file.open(path, std::ios::binary | std::ios::trunc);
+        w->n_counts = n_components << sample_bits;
+        w->keyframe_interval = keyframe_interval;
+        w->previous.resize(w->n_counts);
+        w->buffer.resize(4 + ihist_series_encoded_bound(w->n_counts));
+
+        std::uint8_t header[header_size] = {};
+        std::memcpy(header, file_magic, 8);
+        put_le(header + 8, format_version, 4);
+        put_le(header + 12, sample_bits, 4);
+        put_le(header + 16, n_components, 4);
+        put_le(header + 20, keyframe_interval, 4);
+        w->file.write(reinterpret_cast<char const *>(header), header_size);
+        if (!w->file) {
+            delete w;
+            return nullptr;
+        }
+        return w;
+    } catch (std::bad_alloc const &) {
+        return nullptr;
+    }
+}
+
+extern "C" IHIST_PUBLIC bool
+ihist_series_append(ihist_series_writer *IHIST_RESTRICT writer,
+                    uint32_t const *IHIST_RESTRICT histogram) {
+    assert(writer != nullptr);
+    assert(histogram != nullptr || writer->n_counts == 0);
+    bool const keyframe =
+        writer->offsets.size() % writer->keyframe_interval == 0;
+    std::size_t const size = ihist_series_encode(
+        writer->n_counts, keyframe ? nullptr : writer->previous.data(),
+        histogram, writer->buffer.data() + 4);
+    put_le(writer->buffer.data(), size, 4);
+    writer->file.write(reinterpret_cast<char const *>(writer->buffer.data()),
+                       static_cast<std::streamsize>(4 + size));
+    if (!writer->file) {
+        return false;
+    }
+    try {
+        writer->offsets.push_back(writer->position);
+    } catch (std::bad_alloc const &) {
+        return false;
+    }
+    writer->position += 4 + size;
+    std::copy_n(histogram, writer->n_counts, writer->previous.begin());
+    return true;
+}
+
+extern "C" IHIST_PUBLIC bool ihist_series_close(ihist_series_writer *writer) {
+    assert(writer != nullptr);
+    std::vector<std::uint8_t> index(8 * writer->offsets.size() +
+                                    trailer_size);
+    for (std::size_t i = 0; i < writer->offsets.size(); ++i) {
+        put_le(index.data() + 8 * i, writer->offsets[i], 8);
+    }
+    std::uint8_t *trailer = index.data() + 8 * writer->offsets.size();
+    put_le(trailer, writer->position, 8);
+    put_le(trailer + 8, writer->offsets.size(), 8);
+    std::memcpy(trailer + 16, index_magic, 8);
+    writer->file.write(reinterpret_cast<char const *>(index.data()),
+                       static_cast<std::streamsize>(index.size()));
+    writer->file.close();
+    bool const ok = !writer->file.fail();
+    delete writer;
+    return ok;
+}
+
+extern "C" IHIST_PUBLIC ihist_series_reader *
+ihist_series_open(char const *path) {
+    assert(path != nullptr);
+    try {
+        // Owned until returned, so that nothing leaks if an allocation below
+        // throws.
+        auto r = std::make_unique<ihist_series_reader>();
+        r->file.open(path, std::ios::binary);
+        std::uint8_t header[header_size];
+        if (!r->file || !r->read_at(0, header, header_size) ||
+            std::memcmp(header, file_magic, 8) != 0 ||
+            get_le(header + 8, 4) != format_version ||
+            get_le(header + 12, 4) > 16 || get_le(header + 20, 4) == 0 ||
+            (get_le(header + 16, 4) << get_le(header + 12, 4)) >
+                max_counts) {
+            return nullptr;
+        }
+        r->sample_bits = get_le(header + 12, 4);
+        r->n_components = get_le(header + 16, 4);
+        r->n_counts = r->n_components << r->sample_bits;
+        r->keyframe_interval = get_le(header + 20, 4);
+        r->current.resize(r->n_counts);
+
+        r->file.clear();
+        r->file.seekg(0, std::ios::end);
+        auto const file_size = static_cast<std::uint64_t>(r->file.tellg());
+
+        // Use the index if the file was closed properly.
+        std::uint64_t records_limit = file_size;
+        std::uint8_t trailer[trailer_size];
+        if (file_size >= header_size + trailer_size &&
+            r->read_at(file_size - trailer_size, trailer, trailer_size) &&
+            std::memcmp(trailer + 16, index_magic, 8) == 0) {
+            std::uint64_t const index_offset = get_le(trailer, 8);
+            std::uint64_t const n = get_le(trailer + 8, 8);
+            if (index_offset >= header_size && index_offset <= file_size &&
+                n == (file_size - trailer_size - index_offset) / 8 &&
+                index_offset + 8 * n + trailer_size == file_size) {
+                records_limit = index_offset;
+                std::vector<std::uint8_t> index(8 * n);
+                if (r->read_at(index_offset, index.data(), index.size())) {
+                    // Records follow each other between the header and the
+                    // index; an index that says otherwise is corrupt, and is
+                    // ignored in favor of the size prefixes.
+                    bool valid = true;
+                    r->offsets.resize(n);
+                    for (std::size_t i = 0; i < n && valid; ++i) {
+                        std::uint64_t const offset =
+                            get_le(index.data() + 8 * i, 8);
+                        valid = offset >= header_size &&
+                                offset < index_offset &&
+                                (i == 0 || offset > r->offsets[i - 1]);
+                        r->offsets[i] = offset;
+                    }
+                    if (valid) {
+                        r->records_end = index_offset;
+                        return r.release();
+                    }
+                    r->offsets.clear();
+                }
+            }
+        }
+
+        // Otherwise recover the offsets from the record size prefixes.
+        std::uint64_t offset = header_size;
+        for (;;) {
+            std::uint64_t const size = r->record_size(offset, records_limit);
+            if (size == 0) {
+                break;
+            }
+            r->offsets.push_back(offset);
+            offset += size;
+        }
+        r->records_end = offset;
+        return r.release();
+    } catch (std::bad_alloc const &) {
+        return nullptr;
+    }
+}
+
+extern "C" IHIST_PUBLIC void
+ihist_series_info(ihist_series_reader const *IHIST_RESTRICT reader,
+                  size_t *IHIST_RESTRICT sample_bits,
+                  size_t *IHIST_RESTRICT n_components,
+                  size_t *IHIST_RESTRICT n_histograms) {
+    assert(reader != nullptr);
+    if (sample_bits != nullptr) {
+        *sample_bits = reader->sample_bits;
+    }
+    if (n_components != nullptr) {
+        *n_components = reader->n_components;
+    }
+    if (n_histograms != nullptr) {
+        *n_histograms = reader->offsets.size();
+    }
+}
+
+extern "C" IHIST_PUBLIC bool
+ihist_series_read(ihist_series_reader *IHIST_RESTRICT reader, size_t index,
+                  uint32_t *IHIST_RESTRICT histogram) {
+    assert(reader != nullptr);
+    assert(histogram != nullptr || reader->n_counts == 0);
+    if (index >= reader->offsets.size()) {
+        return false;
+    }
+    std::size_t const keyframe = index - index % reader->keyframe_interval;
+    std::size_t start = keyframe;
+    if (reader->current_index >= keyframe && reader->current_index <= index) {
+        start = reader->current_index + 1;
+    } else {
+        std::fill(reader->current.begin(), reader->current.end(), 0);
+    }
+    for (std::size_t i = start; i <= index; ++i) {
+        if (!reader->apply_record(i)) {
+            reader->current_index = std::numeric_limits<std::size_t>::max();
+            return false;
+        }
+    }
+    reader->current_index = index;
+    std::copy(reader->current.begin(), reader->current.end(), histogram);
+    return true;
+}
+
+extern "C" IHIST_PUBLIC void ihist_series_free(ihist_series_reader *reader) {
+    delete reader;
+}
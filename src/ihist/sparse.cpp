@@ -0,0 +1,211 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+// A histogram of fewer samples than this fraction of its bins is counted
+// into scratch bins that are kept zero between calls, tracking which blocks
+// of bins were touched, so that the cost does not depend on the bin count.
+// Larger images use the tuned dense kernels followed by a full scan.
+constexpr std::size_t scratch_bins_per_sample = 8;
+
+constexpr std::size_t touch_block_bits = 6;
+
+// Bins are scanned in blocks of this many; most blocks of a sparse histogram
+// are empty and cost one vectorized OR-reduction each.
+constexpr std::size_t scan_block = 32;
+
+auto compact(std::size_t n_bins, std::uint32_t const *hist,
+             std::uint16_t *bins, std::uint32_t *counts) -> std::size_t {
+    std::size_t n = 0;
+    for (std::size_t base = 0; base < n_bins; base += scan_block) {
+        std::size_t const len = std::min(scan_block, n_bins - base);
+        if (len == scan_block) {
+            std::uint32_t any = 0;
+            for (std::size_t j = 0; j < scan_block; ++j) {
+                any |= hist[base + j];
+            }
+            if (any == 0) {
+                continue;
+            }
+        }
+        for (std::size_t i = base; i < base + len; ++i) {
+            if (hist[i] != 0) {
+                bins[n] = static_cast<std::uint16_t>(i);
+                counts[n] = hist[i];
+                ++n;
+            }
+        }
+    }
+    return n;
+}
+
+template <typename T>
+auto sparse_by_scratch(std::size_t sample_bits, T const *image,
+                       std::uint8_t const *mask, std::size_t height,
+                       std::size_t width, std::size_t image_stride,
+                       std::size_t mask_stride, std::size_t n_components,
+                       std::size_t n_hist_components,
+                       std::size_t const *component_indices,
+                       std::uint16_t *bins, std::uint32_t *counts,
+                       std::size_t *n_nonzero) -> std::size_t {
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    std::size_t const block_size =
+        std::min(n_bins, std::size_t(1) << touch_block_bits);
+    thread_local std::vector<std::uint32_t> scratch;
+    if (scratch.size() < n_bins) {
+        scratch.resize(n_bins);
+    }
+    std::vector<std::uint64_t> touched(
+        (n_bins / block_size + 63) / 64); // One bit per block
+    std::size_t total = 0;
+    for (std::size_t c = 0; c < n_hist_components; ++c) {
+        std::size_t const offset = component_indices[c];
+        for (std::size_t y = 0; y < height; ++y) {
+            T const *row = image + y * image_stride * n_components + offset;
+            std::uint8_t const *mrow =
+                mask == nullptr ? nullptr : mask + y * mask_stride;
+            for (std::size_t x = 0; x < width; ++x) {
+                std::size_t const v = row[x * n_components];
+                if ((mrow == nullptr || mrow[x] != 0) &&
+                    (v >> sample_bits) == 0) {
+                    ++scratch[v];
+                    std::size_t const block = v >> touch_block_bits;
+                    touched[block / 64] |= std::uint64_t(1) << (block % 64);
+                }
+            }
+        }
+
+        // Emit the touched blocks in order, restoring them to zero.
+        std::size_t n = 0;
+        for (std::size_t w = 0; w < touched.size(); ++w) {
+            for (std::uint64_t bits = touched[w]; bits != 0;
+                 bits &= bits - 1) {
+                std::size_t lowest = 0;
+                while (((bits >> lowest) & 1) == 0) {
+                    ++lowest;
+                }
+                std::size_t const start = (w * 64 + lowest) * block_size;
+                for (std::size_t i = start; i < start + block_size; ++i) {
+                    if (scratch[i] != 0) {
+                        bins[total + n] = static_cast<std::uint16_t>(i);
+                        counts[total + n] = scratch[i];
+                        scratch[i] = 0;
+                        ++n;
+                    }
+                }
+            }
+            touched[w] = 0;
+        }
+        n_nonzero[c] = n;
+        total += n;
+    }
+    return total;
+}
+
+template <typename T>
+auto hist_2d_sparse(std::size_t sample_bits, T const *image,
+                    std::uint8_t const *mask, std::size_t height,
+                    std::size_t width, std::size_t image_stride,
+                    std::size_t mask_stride, std::size_t n_components,
+                    std::size_t n_hist_components,
+                    std::size_t const *component_indices, std::uint16_t *bins,
+                    std::uint32_t *counts, std::size_t *n_nonzero,
+                    bool maybe_parallel) -> std::size_t {
+    assert(sample_bits <= 8 * sizeof(T));
+    assert(image != nullptr || height * width == 0);
+    assert(component_indices != nullptr || n_hist_components == 0);
+    assert(n_nonzero != nullptr || n_hist_components == 0);
+
+    if (n_hist_components == 0) {
+        return 0;
+    }
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    if (height * width * scratch_bins_per_sample < n_bins) {
+        return sparse_by_scratch(sample_bits, image, mask, height, width,
+                                 image_stride, mask_stride, n_components,
+                                 n_hist_components, component_indices, bins,
+                                 counts, n_nonzero);
+    }
+
+    std::vector<std::uint32_t> hist(n_hist_components * n_bins);
+    if constexpr (std::is_same_v<T, std::uint8_t>) {
+        ihist_hist8_2d(sample_bits, image, mask, height, width, image_stride,
+                       mask_stride, n_components, n_hist_components,
+                       component_indices, hist.data(), maybe_parallel);
+    } else {
+        ihist_hist16_2d(sample_bits, image, mask, height, width, image_stride,
+                        mask_stride, n_components, n_hist_components,
+                        component_indices, hist.data(), maybe_parallel);
+    }
+    return ihist_histogram_to_sparse(sample_bits, n_hist_components,
+                                     hist.data(), bins, counts, n_nonzero);
+}
+
+} // namespace
+
+extern "C" IHIST_PUBLIC size_t ihist_sparse_capacity(size_t sample_bits,
+                                                     size_t n_hist_components,
+                                                     size_t n_pixels) {
+    assert(sample_bits <= 32);
+    return n_hist_components *
+           std::min(std::size_t(1) << sample_bits, n_pixels);
+}
+
+extern "C" IHIST_PUBLIC size_t ihist_hist8_2d_sparse(
+    size_t sample_bits, uint8_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint16_t *IHIST_RESTRICT bins, uint32_t *IHIST_RESTRICT counts,
+    size_t *IHIST_RESTRICT n_nonzero, bool maybe_parallel) {
+    return hist_2d_sparse(sample_bits, image, mask, height, width,
+                          image_stride, mask_stride, n_components,
+                          n_hist_components, component_indices, bins, counts,
+                          n_nonzero, maybe_parallel);
+}
+
+extern "C" IHIST_PUBLIC size_t ihist_hist16_2d_sparse(
+    size_t sample_bits, uint16_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint16_t *IHIST_RESTRICT bins, uint32_t *IHIST_RESTRICT counts,
+    size_t *IHIST_RESTRICT n_nonzero, bool maybe_parallel) {
+    return hist_2d_sparse(sample_bits, image, mask, height, width,
+                          image_stride, mask_stride, n_components,
+                          n_hist_components, component_indices, bins, counts,
+                          n_nonzero, maybe_parallel);
+}
+
+extern "C" IHIST_PUBLIC size_t
+ihist_histogram_to_sparse(size_t sample_bits, size_t n_hist_components,
+                          uint32_t const *IHIST_RESTRICT histogram,
+                          uint16_t *IHIST_RESTRICT bins,
+                          uint32_t *IHIST_RESTRICT counts,
+                          size_t *IHIST_RESTRICT n_nonzero) {
+    assert(sample_bits <= 16);
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(n_nonzero != nullptr || n_hist_components == 0);
+
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    std::size_t total = 0;
+    for (std::size_t c = 0; c < n_hist_components; ++c) {
+        n_nonzero[c] = compact(n_bins, histogram + c * n_bins, bins + total,
+                               counts + total);
+        total += n_nonzero[c];
+    }
+    return total;
+}
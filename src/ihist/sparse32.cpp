@@ -0,0 +1,380 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include "ihist/phys_core_count.hpp"
+
+#ifdef IHIST_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/combinable.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// Images of at least this many pixels are counted in parallel, in row bands
+// of about this many pixels.
+constexpr std::size_t parallel_size_threshold = 1uLL << 18;
+constexpr std::size_t parallel_grain_size = 1uLL << 18;
+
+// Each table is split by the top bits of the key's hash into this many
+// partitions, so that the per-thread tables can be merged one partition per
+// task.
+constexpr unsigned partition_bits = 4;
+constexpr std::size_t n_partitions = std::size_t(1) << partition_bits;
+
+constexpr unsigned initial_slot_bits = 6;
+
+// Keys that recur (the background label, a run of equal timestamp bins) are
+// counted in a direct-mapped cache indexed by their low bits, and only reach
+// the hash table when evicted.
+constexpr std::size_t front_size = 256;
+
+inline auto hash_key(std::uint32_t key) -> std::uint64_t {
+    return std::uint64_t(key) * 0x9e3779b97f4a7c15uLL;
+}
+
+struct key_count {
+    std::uint32_t key;
+    std::uint32_t count;
+};
+
+// Open-addressing table with linear probing; a zero count marks an empty
+// slot. Slots are chosen by the hash bits just below the partition bits.
+class key_table {
+    std::vector<key_count> slots_;
+    unsigned slot_bits_ = initial_slot_bits;
+    std::size_t size_ = 0;
+
+    [[nodiscard]] auto slot_of(std::uint64_t hash) const -> std::size_t {
+        return static_cast<std::size_t>((hash << partition_bits) >>
+                                        (64 - slot_bits_));
+    }
+
+    void grow() {
+        std::vector<key_count> old(slots_.size() * 2);
+        old.swap(slots_);
+        ++slot_bits_;
+        std::size_t const mask = slots_.size() - 1;
+        for (key_count const &e : old) {
+            if (e.count != 0) {
+                std::size_t i = slot_of(hash_key(e.key));
+                while (slots_[i].count != 0) {
+                    i = (i + 1) & mask;
+                }
+                slots_[i] = e;
+            }
+        }
+    }
+
+  public:
+    key_table() : slots_(std::size_t(1) << initial_slot_bits) {}
+
+    [[nodiscard]] auto size() const -> std::size_t { return size_; }
+
+    void add(std::uint32_t key, std::uint64_t hash, std::uint32_t count) {
+        std::size_t const mask = slots_.size() - 1;
+        std::size_t i = slot_of(hash);
+        for (; slots_[i].count != 0; i = (i + 1) & mask) {
+            if (slots_[i].key == key) {
+                slots_[i].count += count;
+                return;
+            }
+        }
+        slots_[i] = {key, count};
+        // Keep the load factor at or below 1/2.
+        if (++size_ * 2 > slots_.size()) {
+            grow();
+        }
+    }
+
+    template <typename F> void for_each(F &&f) const {
+        for (key_count const &e : slots_) {
+            if (e.count != 0) {
+                f(e);
+            }
+        }
+    }
+};
+
+// The counts of one histogrammed component, as gathered by one thread.
+class key_counter {
+    std::array<key_count, front_size> front_;
+    std::array<key_table, n_partitions> parts_;
+
+    void add_to_table(std::uint32_t key, std::uint32_t count) {
+        std::uint64_t const hash = hash_key(key);
+        parts_[hash >> (64 - partition_bits)].add(key, hash, count);
+    }
+
+  public:
+    key_counter() {
+        // Each entry starts out holding its own index with a zero count, so
+        // that lookups need not check for empty entries.
+        for (std::size_t i = 0; i < front_size; ++i) {
+            front_[i] = {static_cast<std::uint32_t>(i), 0};
+        }
+    }
+
+    void count(std::uint32_t key, std::uint32_t n) {
+        key_count &e = front_[key % front_size];
+        if (e.key == key) {
+            e.count += n;
+            return;
+        }
+        if (e.count != 0) {
+            add_to_table(e.key, e.count);
+        }
+        e = {key, n};
+    }
+
+    // Move the front cache counts into the tables.
+    void flush() {
+        for (std::size_t i = 0; i < front_size; ++i) {
+            if (front_[i].count != 0) {
+                add_to_table(front_[i].key, front_[i].count);
+                front_[i] = {static_cast<std::uint32_t>(i), 0};
+            }
+        }
+    }
+
+    auto part(std::size_t p) -> key_table & { return parts_[p]; }
+};
+
+using thread_state = std::vector<key_counter>;
+
+struct params {
+    std::size_t sample_bits;
+    std::uint32_t const *image;
+    std::uint8_t const *mask;
+    std::size_t width;
+    std::size_t image_stride;
+    std::size_t mask_stride;
+    std::size_t n_components;
+    std::size_t n_hist_components;
+    std::size_t const *component_indices;
+};
+
+void count_rows(params const &p, std::size_t y_begin, std::size_t y_end,
+                thread_state &state) {
+    // Compare in 64 bits so that sample_bits == 32 needs no special case.
+    std::uint64_t const limit = std::uint64_t(1) << p.sample_bits;
+    for (std::size_t y = y_begin; y < y_end; ++y) {
+        std::uint32_t const *row =
+            p.image + y * p.image_stride * p.n_components;
+        std::uint8_t const *mrow =
+            p.mask == nullptr ? nullptr : p.mask + y * p.mask_stride;
+        for (std::size_t c = 0; c < p.n_hist_components; ++c) {
+            key_counter &counter = state[c];
+            std::uint32_t const *samples = row + p.component_indices[c];
+            // Runs of equal keys are common and are counted in registers.
+            std::uint32_t run_key = 0;
+            std::uint32_t run = 0;
+            for (std::size_t x = 0; x < p.width; ++x) {
+                std::uint32_t const v = samples[x * p.n_components];
+                if ((mrow == nullptr || mrow[x] != 0) && v < limit) {
+                    if (v == run_key) {
+                        ++run;
+                    } else {
+                        if (run != 0) {
+                            counter.count(run_key, run);
+                        }
+                        run_key = v;
+                        run = 1;
+                    }
+                }
+            }
+            if (run != 0) {
+                counter.count(run_key, run);
+            }
+        }
+    }
+}
+
+// Sort by key with an LSD radix sort, skipping digits that all keys share
+// (such as the high digits of small labels).
+void radix_sort(std::vector<key_count> &entries) {
+    constexpr unsigned digit_bits = 11;
+    constexpr std::size_t n_digits = std::size_t(1) << digit_bits;
+    std::vector<key_count> buffer(entries.size());
+    for (unsigned shift = 0; shift < 32; shift += digit_bits) {
+        std::vector<std::size_t> offsets(n_digits + 1);
+        for (key_count const &e : entries) {
+            ++offsets[((e.key >> shift) & (n_digits - 1)) + 1];
+        }
+        if (std::find(offsets.begin(), offsets.end(), entries.size()) !=
+            offsets.end()) {
+            continue;
+        }
+        for (std::size_t d = 1; d <= n_digits; ++d) {
+            offsets[d] += offsets[d - 1];
+        }
+        for (key_count const &e : entries) {
+            buffer[offsets[(e.key >> shift) & (n_digits - 1)]++] = e;
+        }
+        entries.swap(buffer);
+    }
+}
+
+// Below this many keys, comparison sorting is faster than radix sorting.
+constexpr std::size_t radix_sort_threshold = 1024;
+
+// Sorted output of one component, from the merged partitions.
+void emit_sorted(std::vector<key_table const *> const &parts,
+                 std::uint32_t *keys, std::uint32_t *counts) {
+    std::size_t n = 0;
+    for (key_table const *t : parts) {
+        n += t->size();
+    }
+    std::vector<key_count> entries;
+    entries.reserve(n);
+    for (key_table const *t : parts) {
+        t->for_each([&](key_count const &e) { entries.push_back(e); });
+    }
+    if (n < radix_sort_threshold) {
+        std::sort(entries.begin(), entries.end(),
+                  [](key_count const &a, key_count const &b) {
+                      return a.key < b.key;
+                  });
+    } else {
+        radix_sort(entries);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        keys[i] = entries[i].key;
+        counts[i] = entries[i].count;
+    }
+}
+
+auto hist32_2d_sparse(params const &p, std::size_t height,
+                      std::uint32_t *keys, std::uint32_t *counts,
+                      std::size_t *n_nonzero, bool maybe_parallel)
+    -> std::size_t {
+    std::size_t const n_hist = p.n_hist_components;
+
+#ifdef IHIST_USE_TBB
+    if (maybe_parallel && height * p.width >= parallel_size_threshold) {
+        tbb::combinable<thread_state> local_states(
+            [n_hist] { return thread_state(n_hist); });
+
+        auto arena = ihist::internal::phys_core_arena();
+        std::size_t const h_grain_size =
+            std::max(std::size_t(1), parallel_grain_size / p.width);
+        std::vector<thread_state *> states;
+        std::vector<std::vector<key_table const *>> merged(n_hist);
+        arena.execute([&] {
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(0, height, h_grain_size),
+                [&](tbb::blocked_range<std::size_t> const &r) {
+                    count_rows(p, r.begin(), r.end(), local_states.local());
+                });
+            local_states.combine_each(
+                [&](thread_state &s) { states.push_back(&s); });
+
+            // Merge each (component, partition) into the largest of the
+            // threads' tables for it.
+            tbb::parallel_for(std::size_t(0), n_hist, [&](std::size_t c) {
+                for (thread_state *s : states) {
+                    (*s)[c].flush();
+                }
+            });
+            for (std::size_t c = 0; c < n_hist; ++c) {
+                merged[c].resize(n_partitions);
+            }
+            tbb::parallel_for(
+                std::size_t(0), n_hist * n_partitions, [&](std::size_t i) {
+                    std::size_t const c = i / n_partitions;
+                    std::size_t const part = i % n_partitions;
+                    key_table *dest = &(*states[0])[c].part(part);
+                    for (thread_state *s : states) {
+                        key_table *t = &(*s)[c].part(part);
+                        if (t->size() > dest->size()) {
+                            dest = t;
+                        }
+                    }
+                    for (thread_state *s : states) {
+                        key_table const *t = &(*s)[c].part(part);
+                        if (t != dest) {
+                            t->for_each([&](key_count const &e) {
+                                dest->add(e.key, hash_key(e.key), e.count);
+                            });
+                        }
+                    }
+                    merged[c][part] = dest;
+                });
+        });
+
+        std::size_t total = 0;
+        for (std::size_t c = 0; c < n_hist; ++c) {
+            n_nonzero[c] = 0;
+            for (key_table const *t : merged[c]) {
+                n_nonzero[c] += t->size();
+            }
+            emit_sorted(merged[c], keys + total, counts + total);
+            total += n_nonzero[c];
+        }
+        return total;
+    }
+#else
+    (void)maybe_parallel;
+#endif
+
+    thread_state state(n_hist);
+    count_rows(p, 0, height, state);
+    std::size_t total = 0;
+    for (std::size_t c = 0; c < n_hist; ++c) {
+        state[c].flush();
+        std::vector<key_table const *> parts(n_partitions);
+        n_nonzero[c] = 0;
+        for (std::size_t part = 0; part < n_partitions; ++part) {
+            parts[part] = &state[c].part(part);
+            n_nonzero[c] += parts[part]->size();
+        }
+        emit_sorted(parts, keys + total, counts + total);
+        total += n_nonzero[c];
+    }
+    return total;
+}
+
+} // namespace
+
+extern "C" IHIST_PUBLIC size_t ihist_hist32_2d_sparse(
+    size_t sample_bits, uint32_t const *IHIST_RESTRICT image,
+    uint8_t const *IHIST_RESTRICT mask, size_t height, size_t width,
+    size_t image_stride, size_t mask_stride, size_t n_components,
+    size_t n_hist_components, size_t const *IHIST_RESTRICT component_indices,
+    uint32_t *IHIST_RESTRICT keys, uint32_t *IHIST_RESTRICT counts,
+    size_t *IHIST_RESTRICT n_nonzero, bool maybe_parallel) {
+    assert(sample_bits <= 32);
+    assert(image != nullptr || height * width == 0);
+    assert(width <= image_stride || height == 0);
+    assert(mask == nullptr || width <= mask_stride || height == 0);
+    assert(component_indices != nullptr || n_hist_components == 0);
+    assert(n_nonzero != nullptr || n_hist_components == 0);
+    assert(std::all_of(component_indices,
+                       component_indices + n_hist_components,
+                       [&](std::size_t i) { return i < n_components; }));
+    assert(height * width < std::numeric_limits<std::uint32_t>::max());
+
+    if (n_hist_components == 0) {
+        return 0;
+    }
+    params const p{sample_bits,       image,       mask,
+                   width,             image_stride, mask_stride,
+                   n_components,      n_hist_components,
+                   component_indices};
+    return hist32_2d_sparse(p, height, keys, counts, n_nonzero,
+                            maybe_parallel);
+}
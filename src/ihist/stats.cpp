@@ -0,0 +1,84 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace {
+
+// Statistics are derived from the histogram rather than from the image. The
+// histogram already reflects the mask, ROI, and component selection, and a
+// single pass over the bins is far cheaper than a second pass over the pixels
+// (or extra per-pixel work in the histogram kernels) for any image larger than
+// the bin count.
+
+void component_stats(std::size_t n_bins, std::uint32_t const *hist,
+                     ihist_stats &stats) {
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;
+    std::uint64_t sum_sq = 0;
+    // Keep the loop free of data-dependent branches so that it vectorizes.
+    for (std::size_t bin = 0; bin < n_bins; ++bin) {
+        std::uint64_t const c = hist[bin];
+        count += c;
+        sum += c * bin;
+        sum_sq += c * bin * bin;
+    }
+
+    std::size_t lo = 0;
+    while (lo < n_bins && hist[lo] == 0) {
+        ++lo;
+    }
+    std::size_t hi = n_bins;
+    while (hi > lo && hist[hi - 1] == 0) {
+        --hi;
+    }
+
+    stats.count = count;
+    stats.sum = sum;
+    stats.sum_of_squares = sum_sq;
+    stats.min = count > 0 ? static_cast<std::uint32_t>(lo) : 0;
+    stats.max = count > 0 ? static_cast<std::uint32_t>(hi - 1) : 0;
+    stats.n_saturated = n_bins > 0 ? hist[n_bins - 1] : 0;
+
+    if (count == 0) {
+        stats.mean = std::numeric_limits<double>::quiet_NaN();
+        stats.stddev = std::numeric_limits<double>::quiet_NaN();
+        return;
+    }
+
+    double const mean = static_cast<double>(sum) / static_cast<double>(count);
+    // Two-pass variance (over the occupied bins only) to avoid the
+    // cancellation of sum_sq / count - mean^2.
+    double ssd = 0.0;
+    for (std::size_t bin = lo; bin < hi; ++bin) {
+        double const d = static_cast<double>(bin) - mean;
+        ssd += static_cast<double>(hist[bin]) * d * d;
+    }
+    stats.mean = mean;
+    stats.stddev = std::sqrt(ssd / static_cast<double>(count));
+}
+
+} // namespace
+
+extern "C" IHIST_PUBLIC void
+ihist_histogram_stats(size_t sample_bits, size_t n_hist_components,
+                      uint32_t const *IHIST_RESTRICT histogram,
+                      ihist_stats *IHIST_RESTRICT stats) {
+    assert(sample_bits <= 16);
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(stats != nullptr || n_hist_components == 0);
+
+    std::size_t const n_bins = std::size_t(1) << sample_bits;
+    for (std::size_t i = 0; i < n_hist_components; ++i) {
+        component_stats(n_bins, histogram + i * n_bins, stats[i]);
+    }
+}
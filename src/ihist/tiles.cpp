@@ -0,0 +1,154 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ihist/ihist.h"
+
+#include "fused_rows.hpp"
+#include "ihist/phys_core_count.hpp"
+
+#ifdef IHIST_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/combinable.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace {
+
+using ihist::internal::band_histogram;
+
+// A band of rows of one tile; the unit of parallel work. Tiles are split so
+// that bands are about as large as the grain size of the plain histogram
+// functions, and bands of all tiles are scheduled together, so that many
+// small tiles and a few large ones both parallelize.
+struct band {
+    std::size_t tile;
+    std::size_t y_begin;
+    std::size_t y_end;
+};
+
+template <typename Tile>
+void hist_band(std::size_t n_components, std::size_t n_hist_components,
+               std::size_t const *component_indices, Tile const &tile,
+               band const &b, band_histogram &hist) {
+    hist.add(tile.image + b.y_begin * tile.image_stride * n_components,
+             tile.mask == nullptr ? nullptr
+                                  : tile.mask + b.y_begin * tile.mask_stride,
+             b.y_end - b.y_begin, tile.width, tile.image_stride,
+             tile.mask_stride, n_components, n_hist_components,
+             component_indices);
+}
+
+// Each band is histogrammed with the tuned kernels. All tiles share one
+// per-thread band_histogram, which is reduced into the histogram once at the
+// end rather than once per tile.
+template <typename T, typename Tile>
+void hist_tiles(std::size_t sample_bits, std::size_t n_tiles,
+                Tile const *tiles, std::size_t n_components,
+                std::size_t n_hist_components,
+                std::size_t const *component_indices,
+                std::uint32_t *histogram, bool maybe_parallel) {
+    assert(sample_bits <= 8 * sizeof(T));
+    assert(tiles != nullptr || n_tiles == 0);
+    assert(histogram != nullptr || n_hist_components == 0);
+    assert(std::all_of(component_indices,
+                       component_indices + n_hist_components,
+                       [&](std::size_t i) { return i < n_components; }));
+
+    std::vector<band> bands;
+    std::size_t total_pixels = 0;
+    for (std::size_t t = 0; t < n_tiles; ++t) {
+        Tile const &tile = tiles[t];
+        assert(tile.image != nullptr || tile.height * tile.width == 0);
+        assert(tile.width <= tile.image_stride || tile.height == 0);
+        assert(tile.mask == nullptr || tile.width <= tile.mask_stride ||
+               tile.height == 0);
+        if (tile.height == 0 || tile.width == 0) {
+            continue;
+        }
+        total_pixels += tile.height * tile.width;
+        std::size_t const band_rows = std::max(
+            std::size_t(1),
+            ihist::internal::fused_parallel_grain_size / tile.width);
+        for (std::size_t y = 0; y < tile.height; y += band_rows) {
+            bands.push_back({t, y, std::min(tile.height, y + band_rows)});
+        }
+    }
+    assert(total_pixels < std::numeric_limits<std::uint32_t>::max());
+    if (bands.empty() || n_hist_components == 0) {
+        return;
+    }
+
+    std::size_t const kernel_bits =
+        ihist::internal::tuned_kernel_bits<T>(sample_bits);
+
+#ifdef IHIST_USE_TBB
+    if (maybe_parallel &&
+        total_pixels >= ihist::internal::fused_parallel_size_threshold) {
+        tbb::combinable<band_histogram> local_hists([&] {
+            return band_histogram(kernel_bits, n_hist_components);
+        });
+
+        auto arena = ihist::internal::phys_core_arena();
+        arena.execute([&] {
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(0, bands.size()),
+                [&](tbb::blocked_range<std::size_t> const &r) {
+                    auto &hist = local_hists.local();
+                    for (std::size_t i = r.begin(); i < r.end(); ++i) {
+                        hist_band(n_components, n_hist_components,
+                                  component_indices, tiles[bands[i].tile],
+                                  bands[i], hist);
+                    }
+                });
+        });
+        local_hists.combine_each([&](band_histogram &hist) {
+            hist.reduce(sample_bits, histogram, nullptr);
+        });
+        return;
+    }
+#else
+    (void)maybe_parallel;
+#endif
+
+    band_histogram hist(kernel_bits, n_hist_components);
+    for (band const &b : bands) {
+        hist_band(n_components, n_hist_components, component_indices,
+                  tiles[b.tile], b, hist);
+    }
+    hist.reduce(sample_bits, histogram, nullptr);
+}
+
+} // namespace
+
+extern "C" IHIST_PUBLIC void
+ihist_hist8_tiles(size_t sample_bits, size_t n_tiles,
+                  ihist_tile8 const *IHIST_RESTRICT tiles,
+                  size_t n_components, size_t n_hist_components,
+                  size_t const *IHIST_RESTRICT component_indices,
+                  uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel) {
+    hist_tiles<std::uint8_t>(sample_bits, n_tiles, tiles, n_components,
+                             n_hist_components, component_indices, histogram,
+                             maybe_parallel);
+}
+
+extern "C" IHIST_PUBLIC void
+ihist_hist16_tiles(size_t sample_bits, size_t n_tiles,
+                   ihist_tile16 const *IHIST_RESTRICT tiles,
+                   size_t n_components, size_t n_hist_components,
+                   size_t const *IHIST_RESTRICT component_indices,
+                   uint32_t *IHIST_RESTRICT histogram, bool maybe_parallel) {
+    hist_tiles<std::uint16_t>(sample_bits, n_tiles, tiles, n_components,
+                              n_hist_components, component_indices, histogram,
+                              maybe_parallel);
+}
@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include <ihist.hpp>
+#include <ihist/ihist.hpp>
 
 #include <cstddef>
 #include <cstdint>
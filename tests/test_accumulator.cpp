@@ -0,0 +1,107 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+TEST_CASE("accumulator fed in row bands matches whole image") {
+    auto const [width, height] = GENERATE(
+        table<std::size_t, std::size_t>({{65, 63}, {1024, 3000}, {1, 1}}));
+    auto const [n_components, indices] =
+        GENERATE(table<std::size_t, std::vector<std::size_t>>({
+            {1, {0}},
+            {3, {2, 0}},
+        }));
+    // Band heights from line-scan-like to larger than the parallel threshold.
+    auto const band_height = GENERATE(std::size_t(1), std::size_t(7),
+                                      std::size_t(1100));
+    bool const use_mask = GENERATE(false, true);
+    bool const parallel = GENERATE(false, true);
+    CAPTURE(width, height, n_components, indices, band_height, use_mask,
+            parallel);
+
+    std::size_t const stride = width + 3;
+    std::size_t const n_hist = indices.size();
+    auto const data = test_data<u16, 13>(height * stride * n_components);
+    auto const mask = test_data<u8, 1>(height * stride);
+
+    std::vector<u32> ref(n_hist << 12);
+    std::vector<u32> ref_overflow(n_hist);
+    ihist_hist16_2d_overflow(12, data.data(),
+                             use_mask ? mask.data() : nullptr, height, width,
+                             stride, use_mask ? stride : 0, n_components,
+                             n_hist, indices.data(), ref.data(),
+                             ref_overflow.data(), false);
+
+    ihist_accumulator *acc =
+        ihist_accumulator_create(12, n_components, n_hist, indices.data());
+    REQUIRE(acc != nullptr);
+    for (std::size_t y = 0; y < height; y += band_height) {
+        ihist_accumulator_feed16(
+            acc, data.data() + y * stride * n_components,
+            use_mask ? mask.data() + y * stride : nullptr,
+            std::min(band_height, height - y), width, stride,
+            use_mask ? stride : 0, parallel);
+    }
+    std::vector<u32> hist(n_hist << 12);
+    std::vector<u32> overflow(n_hist);
+    ihist_accumulator_finish(acc, hist.data(), overflow.data());
+    CHECK(hist == ref);
+    CHECK(overflow == ref_overflow);
+
+    // Finish resets: a second finish adds nothing.
+    ihist_accumulator_finish(acc, hist.data(), nullptr);
+    CHECK(hist == ref);
+    ihist_accumulator_destroy(acc);
+}
+
+TEST_CASE("accumulator accepts 8-bit feeds") {
+    std::vector<u8> const row{0, 1, 1, 255};
+    std::vector<std::size_t> const indices{0};
+    ihist_accumulator *acc = ihist_accumulator_create(8, 1, 1, indices.data());
+    REQUIRE(acc != nullptr);
+    ihist_accumulator_feed8(acc, row.data(), nullptr, 1, 4, 4, 0, false);
+    ihist_accumulator_feed8(acc, row.data(), nullptr, 1, 2, 2, 0, false);
+    std::vector<u32> hist(256);
+    ihist_accumulator_finish(acc, hist.data(), nullptr);
+    CHECK(hist[0] == 2);
+    CHECK(hist[1] == 3);
+    CHECK(hist[255] == 1);
+    ihist_accumulator_destroy(acc);
+}
+
+TEST_CASE("accumulator accepts mixed 8-bit and 16-bit feeds") {
+    std::vector<u8> const row8{0, 1, 255};
+    std::vector<u16> const row16{1, 1023, 1024, 65535};
+    std::vector<std::size_t> const indices{0};
+    ihist_accumulator *acc =
+        ihist_accumulator_create(10, 1, 1, indices.data());
+    REQUIRE(acc != nullptr);
+    ihist_accumulator_feed8(acc, row8.data(), nullptr, 1, 3, 3, 0, false);
+    ihist_accumulator_feed16(acc, row16.data(), nullptr, 1, 4, 4, 0, false);
+    std::vector<u32> hist(1024);
+    u32 overflow = 0;
+    ihist_accumulator_finish(acc, hist.data(), &overflow);
+    CHECK(hist[0] == 1);
+    CHECK(hist[1] == 2);
+    CHECK(hist[255] == 1);
+    CHECK(hist[1023] == 1);
+    CHECK(overflow == 2);
+    ihist_accumulator_destroy(acc);
+}
@@ -0,0 +1,202 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+using u64 = std::uint64_t;
+
+namespace {
+
+// Histogram of 3 components (12-bit) from test data, with sorted samples per
+// component for reference computations.
+struct test_hists {
+    static constexpr std::size_t bits = 12;
+    static constexpr std::size_t nbins = std::size_t{1} << bits;
+    static constexpr std::size_t n_pixels = 5000;
+    std::vector<u32> hist;
+    std::vector<std::vector<u16>> samples;
+
+    test_hists() : hist(3 * nbins), samples(3) {
+        // Low-bit-depth data with a skewed distribution, so that bins have
+        // varied counts.
+        auto const data = test_data<u16, bits>(3 * n_pixels);
+        auto const shift = test_data<u8, 2>(3 * n_pixels);
+        std::vector<u16> skewed(data.size());
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            skewed[i] = static_cast<u16>(data[i] >> shift[i]);
+        }
+        constexpr std::size_t indices[] = {0, 1, 2};
+        ihist_hist16_2d(bits, skewed.data(), nullptr, 1, n_pixels, n_pixels,
+                        n_pixels, 3, 3, indices, hist.data(), false);
+        for (std::size_t s = 0; s < 3; ++s) {
+            for (std::size_t i = 0; i < n_pixels; ++i) {
+                samples[s].push_back(skewed[3 * i + s]);
+            }
+            std::sort(samples[s].begin(), samples[s].end());
+        }
+    }
+};
+
+} // namespace
+
+TEST_CASE("cumsum of histogram") {
+    test_hists const th;
+    std::vector<u64> cumsum(3 * th.nbins);
+    ihist_histogram_cumsum(th.bits, 3, th.hist.data(), cumsum.data());
+    for (std::size_t s = 0; s < 3; ++s) {
+        u64 sum = 0;
+        for (std::size_t bin = 0; bin < th.nbins; ++bin) {
+            sum += th.hist[s * th.nbins + bin];
+            CHECK(cumsum[s * th.nbins + bin] == sum);
+        }
+        CHECK(sum == th.n_pixels);
+    }
+}
+
+TEST_CASE("quantiles match sorted samples") {
+    test_hists const th;
+    std::vector<double> const qs{0.5, 0.0, 1.0, 0.001, 0.999, 0.25, 0.25};
+    std::vector<u32> values(3 * qs.size());
+    ihist_histogram_quantiles(th.bits, 3, th.hist.data(), qs.size(),
+                              qs.data(), values.data());
+    for (std::size_t s = 0; s < 3; ++s) {
+        auto const &sorted = th.samples[s];
+        for (std::size_t k = 0; k < qs.size(); ++k) {
+            CAPTURE(s, qs[k]);
+            auto const rank = std::max<std::size_t>(
+                1, static_cast<std::size_t>(
+                       std::ceil(qs[k] * double(sorted.size()))));
+            CHECK(values[s * qs.size() + k] == sorted[rank - 1]);
+        }
+    }
+}
+
+TEST_CASE("quantiles of empty histogram are zero") {
+    std::vector<u32> const hist(256);
+    double const qs[] = {0.0, 0.5, 1.0};
+    std::vector<u32> values(3, 42);
+    ihist_histogram_quantiles(8, 1, hist.data(), 3, qs, values.data());
+    CHECK(values == std::vector<u32>{0, 0, 0});
+}
+
+TEST_CASE("otsu threshold maximizes between-class variance") {
+    test_hists const th;
+    std::vector<u32> thresholds(3);
+    ihist_histogram_otsu(th.bits, 3, th.hist.data(), thresholds.data());
+
+    for (std::size_t s = 0; s < 3; ++s) {
+        u32 const *h = th.hist.data() + s * th.nbins;
+        double best = -1.0;
+        std::size_t best_t = 0;
+        for (std::size_t t = 0; t + 1 < th.nbins; ++t) {
+            double w0 = 0, w1 = 0, m0 = 0, m1 = 0;
+            for (std::size_t b = 0; b < th.nbins; ++b) {
+                if (b <= t) {
+                    w0 += h[b];
+                    m0 += double(h[b]) * double(b);
+                } else {
+                    w1 += h[b];
+                    m1 += double(h[b]) * double(b);
+                }
+            }
+            if (w0 == 0 || w1 == 0) {
+                continue;
+            }
+            double const d = m0 / w0 - m1 / w1;
+            double const between = w0 * w1 * d * d;
+            if (between > best * (1.0 + 1e-12)) {
+                best = between;
+                best_t = t;
+            }
+        }
+        CAPTURE(s);
+        CHECK(thresholds[s] == best_t);
+    }
+}
+
+TEST_CASE("otsu threshold of bimodal histogram") {
+    std::vector<u32> hist(256);
+    hist[10] = 100;
+    hist[11] = 50;
+    hist[200] = 80;
+    hist[210] = 20;
+    u32 threshold = 0;
+    ihist_histogram_otsu(8, 1, hist.data(), &threshold);
+    CHECK(threshold >= 11);
+    CHECK(threshold < 200);
+}
+
+TEST_CASE("otsu threshold of degenerate histograms is zero") {
+    std::vector<u32> hist(256);
+    u32 threshold = 42;
+    ihist_histogram_otsu(8, 1, hist.data(), &threshold);
+    CHECK(threshold == 0);
+    hist[77] = 5;
+    ihist_histogram_otsu(8, 1, hist.data(), &threshold);
+    CHECK(threshold == 0);
+}
+
+TEST_CASE("entropy of histogram") {
+    SECTION("uniform") {
+        std::vector<u32> const hist(256, 3);
+        double entropy = 0.0;
+        ihist_histogram_entropy(8, 1, hist.data(), &entropy);
+        CHECK(std::abs(entropy - 8.0) < 1e-12);
+    }
+    SECTION("single bin") {
+        std::vector<u32> hist(256);
+        hist[3] = 1000;
+        double entropy = -1.0;
+        ihist_histogram_entropy(8, 1, hist.data(), &entropy);
+        CHECK(entropy == 0.0);
+    }
+    SECTION("empty") {
+        std::vector<u32> const hist(256);
+        double entropy = 0.0;
+        ihist_histogram_entropy(8, 1, hist.data(), &entropy);
+        CHECK(std::isnan(entropy));
+    }
+    SECTION("matches definition") {
+        test_hists const th;
+        std::vector<double> entropy(3);
+        ihist_histogram_entropy(th.bits, 3, th.hist.data(), entropy.data());
+        for (std::size_t s = 0; s < 3; ++s) {
+            double expected = 0.0;
+            for (std::size_t b = 0; b < th.nbins; ++b) {
+                double const p =
+                    th.hist[s * th.nbins + b] / double(th.n_pixels);
+                if (p > 0.0) {
+                    expected -= p * std::log2(p);
+                }
+            }
+            CHECK(std::abs(entropy[s] - expected) < 1e-9);
+        }
+    }
+}
+
+TEST_CASE("mode of histogram") {
+    std::vector<u32> hist(2 * 16);
+    hist[3] = 5;
+    hist[7] = 9;
+    hist[9] = 9; // Tie: lowest bin wins.
+    hist[16 + 15] = 1;
+    std::vector<u32> modes(2);
+    ihist_histogram_mode(4, 2, hist.data(), modes.data());
+    CHECK(modes == std::vector<u32>{7, 15});
+}
@@ -0,0 +1,104 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+TEST_CASE("batch histograms match separate calls") {
+    // Many small ROIs (distributed across threads), plus one image large
+    // enough to be parallelized internally.
+    std::size_t const n_small = GENERATE(std::size_t(1), std::size_t(300));
+    bool const with_large = GENERATE(false, true);
+    auto const [n_components, indices] =
+        GENERATE(table<std::size_t, std::vector<std::size_t>>({
+            {1, {0}},
+            {3, {2, 0}},
+        }));
+    bool const use_mask = GENERATE(false, true);
+    bool const parallel = GENERATE(false, true);
+    CAPTURE(n_small, with_large, n_components, indices, use_mask, parallel);
+
+    std::size_t const width = 1200;
+    std::size_t const height = with_large ? 1000 : 100;
+    std::size_t const n_hist = indices.size();
+    auto const data = test_data<u16, 12>(height * width * n_components);
+    auto const mask = test_data<u8, 1>(height * width);
+
+    std::vector<ihist_tile16> images;
+    for (std::size_t i = 0; i < n_small; ++i) {
+        std::size_t const x = (i * 37) % (width - 40);
+        std::size_t const y = (i * 11) % (100 - 20);
+        ihist_tile16 roi{};
+        roi.image = data.data() + (y * width + x) * n_components;
+        roi.mask = use_mask ? mask.data() + y * width + x : nullptr;
+        roi.height = 1 + i % 20;
+        roi.width = 1 + i % 40;
+        roi.image_stride = width;
+        roi.mask_stride = use_mask ? width : 0;
+        images.push_back(roi);
+    }
+    if (with_large) {
+        images.push_back({data.data(), use_mask ? mask.data() : nullptr,
+                          height, width, width, use_mask ? width : 0});
+    }
+    images.push_back(ihist_tile16{});
+
+    std::vector<std::vector<u32>> hists(images.size(),
+                                        std::vector<u32>(n_hist << 12, 1));
+    std::vector<u32 *> hist_ptrs;
+    for (auto &h : hists) {
+        hist_ptrs.push_back(h.data());
+    }
+    ihist_hist16_2d_batch(12, images.size(), images.data(), n_components,
+                          n_hist, indices.data(), hist_ptrs.data(), parallel);
+
+    for (std::size_t i = 0; i < images.size(); ++i) {
+        ihist_tile16 const &roi = images[i];
+        std::vector<u32> ref(n_hist << 12, 1);
+        if (roi.height * roi.width > 0) {
+            ihist_hist16_2d(12, roi.image, roi.mask, roi.height, roi.width,
+                            roi.image_stride, roi.mask_stride, n_components,
+                            n_hist, indices.data(), ref.data(), false);
+        }
+        if (hists[i] != ref) {
+            CAPTURE(i);
+            CHECK(hists[i] == ref);
+        }
+    }
+}
+
+TEST_CASE("batch histograms of 8-bit images") {
+    std::vector<u8> const a{1, 2, 3, 4};
+    std::vector<u8> const b{5, 5, 255};
+    std::vector<u8> const b_mask{1, 0, 1};
+    std::vector<ihist_tile8> const images{
+        {a.data(), nullptr, 2, 2, 2, 0},
+        {b.data(), b_mask.data(), 1, 3, 3, 3},
+    };
+    std::vector<u32> ha(256);
+    std::vector<u32> hb(256);
+    std::vector<u32 *> const hists{ha.data(), hb.data()};
+    std::size_t const index = 0;
+    ihist_hist8_2d_batch(8, 2, images.data(), 1, 1, &index, hists.data(),
+                         true);
+    CHECK(ha[1] == 1);
+    CHECK(ha[4] == 1);
+    CHECK(hb[5] == 1);
+    CHECK(hb[255] == 1);
+    CHECK(ha[5] + hb[1] == 0);
+}
@@ -0,0 +1,180 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "output.hpp"
+#include "tiff.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using ihist::cli::output_format;
+using ihist::cli::parse_tiff;
+
+namespace {
+
+// Minimal little- or big-endian classic TIFF writer for one page of 16-bit
+// samples with RowsPerStrip rows per strip; entries are (tag, value) with all
+// values stored as LONG.
+class tiff_builder {
+  public:
+    explicit tiff_builder(bool big_endian) : big_endian_(big_endian) {
+        auto const order =
+            static_cast<unsigned char>(big_endian ? 'M' : 'I');
+        bytes_ = {order, order};
+        put(42, 2);
+        put(0, 4); // First IFD offset, patched in finish()
+    }
+
+    auto add_strip(std::size_t n_bytes) -> std::uint32_t {
+        auto const offset = static_cast<std::uint32_t>(bytes_.size());
+        bytes_.resize(bytes_.size() + n_bytes, '\0');
+        return offset;
+    }
+
+    using entry = std::pair<std::uint16_t, std::vector<std::uint32_t>>;
+
+    auto finish(std::vector<entry> const &entries)
+        -> std::vector<unsigned char> {
+        // Arrays of more than one value go before the IFD.
+        std::vector<std::uint32_t> value_fields;
+        for (auto const &[tag, values] : entries) {
+            if (values.size() == 1) {
+                value_fields.push_back(values[0]);
+            } else {
+                value_fields.push_back(
+                    static_cast<std::uint32_t>(bytes_.size()));
+                for (std::uint32_t v : values) {
+                    put(v, 4);
+                }
+            }
+        }
+        auto const ifd = static_cast<std::uint32_t>(bytes_.size());
+        put(entries.size(), 2);
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            put(entries[i].first, 2);
+            put(4, 2);
+            put(entries[i].second.size(), 4);
+            put(value_fields[i], 4);
+        }
+        put(0, 4);
+        for (std::size_t i = 0; i < 4; ++i) {
+            bytes_[4 + i] = static_cast<unsigned char>(
+                ifd >> (big_endian_ ? 8 * (3 - i) : 8 * i));
+        }
+        return bytes_;
+    }
+
+  private:
+    void put(std::uint64_t v, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t const shift = big_endian_ ? 8 * (n - 1 - i) : 8 * i;
+            bytes_.push_back(static_cast<unsigned char>(v >> shift));
+        }
+    }
+
+    bool big_endian_;
+    std::vector<unsigned char> bytes_;
+};
+
+} // namespace
+
+TEST_CASE("tiff strips are located") {
+    bool const big_endian = GENERATE(false, true);
+    bool const planar = GENERATE(false, true);
+    CAPTURE(big_endian, planar);
+
+    // 5 x 3 pixels, 2 samples, 2 rows per strip.
+    tiff_builder b(big_endian);
+    std::size_t const strip_samples = planar ? 3 : 6;
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> counts;
+    for (std::size_t s = 0; s < (planar ? 6 : 3); ++s) {
+        std::size_t const rows = s % 3 == 2 ? 1 : 2;
+        offsets.push_back(b.add_strip(rows * strip_samples * 2));
+        counts.push_back(static_cast<std::uint32_t>(rows * strip_samples * 2));
+    }
+    auto const data = b.finish({{256, {3}},
+                                {257, {5}},
+                                {258, {16, 16}},
+                                {259, {1}},
+                                {273, offsets},
+                                {277, {2}},
+                                {278, {2}},
+                                {279, counts},
+                                {284, {planar ? 2u : 1u}}});
+
+    auto const tiff = parse_tiff(data.data(), data.size());
+    CHECK(tiff.big_endian == big_endian);
+    REQUIRE(tiff.pages.size() == 1);
+    auto const &page = tiff.pages[0];
+    CHECK(page.width == 3);
+    CHECK(page.height == 5);
+    CHECK(page.bits_per_sample == 16);
+    CHECK(page.samples_per_pixel == 2);
+    CHECK(page.planar == planar);
+    REQUIRE(page.strips.size() == offsets.size());
+    for (std::size_t s = 0; s < offsets.size(); ++s) {
+        CHECK(page.strips[s].offset == offsets[s]);
+        CHECK(page.strips[s].rows == (s % 3 == 2 ? 1 : 2));
+        CHECK(page.strips[s].plane == (planar ? s / 3 : 0));
+    }
+}
+
+TEST_CASE("unsupported or truncated tiff is rejected") {
+    tiff_builder b(false);
+    auto const offset = b.add_strip(8);
+    std::uint32_t const compression = GENERATE(1u, 5u);
+    std::uint32_t const byte_count = GENERATE(8u, 6u);
+    std::uint32_t const height = GENERATE(2u, 100u);
+    CAPTURE(compression, byte_count, height);
+    auto const data = b.finish({{256, {2}},
+                                {257, {height}},
+                                {258, {16}},
+                                {259, {compression}},
+                                {273, {offset}},
+                                {279, {byte_count}}});
+    if (compression == 1 && byte_count == 8 && height == 2) {
+        CHECK(parse_tiff(data.data(), data.size()).pages.size() == 1);
+    } else {
+        CHECK_THROWS_AS(parse_tiff(data.data(), data.size()),
+                        std::runtime_error);
+    }
+    CHECK_THROWS_AS(parse_tiff(data.data(), 16), std::runtime_error);
+}
+
+TEST_CASE("histogram output formats") {
+    std::vector<std::uint64_t> const hist{1, 2, 3, 4, 5, 6, 7, 8};
+
+    std::ostringstream csv;
+    write_histogram(csv, output_format::csv, 2, 2, hist);
+    CHECK(csv.str() == "bin,c0,c1\n0,1,5\n1,2,6\n2,3,7\n3,4,8\n");
+
+    std::ostringstream json;
+    write_histogram(json, output_format::json, 3, 1, hist);
+    CHECK(json.str() == "{\"bits\":3,\"histogram\":[1,2,3,4,5,6,7,8]}\n");
+
+    std::ostringstream npy;
+    write_histogram(npy, output_format::npy, 2, 2, hist);
+    std::string const s = npy.str();
+    // The header is padded to 128 bytes.
+    REQUIRE(s.size() == 128 + 8 * 8);
+    CHECK(s.compare(0, 6, "\x93NUMPY") == 0);
+    CHECK(s[127] == '\n');
+    CHECK(s.find("'shape': (2, 4)") != std::string::npos);
+    CHECK(s[128 + 8] == 2);
+
+    CHECK(ihist::cli::parse_output_format("json") == output_format::json);
+    CHECK_THROWS_AS(ihist::cli::parse_output_format("tsv"),
+                    std::invalid_argument);
+}
@@ -6,7 +6,7 @@
 
 #include <ihist/ihist.h>
 
-#include "ihist.hpp"
+#include "ihist/ihist.hpp"
 
 #include "gen_data.hpp"
 
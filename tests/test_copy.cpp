@@ -0,0 +1,95 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+TEST_CASE("copy and histogram matches separate copy and histogram") {
+    auto const [width, height] = GENERATE(
+        table<std::size_t, std::size_t>({{65, 63}, {1024, 1100}, {1, 1}}));
+    auto const [n_components, indices] =
+        GENERATE(table<std::size_t, std::vector<std::size_t>>({
+            {1, {0}},
+            {3, {2, 0}},
+        }));
+    bool const use_mask = GENERATE(false, true);
+    bool const non_temporal = GENERATE(false, true);
+    bool const parallel = GENERATE(false, true);
+    CAPTURE(width, height, n_components, indices, use_mask, non_temporal,
+            parallel);
+
+    // Different row strides for source and destination, and an odd
+    // destination offset so that streaming stores start unaligned.
+    std::size_t const stride = width + 3;
+    std::size_t const dest_stride = width + 5;
+    std::size_t const n_hist = indices.size();
+    auto const mask = test_data<u8, 1>(height * stride);
+
+    SECTION("8-bit") {
+        auto const data = test_data<u8>(height * stride * n_components);
+        std::vector<u32> ref(n_hist << 8);
+        ihist_hist8_2d(8, data.data(), use_mask ? mask.data() : nullptr,
+                       height, width, stride, use_mask ? stride : 0,
+                       n_components, n_hist, indices.data(), ref.data(),
+                       false);
+        std::vector<u8> ref_dest(height * dest_stride * n_components + 1, 42);
+        for (std::size_t y = 0; y < height; ++y) {
+            for (std::size_t i = 0; i < width * n_components; ++i) {
+                ref_dest[1 + y * dest_stride * n_components + i] =
+                    data[y * stride * n_components + i];
+            }
+        }
+
+        std::vector<u32> hist(n_hist << 8);
+        std::vector<u8> dest(ref_dest.size(), 42);
+        ihist_hist8_2d_copy(8, data.data(), use_mask ? mask.data() : nullptr,
+                            height, width, stride, use_mask ? stride : 0,
+                            n_components, n_hist, indices.data(), hist.data(),
+                            dest.data() + 1, dest_stride, non_temporal,
+                            parallel);
+        CHECK(hist == ref);
+        CHECK(dest == ref_dest);
+    }
+
+    SECTION("16-bit") {
+        auto const data = test_data<u16, 12>(height * stride * n_components);
+        std::vector<u32> ref(n_hist << 12);
+        ihist_hist16_2d(12, data.data(), use_mask ? mask.data() : nullptr,
+                        height, width, stride, use_mask ? stride : 0,
+                        n_components, n_hist, indices.data(), ref.data(),
+                        false);
+        std::vector<u16> ref_dest(height * dest_stride * n_components + 1,
+                                  42);
+        for (std::size_t y = 0; y < height; ++y) {
+            for (std::size_t i = 0; i < width * n_components; ++i) {
+                ref_dest[1 + y * dest_stride * n_components + i] =
+                    data[y * stride * n_components + i];
+            }
+        }
+
+        std::vector<u32> hist(n_hist << 12);
+        std::vector<u16> dest(ref_dest.size(), 42);
+        ihist_hist16_2d_copy(
+            12, data.data(), use_mask ? mask.data() : nullptr, height, width,
+            stride, use_mask ? stride : 0, n_components, n_hist,
+            indices.data(), hist.data(), dest.data() + 1, dest_stride,
+            non_temporal, parallel);
+        CHECK(hist == ref);
+        CHECK(dest == ref_dest);
+    }
+}
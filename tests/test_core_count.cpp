@@ -4,7 +4,7 @@
  * SPDX-License-Identifier: MIT
  */
 
-#include "phys_core_count.hpp"
+#include "ihist/phys_core_count.hpp"
 
 #include <catch2/catch_test_macros.hpp>
 
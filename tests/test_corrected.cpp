@@ -0,0 +1,96 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+TEST_CASE("dark and gain corrected histogram matches corrected image") {
+    auto const [width, height] = GENERATE(
+        table<std::size_t, std::size_t>({{65, 63}, {1024, 1100}, {1, 1}}));
+    auto const [n_components, indices] =
+        GENERATE(table<std::size_t, std::vector<std::size_t>>({
+            {1, {0}},
+            {3, {2, 0}},
+        }));
+    auto const bits = GENERATE(std::size_t(16), std::size_t(12));
+    bool const use_dark = GENERATE(false, true);
+    bool const use_gain = GENERATE(false, true);
+    bool const use_mask = GENERATE(false, true);
+    bool const parallel = GENERATE(false, true);
+    CAPTURE(width, height, n_components, indices, bits, use_dark, use_gain,
+            use_mask, parallel);
+
+    std::size_t const stride = width + 3;
+    std::size_t const size = height * stride * n_components;
+    std::size_t const n_hist = indices.size();
+    std::size_t const gain_frac_bits = 12;
+    auto const data = test_data<u16>(size);
+    // Different seeds so that the planes are independent of the image.
+    auto const dark = generate_random_data<u16, 10>(size, 1);
+    // Gains between 0.5 and 1.5 (in units of 2^-12).
+    auto gain = generate_random_data<u16, 12>(size, 2);
+    for (auto &g : gain) {
+        g = static_cast<u16>(g + 2048);
+    }
+    auto const mask = test_data<u8, 1>(height * stride);
+
+    std::vector<u32> ref(n_hist << bits);
+    for (std::size_t y = 0; y < height; ++y) {
+        for (std::size_t x = 0; x < width; ++x) {
+            if (use_mask && mask[y * stride + x] == 0) {
+                continue;
+            }
+            for (std::size_t s = 0; s < n_hist; ++s) {
+                auto const i = (y * stride + x) * n_components + indices[s];
+                std::uint64_t v = data[i];
+                if (use_dark) {
+                    v = v > dark[i] ? v - dark[i] : 0;
+                }
+                if (use_gain) {
+                    v = (v * gain[i] + (1 << (gain_frac_bits - 1))) >>
+                        gain_frac_bits;
+                }
+                if (v >> bits == 0) {
+                    ++ref[(s << bits) + v];
+                }
+            }
+        }
+    }
+
+    std::vector<u32> hist(n_hist << bits);
+    ihist_hist16_2d_corrected(
+        bits, data.data(), use_mask ? mask.data() : nullptr, height, width,
+        stride, use_mask ? stride : 0, n_components, n_hist, indices.data(),
+        use_dark ? dark.data() : nullptr, use_gain ? gain.data() : nullptr,
+        gain_frac_bits, hist.data(), parallel);
+    CHECK(hist == ref);
+}
+
+TEST_CASE("dark subtraction clamps at zero") {
+    std::vector<u16> const image{10, 20, 30, 40};
+    std::vector<u16> const dark{15, 15, 15, 15};
+    std::vector<std::size_t> const indices{0};
+    std::vector<u32> hist(256);
+    ihist_hist16_2d_corrected(8, image.data(), nullptr, 1, 4, 4, 0, 1, 1,
+                              indices.data(), dark.data(), nullptr, 0,
+                              hist.data(), false);
+    CHECK(hist[0] == 1);
+    CHECK(hist[5] == 1);
+    CHECK(hist[15] == 1);
+    CHECK(hist[25] == 1);
+}
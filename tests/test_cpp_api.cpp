@@ -0,0 +1,169 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "ihist/ihist.hpp"
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+namespace {
+
+constexpr std::size_t width = 65;
+constexpr std::size_t height = 63;
+constexpr std::size_t roi_x = 7;
+constexpr std::size_t roi_y = 5;
+constexpr std::size_t roi_width = 33;
+constexpr std::size_t roi_height = 29;
+
+constexpr ihist::tuning_parameters tuning_2x8{2, 8};
+
+static_assert(ihist::mono<u8>::histogram_size == 256);
+static_assert(ihist::abcx<u16, 12>::n_hist_components == 3);
+static_assert(ihist::abcx<u16, 12>::histogram_size == 3 * 4096);
+static_assert(ihist::xabc<u8>::samples_per_pixel == 4);
+static_assert(ihist::xabc<u8>::sample_indices[0] == 1);
+static_assert(ihist::default_tuning<ihist::mono<u8>>.n_stripes == 4);
+static_assert(ihist::default_tuning<ihist::abc<u8>>.n_stripes == 1);
+
+// Reference result from the C API, over the ROI.
+template <typename Format>
+void c_api_hist(std::vector<typename Format::sample_type> const &image,
+                u8 const *mask, std::vector<u32> &hist,
+                std::vector<u32> &overflow) {
+    using T = typename Format::sample_type;
+    constexpr auto spp = Format::samples_per_pixel;
+    auto const &indices = Format::sample_indices;
+    T const *roi = image.data() + (roi_y * width + roi_x) * spp;
+    u8 const *roi_mask = mask ? mask + roi_y * width + roi_x : nullptr;
+    if constexpr (sizeof(T) == 1) {
+        ihist_hist8_2d_overflow(Format::bits, roi, roi_mask, roi_height,
+                                roi_width, width, width, spp, indices.size(),
+                                indices.data(), hist.data(), overflow.data(),
+                                false);
+    } else {
+        ihist_hist16_2d_overflow(Format::bits, roi, roi_mask, roi_height,
+                                 roi_width, width, width, spp, indices.size(),
+                                 indices.data(), hist.data(), overflow.data(),
+                                 false);
+    }
+}
+
+} // namespace
+
+using cpp_api_formats =
+    std::tuple<ihist::mono<u8>, ihist::mono<u16, 12>, ihist::mono<u16>,
+               ihist::abc<u8>, ihist::xabc<u8>, ihist::abcx<u16, 10>>;
+
+TEMPLATE_LIST_TEST_CASE("C++ API matches C API", "", cpp_api_formats) {
+    using Format = TestType;
+    using T = typename Format::sample_type;
+    constexpr auto spp = Format::samples_per_pixel;
+    constexpr auto n_comps = Format::n_hist_components;
+
+    // Full-range data, so that there are out-of-range samples when Bits is
+    // less than the type's width.
+    auto const image = test_data<T>(width * height * spp);
+    auto const mask_data = test_data<u8, 1>(width * height);
+    bool const use_mask = GENERATE(false, true);
+    bool const mt = GENERATE(false, true);
+    u8 const *mask = use_mask ? mask_data.data() : nullptr;
+
+    std::vector<u32> expected(Format::histogram_size, 3);
+    std::vector<u32> expected_overflow(n_comps, 5);
+    c_api_hist<Format>(image, mask, expected, expected_overflow);
+
+    typename Format::view_type const frame(image.data(), height, width);
+    auto const roi = frame.subview(roi_y, roi_x, roi_height, roi_width);
+    ihist::mask_view const frame_mask(mask_data.data(), height, width);
+    auto const roi_mask =
+        frame_mask.subview(roi_y, roi_x, roi_height, roi_width);
+
+    std::vector<u32> hist(Format::histogram_size, 3);
+    std::vector<u32> overflow(n_comps, 5);
+    if (mt) {
+        // Small grain size to exercise the per-thread reduction.
+        if (use_mask) {
+            ihist::histogram_mt<Format>(roi, roi_mask, hist.data(),
+                                        overflow.data(), 64);
+        } else {
+            ihist::histogram_mt<Format>(roi, hist.data(), overflow.data(),
+                                        64);
+        }
+    } else {
+        if (use_mask) {
+            ihist::histogram<Format>(roi, roi_mask, hist.data(),
+                                     overflow.data());
+        } else {
+            ihist::histogram<Format>(roi, hist.data(), overflow.data());
+        }
+    }
+    CHECK(hist == expected);
+    CHECK(overflow == expected_overflow);
+
+    // Without overflow counts.
+    std::vector<u32> hist2(Format::histogram_size, 3);
+    if (mt) {
+        ihist::histogram_mt<Format>(roi, hist2.data());
+    } else {
+        ihist::histogram<Format>(roi, hist2.data());
+    }
+    std::vector<u32> unmasked(Format::histogram_size, 3);
+    std::vector<u32> unmasked_overflow(n_comps, 0);
+    c_api_hist<Format>(image, nullptr, unmasked, unmasked_overflow);
+    CHECK(hist2 == unmasked);
+}
+
+TEST_CASE("C++ API custom tuning") {
+    using Format = ihist::mono<u16, 12>;
+    auto const image = test_data<u16, 12>(width * height);
+    Format::view_type const view(image.data(), height, width);
+
+    std::vector<u32> expected(Format::histogram_size);
+    ihist::histogram<Format>(view, expected.data());
+
+    std::vector<u32> hist(Format::histogram_size);
+    ihist::histogram<Format, tuning_2x8>(view, hist.data());
+    CHECK(hist == expected);
+
+    std::vector<u32> hist_mt(Format::histogram_size);
+    ihist::histogram_mt<Format, tuning_2x8>(view, hist_mt.data(), nullptr,
+                                            1000);
+    CHECK(hist_mt == expected);
+}
+
+TEST_CASE("image_view") {
+    std::vector<u16> const data(4 * 10 * 3);
+    ihist::image_view<u16, 3> const view(data.data(), 4, 8, 10);
+    CHECK(view.height() == 4);
+    CHECK(view.width() == 8);
+    CHECK(view.stride() == 10);
+
+    auto const sub = view.subview(1, 2, 3, 5);
+    CHECK(sub.data() == data.data() + (1 * 10 + 2) * 3);
+    CHECK(sub.height() == 3);
+    CHECK(sub.width() == 5);
+    CHECK(sub.stride() == 10);
+
+    ihist::mask_view const packed(nullptr, 3, 7);
+    CHECK(packed.stride() == 7);
+
+    constexpr ihist::mask_view empty;
+    static_assert(empty.data() == nullptr && empty.height() == 0);
+}
@@ -0,0 +1,102 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+TEST_CASE("derived max and mean histograms match a derived image") {
+    auto const [width, height] = GENERATE(
+        table<std::size_t, std::size_t>({{65, 63}, {1024, 1100}, {1, 1}}));
+    auto const [n_components, rgb] =
+        GENERATE(table<std::size_t, std::vector<std::size_t>>({
+            {3, {0, 1, 2}},
+            {4, {2, 1, 0}},
+        }));
+    auto const bits = GENERATE(std::size_t(16), std::size_t(12));
+    bool const use_mask = GENERATE(false, true);
+    bool const parallel = GENERATE(false, true);
+    CAPTURE(width, height, n_components, rgb, bits, use_mask, parallel);
+
+    std::size_t const stride = width + 3;
+    auto const data = test_data<u16>(height * stride * n_components);
+    auto const mask = test_data<u8, 1>(height * stride);
+    std::vector<std::size_t> const indices{1};
+    std::vector<ihist_derived_channel> const derived{IHIST_DERIVED_MAX,
+                                                     IHIST_DERIVED_MEAN};
+
+    // Reference: histogram an image of (G, max, mean) pixels.
+    std::vector<u16> expanded(height * stride * 3);
+    for (std::size_t p = 0; p < height * stride; ++p) {
+        u16 const *px = data.data() + p * n_components;
+        u32 const r = px[rgb[0]];
+        u32 const g = px[rgb[1]];
+        u32 const b = px[rgb[2]];
+        expanded[p * 3] = px[indices[0]];
+        expanded[p * 3 + 1] = static_cast<u16>(std::max({r, g, b}));
+        expanded[p * 3 + 2] = static_cast<u16>((r + g + b) / 3);
+    }
+    std::vector<std::size_t> const ref_indices{0, 1, 2};
+    std::vector<u32> ref(3 << bits);
+    ihist_hist16_2d(bits, expanded.data(), use_mask ? mask.data() : nullptr,
+                    height, width, stride, use_mask ? stride : 0, 3, 3,
+                    ref_indices.data(), ref.data(), false);
+
+    std::vector<u32> hist(3 << bits);
+    ihist_hist16_2d_derived(bits, data.data(),
+                            use_mask ? mask.data() : nullptr, height, width,
+                            stride, use_mask ? stride : 0, n_components, 1,
+                            indices.data(), rgb.data(), derived.size(),
+                            derived.data(), hist.data(), parallel);
+    CHECK(hist == ref);
+}
+
+TEST_CASE("derived luma values") {
+    std::vector<std::size_t> const rgb{0, 1, 2};
+    std::vector<ihist_derived_channel> const derived{IHIST_DERIVED_LUMA_709,
+                                                     IHIST_DERIVED_LUMA_601};
+
+    SECTION("gray pixels map to themselves") {
+        std::vector<u8> image;
+        for (std::size_t v = 0; v < 256; ++v) {
+            image.insert(image.end(), 3, static_cast<u8>(v));
+        }
+        std::vector<u32> hist(2 * 256);
+        ihist_hist8_2d_derived(8, image.data(), nullptr, 1, 256, 256, 0, 3, 0,
+                               nullptr, rgb.data(), derived.size(),
+                               derived.data(), hist.data(), false);
+        CHECK(std::all_of(hist.begin(), hist.end(),
+                          [](u32 c) { return c == 1; }));
+    }
+
+    SECTION("primaries") {
+        std::vector<u8> const image{255, 0, 0, 0, 255, 0, 0, 0, 255};
+        std::vector<u32> hist(2 * 256);
+        ihist_hist8_2d_derived(8, image.data(), nullptr, 1, 3, 3, 0, 3, 0,
+                               nullptr, rgb.data(), derived.size(),
+                               derived.data(), hist.data(), false);
+        // Rec. 709: 54.2, 182.4, 18.4
+        CHECK(hist[54] == 1);
+        CHECK(hist[182] == 1);
+        CHECK(hist[18] == 1);
+        // Rec. 601: 76.2, 149.7, 29.1
+        CHECK(hist[256 + 76] == 1);
+        CHECK(hist[256 + 150] == 1);
+        CHECK(hist[256 + 29] == 1);
+    }
+}
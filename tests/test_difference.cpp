@@ -0,0 +1,120 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+namespace {
+
+template <typename T>
+void hist_difference(std::size_t bits, T const *image, T const *previous,
+                     u8 const *mask, std::size_t height, std::size_t width,
+                     std::size_t stride, std::size_t n_components,
+                     std::vector<std::size_t> const &indices,
+                     ihist_difference_mode mode, u32 *histogram,
+                     bool parallel) {
+    if constexpr (std::is_same_v<T, u8>) {
+        ihist_hist8_2d_difference(bits, image, previous, mask, height, width,
+                                  stride, mask == nullptr ? 0 : stride,
+                                  n_components, indices.size(),
+                                  indices.data(), mode, histogram, parallel);
+    } else {
+        ihist_hist16_2d_difference(bits, image, previous, mask, height, width,
+                                   stride, mask == nullptr ? 0 : stride,
+                                   n_components, indices.size(),
+                                   indices.data(), mode, histogram, parallel);
+    }
+}
+
+} // namespace
+
+TEMPLATE_TEST_CASE("frame difference histogram matches difference image", "",
+                   u8, u16) {
+    using T = TestType;
+    auto const [width, height] = GENERATE(
+        table<std::size_t, std::size_t>({{65, 63}, {1024, 1100}, {1, 1}}));
+    auto const [n_components, indices] =
+        GENERATE(table<std::size_t, std::vector<std::size_t>>({
+            {1, {0}},
+            {3, {2, 0}},
+        }));
+    // One bit short of full width takes a different scratch type than two
+    // bits short for signed differences.
+    auto const bits =
+        GENERATE(std::size_t(8 * sizeof(T)), std::size_t(8 * sizeof(T) - 1),
+                 std::size_t(8 * sizeof(T) - 2));
+    auto const mode =
+        GENERATE(IHIST_DIFFERENCE_ABSOLUTE, IHIST_DIFFERENCE_SIGNED);
+    bool const use_mask = GENERATE(false, true);
+    bool const parallel = GENERATE(false, true);
+    CAPTURE(width, height, n_components, indices, bits, mode, use_mask,
+            parallel);
+
+    std::size_t const stride = width + 3;
+    std::size_t const size = height * stride * n_components;
+    std::size_t const n_hist = indices.size();
+    bool const is_signed = mode == IHIST_DIFFERENCE_SIGNED;
+    std::size_t const hist_bits = is_signed ? bits + 1 : bits;
+    auto const image = test_data<T>(size);
+    auto const previous = generate_random_data<T>(size, 1);
+    auto const mask = test_data<u8, 1>(height * stride);
+
+    std::vector<u32> ref(n_hist << hist_bits);
+    for (std::size_t y = 0; y < height; ++y) {
+        for (std::size_t x = 0; x < width; ++x) {
+            if (use_mask && mask[y * stride + x] == 0) {
+                continue;
+            }
+            for (std::size_t s = 0; s < n_hist; ++s) {
+                auto const i = (y * stride + x) * n_components + indices[s];
+                std::int64_t const a = image[i];
+                std::int64_t const b = previous[i];
+                if ((a >> bits) != 0 || (b >> bits) != 0) {
+                    continue;
+                }
+                std::int64_t const d =
+                    is_signed ? a - b + (std::int64_t(1) << bits)
+                              : (a > b ? a - b : b - a);
+                ++ref[(s << hist_bits) + static_cast<std::size_t>(d)];
+            }
+        }
+    }
+
+    std::vector<u32> hist(n_hist << hist_bits);
+    hist_difference<T>(bits, image.data(), previous.data(),
+                       use_mask ? mask.data() : nullptr, height, width,
+                       stride, n_components, indices, mode, hist.data(),
+                       parallel);
+    CHECK(hist == ref);
+}
+
+TEST_CASE("signed frame difference bins") {
+    std::vector<u8> const image{0, 5, 255, 7};
+    std::vector<u8> const previous{255, 5, 0, 3};
+    std::vector<std::size_t> const indices{0};
+    std::vector<u32> hist(512);
+    ihist_hist8_2d_difference(8, image.data(), previous.data(), nullptr, 1, 4,
+                              4, 0, 1, 1, indices.data(),
+                              IHIST_DIFFERENCE_SIGNED, hist.data(), false);
+    CHECK(hist[256 - 255] == 1);
+    CHECK(hist[256] == 1);
+    CHECK(hist[256 + 255] == 1);
+    CHECK(hist[256 + 4] == 1);
+}
@@ -0,0 +1,111 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+TEST_CASE("fused histogram and LUT matches separate passes") {
+    auto const [width, height] = GENERATE(
+        table<std::size_t, std::size_t>({{65, 63}, {1024, 1100}, {1, 1}}));
+    auto const [n_components, indices] =
+        GENERATE(table<std::size_t, std::vector<std::size_t>>({
+            {1, {0}},
+            {3, {2, 0}},
+        }));
+    auto const bits = GENERATE(std::size_t(16), std::size_t(12));
+    bool const use_mask = GENERATE(false, true);
+    bool const parallel = GENERATE(false, true);
+    CAPTURE(width, height, n_components, indices, bits, use_mask, parallel);
+
+    // Extra row stride for the image, mask, and output.
+    std::size_t const stride = width + 3;
+    std::size_t const n_hist = indices.size();
+    auto const data = test_data<u16>(height * stride * n_components);
+    auto const mask = test_data<u8, 1>(height * stride);
+    std::vector<u8> lut(std::size_t(1) << bits);
+    for (std::size_t v = 0; v < lut.size(); ++v) {
+        lut[v] = static_cast<u8>(v * 7 + 3);
+    }
+
+    std::vector<u32> ref(n_hist << bits);
+    ihist_hist16_2d(bits, data.data(), use_mask ? mask.data() : nullptr,
+                    height, width, stride, use_mask ? stride : 0,
+                    n_components, n_hist, indices.data(), ref.data(), false);
+    std::vector<u8> ref_out(height * stride * n_components, 42);
+    for (std::size_t y = 0; y < height; ++y) {
+        for (std::size_t i = 0; i < width * n_components; ++i) {
+            auto const j = y * stride * n_components + i;
+            ref_out[j] = lut[std::min<std::size_t>(data[j], lut.size() - 1)];
+        }
+    }
+
+    std::vector<u32> hist(n_hist << bits, 1);
+    std::vector<u8> out(height * stride * n_components, 42);
+    ihist_hist16_2d_lut8(bits, data.data(), use_mask ? mask.data() : nullptr,
+                         height, width, stride, use_mask ? stride : 0,
+                         n_components, n_hist, indices.data(), hist.data(),
+                         lut.data(), out.data(), stride, parallel);
+    // The histogram is accumulated.
+    std::transform(ref.begin(), ref.end(), ref.begin(),
+                   [](u32 c) { return c + 1; });
+    CHECK(hist == ref);
+    CHECK(out == ref_out);
+}
+
+TEST_CASE("window LUT") {
+    std::vector<u8> lut(256);
+
+    SECTION("ramp") {
+        ihist_window_lut8(8, 10, 20, lut.data());
+        CHECK(lut[0] == 0);
+        CHECK(lut[10] == 0);
+        CHECK(lut[15] == 128);
+        CHECK(lut[20] == 255);
+        CHECK(lut[255] == 255);
+        CHECK(std::is_sorted(lut.begin(), lut.end()));
+    }
+    SECTION("identity") {
+        ihist_window_lut8(8, 0, 255, lut.data());
+        for (std::size_t v = 0; v < 256; ++v) {
+            CHECK(lut[v] == v);
+        }
+    }
+    SECTION("step") {
+        ihist_window_lut8(8, 100, 100, lut.data());
+        CHECK(lut[100] == 0);
+        CHECK(lut[101] == 255);
+    }
+}
+
+TEST_CASE("auto-contrast LUT uses histogram quantiles") {
+    std::vector<u32> hist(4096);
+    hist[100] = 1;
+    hist[200] = 98;
+    hist[3000] = 1;
+    std::vector<u8> lut(4096);
+    ihist_auto_contrast_lut8(12, hist.data(), 0.02, 0.98, lut.data());
+    // Both quantiles fall in bin 200: a step at 200.
+    CHECK(lut[200] == 0);
+    CHECK(lut[201] == 255);
+
+    ihist_auto_contrast_lut8(12, hist.data(), 0.0, 1.0, lut.data());
+    CHECK(lut[100] == 0);
+    CHECK(lut[1550] == 128);
+    CHECK(lut[3000] == 255);
+}
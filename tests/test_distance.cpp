@@ -0,0 +1,205 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+namespace {
+
+constexpr std::size_t bits = 10;
+constexpr std::size_t nbins = std::size_t{1} << bits;
+
+auto make_hist(std::size_t n_hist, std::size_t n_pixels, std::size_t seed)
+    -> std::vector<u32> {
+    // Offset the test data so that different seeds give different histograms.
+    auto data = test_data<u16, bits>(n_hist * n_pixels + seed);
+    data.erase(data.begin(), data.begin() + static_cast<long>(seed));
+    std::vector<u32> hist(n_hist * nbins);
+    for (std::size_t i = 0; i < n_pixels; ++i) {
+        for (std::size_t s = 0; s < n_hist; ++s) {
+            ++hist[s * nbins + data[i * n_hist + s]];
+        }
+    }
+    return hist;
+}
+
+// Straightforward reference implementations.
+auto reference_distance(ihist_distance_metric metric, u32 const *a,
+                        u32 const *b) -> double {
+    double na = 0, nb = 0;
+    for (std::size_t i = 0; i < nbins; ++i) {
+        na += a[i];
+        nb += b[i];
+    }
+    double result = 0.0;
+    double cdf_a = 0.0, cdf_b = 0.0;
+    for (std::size_t i = 0; i < nbins; ++i) {
+        double const p = a[i] / na;
+        double const q = b[i] / nb;
+        switch (metric) {
+        case IHIST_DISTANCE_CHI_SQUARE:
+            if (p + q > 0) {
+                result += (p - q) * (p - q) / (p + q);
+            }
+            break;
+        case IHIST_DISTANCE_BHATTACHARYYA:
+            result += std::sqrt(p * q);
+            break;
+        case IHIST_DISTANCE_INTERSECTION:
+            result += std::min(p, q);
+            break;
+        case IHIST_DISTANCE_EMD:
+            cdf_a += p;
+            cdf_b += q;
+            result += std::abs(cdf_a - cdf_b);
+            break;
+        case IHIST_DISTANCE_KL_DIVERGENCE:
+            if (p > 0) {
+                result += p * std::log2(p / q);
+            }
+            break;
+        }
+    }
+    if (metric == IHIST_DISTANCE_BHATTACHARYYA) {
+        return std::sqrt(std::max(0.0, 1.0 - result));
+    }
+    if (metric == IHIST_DISTANCE_INTERSECTION) {
+        return 1.0 - result;
+    }
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("histogram distance matches reference") {
+    auto const metric = GENERATE(
+        IHIST_DISTANCE_CHI_SQUARE, IHIST_DISTANCE_BHATTACHARYYA,
+        IHIST_DISTANCE_INTERSECTION, IHIST_DISTANCE_EMD,
+        IHIST_DISTANCE_KL_DIVERGENCE);
+    CAPTURE(metric);
+
+    // Many samples per bin, so that no bin of b is empty (for KL).
+    auto const a = make_hist(3, 100000, 0);
+    auto const b = make_hist(3, 100000, 1);
+    REQUIRE(std::find(b.begin(), b.end(), 0u) == b.end());
+
+    std::vector<double> dist(3);
+    ihist_histogram_distance(bits, 3, a.data(), b.data(), metric,
+                             dist.data());
+    for (std::size_t s = 0; s < 3; ++s) {
+        auto const expected =
+            reference_distance(metric, a.data() + s * nbins,
+                               b.data() + s * nbins);
+        CAPTURE(s, expected, dist[s]);
+        CHECK(std::abs(dist[s] - expected) <= 1e-9 * (1.0 + expected));
+        CHECK(dist[s] > 0.0);
+    }
+
+    std::vector<double> self(3);
+    ihist_histogram_distance(bits, 3, a.data(), a.data(), metric,
+                             self.data());
+    for (double const d : self) {
+        CHECK(std::abs(d) < 1e-6);
+    }
+}
+
+TEST_CASE("histogram distance is normalized") {
+    auto const metric = GENERATE(
+        IHIST_DISTANCE_CHI_SQUARE, IHIST_DISTANCE_BHATTACHARYYA,
+        IHIST_DISTANCE_INTERSECTION, IHIST_DISTANCE_EMD,
+        IHIST_DISTANCE_KL_DIVERGENCE);
+    CAPTURE(metric);
+    auto const a = make_hist(1, 5000, 0);
+    auto b = a;
+    for (auto &c : b) {
+        c *= 3;
+    }
+    double dist = -1.0;
+    ihist_histogram_distance(bits, 1, a.data(), b.data(), metric, &dist);
+    CHECK(std::abs(dist) < 1e-6);
+}
+
+TEST_CASE("histogram distance special cases") {
+    std::vector<u32> a(16);
+    std::vector<u32> b(16);
+    a[2] = 10;
+    b[5] = 10;
+    double dist = 0.0;
+
+    SECTION("disjoint") {
+        ihist_histogram_distance(4, 1, a.data(), b.data(),
+                                 IHIST_DISTANCE_CHI_SQUARE, &dist);
+        CHECK(dist == 2.0);
+        ihist_histogram_distance(4, 1, a.data(), b.data(),
+                                 IHIST_DISTANCE_BHATTACHARYYA, &dist);
+        CHECK(dist == 1.0);
+        ihist_histogram_distance(4, 1, a.data(), b.data(),
+                                 IHIST_DISTANCE_INTERSECTION, &dist);
+        CHECK(dist == 1.0);
+        ihist_histogram_distance(4, 1, a.data(), b.data(), IHIST_DISTANCE_EMD,
+                                 &dist);
+        CHECK(dist == 3.0);
+        ihist_histogram_distance(4, 1, a.data(), b.data(),
+                                 IHIST_DISTANCE_KL_DIVERGENCE, &dist);
+        CHECK(std::isinf(dist));
+    }
+    SECTION("empty") {
+        std::vector<u32> const empty(16);
+        ihist_histogram_distance(4, 1, a.data(), empty.data(),
+                                 IHIST_DISTANCE_EMD, &dist);
+        CHECK(std::isnan(dist));
+        dist = 0.0;
+        ihist_histogram_distance(4, 1, empty.data(), a.data(),
+                                 IHIST_DISTANCE_CHI_SQUARE, &dist);
+        CHECK(std::isnan(dist));
+    }
+}
+
+TEST_CASE("batch histogram distance matches pairwise") {
+    auto const metric = GENERATE(
+        IHIST_DISTANCE_CHI_SQUARE, IHIST_DISTANCE_BHATTACHARYYA,
+        IHIST_DISTANCE_INTERSECTION, IHIST_DISTANCE_EMD,
+        IHIST_DISTANCE_KL_DIVERGENCE);
+    bool const parallel = GENERATE(false, true);
+    CAPTURE(metric, parallel);
+
+    constexpr std::size_t n_hist = 2;
+    // Enough references to take the parallel path.
+    constexpr std::size_t n_refs = 600;
+    auto const query = make_hist(n_hist, 3000, 0);
+    std::vector<u32> refs;
+    for (std::size_t r = 0; r < n_refs; ++r) {
+        auto const h = make_hist(n_hist, 200, r % 7 + 1);
+        refs.insert(refs.end(), h.begin(), h.end());
+    }
+
+    std::vector<double> batch(n_refs * n_hist);
+    ihist_histogram_distance_batch(bits, n_hist, query.data(), n_refs,
+                                   refs.data(), metric, batch.data(),
+                                   parallel);
+    for (std::size_t r = 0; r < n_refs; ++r) {
+        std::vector<double> pair(n_hist);
+        ihist_histogram_distance(bits, n_hist, query.data(),
+                                 refs.data() + r * n_hist * nbins, metric,
+                                 pair.data());
+        CAPTURE(r);
+        CHECK(batch[r * n_hist] == pair[0]);
+        CHECK(batch[r * n_hist + 1] == pair[1]);
+    }
+}
@@ -4,7 +4,7 @@
  * SPDX-License-Identifier: MIT
  */
 
-#include <ihist.hpp>
+#include <ihist/ihist.hpp>
 
 #include "gen_data.hpp"
 #include "parameterization.hpp"
@@ -0,0 +1,125 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+namespace {
+
+constexpr std::size_t width = 65;
+constexpr std::size_t height = 63;
+
+// Reference: histogram of the top 'level_bits' of each in-range sample.
+template <typename T>
+auto reference_level(std::vector<T> const &data, std::vector<u8> const &mask,
+                     std::size_t sample_bits, std::size_t level_bits,
+                     std::size_t n_components,
+                     std::vector<std::size_t> const &indices)
+    -> std::vector<u32> {
+    std::vector<u32> hist(indices.size() << level_bits);
+    for (std::size_t j = 0; j < width * height; ++j) {
+        if (mask[j] == 0) {
+            continue;
+        }
+        for (std::size_t s = 0; s < indices.size(); ++s) {
+            std::size_t const v = data[j * n_components + indices[s]];
+            if (v >> sample_bits == 0) {
+                ++hist[(s << level_bits) + (v >> (sample_bits - level_bits))];
+            }
+        }
+    }
+    return hist;
+}
+
+} // namespace
+
+TEST_CASE("multires 16-bit histogram levels") {
+    auto const sample_bits = GENERATE(std::size_t(16), std::size_t(12));
+    auto const [n_components, indices] =
+        GENERATE(table<std::size_t, std::vector<std::size_t>>({
+            {1, {0}},
+            {3, {0, 1, 2}},
+            {4, {3, 0}},
+        }));
+    bool const parallel = GENERATE(false, true);
+    CAPTURE(sample_bits, n_components, indices, parallel);
+
+    auto const data = test_data<u16>(width * height * n_components);
+    auto const mask = test_data<u8, 1>(width * height);
+    std::size_t const n_hist = indices.size();
+
+    // Deliberately unsorted, including the full resolution.
+    std::vector<std::size_t> const level_bits{8, sample_bits, 4, 10};
+    std::vector<std::vector<u32>> levels;
+    std::vector<u32 *> level_ptrs;
+    for (auto const b : level_bits) {
+        levels.emplace_back(n_hist << b, 12345);
+    }
+    for (auto &lv : levels) {
+        level_ptrs.push_back(lv.data());
+    }
+
+    std::vector<u32> hist(n_hist << sample_bits);
+    ihist_hist16_2d_multires(sample_bits, data.data(), mask.data(), height,
+                             width, width, width, n_components, n_hist,
+                             indices.data(), hist.data(), level_bits.size(),
+                             level_bits.data(), level_ptrs.data(), parallel);
+
+    CHECK(hist == reference_level(data, mask, sample_bits, sample_bits,
+                                  n_components, indices));
+    for (std::size_t i = 0; i < level_bits.size(); ++i) {
+        CAPTURE(level_bits[i]);
+        CHECK(levels[i] == reference_level(data, mask, sample_bits,
+                                           level_bits[i], n_components,
+                                           indices));
+    }
+}
+
+TEST_CASE("multires 8-bit histogram levels reflect accumulated histogram") {
+    auto const data = test_data<u8>(width * height);
+    std::vector<u8> const mask(width * height, 1);
+    constexpr std::size_t indices[] = {0};
+    std::size_t const level_bits[] = {2};
+    std::vector<u32> coarse(4);
+    u32 *const level_ptrs[] = {coarse.data()};
+
+    std::vector<u32> hist(256);
+    for (int rep = 0; rep < 2; ++rep) {
+        ihist_hist8_2d_multires(8, data.data(), nullptr, height, width, width,
+                                width, 1, 1, indices, hist.data(), 1,
+                                level_bits, level_ptrs, false);
+    }
+    auto expected = reference_level(data, mask, 8, 2, 1, {0});
+    for (auto &c : expected) {
+        c *= 2;
+    }
+    CHECK(coarse == expected);
+}
+
+TEST_CASE("rebin histogram") {
+    std::vector<u32> hist(2 * 16);
+    for (std::size_t i = 0; i < hist.size(); ++i) {
+        hist[i] = static_cast<u32>(i);
+    }
+    std::vector<u32> coarse(2 * 4);
+    ihist_histogram_rebin(4, 2, hist.data(), 2, coarse.data());
+    CHECK(coarse == std::vector<u32>{6, 22, 38, 54, 70, 86, 102, 118});
+    std::vector<u32> single(2);
+    ihist_histogram_rebin(4, 2, hist.data(), 0, single.data());
+    CHECK(single == std::vector<u32>{120, 376});
+}
@@ -0,0 +1,230 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "ihist/ihist.hpp"
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+namespace {
+
+constexpr std::size_t width = 65;
+constexpr std::size_t height = 63;
+constexpr std::size_t roi_x = 7;
+constexpr std::size_t roi_y = 5;
+constexpr std::size_t roi_width = 33;
+constexpr std::size_t roi_height = 29;
+constexpr std::size_t size = width * height;
+
+constexpr ihist::tuning_parameters tuning_4x4{4, 4};
+
+template <typename T, unsigned SampleBits>
+void call_api_overflow(T const *image, u8 const *mask, std::size_t h,
+                       std::size_t w, std::size_t image_stride,
+                       std::size_t mask_stride, std::size_t n_components,
+                       std::size_t n_hist_components,
+                       std::size_t const *component_indices, u32 *histogram,
+                       u32 *overflow, bool parallel) {
+    if constexpr (sizeof(T) == 1) {
+        ihist_hist8_2d_overflow(SampleBits, image, mask, h, w, image_stride,
+                                mask_stride, n_components, n_hist_components,
+                                component_indices, histogram, overflow,
+                                parallel);
+    } else {
+        ihist_hist16_2d_overflow(SampleBits, image, mask, h, w, image_stride,
+                                 mask_stride, n_components, n_hist_components,
+                                 component_indices, histogram, overflow,
+                                 parallel);
+    }
+}
+
+// Reference: histogram (dropping out-of-range values) and overflow counts
+// over the ROI, honoring the mask.
+template <typename T>
+void reference_hist_overflow(std::vector<T> const &data,
+                             std::vector<u8> const &mask,
+                             std::size_t sample_bits, std::size_t n_components,
+                             std::vector<std::size_t> const &indices,
+                             std::vector<u32> &hist,
+                             std::vector<u32> &overflow) {
+    std::size_t const nbins = std::size_t{1} << sample_bits;
+    for (std::size_t y = roi_y; y < roi_y + roi_height; ++y) {
+        for (std::size_t x = roi_x; x < roi_x + roi_width; ++x) {
+            auto const j = y * width + x;
+            if (mask[j] == 0) {
+                continue;
+            }
+            for (std::size_t s = 0; s < indices.size(); ++s) {
+                auto const v = data[j * n_components + indices[s]];
+                if (v < nbins) {
+                    ++hist[s * nbins + v];
+                } else {
+                    ++overflow[s];
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+template <typename T, unsigned SampleBits> struct overflow_test_traits {
+    using value_type = T;
+    static constexpr unsigned sample_bits = SampleBits;
+};
+
+using overflow_test_traits_list =
+    std::tuple<overflow_test_traits<u8, 8>, overflow_test_traits<u8, 5>,
+               overflow_test_traits<u16, 16>, overflow_test_traits<u16, 15>,
+               overflow_test_traits<u16, 12>, overflow_test_traits<u16, 11>>;
+
+TEMPLATE_LIST_TEST_CASE("C API overflow counts out-of-range samples", "",
+                        overflow_test_traits_list) {
+    using T = typename TestType::value_type;
+    constexpr auto sample_bits = TestType::sample_bits;
+    constexpr std::size_t nbins = std::size_t{1} << sample_bits;
+
+    // Mono, abc, abcx, xabc (static paths), and a dynamic combination.
+    auto const [n_components, indices] =
+        GENERATE(table<std::size_t, std::vector<std::size_t>>({
+            {1, {0}},
+            {3, {0, 1, 2}},
+            {4, {0, 1, 2}},
+            {4, {1, 2, 3}},
+            {4, {3, 1}},
+        }));
+    CAPTURE(n_components, indices);
+    std::size_t const n_hist = indices.size();
+
+    auto const data = test_data<T>(size * n_components);
+    auto const mask = test_data<u8, 1>(size);
+
+    std::vector<u32> ref(n_hist * nbins);
+    std::vector<u32> ref_overflow(n_hist);
+    reference_hist_overflow(data, mask, sample_bits, n_components, indices,
+                            ref, ref_overflow);
+
+    bool const parallel = GENERATE(false, true);
+    CAPTURE(parallel);
+
+    std::vector<u32> hist(n_hist * nbins);
+    std::vector<u32> overflow(n_hist);
+    auto const offset = roi_y * width + roi_x;
+    call_api_overflow<T, sample_bits>(
+        data.data() + offset * n_components, mask.data() + offset, roi_height,
+        roi_width, width, width, n_components, n_hist, indices.data(),
+        hist.data(), overflow.data(), parallel);
+    CHECK(hist == ref);
+    CHECK(overflow == ref_overflow);
+}
+
+TEST_CASE("C API overflow is accumulated") {
+    std::vector<u16> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<u16>(i % 8 == 0 ? 4096 + i : i % 4096);
+    }
+    constexpr std::size_t indices[] = {0};
+    std::vector<u32> hist(4096);
+    u32 overflow = 5;
+    ihist_hist16_2d_overflow(12, data.data(), nullptr, height, width, width,
+                             width, 1, 1, indices, hist.data(), &overflow,
+                             false);
+    CHECK(overflow == 5 + (size + 7) / 8);
+}
+
+TEST_CASE("C API overflow counts with parallel execution") {
+    // Large enough to take the multithreaded path.
+    constexpr std::size_t w = 1024;
+    constexpr std::size_t h = 1024;
+    auto const data = test_data<u16>(w * h);
+    constexpr std::size_t indices[] = {0};
+
+    auto const bits = GENERATE(std::size_t(12), std::size_t(10));
+    CAPTURE(bits);
+    u32 expected = 0;
+    for (auto const v : data) {
+        expected += v >> bits ? 1 : 0;
+    }
+
+    std::vector<u32> hist(std::size_t{1} << bits);
+    u32 overflow = 0;
+    ihist_hist16_2d_overflow(bits, data.data(), nullptr, h, w, w, w, 1, 1,
+                             indices, hist.data(), &overflow, true);
+    CHECK(overflow == expected);
+}
+
+TEST_CASE("striped kernel reports overflow bin") {
+    auto const data = test_data<u16>(size * 3);
+    auto const mask = test_data<u8, 1>(size);
+    constexpr std::size_t nbins = 1 << 12;
+    std::vector<std::size_t> const indices{0, 1, 2};
+
+    std::vector<u32> ref(3 * nbins);
+    std::vector<u32> ref_overflow(3);
+    reference_hist_overflow(data, mask, 12, 3, indices, ref, ref_overflow);
+
+    auto const offset = roi_y * width + roi_x;
+    std::vector<u32> hist(3 * nbins);
+    std::vector<u32> overflow(3);
+    SECTION("single-threaded") {
+        ihist::internal::histxy_striped<tuning_4x4, u16, true, 12, 0, 3, 0, 1,
+                                        2>(
+            data.data() + offset * 3, mask.data() + offset, roi_height,
+            roi_width, width, width, hist.data(), overflow.data());
+    }
+    SECTION("multithreaded") {
+        ihist::internal::histxy_striped_maybe_mt<tuning_4x4, u16, true, 12, 0,
+                                                 3, 0, 1, 2>(
+            data.data() + offset * 3, mask.data() + offset, roi_height,
+            roi_width, width, width, hist.data(), overflow.data(), true, 1);
+    }
+    CHECK(hist == ref);
+    CHECK(overflow == ref_overflow);
+}
+
+TEST_CASE("dynamic kernel reports overflow bin") {
+    auto const data = test_data<u16>(size * 3);
+    auto const mask = test_data<u8, 1>(size);
+    constexpr std::size_t nbins = 1 << 12;
+    std::vector<std::size_t> const indices{2, 0};
+
+    std::vector<u32> ref(2 * nbins);
+    std::vector<u32> ref_overflow(2);
+    reference_hist_overflow(data, mask, 12, 3, indices, ref, ref_overflow);
+
+    auto const offset = roi_y * width + roi_x;
+    std::vector<u32> hist(2 * nbins);
+    std::vector<u32> overflow(2);
+    SECTION("single-threaded") {
+        ihist::histxy_dynamic_st<u16, true, 12>(
+            data.data() + offset * 3, mask.data() + offset, roi_height,
+            roi_width, width, width, 3, 2, indices.data(), hist.data(),
+            overflow.data());
+    }
+    SECTION("multithreaded") {
+        // Grain size before overflow, as in the signature without overflow.
+        ihist::histxy_dynamic_mt<u16, true, 12>(
+            data.data() + offset * 3, mask.data() + offset, roi_height,
+            roi_width, width, width, 3, 2, indices.data(), hist.data(), 1,
+            overflow.data());
+    }
+    CHECK(hist == ref);
+    CHECK(overflow == ref_overflow);
+}
@@ -0,0 +1,231 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+namespace {
+
+// A sequence of histograms of slowly changing images, as from a camera.
+auto make_series(std::size_t bits, std::size_t n_components, std::size_t n)
+    -> std::vector<std::vector<u32>> {
+    std::vector<std::vector<u32>> series;
+    auto const data = generate_random_data<u16, 8>(4096 * n_components, 1);
+    auto const noise = generate_random_data<u8, 2>(4096 * n_components, 2);
+    std::vector<u16> frame(data.size());
+    std::vector<std::size_t> indices(n_components);
+    for (std::size_t c = 0; c < n_components; ++c) {
+        indices[c] = c;
+    }
+    for (std::size_t f = 0; f < n; ++f) {
+        for (std::size_t i = 0; i < frame.size(); ++i) {
+            frame[i] = static_cast<u16>(data[i] + (noise[i] & f) + f);
+        }
+        std::vector<u32> hist(n_components << bits);
+        ihist_hist16_2d(bits, frame.data(), nullptr, 64, 64, 64, 64,
+                        n_components, n_components, indices.data(),
+                        hist.data(), false);
+        series.push_back(hist);
+    }
+    return series;
+}
+
+auto temp_path(std::string const &name) -> std::string {
+    return (std::filesystem::temp_directory_path() /
+            ("ihist-test-series-" + name))
+        .string();
+}
+
+} // namespace
+
+TEST_CASE("series encoding round trip") {
+    std::size_t const n = GENERATE(std::size_t(0), std::size_t(1),
+                                   std::size_t(31), std::size_t(4096));
+    CAPTURE(n);
+    auto previous = test_data<u32, 32>(n);
+    auto histogram = previous;
+    for (std::size_t i = 0; i < n; i += 3) {
+        histogram[i] = static_cast<u32>(i * 7919u);
+    }
+    if (n > 0) {
+        histogram[n - 1] = 0xffffffffu;
+        previous[n - 1] = 0;
+    }
+
+    std::vector<u8> encoded(ihist_series_encoded_bound(n));
+    SECTION("delta") {
+        auto const size = ihist_series_encode(
+            n, previous.data(), histogram.data(), encoded.data());
+        CHECK(size <= encoded.size());
+        auto decoded = previous;
+        CHECK(ihist_series_decode(n, encoded.data(), size, decoded.data()));
+        CHECK(decoded == histogram);
+    }
+    SECTION("keyframe") {
+        auto const size = ihist_series_encode(n, nullptr, histogram.data(),
+                                              encoded.data());
+        CHECK(size <= encoded.size());
+        std::vector<u32> decoded(n);
+        CHECK(ihist_series_decode(n, encoded.data(), size, decoded.data()));
+        CHECK(decoded == histogram);
+    }
+}
+
+TEST_CASE("series encoding of unchanged histogram is empty") {
+    auto const hist = test_data<u32, 32>(1 << 16);
+    std::vector<u8> encoded(ihist_series_encoded_bound(hist.size()));
+    CHECK(ihist_series_encode(hist.size(), hist.data(), hist.data(),
+                              encoded.data()) == 0);
+}
+
+TEST_CASE("series decoding rejects malformed data") {
+    std::vector<u32> hist(16);
+    // Gap beyond the end.
+    std::vector<u8> const gap{16, 2};
+    CHECK_FALSE(ihist_series_decode(16, gap.data(), gap.size(), hist.data()));
+    // Truncated varint.
+    std::vector<u8> const truncated{0, 0x80};
+    CHECK_FALSE(ihist_series_decode(16, truncated.data(), truncated.size(),
+                                    hist.data()));
+    // Count going negative.
+    std::vector<u8> const negative{0, 1};
+    CHECK_FALSE(ihist_series_decode(16, negative.data(), negative.size(),
+                                    hist.data()));
+}
+
+TEST_CASE("series file random and sequential access") {
+    std::size_t const bits = GENERATE(std::size_t(8), std::size_t(12));
+    std::size_t const n_components = GENERATE(std::size_t(1), std::size_t(3));
+    std::size_t const keyframe_interval = GENERATE(std::size_t(1),
+                                                   std::size_t(16));
+    CAPTURE(bits, n_components, keyframe_interval);
+    auto const series = make_series(bits, n_components, 50);
+    auto const path = temp_path("access");
+
+    ihist_series_writer *w = ihist_series_create(path.c_str(), bits,
+                                                 n_components,
+                                                 keyframe_interval);
+    REQUIRE(w != nullptr);
+    for (auto const &h : series) {
+        REQUIRE(ihist_series_append(w, h.data()));
+    }
+    REQUIRE(ihist_series_close(w));
+
+    ihist_series_reader *r = ihist_series_open(path.c_str());
+    REQUIRE(r != nullptr);
+    std::size_t info_bits = 0;
+    std::size_t info_components = 0;
+    std::size_t info_count = 0;
+    ihist_series_info(r, &info_bits, &info_components, &info_count);
+    CHECK(info_bits == bits);
+    CHECK(info_components == n_components);
+    CHECK(info_count == series.size());
+
+    std::vector<u32> hist(n_components << bits);
+    for (std::size_t i = 0; i < series.size(); ++i) {
+        REQUIRE(ihist_series_read(r, i, hist.data()));
+        CHECK(hist == series[i]);
+    }
+    for (std::size_t i : {49, 0, 17, 16, 15, 33, 33, 2}) {
+        CAPTURE(i);
+        REQUIRE(ihist_series_read(r, i, hist.data()));
+        CHECK(hist == series[i]);
+    }
+    CHECK_FALSE(ihist_series_read(r, series.size(), hist.data()));
+    ihist_series_free(r);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("series file that was not closed is readable") {
+    auto const series = make_series(10, 1, 20);
+    auto const path = temp_path("unclosed");
+
+    ihist_series_writer *w = ihist_series_create(path.c_str(), 10, 1, 8);
+    REQUIRE(w != nullptr);
+    for (auto const &h : series) {
+        REQUIRE(ihist_series_append(w, h.data()));
+    }
+    REQUIRE(ihist_series_close(w));
+
+    // Cut off the index and part of the last record.
+    auto const size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size - 24 - 8 * series.size() - 1);
+
+    ihist_series_reader *r = ihist_series_open(path.c_str());
+    REQUIRE(r != nullptr);
+    std::size_t count = 0;
+    ihist_series_info(r, nullptr, nullptr, &count);
+    CHECK(count == series.size() - 1);
+    std::vector<u32> hist(1 << 10);
+    for (std::size_t i = count; i-- > 0;) {
+        REQUIRE(ihist_series_read(r, i, hist.data()));
+        CHECK(hist == series[i]);
+    }
+    ihist_series_free(r);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("series file with corrupt index is readable") {
+    auto const series = make_series(10, 1, 20);
+    auto const path = temp_path("badindex");
+
+    ihist_series_writer *w = ihist_series_create(path.c_str(), 10, 1, 8);
+    REQUIRE(w != nullptr);
+    for (auto const &h : series) {
+        REQUIRE(ihist_series_append(w, h.data()));
+    }
+    REQUIRE(ihist_series_close(w));
+
+    // Point one index entry past the end of the file.
+    auto const size = std::filesystem::file_size(path);
+    auto const entry = static_cast<long>(size - 24 - 8 * series.size() + 8);
+    std::FILE *f = std::fopen(path.c_str(), "r+b");
+    REQUIRE(f != nullptr);
+    REQUIRE(std::fseek(f, entry, SEEK_SET) == 0);
+    std::uint8_t const garbage[8] = {0xff, 0xff, 0xff, 0xff,
+                                     0xff, 0xff, 0xff, 0x7f};
+    REQUIRE(std::fwrite(garbage, 1, 8, f) == 8);
+    std::fclose(f);
+
+    ihist_series_reader *r = ihist_series_open(path.c_str());
+    REQUIRE(r != nullptr);
+    std::size_t count = 0;
+    ihist_series_info(r, nullptr, nullptr, &count);
+    CHECK(count == series.size());
+    std::vector<u32> hist(1 << 10);
+    for (std::size_t i = 0; i < count; ++i) {
+        REQUIRE(ihist_series_read(r, i, hist.data()));
+        CHECK(hist == series[i]);
+    }
+    ihist_series_free(r);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("series open rejects other files") {
+    auto const path = temp_path("other");
+    std::FILE *f = std::fopen(path.c_str(), "wb");
+    REQUIRE(f != nullptr);
+    std::fputs("not a histogram series, but long enough to have a header", f);
+    std::fclose(f);
+    CHECK(ihist_series_open(path.c_str()) == nullptr);
+    std::remove(path.c_str());
+    CHECK(ihist_series_open(path.c_str()) == nullptr);
+}
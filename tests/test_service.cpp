@@ -0,0 +1,153 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "client.hpp"
+#include "gen_data.hpp"
+#include "posix.hpp"
+#include "protocol.hpp"
+#include "server.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+namespace {
+
+auto unique_name(std::string const &what) -> std::string {
+    return "/ihist-test-" + what + "-" + std::to_string(getpid());
+}
+
+} // namespace
+
+TEST_CASE("service publishes frame histograms") {
+    std::size_t const n_components = GENERATE(1, 3);
+    bool const parallel = GENERATE(false, true);
+    CAPTURE(n_components, parallel);
+
+    std::size_t const width = 70;
+    std::size_t const stride = 73;
+    std::size_t const height = 50;
+    std::size_t const offset = 64; // Frame follows a header in the buffer
+    auto const data = test_data<u16, 12>(height * stride * n_components);
+    std::string const frame_name = unique_name("frame");
+    auto frame = ihist::service::shared_memory::create(
+        frame_name, offset + data.size() * sizeof(u16));
+    std::memcpy(static_cast<char *>(frame.data()) + offset, data.data(),
+                data.size() * sizeof(u16));
+
+    ihist::service::server_config config;
+    config.socket_path = "/tmp" + unique_name("socket");
+    config.region_name = unique_name("region");
+    config.max_sample_bits = 12;
+    config.parallel = parallel;
+    ihist::service::server srv(config);
+    std::thread thread([&] { srv.run(); });
+
+    {
+        ihist::service::client cli(config.socket_path);
+        ihist::service::region_reader const reader(config.region_name);
+        ihist::service::snapshot snap{};
+        CHECK_FALSE(reader.read_latest(snap));
+
+        ihist::service::frame_request request{};
+        request.version = ihist::service::protocol_version;
+        request.sample_size = 2;
+        request.sample_bits = 12;
+        request.n_components = static_cast<std::uint32_t>(n_components);
+        request.frame_id = 42;
+        request.offset = offset;
+        request.height = height;
+        request.width = width;
+        request.stride = stride;
+        std::strncpy(request.shm_name, frame_name.c_str(),
+                     sizeof(request.shm_name) - 1);
+
+        auto const reply = cli.submit(request);
+        CHECK(reply.result == ihist::service::status::ok);
+        CHECK(reply.frame_id == 42);
+        REQUIRE(reader.read_latest(snap));
+        CHECK(snap.sequence == reply.sequence);
+        CHECK(reader.sequence() == reply.sequence);
+        CHECK(snap.frame_id == 42);
+        CHECK(snap.sample_bits == 12);
+        CHECK(snap.n_components == n_components);
+
+        std::vector<std::size_t> indices(n_components);
+        for (std::size_t i = 0; i < n_components; ++i) {
+            indices[i] = i;
+        }
+        std::vector<u32> expected(n_components << 12);
+        ihist_hist16_2d(12, data.data(), nullptr, height, width, stride,
+                        stride, n_components, n_components, indices.data(),
+                        expected.data(), false);
+        CHECK(snap.histogram == expected);
+
+        // Invalid requests are rejected without publishing.
+        auto bad = request;
+        bad.sample_bits = 16; // Above the service's limit
+        CHECK(cli.submit(bad).result ==
+              ihist::service::status::bad_request);
+        bad = request;
+        bad.n_components = 0;
+        CHECK(cli.submit(bad).result ==
+              ihist::service::status::bad_request);
+        for (std::uint32_t const sample_size : {0, 3}) {
+            bad = request;
+            bad.sample_size = sample_size;
+            CHECK(cli.submit(bad).result ==
+                  ihist::service::status::bad_request);
+        }
+        for (std::uint64_t const bad_stride : {std::size_t(0), width - 1}) {
+            bad = request;
+            bad.stride = bad_stride;
+            CHECK(cli.submit(bad).result ==
+                  ihist::service::status::bad_request);
+        }
+        bad = request;
+        bad.height = height + 1; // Extends past the end of the memory
+        CHECK(cli.submit(bad).result == ihist::service::status::shm_error);
+        bad = request;
+        std::strncpy(bad.shm_name, "/ihist-test-missing",
+                     sizeof(bad.shm_name) - 1);
+        CHECK(cli.submit(bad).result == ihist::service::status::shm_error);
+        CHECK(reader.sequence() == reply.sequence);
+
+        // A frame object recreated under the same name, with the same size,
+        // is remapped rather than read through the stale mapping.
+        auto const data2 =
+            generate_random_data<u16, 12>(data.size(), TEST_SEED + 1);
+        auto frame2 = ihist::service::shared_memory::create(
+            frame_name, offset + data2.size() * sizeof(u16));
+        std::memcpy(static_cast<char *>(frame2.data()) + offset,
+                    data2.data(), data2.size() * sizeof(u16));
+        request.frame_id = 43;
+        auto const reply2 = cli.submit(request);
+        CHECK(reply2.result == ihist::service::status::ok);
+        REQUIRE(reader.read_latest(snap));
+        CHECK(snap.frame_id == 43);
+        std::vector<u32> expected2(n_components << 12);
+        ihist_hist16_2d(12, data2.data(), nullptr, height, width, stride,
+                        stride, n_components, n_components, indices.data(),
+                        expected2.data(), false);
+        CHECK(snap.histogram == expected2);
+    }
+
+    srv.stop();
+    thread.join();
+}
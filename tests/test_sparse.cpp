@@ -0,0 +1,191 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+namespace {
+
+// Expand sparse output back to dense histograms.
+auto densify(std::size_t bits, std::size_t n_hist,
+             std::vector<u16> const &bins, std::vector<u32> const &counts,
+             std::vector<std::size_t> const &n_nonzero, std::size_t total)
+    -> std::vector<u32> {
+    std::vector<u32> dense(n_hist << bits);
+    std::size_t k = 0;
+    for (std::size_t c = 0; c < n_hist; ++c) {
+        for (std::size_t i = 0; i < n_nonzero[c]; ++i, ++k) {
+            CHECK(counts[k] != 0);
+            if (i > 0) {
+                CHECK(bins[k] > bins[k - 1]);
+            }
+            dense[(c << bits) + bins[k]] = counts[k];
+        }
+    }
+    CHECK(k == total);
+    return dense;
+}
+
+} // namespace
+
+TEST_CASE("sparse histogram matches dense histogram") {
+    // Small sizes take the scratch path; large ones the dense path.
+    auto const [width, height] = GENERATE(table<std::size_t, std::size_t>(
+        {{0, 0}, {1, 1}, {17, 5}, {64, 64}, {300, 200}}));
+    std::size_t const bits = GENERATE(std::size_t(10), std::size_t(16));
+    auto const [n_components, indices] =
+        GENERATE(table<std::size_t, std::vector<std::size_t>>({
+            {1, {0}},
+            {3, {2, 0}},
+        }));
+    bool const use_mask = GENERATE(false, true);
+    CAPTURE(width, height, bits, n_components, indices, use_mask);
+
+    std::size_t const stride = width + 2;
+    std::size_t const n_hist = indices.size();
+    auto const data = test_data<u16, 16>(height * stride * n_components + 1);
+    auto const mask = test_data<u8, 1>(height * stride + 1);
+    u8 const *mask_ptr = use_mask ? mask.data() : nullptr;
+    std::size_t const mask_stride = use_mask ? stride : 0;
+
+    std::vector<u32> ref(n_hist << bits);
+    if (width * height > 0) {
+        ihist_hist16_2d(bits, data.data(), mask_ptr, height, width, stride,
+                        mask_stride, n_components, n_hist, indices.data(),
+                        ref.data(), false);
+    }
+
+    std::size_t const cap =
+        ihist_sparse_capacity(bits, n_hist, width * height);
+    std::vector<u16> bins(cap);
+    std::vector<u32> counts(cap);
+    std::vector<std::size_t> n_nonzero(n_hist);
+    std::size_t const total = ihist_hist16_2d_sparse(
+        bits, data.data(), mask_ptr, height, width, stride, mask_stride,
+        n_components, n_hist, indices.data(), bins.data(), counts.data(),
+        n_nonzero.data(), true);
+    CHECK(total <= cap);
+    CHECK(densify(bits, n_hist, bins, counts, n_nonzero, total) == ref);
+}
+
+TEST_CASE("sparse histogram of 8-bit image") {
+    std::size_t const width = GENERATE(std::size_t(3), std::size_t(1000));
+    std::size_t const bits = GENERATE(std::size_t(5), std::size_t(8));
+    CAPTURE(width, bits);
+    auto const data = test_data<u8, 8>(width);
+    std::size_t const index = 0;
+
+    std::vector<u32> ref(std::size_t(1) << bits);
+    ihist_hist8_2d(bits, data.data(), nullptr, 1, width, width, 0, 1, 1,
+                   &index, ref.data(), false);
+
+    std::size_t const cap = ihist_sparse_capacity(bits, 1, width);
+    std::vector<u16> bins(cap);
+    std::vector<u32> counts(cap);
+    std::vector<std::size_t> n_nonzero(1);
+    std::size_t const total = ihist_hist8_2d_sparse(
+        bits, data.data(), nullptr, 1, width, width, 0, 1, 1, &index,
+        bins.data(), counts.data(), n_nonzero.data(), false);
+    CHECK(densify(bits, 1, bins, counts, n_nonzero, total) == ref);
+}
+
+TEST_CASE("dense histogram to sparse") {
+    std::size_t const bits = GENERATE(std::size_t(0), std::size_t(6),
+                                      std::size_t(16));
+    CAPTURE(bits);
+    auto hist = test_data<u32, 2>(std::size_t(2) << bits);
+    for (std::size_t i = 0; i < hist.size(); i += 5) {
+        hist[i] = 0;
+    }
+    std::vector<u16> bins(hist.size());
+    std::vector<u32> counts(hist.size());
+    std::vector<std::size_t> n_nonzero(2);
+    std::size_t const total = ihist_histogram_to_sparse(
+        bits, 2, hist.data(), bins.data(), counts.data(), n_nonzero.data());
+    CHECK(densify(bits, 2, bins, counts, n_nonzero, total) == hist);
+}
+
+TEST_CASE("sparse histogram of 32-bit keys") {
+    // Label-like data (few keys, long runs), a wide spread of keys, and a
+    // size large enough to be counted in parallel.
+    auto const [width, height, key_bits] =
+        GENERATE(table<std::size_t, std::size_t, std::size_t>({
+            {0, 0, 32},
+            {1, 1, 32},
+            {37, 11, 8},
+            {300, 200, 32},
+            {1024, 600, 20},
+        }));
+    std::size_t const sample_bits = GENERATE(std::size_t(16), std::size_t(32));
+    auto const [n_components, indices] =
+        GENERATE(table<std::size_t, std::vector<std::size_t>>({
+            {1, {0}},
+            {2, {1, 0}},
+        }));
+    bool const use_mask = GENERATE(false, true);
+    CAPTURE(width, height, key_bits, sample_bits, n_components, use_mask);
+
+    std::size_t const stride = width + 3;
+    std::size_t const n_hist = indices.size();
+    auto data = generate_random_data<u32, 32>(
+        height * stride * n_components + 1, 42);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        // Runs of 4 equal keys.
+        data[i] = data[i / 4 * 4] >> (32 - key_bits);
+    }
+    auto const mask = test_data<u8, 1>(height * stride + 1);
+    u8 const *mask_ptr = use_mask ? mask.data() : nullptr;
+
+    std::vector<std::map<u32, u32>> ref(n_hist);
+    for (std::size_t c = 0; c < n_hist; ++c) {
+        for (std::size_t y = 0; y < height; ++y) {
+            for (std::size_t x = 0; x < width; ++x) {
+                u32 const v =
+                    data[(y * stride + x) * n_components + indices[c]];
+                if ((!use_mask || mask[y * stride + x] != 0) &&
+                    (sample_bits == 32 || (v >> sample_bits) == 0)) {
+                    ++ref[c][v];
+                }
+            }
+        }
+    }
+
+    std::size_t const cap =
+        ihist_sparse_capacity(sample_bits, n_hist, width * height);
+    std::vector<u32> keys(cap);
+    std::vector<u32> counts(cap);
+    std::vector<std::size_t> n_nonzero(n_hist);
+    std::size_t const total = ihist_hist32_2d_sparse(
+        sample_bits, data.data(), mask_ptr, height, width, stride,
+        use_mask ? stride : 0, n_components, n_hist, indices.data(),
+        keys.data(), counts.data(), n_nonzero.data(), true);
+
+    std::size_t k = 0;
+    for (std::size_t c = 0; c < n_hist; ++c) {
+        std::vector<std::pair<u32, u32>> got;
+        for (std::size_t i = 0; i < n_nonzero[c]; ++i, ++k) {
+            got.emplace_back(keys[k], counts[k]);
+        }
+        // Equal to the map's contents only if sorted by key.
+        CHECK(got == std::vector<std::pair<u32, u32>>(ref[c].begin(),
+                                                       ref[c].end()));
+    }
+    CHECK(k == total);
+}
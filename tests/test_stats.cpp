@@ -0,0 +1,120 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+using u64 = std::uint64_t;
+
+TEST_CASE("stats of empty histogram") {
+    std::vector<u32> const hist(256);
+    ihist_stats stats{};
+    ihist_histogram_stats(8, 1, hist.data(), &stats);
+    CHECK(stats.count == 0);
+    CHECK(stats.sum == 0);
+    CHECK(stats.sum_of_squares == 0);
+    CHECK(stats.min == 0);
+    CHECK(stats.max == 0);
+    CHECK(stats.n_saturated == 0);
+    CHECK(std::isnan(stats.mean));
+    CHECK(std::isnan(stats.stddev));
+}
+
+TEST_CASE("stats of single-valued histogram") {
+    std::vector<u32> hist(4096);
+    hist[1000] = 7;
+    ihist_stats stats{};
+    ihist_histogram_stats(12, 1, hist.data(), &stats);
+    CHECK(stats.count == 7);
+    CHECK(stats.sum == 7000);
+    CHECK(stats.sum_of_squares == 7000000);
+    CHECK(stats.min == 1000);
+    CHECK(stats.max == 1000);
+    CHECK(stats.n_saturated == 0);
+    CHECK(stats.mean == 1000.0);
+    CHECK(stats.stddev == 0.0);
+}
+
+TEST_CASE("stats count saturated samples in the top bin") {
+    std::vector<u32> hist(32);
+    hist[0] = 1;
+    hist[31] = 3;
+    ihist_stats stats{};
+    ihist_histogram_stats(5, 1, hist.data(), &stats);
+    CHECK(stats.min == 0);
+    CHECK(stats.max == 31);
+    CHECK(stats.n_saturated == 3);
+}
+
+TEST_CASE("stats match direct computation over masked multi-component image") {
+    constexpr std::size_t width = 65;
+    constexpr std::size_t height = 63;
+    constexpr std::size_t size = width * height;
+    constexpr std::size_t bits = 12;
+    constexpr std::size_t nbins = std::size_t{1} << bits;
+
+    auto const data = test_data<u16, bits>(4 * size);
+    auto const mask = test_data<u8, 1>(size);
+    constexpr std::size_t indices[] = {0, 1, 2};
+
+    std::vector<u32> hist(3 * nbins);
+    ihist_hist16_2d(bits, data.data(), mask.data(), height, width, width,
+                    width, 4, 3, indices, hist.data(), false);
+
+    std::vector<ihist_stats> stats(3);
+    ihist_histogram_stats(bits, 3, hist.data(), stats.data());
+
+    for (std::size_t s = 0; s < 3; ++s) {
+        u64 count = 0;
+        u64 sum = 0;
+        u64 sum_sq = 0;
+        u32 min = nbins;
+        u32 max = 0;
+        u64 saturated = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            if (mask[i] == 0) {
+                continue;
+            }
+            u32 const v = data[4 * i + indices[s]];
+            ++count;
+            sum += v;
+            sum_sq += u64(v) * v;
+            min = std::min(min, v);
+            max = std::max(max, v);
+            saturated += v == nbins - 1 ? 1 : 0;
+        }
+        double const mean = double(sum) / double(count);
+        double ssd = 0.0;
+        for (std::size_t i = 0; i < size; ++i) {
+            if (mask[i] != 0) {
+                double const d = data[4 * i + indices[s]] - mean;
+                ssd += d * d;
+            }
+        }
+
+        CHECK(stats[s].count == count);
+        CHECK(stats[s].sum == sum);
+        CHECK(stats[s].sum_of_squares == sum_sq);
+        CHECK(stats[s].min == min);
+        CHECK(stats[s].max == max);
+        CHECK(stats[s].n_saturated == saturated);
+        CHECK(std::abs(stats[s].mean - mean) < 1e-9 * mean);
+        CHECK(std::abs(stats[s].stddev - std::sqrt(ssd / double(count))) <
+              1e-9 * mean);
+    }
+}
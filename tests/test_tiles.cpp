@@ -0,0 +1,93 @@
+/*
+ * This file is part of ihist
+ * Copyright 2025 Board of Regents of the University of Wisconsin System
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <ihist/ihist.h>
+
+#include "gen_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using u8 = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+
+TEST_CASE("tiled histogram matches the assembled image") {
+    // A 2x3 grid of tiles cut out of one image, with ragged edges.
+    auto const [width, height, tile_w, tile_h] =
+        GENERATE(table<std::size_t, std::size_t, std::size_t, std::size_t>({
+            {65, 63, 30, 25},
+            {2000, 1100, 700, 512},
+            {1, 1, 1, 1},
+        }));
+    auto const [n_components, indices] =
+        GENERATE(table<std::size_t, std::vector<std::size_t>>({
+            {1, {0}},
+            {3, {2, 0}},
+        }));
+    bool const use_mask = GENERATE(false, true);
+    bool const parallel = GENERATE(false, true);
+    CAPTURE(width, height, tile_w, tile_h, n_components, indices, use_mask,
+            parallel);
+
+    std::size_t const stride = width + 3;
+    std::size_t const n_hist = indices.size();
+    auto const data = test_data<u16, 12>(height * stride * n_components);
+    auto const mask = test_data<u8, 1>(height * stride);
+
+    std::vector<u32> ref(n_hist << 12);
+    ihist_hist16_2d(12, data.data(), use_mask ? mask.data() : nullptr, height,
+                    width, stride, use_mask ? stride : 0, n_components,
+                    n_hist, indices.data(), ref.data(), false);
+
+    // Tiles are views into the image, so the strides are the image's.
+    std::vector<ihist_tile16> tiles;
+    for (std::size_t y = 0; y < height; y += tile_h) {
+        for (std::size_t x = 0; x < width; x += tile_w) {
+            ihist_tile16 tile{};
+            tile.image = data.data() + (y * stride + x) * n_components;
+            tile.mask = use_mask ? mask.data() + y * stride + x : nullptr;
+            tile.height = std::min(tile_h, height - y);
+            tile.width = std::min(tile_w, width - x);
+            tile.image_stride = stride;
+            tile.mask_stride = use_mask ? stride : 0;
+            tiles.push_back(tile);
+        }
+    }
+    // An empty tile is allowed.
+    tiles.push_back(ihist_tile16{});
+
+    std::vector<u32> hist(n_hist << 12, 1);
+    ihist_hist16_tiles(12, tiles.size(), tiles.data(), n_components, n_hist,
+                       indices.data(), hist.data(), parallel);
+    for (auto &c : ref) {
+        ++c;
+    }
+    CHECK(hist == ref);
+}
+
+TEST_CASE("tiles of different sizes and masking") {
+    std::vector<u8> const a{1, 2, 3, 4};
+    std::vector<u8> const b{5, 5, 255};
+    std::vector<u8> const b_mask{1, 0, 1};
+    std::vector<ihist_tile8> const tiles{
+        {a.data(), nullptr, 2, 2, 2, 0},
+        {b.data(), b_mask.data(), 1, 3, 3, 3},
+    };
+    std::vector<std::size_t> const indices{0};
+    std::vector<u32> hist(256);
+    ihist_hist8_tiles(8, tiles.size(), tiles.data(), 1, 1, indices.data(),
+                      hist.data(), false);
+    CHECK(hist[1] == 1);
+    CHECK(hist[4] == 1);
+    CHECK(hist[5] == 1);
+    CHECK(hist[255] == 1);
+}